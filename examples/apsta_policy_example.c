@@ -0,0 +1,41 @@
+#include <stdio.h>
+#include "nvs_flash.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "wifi_controller.h"
+
+/*
+ * AP is started first and serves clients, then STA joins upstream network without sweeping
+ * all channels. Connect one client to AP_SSID before STA connects to see disruption counters.
+ */
+void app_main(void)
+{
+    wifi_c_apsta_policy_t policy = WIFI_C_APSTA_POLICY_DEFAULT();
+    wifi_c_apsta_stats_t stats;
+
+    // Initialize NVS
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK( ret );
+
+    // Clients get 5 beacons warning before AP follows STA to other channel
+    policy.csa_count = 5;
+    ESP_ERROR_CHECK(wifi_c_apsta_set_policy(&policy));
+
+    ESP_ERROR_CHECK(wifi_c_init_wifi(WIFI_C_MODE_APSTA));
+    ESP_ERROR_CHECK(wifi_c_start_ap("AP_SSID", "AP_PASSWORD"));
+    vTaskDelay(pdMS_TO_TICKS(20000)); // time to connect client to AP
+    ESP_ERROR_CHECK(wifi_c_start_sta("STA_SSID", "STA_PASSWORD"));
+
+    wifi_c_apsta_get_stats(&stats);
+    printf("connects %lu, same channel %lu, channel switches %lu (CSA %lu, %lu clients)\n",
+           (unsigned long)stats.connects, (unsigned long)stats.same_channel, (unsigned long)stats.channel_switches,
+           (unsigned long)stats.csa_announced, (unsigned long)stats.clients_at_switch);
+    printf("clients dropped %lu, reconnects %lu, longest time off AP channel %lu us\n",
+           (unsigned long)stats.clients_dropped, (unsigned long)stats.reconnects,
+           (unsigned long)stats.max_off_channel_us);
+}
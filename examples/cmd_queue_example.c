@@ -0,0 +1,55 @@
+#include <stdio.h>
+#include "nvs_flash.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "wifi_controller.h"
+#include "wifi_c_cmd.h"
+
+/*
+ * Two tasks scan at the same time, second one gets results of the first scan.
+ */
+static void scan_task(void *arg)
+{
+    wifi_c_scan_result_t scan;
+
+    if (wifi_c_scan_all_ap(&scan) == ESP_OK)
+    {
+        printf("%s: %u APs\n", (const char *)arg, scan.ap_count);
+    }
+    vTaskDelete(NULL);
+}
+
+void app_main(void)
+{
+    wifi_c_cmd_stats_t stats;
+
+    // Initialize NVS
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK( ret );
+
+    // API calls from all tasks run one at a time on controller task
+    ESP_ERROR_CHECK(wifi_c_cmd_start(NULL));
+    ESP_ERROR_CHECK(wifi_c_init_wifi(WIFI_C_MODE_STA));
+    ESP_ERROR_CHECK(wifi_c_start_sta("STA_SSID", "STA_PASSWORD"));
+
+    xTaskCreate(scan_task, "scan_a", 4096, "scan_a", 5, NULL);
+    xTaskCreate(scan_task, "scan_b", 4096, "scan_b", 5, NULL);
+    vTaskDelay(pdMS_TO_TICKS(10000));
+
+    ESP_ERROR_CHECK(wifi_c_cmd_get_stats(&stats));
+    for (int i = 0; i < WIFI_C_CMD_COUNT; i++)
+    {
+        const wifi_c_cmd_latency_t *latency = &stats.commands[i];
+        if (latency->calls > 0)
+        {
+            printf("%-22s calls %lu coalesced %lu avg wait %llu us avg run %llu us max run %lu us\n",
+                   wifi_c_cmd_name(i), latency->calls, latency->coalesced, latency->wait_us / latency->calls,
+                   latency->run_us / latency->calls, latency->max_run_us);
+        }
+    }
+}
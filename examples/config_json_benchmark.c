@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "cJSON.h"
+#include "wifi_controller.h"
+#include "wifi_c_config.h"
+
+/*
+ * Compares wifi_c_config_parse() with cJSON_Parse() plus reading the same members, for typical
+ * provisioning documents. Project needs "json" component in REQUIRES for cJSON.
+ */
+#define RUNS        1000
+
+static const char *documents[] = {
+    "{\"sta\":{\"ssid\":\"HomeNetwork\",\"password\":\"correct horse battery\"}}",
+    "{\"mode\":\"apsta\",\"sta\":[{\"ssid\":\"HomeNetwork\",\"password\":\"correct horse battery\"},"
+    "{\"ssid\":\"Office\",\"password\":\"s3cr3t-office-pass\"}],\"ap\":{\"ssid\":\"device-setup\","
+    "\"password\":\"provision-me\",\"channel\":6,\"bandwidth\":20,\"authmode\":\"wpa2\",\"max_connection\":2}}",
+};
+
+static uint32_t cjson_allocs = 0;
+
+static void *counting_malloc(size_t size)
+{
+    cjson_allocs++;
+    return malloc(size);
+}
+
+static int read_with_cjson(const char *text)
+{
+    cJSON *root = cJSON_Parse(text);
+    int found = 0;
+
+    if (root == NULL)
+    {
+        return -1;
+    }
+    found += cJSON_IsString(cJSON_GetObjectItem(root, "mode"));
+    cJSON *sta = cJSON_GetObjectItem(root, "sta");
+    cJSON *networks = cJSON_IsArray(sta) ? sta : NULL; // cJSON_ArrayForEach() doesn't parenthesize its array argument
+    cJSON *network = NULL;
+    cJSON_ArrayForEach(network, networks)
+    {
+        found += cJSON_IsString(cJSON_GetObjectItem(network, "ssid"));
+        found += cJSON_IsString(cJSON_GetObjectItem(network, "password"));
+    }
+    if (cJSON_IsObject(sta))
+    {
+        found += cJSON_IsString(cJSON_GetObjectItem(sta, "ssid"));
+        found += cJSON_IsString(cJSON_GetObjectItem(sta, "password"));
+    }
+    cJSON *ap = cJSON_GetObjectItem(root, "ap");
+    found += cJSON_IsString(cJSON_GetObjectItem(ap, "ssid"));
+    found += cJSON_IsNumber(cJSON_GetObjectItem(ap, "channel"));
+    cJSON_Delete(root);
+    return found;
+}
+
+void app_main(void)
+{
+    cJSON_Hooks hooks = {.malloc_fn = counting_malloc, .free_fn = free};
+    wifi_c_config_t config;
+    char buffer[512];
+
+    cJSON_InitHooks(&hooks);
+
+    for (size_t d = 0; d < sizeof(documents) / sizeof(documents[0]); d++)
+    {
+        size_t len = strlen(documents[d]);
+        int64_t start_us = 0;
+        int64_t config_us = 0;
+        int64_t cjson_us = 0;
+
+        for (int i = 0; i < RUNS; i++)
+        {
+            memcpy(buffer, documents[d], len); // parsing is in place, each run needs fresh copy
+            start_us = esp_timer_get_time();
+            ESP_ERROR_CHECK(wifi_c_config_parse(buffer, len, &config, NULL));
+            config_us += esp_timer_get_time() - start_us;
+        }
+
+        cjson_allocs = 0;
+        for (int i = 0; i < RUNS; i++)
+        {
+            start_us = esp_timer_get_time();
+            read_with_cjson(documents[d]);
+            cjson_us += esp_timer_get_time() - start_us;
+        }
+
+        printf("document %u (%u bytes):\n", (unsigned)d, (unsigned)len);
+        printf("  wifi_c_config_parse %lld ns, 0 allocations\n", config_us * 1000 / RUNS);
+        printf("  cJSON_Parse         %lld ns, %lu allocations\n", cjson_us * 1000 / RUNS,
+               (unsigned long)(cjson_allocs / RUNS));
+    }
+}
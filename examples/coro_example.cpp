@@ -0,0 +1,49 @@
+#include <cstdio>
+#include "nvs_flash.h"
+#include "esp_err.h"
+#include "wifi_c_coro.hpp"
+
+/*
+ * One task scans, connects to strongest AP of known SSID and waits for IP address, without blocking on any of it.
+ */
+static wifi_c::task<int> provision(wifi_c::loop &loop)
+{
+    auto scan = co_await wifi_c::scan(loop);
+    if (scan.error != ESP_OK)
+    {
+        co_return scan.error;
+    }
+    for (const wifi_ap_record_t &ap : scan.records)
+    {
+        printf("%-32s ch %2u rssi %d\n", (const char *)ap.ssid, ap.primary, ap.rssi);
+    }
+
+    int err = co_await wifi_c::connect(loop, "STA_SSID", "STA_PASSWORD");
+    if (err != ESP_OK)
+    {
+        co_return err;
+    }
+
+    // after link drops controller reconnects, here just wait for address again
+    co_await wifi_c::wait_for_ip(loop);
+    co_return ESP_OK;
+}
+
+extern "C" void app_main(void)
+{
+    // Initialize NVS
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK( ret );
+
+    // WiFi is deinitialized when wifi goes out of scope
+    wifi_c::wifi wifi(WIFI_C_MODE_STA);
+    ESP_ERROR_CHECK(wifi.error());
+
+    wifi_c::loop loop;
+    auto op = provision(loop);
+    printf("provisioning finished: %d\n", loop.run(op));
+}
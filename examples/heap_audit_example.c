@@ -0,0 +1,38 @@
+#include <stdio.h>
+#include "nvs_flash.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "wifi_controller.h"
+#include "wifi_c_heap.h"
+
+/*
+ * Needs CONFIG_WIFI_C_HEAP_AUDIT, and CONFIG_WIFI_C_STATIC_ALLOC for the check to pass.
+ * Startup may allocate, everything after wifi_c_heap_audit_set_steady() must not.
+ */
+void app_main(void)
+{
+    // Initialize NVS
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK( ret );
+
+    ESP_ERROR_CHECK(wifi_c_init_wifi(WIFI_C_MODE_STA));
+    ESP_ERROR_CHECK(wifi_c_start_sta("STA_SSID", "STA_PASSWORD"));
+    wifi_c_heap_audit_print();
+
+    // Steady state: reconnects and status reads
+    wifi_c_heap_audit_set_steady();
+    for (int i = 0; i < 3; i++)
+    {
+        ESP_ERROR_CHECK(wifi_c_disconnect());
+        ESP_ERROR_CHECK(wifi_c_start_sta("STA_SSID", "STA_PASSWORD"));
+        vTaskDelay(pdMS_TO_TICKS(5000));
+    }
+
+    wifi_c_heap_audit_print();
+    printf("steady-state allocations: %s\n", (wifi_c_heap_audit_check() == ESP_OK) ? "none" : "found, see log");
+}
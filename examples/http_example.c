@@ -0,0 +1,34 @@
+#include "nvs_flash.h"
+#include "esp_err.h"
+#include "esp_http_server.h"
+#include "wifi_controller.h"
+#include "wifi_c_http.h"
+
+/*
+ * Serves controller state on AP+STA device, needs CONFIG_WIFI_C_HTTP.
+ * Try: curl http://192.168.4.1/wifi/status, /wifi/scan, /wifi/stations, /wifi/metrics
+ */
+void app_main(void)
+{
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    httpd_handle_t server = NULL;
+    wifi_c_scan_result_t scan;
+
+    // Initialize NVS
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK( ret );
+
+    ESP_ERROR_CHECK(wifi_c_init_wifi(WIFI_C_MODE_APSTA));
+    ESP_ERROR_CHECK(wifi_c_start_ap("AP_SSID", "AP_PASSWORD"));
+    ESP_ERROR_CHECK(wifi_c_start_sta("STA_SSID", "STA_PASSWORD"));
+    ESP_ERROR_CHECK(wifi_c_scan_all_ap(&scan));
+
+    // room for own handlers of application next to WiFi ones
+    config.max_uri_handlers = 4 + WIFI_C_HTTP_URI_COUNT;
+    ESP_ERROR_CHECK(httpd_start(&server, &config));
+    ESP_ERROR_CHECK(wifi_c_http_register(server, NULL));
+}
@@ -0,0 +1,47 @@
+#include <stdio.h>
+#include "nvs_flash.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "wifi_controller.h"
+#include "wifi_c_event_loop.h"
+
+/*
+ * Needs CONFIG_WIFI_C_PRIVATE_EVENT_LOOP.
+ * Controller handlers run on their own task, pinned to core 1 above default loop task.
+ */
+void app_main(void)
+{
+    // Initialize NVS
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK( ret );
+
+    // Application may create default loop itself, wifi_c_deinit() leaves it running then
+    ESP_ERROR_CHECK(esp_event_loop_create_default());
+
+    wifi_c_event_loop_config_t loop_config = WIFI_C_EVENT_LOOP_CONFIG_DEFAULT();
+    loop_config.queue_size = 16;
+    loop_config.priority = 21;
+    loop_config.core_id = 1;
+    loop_config.post_timeout_ms = 10;
+    ESP_ERROR_CHECK(wifi_c_event_loop_set_config(&loop_config));
+
+    ESP_ERROR_CHECK(wifi_c_init_wifi(WIFI_C_MODE_STA));
+    ESP_ERROR_CHECK(wifi_c_start_sta("STA_SSID", "STA_PASSWORD"));
+
+    for (int i = 0; i < 6; i++)
+    {
+        wifi_c_event_loop_stats_t stats;
+        wifi_c_event_loop_get_stats(&stats);
+        printf("events forwarded %lu, dropped %lu, skipped %lu, queue %u/%u, high-water %u\n",
+               (unsigned long)stats.forwarded, (unsigned long)stats.dropped, (unsigned long)stats.skipped,
+               stats.queue_depth, stats.queue_size, stats.queue_max_depth);
+        vTaskDelay(pdMS_TO_TICKS(10000));
+    }
+
+    wifi_c_deinit();
+}
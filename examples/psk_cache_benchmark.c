@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include "nvs_flash.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "wifi_controller.h"
+#include "wifi_c_psk.h"
+
+/*
+ * Compares connect with passphrase (PBKDF2 on every connect) and with precomputed PSK,
+ * which is what STA uses on cache hit with CONFIG_WIFI_C_PSK_CACHE.
+ */
+#define SSID        "STA_SSID"
+#define PASSPHRASE  "STA_PASSWORD"
+#define RUNS        5
+
+static void measure_connect(const char *label, const char *password)
+{
+    int64_t total_us = 0;
+    int64_t max_us = 0;
+
+    for (int i = 0; i < RUNS; i++)
+    {
+#if CONFIG_WIFI_C_PSK_CACHE
+        wifi_c_psk_clear(); // passphrase runs are always cold
+#endif
+        int64_t start_us = esp_timer_get_time();
+        ESP_ERROR_CHECK(wifi_c_start_sta(SSID, password));
+        int64_t elapsed_us = esp_timer_get_time() - start_us;
+
+        total_us += elapsed_us;
+        max_us = (elapsed_us > max_us) ? elapsed_us : max_us;
+        ESP_ERROR_CHECK(wifi_c_disconnect());
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+    printf("%-12s connect to IP avg %lld ms, max %lld ms\n", label, total_us / RUNS / 1000, max_us / 1000);
+}
+
+void app_main(void)
+{
+    uint8_t psk[WIFI_C_PSK_LEN];
+    char psk_hex[WIFI_C_PSK_HEX_LEN + 1];
+    int64_t derive_us = 0;
+
+    // Initialize NVS
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK( ret );
+
+    // CPU time of PBKDF2 alone, nothing else runs on this task meanwhile
+    for (int i = 0; i < RUNS; i++)
+    {
+        int64_t start_us = esp_timer_get_time();
+        ESP_ERROR_CHECK(wifi_c_psk_derive(SSID, PASSPHRASE, psk));
+        derive_us += esp_timer_get_time() - start_us;
+    }
+    printf("PBKDF2 %u iterations: avg %lld us of CPU\n", WIFI_C_PSK_ITERATIONS, derive_us / RUNS);
+    for (int i = 0; i < WIFI_C_PSK_LEN; i++)
+    {
+        sprintf(&psk_hex[i * 2], "%02x", psk[i]);
+    }
+
+    ESP_ERROR_CHECK(wifi_c_init_wifi(WIFI_C_MODE_STA));
+    measure_connect("passphrase", PASSPHRASE);
+    measure_connect("cached PSK", psk_hex);
+}
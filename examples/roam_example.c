@@ -0,0 +1,53 @@
+#include "nvs_flash.h"
+#include "esp_log.h"
+#include "esp_mac.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "wifi_controller.h"
+#include "wifi_c_history.h"
+#include "wifi_c_roam.h"
+
+/*
+ * Connects to strongest BSSID of SSID served by many APs and keeps roaming while walking around.
+ * History makes roam scans look only on channels where SSID was already seen.
+ */
+const char* MAIN = "main";
+
+void app_main(void)
+{
+    wifi_c_history_config_t history = { .max_bssids = 32, .max_ssids = 8 };
+    wifi_c_bssid_select_config_t select = WIFI_C_BSSID_SELECT_CONFIG_DEFAULT();
+    wifi_c_roam_config_t roam = WIFI_C_ROAM_CONFIG_DEFAULT();
+    wifi_c_roam_stats_t stats;
+    wifi_ap_record_t selected;
+
+    // Initialize NVS
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK( ret );
+
+    ESP_ERROR_CHECK(wifi_c_history_init(&history));
+    ESP_ERROR_CHECK(wifi_c_init_wifi(WIFI_C_MODE_STA));
+
+    // prefer APs on quieter channels, 3 dB per neighbour AP heard at -50 dBm
+    select.min_rssi = -85;
+    select.load_penalty_db = 3;
+    wifi_c_sta_set_11kv(true);
+    ESP_ERROR_CHECK(wifi_c_start_sta_best_bssid("SSID", "PASSWORD", &select, &selected));
+    ESP_LOGI(MAIN, "connected to " MACSTR " on channel %u", MAC2STR(selected.bssid), selected.primary);
+
+    roam.select = select;
+    ESP_ERROR_CHECK(wifi_c_roam_start(&roam));
+
+    while(1) {
+      vTaskDelay(pdMS_TO_TICKS(60000));
+      wifi_c_roam_get_stats(&stats);
+      ESP_LOGI(MAIN, "roam scans %lu, roams %lu, failed %lu, last %lu ms (link %lu ms), slowest %lu ms, channels 0x%04x",
+               (unsigned long)stats.scans, (unsigned long)stats.roams, (unsigned long)stats.failures,
+               (unsigned long)stats.last_ip_ms, (unsigned long)stats.last_link_ms, (unsigned long)stats.max_ip_ms,
+               stats.channel_mask);
+    }
+}
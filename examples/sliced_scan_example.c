@@ -0,0 +1,112 @@
+#include <string.h>
+#include "nvs_flash.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+#include "wifi_controller.h"
+#include "wifi_c_scan_slice.h"
+
+/*
+ * Compares throughput impact of full and sliced scan while connected.
+ * UDP packets are sent to UPLINK_HOST as fast as possible, bytes accepted by stack are counted
+ * in 50 ms windows. Start receiver on the host e.g. with: nc -ul 5001 > /dev/null
+ */
+#define UPLINK_HOST     "192.168.1.10"
+#define UPLINK_PORT     5001
+#define WINDOW_MS       50
+#define MEASURE_MS      4000
+
+const char* MAIN = "main";
+
+static volatile uint32_t sent_bytes;
+
+wifi_ap_record_t records[16];
+
+static void uplink_task(void *arg)
+{
+    static uint8_t payload[1400];
+    struct sockaddr_in dest = {
+        .sin_family = AF_INET,
+        .sin_port = htons(UPLINK_PORT),
+        .sin_addr.s_addr = inet_addr(UPLINK_HOST),
+    };
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_IP);
+
+    while (1) {
+      if (sendto(sock, payload, sizeof(payload), 0, (struct sockaddr *)&dest, sizeof(dest)) > 0) {
+        sent_bytes += sizeof(payload);
+      } else {
+        vTaskDelay(1); // stack buffers full, radio is probably off channel
+      }
+    }
+}
+
+/*Sample throughput in windows for MEASURE_MS, while scan runs in other task or not at all.*/
+static void measure(const char *mode)
+{
+    uint32_t windows = MEASURE_MS / WINDOW_MS;
+    uint32_t total = 0, worst = UINT32_MAX, stalled = 0;
+
+    for (uint32_t i = 0; i < windows; i++) {
+      uint32_t start = sent_bytes;
+      vTaskDelay(pdMS_TO_TICKS(WINDOW_MS));
+      uint32_t bytes = sent_bytes - start;
+      total += bytes;
+      if (bytes < worst) worst = bytes;
+      if (bytes == 0) stalled++;
+    }
+    ESP_LOGI(MAIN, "%-8s avg %lu kB/s, worst window %lu kB/s, stalled windows %lu of %lu", mode,
+             (unsigned long)(total / MEASURE_MS), (unsigned long)(worst / WINDOW_MS), (unsigned long)stalled, (unsigned long)windows);
+}
+
+static void full_scan_task(void *arg)
+{
+    wifi_c_scan_result_t scan_results;
+    wifi_c_scan_all_ap(&scan_results);
+    vTaskDelete(NULL);
+}
+
+static void sliced_scan_task(void *arg)
+{
+    wifi_c_scan_slice_config_t config = WIFI_C_SCAN_SLICE_CONFIG_DEFAULT();
+    wifi_c_scan_slice_report_t report;
+    uint16_t count = sizeof(records) / sizeof(records[0]);
+
+    if (wifi_c_scan_sliced(&config, NULL, records, &count, &report) == 0) {
+      ESP_LOGI(MAIN, "sliced: %u APs, %u slices, sweep %lu ms, off channel %lu ms, longest slice %lu ms", count,
+               report.slices, (unsigned long)(report.duration_us / 1000), (unsigned long)(report.off_channel_us / 1000),
+               (unsigned long)(report.max_off_channel_us / 1000));
+    }
+    vTaskDelete(NULL);
+}
+
+void app_main(void)
+{
+    // Initialize NVS
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK( ret );
+
+    ESP_ERROR_CHECK(wifi_c_init_wifi(WIFI_C_MODE_STA));
+    ESP_ERROR_CHECK(wifi_c_start_sta("SSID", "PASSWORD"));
+
+    xTaskCreate(uplink_task, "uplink", 3072, NULL, 5, NULL);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+
+    while(1) {
+      measure("idle");
+
+      xTaskCreate(full_scan_task, "full_scan", 4096, NULL, 4, NULL);
+      measure("full");
+      vTaskDelay(pdMS_TO_TICKS(1000));
+
+      xTaskCreate(sliced_scan_task, "sliced_scan", 4096, NULL, 4, NULL);
+      measure("sliced");
+      vTaskDelay(pdMS_TO_TICKS(5000)); // let sliced sweep finish
+    }
+}
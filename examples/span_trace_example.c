@@ -0,0 +1,35 @@
+#include <stdio.h>
+#include "nvs_flash.h"
+#include "esp_err.h"
+#include "wifi_controller.h"
+#include "wifi_c_span.h"
+
+/*
+ * Prints spans of startup as Chrome trace JSON, needs CONFIG_WIFI_C_SPAN_TRACE.
+ * Copy printed line to file and open it in https://ui.perfetto.dev
+ */
+static int print_sink(const char *data, size_t len, void *arg)
+{
+    fwrite(data, 1, len, stdout);
+    return ESP_OK;
+}
+
+void app_main(void)
+{
+    wifi_c_scan_result_t scan;
+
+    // Initialize NVS
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK( ret );
+
+    ESP_ERROR_CHECK(wifi_c_init_wifi(WIFI_C_MODE_STA));
+    ESP_ERROR_CHECK(wifi_c_start_sta("STA_SSID", "STA_PASSWORD"));
+    ESP_ERROR_CHECK(wifi_c_scan_all_ap(&scan));
+
+    ESP_ERROR_CHECK(wifi_c_span_export_chrome(print_sink, NULL));
+    printf("\n");
+}
@@ -0,0 +1,28 @@
+#include "nvs_flash.h"
+#include "esp_err.h"
+#include "wifi_controller.h"
+
+void app_main(void)
+{
+    // Initialize NVS
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK( ret );
+
+    /*STA link profile example*/
+
+    //Init Wifi
+    ESP_ERROR_CHECK(wifi_c_init_wifi(WIFI_C_MODE_STA));
+
+    //Sensor far from AP: allow Long Range mode and full TX power
+    wifi_c_sta_link_profile_t profile = WIFI_C_STA_LINK_PROFILE_LONG_RANGE();
+    //Near AP use WIFI_C_STA_LINK_PROFILE_HIGH_THROUGHPUT(), fields can also be tuned one by one, e.g. sleep longer:
+    profile.listen_interval = 10;
+    ESP_ERROR_CHECK(wifi_c_sta_set_link_profile(&profile));
+
+    //Profile is applied before association and kept for reconnects
+    ESP_ERROR_CHECK(wifi_c_start_sta("SSID", "PASSWORD"));
+}
@@ -0,0 +1,42 @@
+#include "nvs_flash.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "wifi_controller.h"
+
+/*
+ * Turns radio off between bursts of work without tearing down WiFi, then reconnects to the same AP.
+ * Resume skips driver and netif init and the scan for AP, compare its time with first connection.
+ */
+const char* MAIN = "main";
+
+void app_main(void)
+{
+    wifi_c_resume_stats_t stats;
+
+    // Initialize NVS
+    esp_err_t ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK( ret );
+
+    ESP_ERROR_CHECK(wifi_c_init_wifi(WIFI_C_MODE_STA));
+    ESP_ERROR_CHECK(wifi_c_start_sta("SSID", "PASSWORD"));
+
+    while(1) {
+      // do the network work here
+      vTaskDelay(pdMS_TO_TICKS(5000));
+
+      ESP_ERROR_CHECK(wifi_c_suspend());
+      vTaskDelay(pdMS_TO_TICKS(30000));
+
+      if (wifi_c_resume(10000) == ESP_OK) {
+        wifi_c_get_resume_stats(&stats);
+        ESP_LOGI(MAIN, "resumed, link after %lu ms, IP after %lu ms (slowest %lu ms), %lu fallbacks to full scan",
+                 (unsigned long)stats.last_link_ms, (unsigned long)stats.last_ip_ms,
+                 (unsigned long)stats.max_ip_ms, (unsigned long)stats.fallbacks);
+      }
+    }
+}
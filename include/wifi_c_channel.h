@@ -0,0 +1,198 @@
+/**
+ * @file wifi_c_channel.h
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief AP channel congestion scoring header file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_wifi.h"
+
+#define WIFI_C_CHANNEL_MAX              14                          ///< Highest 2.4 GHz channel.
+#define WIFI_C_CHANNEL_OVERLAP          5                           ///< 20 MHz wide channels 5 MHz apart overlap up to 4 neighbours on each side.
+#define WIFI_C_CHANNEL_SCAN_TIME_MS     100                         ///< Dwell time on every channel when measuring congestion.
+
+/**
+ * @brief Candidates used when no channel mask is given, channels 1, 6 and 11 don't overlap each other.
+ *
+ */
+#define WIFI_C_CHANNEL_MASK_DEFAULT     ((1U << 1) | (1U << 6) | (1U << 11))
+
+/**
+ * @brief Congestion of every 2.4 GHz channel, measured by one scan.
+ *
+ * @note Every AP adds to score of its own and overlapping channels,
+ * weighted by signal strength and by distance from its channel.
+ */
+struct wifi_c_channel_scores_obj {
+    uint32_t score[WIFI_C_CHANNEL_MAX + 1];       /**< Congestion score, lower is better, index is channel number. */
+    uint16_t ap_count[WIFI_C_CHANNEL_MAX + 1];    /**< Number of APs with primary channel at index. */
+};
+
+/**
+ * @brief Type of channel scores.
+ *
+ */
+typedef struct wifi_c_channel_scores_obj wifi_c_channel_scores_t;
+
+/**
+ * @brief Report of channel re-evaluation.
+ *
+ */
+struct wifi_c_channel_report_obj {
+    uint8_t channel;                      /**< Channel AP is working on. */
+    uint32_t score;                       /**< Current score of that channel. */
+    uint32_t previous_score;              /**< Score of that channel in previous evaluation. */
+    uint16_t ap_count;                    /**< Number of other APs on that channel. */
+    uint8_t best_channel;                 /**< Least congested candidate channel now, 0 when only AP channel was measured. */
+    uint32_t best_score;                  /**< Score of least congested candidate channel. */
+    uint32_t evaluation;                  /**< Number of evaluation, starting at 1. */
+};
+
+/**
+ * @brief Type of channel report.
+ *
+ */
+typedef struct wifi_c_channel_report_obj wifi_c_channel_report_t;
+
+/**
+ * @brief Which channels monitor measures, sweeping all channels takes radio away from AP channel for whole scan.
+ *
+ */
+enum wifi_c_channel_sweep_obj {
+    WIFI_C_CHANNEL_SWEEP_NEVER = 0,       /**< Measure only AP channel, AP stays available. */
+    WIFI_C_CHANNEL_SWEEP_IDLE,            /**< Measure all channels when no station is connected to AP, otherwise only AP channel. */
+    WIFI_C_CHANNEL_SWEEP_ALWAYS,          /**< Measure all channels every period, connected stations lose service during scan. */
+};
+
+/**
+ * @brief Type of channel sweep policy.
+ *
+ */
+typedef enum wifi_c_channel_sweep_obj wifi_c_channel_sweep_t;
+
+/**
+ * @brief Callback receiving channel reports, called from monitor task.
+ *
+ */
+typedef void (*wifi_c_channel_report_cb_t)(const wifi_c_channel_report_t *report, void *arg);
+
+/**
+ * @brief Configuration of periodic channel re-evaluation.
+ *
+ */
+struct wifi_c_channel_monitor_config_obj {
+    uint32_t period_ms;                   /**< Time between evaluations. */
+    uint16_t channel_mask;                /**< Candidate channels for best channel, bit per channel, 0 for WIFI_C_CHANNEL_MASK_DEFAULT. */
+    wifi_c_channel_sweep_t sweep;         /**< When all channels are measured, best channel is known only after full sweep. */
+    wifi_c_channel_report_cb_t report;    /**< Callback receiving reports, NULL to only log them. */
+    void *arg;                            /**< Argument passed to callback. */
+    uint8_t priority;                     /**< Priority of monitor task. */
+    uint32_t stack_size;                  /**< Stack size of monitor task in bytes, must fit callback. */
+};
+
+/**
+ * @brief Type of channel monitor configuration.
+ *
+ */
+typedef struct wifi_c_channel_monitor_config_obj wifi_c_channel_monitor_config_t;
+
+#define WIFI_C_CHANNEL_MONITOR_CONFIG_DEFAULT() {   \
+    .period_ms = 10 * 60 * 1000,                    \
+    .channel_mask = 0,                              \
+    .sweep = WIFI_C_CHANNEL_SWEEP_IDLE,             \
+    .report = NULL,                                 \
+    .arg = NULL,                                    \
+    .priority = 1,                                  \
+    .stack_size = 4096,                             \
+}
+
+/**
+ * @brief Reset all scores to zero.
+ *
+ */
+void wifi_c_channel_scores_clear(wifi_c_channel_scores_t *scores);
+
+/**
+ * @brief Add congestion caused by one scanned AP.
+ *
+ */
+void wifi_c_channel_scores_add(wifi_c_channel_scores_t *scores, const wifi_ap_record_t *record);
+
+/**
+ * @brief Find least congested channel, fewer APs and lower channel win ties.
+ *
+ * @param scores        Measured scores.
+ * @param channel_mask  Candidate channels, bit per channel, 0 for WIFI_C_CHANNEL_MASK_DEFAULT.
+ *
+ * @return Best channel, 0 if mask has no valid channel.
+ */
+uint8_t wifi_c_channel_pick_best(const wifi_c_channel_scores_t *scores, uint16_t channel_mask);
+
+/**
+ * @brief Scan all channels and score their congestion.
+ *
+ * @note In AP mode STA is enabled only for time of the scan, AP keeps running.
+ *
+ * @param scores Pointer to store scores.
+ *
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_WIFI_NOT_INIT Wifi was not initialized
+ * @retval esp specific error codes
+ */
+int wifi_c_measure_channels(wifi_c_channel_scores_t *scores);
+
+/**
+ * @brief Listen on one channel and score congestion seen there.
+ *
+ * @note Scan is passive, measuring AP channel doesn't take radio away from AP clients.
+ *
+ * @param channel Channel to measure, 1 - WIFI_C_CHANNEL_MAX.
+ * @param scores  Pointer to store scores, only APs heard on the channel are counted.
+ *
+ * @retval ERR_C_OK on success
+ * @retval ERR_C_INVALID_ARGS if channel is out of range
+ * @retval same errors as wifi_c_measure_channels()
+ */
+int wifi_c_measure_channel(uint8_t channel, wifi_c_channel_scores_t *scores);
+
+/**
+ * @brief Measure congestion and start AP on least congested channel.
+ *
+ * @note When STA is connected AP has to use its channel, then no scan is done.
+ *
+ * @param ssid          SSID of AP.
+ * @param password      Password of AP, NULL or empty for open AP.
+ * @param channel_mask  Candidate channels, bit per channel, 0 for WIFI_C_CHANNEL_MASK_DEFAULT.
+ * @param channel       Pointer to store selected channel, can be NULL.
+ *
+ * @retval ERR_C_OK on success
+ * @retval same errors as wifi_c_start_ap() and wifi_c_measure_channels()
+ */
+int wifi_c_start_ap_auto_channel(const char *ssid, const char *password, uint16_t channel_mask, uint8_t *channel);
+
+/**
+ * @brief Start task periodically measuring congestion and reporting score of AP channel.
+ *
+ * @note By default all channels are swept only while no station is connected to AP - see wifi_c_channel_sweep_t.
+ *
+ * @param config Monitor configuration, NULL for WIFI_C_CHANNEL_MONITOR_CONFIG_DEFAULT().
+ *
+ * @retval ERR_C_OK on success
+ * @retval ERR_C_INVALID_ARGS if period is zero
+ * @retval WIFI_C_ERR_CHANNEL_MONITOR_STARTED if monitor is already running
+ * @retval ERR_C_MEMORY_ERR if task could not be created
+ */
+int wifi_c_channel_monitor_start(const wifi_c_channel_monitor_config_t *config);
+
+/**
+ * @brief Stop channel monitor task, waits for evaluation in progress to finish.
+ *
+ */
+void wifi_c_channel_monitor_stop(void);
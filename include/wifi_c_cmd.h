@@ -0,0 +1,183 @@
+/**
+ * @file wifi_c_cmd.h
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief Serialized API command queue header file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+
+/**
+ * @brief API calls executed by controller task.
+ *
+ */
+typedef enum {
+    WIFI_C_CMD_INIT_WIFI = 0,
+    WIFI_C_CMD_START_AP,
+    WIFI_C_CMD_START_STA,
+    WIFI_C_CMD_START_STA_BEST_BSSID,
+    WIFI_C_CMD_START_STA_ASYNC,
+    WIFI_C_CMD_DISCONNECT,
+    WIFI_C_CMD_SCAN_ALL_AP,
+    WIFI_C_CMD_SCAN_FILTERED,
+    WIFI_C_CMD_SCAN_SLICED,
+    WIFI_C_CMD_SCAN_START,                /*scan without waiting for it*/
+    WIFI_C_CMD_SCAN_RESULTS,              /*reading results of last scan*/
+    WIFI_C_CMD_STATUS,                    /*reading status as JSON*/
+    WIFI_C_CMD_MEASURE_CHANNELS,
+    WIFI_C_CMD_START_AP_AUTO_CHANNEL,
+    WIFI_C_CMD_ROAM_TO,
+    WIFI_C_CMD_SUSPEND,
+    WIFI_C_CMD_RESUME,
+    WIFI_C_CMD_CHANGE_MODE,
+    WIFI_C_CMD_DEINIT,
+    WIFI_C_CMD_COUNT
+} wifi_c_cmd_id_t;
+
+/**
+ * @brief Executes command on controller task.
+ *
+ * @param args Arguments passed to wifi_c_cmd_call(), also used to return results.
+ *
+ * @return Result returned to caller.
+ */
+typedef int (*wifi_c_cmd_run_t)(void *args);
+
+/**
+ * @brief Gives results of finished command to the same command which arrived while it was running.
+ *
+ * @param done      Arguments of finished command.
+ * @param waiting   Arguments of waiting command, which is answered without running.
+ */
+typedef void (*wifi_c_cmd_share_t)(const void *done, void *waiting);
+
+/**
+ * @brief Configuration of controller task.
+ *
+ */
+struct wifi_c_cmd_config_obj {
+    uint16_t queue_length;                /**< Number of commands waiting to run, more callers block until there is space. */
+    uint8_t priority;                     /**< Priority of controller task. */
+    uint32_t stack_size;                  /**< Stack size of controller task in bytes, must fit deepest API call (sliced scan). */
+    int core_id;                          /**< Core to pin task to, or tskNO_AFFINITY. */
+};
+
+/**
+ * @brief Type of controller task configuration.
+ *
+ */
+typedef struct wifi_c_cmd_config_obj wifi_c_cmd_config_t;
+
+#define WIFI_C_CMD_CONFIG_DEFAULT() {       \
+    .queue_length = 8,                      \
+    .priority = 5,                          \
+    .stack_size = 6144,                     \
+    .core_id = tskNO_AFFINITY,              \
+}
+
+/**
+ * @brief Latency of one command type.
+ *
+ * @note Calls made directly (controller task not running) count with zero wait.
+ */
+struct wifi_c_cmd_latency_obj {
+    uint32_t calls;                       /**< Commands finished, including coalesced ones. */
+    uint32_t coalesced;                   /**< Commands answered with results of the same command running when they arrived. */
+    uint64_t wait_us;                     /**< Total time commands waited in queue. */
+    uint64_t run_us;                      /**< Total time from start of execution to result, coalesced commands included. */
+    uint32_t max_wait_us;                 /**< Longest wait in queue. */
+    uint32_t max_run_us;                  /**< Longest execution. */
+};
+
+/**
+ * @brief Type of command latency.
+ *
+ */
+typedef struct wifi_c_cmd_latency_obj wifi_c_cmd_latency_t;
+
+/**
+ * @brief Statistics of command queue.
+ *
+ */
+struct wifi_c_cmd_stats_obj {
+    wifi_c_cmd_latency_t commands[WIFI_C_CMD_COUNT]; /**< Latency per command, indexed by wifi_c_cmd_id_t. */
+    uint16_t queue_depth;                 /**< Commands currently waiting in queue. */
+    uint16_t queue_max_depth;             /**< Highest number of commands waiting in queue. */
+};
+
+/**
+ * @brief Type of command queue statistics.
+ *
+ */
+typedef struct wifi_c_cmd_stats_obj wifi_c_cmd_stats_t;
+
+/**
+ * @brief Start controller task, after this API functions without context argument run one at a time on it.
+ *
+ * @note Queue is allocated on first start and reused after wifi_c_cmd_stop().
+ *
+ * @param config Controller task configuration, NULL for WIFI_C_CMD_CONFIG_DEFAULT().
+ *
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_CMD_QUEUE_STARTED if controller task is already running
+ * @retval ERR_C_INVALID_ARGS if queue length is zero or differs from the one allocated before
+ * @retval ERR_C_MEMORY_ERR if queue or task could not be created
+ */
+int wifi_c_cmd_start(const wifi_c_cmd_config_t *config);
+
+/**
+ * @brief Run commands already queued and stop controller task.
+ *
+ * @note After this API calls run directly on calling task again. Calls made while task is stopping are
+ * still queued and run on controller task, it exits once queue is empty, so calls never run at once.
+ * @note Must not be called from a command, e.g. from wifi_c_deinit(), controller task can't wait for itself.
+ */
+void wifi_c_cmd_stop(void);
+
+/**
+ * @brief Run command on controller task and wait for its result, or run it directly when task is not running.
+ *
+ * @note Commands run in order of arrival. When share is given, the same commands waiting at front of queue
+ * which arrived while this one was running get its results instead of running again.
+ * @note Only wifi_c_scan_all_ap() shares results. wifi_c_scan_filtered() and wifi_c_scan_sliced() results
+ * depend on filter and slice settings of each caller, so concurrent requests run one sweep each, back to back.
+ * @note Called from controller task itself, e.g. from nested call, command runs directly.
+ *
+ * @param id    Command type, used for coalescing and latency accounting.
+ * @param run   Function executing command.
+ * @param share Function copying results to coalesced command, NULL if command must always run.
+ * @param args  Arguments of run, stay owned by caller.
+ *
+ * @return Result of run.
+ */
+int wifi_c_cmd_call(wifi_c_cmd_id_t id, wifi_c_cmd_run_t run, wifi_c_cmd_share_t share, void *args);
+
+/**
+ * @brief Get latency of commands and queue statistics.
+ *
+ * @param stats Pointer to store statistics.
+ *
+ * @retval ERR_C_OK on success
+ * @retval ERR_NULL_POINTER if stats is NULL
+ */
+int wifi_c_cmd_get_stats(wifi_c_cmd_stats_t *stats);
+
+/**
+ * @brief Zero latency statistics.
+ *
+ */
+void wifi_c_cmd_reset_stats(void);
+
+/**
+ * @brief Get name of command, e.g. for printing statistics.
+ *
+ * @return Name, "unknown" for id out of range.
+ */
+const char *wifi_c_cmd_name(wifi_c_cmd_id_t id);
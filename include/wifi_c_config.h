@@ -0,0 +1,111 @@
+/**
+ * @file wifi_c_config.h
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief JSON provisioning config parser header file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * Document format, all members are optional, unknown members are skipped:
+ * @code
+ * {
+ *   "mode": "sta" | "ap" | "apsta",                  // default: from "sta" and "ap" present
+ *   "sta": [{"ssid": "...", "password": "..."}],    // or single object, tried in order
+ *   "ap": {"ssid": "...", "password": "...", "channel": 6, "bandwidth": 20, "authmode": "wpa2",
+ *          "pmf_required": false, "max_connection": 4, "beacon_interval": 100, "dtim_period": 2}
+ * }
+ * @endcode
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "wifi_controller.h"
+
+#define WIFI_C_CONFIG_MAX_NETWORKS      4                           ///< STA networks kept from one document.
+#define WIFI_C_CONFIG_MAX_DEPTH         8                           ///< Nesting of skipped unknown values, deeper documents are rejected.
+
+#if WIFI_C_STA_ENABLED
+/**
+ * @brief STA network of config, strings point into parsed document.
+ *
+ */
+struct wifi_c_config_network_obj {
+    const char *ssid;                     /**< SSID, 1-32 bytes */
+    const char *password;                 /**< empty for open network, 8-63 characters or 64 hex digits of PSK */
+};
+
+/**
+ * @brief Type of STA network of config.
+ *
+ */
+typedef struct wifi_c_config_network_obj wifi_c_config_network_t;
+#endif
+
+/**
+ * @brief Settings of controller parsed from JSON document.
+ *
+ */
+struct wifi_c_config_obj {
+    wifi_c_mode_t mode;                   /**< mode to init WiFi with */
+#if WIFI_C_STA_ENABLED
+    wifi_c_config_network_t networks[WIFI_C_CONFIG_MAX_NETWORKS]; /**< STA networks, in order of preference */
+    uint8_t network_count;                /**< number of networks used */
+#endif
+#if WIFI_C_AP_ENABLED
+    wifi_c_ap_config_t ap;                /**< AP settings, WIFI_C_AP_CONFIG_DEFAULT() for members not in document */
+#endif
+};
+
+/**
+ * @brief Type of parsed config.
+ *
+ */
+typedef struct wifi_c_config_obj wifi_c_config_t;
+
+/**
+ * @brief Where and why document was rejected.
+ *
+ */
+struct wifi_c_config_error_obj {
+    size_t offset;                        /**< byte of document where error was found */
+    const char *reason;                   /**< static description, e.g. "SSID longer than 32 bytes" */
+};
+
+/**
+ * @brief Type of config parse error.
+ *
+ */
+typedef struct wifi_c_config_error_obj wifi_c_config_error_t;
+
+/**
+ * @brief Parse and validate JSON config document without allocating memory.
+ *
+ * @note Document is tokenized in place: strings are unescaped and terminated inside json, and config
+ * points to them, so json must stay unchanged as long as config is used.
+ * @note Checked are SSID length, password length (8 characters minimum, as wifi_c_start_ap() requires),
+ * channel range, numbers of AP settings and mode against networks present and compiled roles.
+ *
+ * @param json      Document, modified by parsing, doesn't have to be null terminated.
+ * @param len       Length of document.
+ * @param config    Pointer to store settings.
+ * @param error     Pointer to store error position and reason, can be NULL.
+ *
+ * @retval ERR_C_OK on success
+ * @retval ERR_NULL_POINTER if json or config is NULL
+ * @retval WIFI_C_ERR_CONFIG_INVALID if document is not valid JSON or settings are out of range
+ */
+int wifi_c_config_parse(char *json, size_t len, wifi_c_config_t *config, wifi_c_config_error_t *error);
+
+/**
+ * @brief Init WiFi in config mode, start AP and connect STA to first network which accepts connection.
+ *
+ * @param config Settings returned by wifi_c_config_parse().
+ *
+ * @retval ERR_C_OK on success
+ * @retval ERR_NULL_POINTER if config is NULL
+ * @retval errors of wifi_c_init_wifi(), wifi_c_start_ap_with_config() and wifi_c_start_sta() of last network tried
+ */
+int wifi_c_config_apply(const wifi_c_config_t *config);
@@ -0,0 +1,501 @@
+/**
+ * @file wifi_c_coro.hpp
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief C++20 coroutine front-end of wifi_controller, header only.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ * Connect, scan and waiting for IP address are awaitables. Coroutines waiting for them are queued by
+ * state handler of controller (see wifi_c_register_state_handler()) and resumed by wifi_c::loop on
+ * the task running it, so one task can drive many operations without blocking on any of them.
+ *
+ * @code
+ * wifi_c::task<int> provision(wifi_c::loop &loop)
+ * {
+ *     auto scan = co_await wifi_c::scan(loop);
+ *     for (const wifi_ap_record_t &ap : scan.records) { ... }
+ *     co_return co_await wifi_c::connect(loop, "SSID", "PASSWORD");
+ * }
+ *
+ * wifi_c::wifi wifi(WIFI_C_MODE_STA);
+ * wifi_c::loop loop;
+ * auto op = provision(loop);
+ * int err = loop.run(op);
+ * @endcode
+ */
+#pragma once
+
+#include <algorithm>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <span>
+#include <utility>
+
+extern "C" {
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "err_controller.h"
+#include "wifi_controller.h"
+}
+
+#if WIFI_C_STA_ENABLED
+namespace wifi_c {
+
+/**
+ * @brief Owns initialized WiFi, wifi_c_deinit() is called when it goes out of scope.
+ *
+ * @note If WiFi was already initialized, error() is WIFI_C_ERR_WIFI_ALREADY_INIT and nothing is deinitialized.
+ */
+class wifi {
+public:
+    explicit wifi(wifi_c_mode_t mode) : err_(wifi_c_init_wifi(mode)) {}
+    ~wifi()
+    {
+        if (err_ == ERR_C_OK)
+        {
+            wifi_c_deinit();
+        }
+    }
+    wifi(const wifi &) = delete;
+    wifi &operator=(const wifi &) = delete;
+
+    /** @brief Result of wifi_c_init_wifi(). */
+    int error() const { return err_; }
+    explicit operator bool() const { return err_ == ERR_C_OK; }
+
+private:
+    int err_;
+};
+
+class loop;
+
+/**
+ * @brief Coroutine returning T, started by loop::run()/loop::start() or by co_await from other coroutine.
+ *
+ * @note Frame is allocated with operator new. Functions of controller return error codes,
+ * so coroutines usually are task<int>; exceptions are not used.
+ */
+template <typename T>
+class task {
+public:
+    struct promise_type;
+    using handle_t = std::coroutine_handle<promise_type>;
+
+    struct promise_type {
+        T value{};
+        std::coroutine_handle<> continuation;
+        bool started = false;             // resumed once, later resumes come only from what it awaits
+
+        task get_return_object() { return task(handle_t::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        /*Finished coroutine resumes the one awaiting it directly, without going through loop.*/
+        struct final_awaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(handle_t h) noexcept
+            {
+                std::coroutine_handle<> next = h.promise().continuation;
+                return next ? next : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        final_awaiter final_suspend() noexcept { return {}; }
+
+        void return_value(T v) { value = std::move(v); }
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+
+    task(task &&other) noexcept : h_(std::exchange(other.h_, {})) {}
+    task &operator=(task &&) = delete;
+    task(const task &) = delete;
+    ~task()
+    {
+        if (h_)
+        {
+            h_.destroy();
+        }
+    }
+
+    /** @brief Coroutine finished and result() can be read. */
+    bool done() const { return !h_ || h_.done(); }
+    T &result() { return h_.promise().value; }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        h_.promise().continuation = awaiting;
+        h_.promise().started = true;
+        return h_;
+    }
+    T await_resume() { return std::move(h_.promise().value); }
+
+private:
+    friend class loop;
+    explicit task(handle_t h) : h_(h) {}
+    handle_t h_;
+};
+
+/**
+ * @brief Resumes coroutines waiting for controller states, on the task calling run() or poll().
+ *
+ * @note Registers itself as state handler of controller, so only one loop can exist at a time.
+ * Task running it is woken with direct-to-task notification (index 0), it shouldn't use it for anything else.
+ */
+class loop {
+    struct waiter {
+        int states;                       // or-ed wifi_c_state_t to wait for
+        int result;                       // state reached, 0 when timeout expired
+        int64_t deadline_us;
+        std::coroutine_handle<> handle;
+        waiter *next;
+        bool linked;                      // on waiting list, only one of handler, timeout and awaiter may take it off
+    };
+
+public:
+    /**
+     * @brief Awaitable resuming when any of states holds, returns that state or 0 on timeout.
+     *
+     * @note States are checked first, so state reached before co_await is not missed.
+     */
+    class state_awaiter {
+    public:
+        bool await_ready()
+        {
+            w_.result = holding(w_.states);
+            return w_.result != 0;
+        }
+        bool await_suspend(std::coroutine_handle<> h)
+        {
+            int held = 0;
+
+            w_.handle = h;
+            loop_.link(w_);
+            /*State reached between await_ready() and link() has no event anymore, look again.*/
+            held = holding(w_.states);
+            if (held != 0 && loop_.unlink(w_))
+            {
+                w_.result = held;
+                return false;
+            }
+            return true;
+        }
+        int await_resume() const { return w_.result; }
+
+    private:
+        friend class loop;
+        state_awaiter(loop &l, int states, uint32_t timeout_ms)
+            : loop_(l), w_{states, 0,
+                           (timeout_ms == WIFI_C_WAIT_FOREVER) ? INT64_MAX
+                                                               : esp_timer_get_time() + (int64_t)timeout_ms * 1000,
+                           {}, nullptr, false}
+        {
+        }
+
+        static int holding(int states)
+        {
+            for (int bit = 1; bit <= states; bit <<= 1)
+            {
+                if ((states & bit) && wifi_c_wait_for((wifi_c_state_t)bit, 0) == ERR_C_OK)
+                {
+                    return bit;
+                }
+            }
+            return 0;
+        }
+
+        loop &loop_;
+        waiter w_;
+    };
+
+    loop() { wifi_c_register_state_handler(&loop::on_state, this); }
+    ~loop() { wifi_c_register_state_handler(nullptr, nullptr); }
+    loop(const loop &) = delete;
+    loop &operator=(const loop &) = delete;
+
+    /**
+     * @brief Wait until any of or-ed wifi_c_state_t holds.
+     *
+     * @param states        States to wait for, e.g. WIFI_C_STATE_STA_GOT_IP | WIFI_C_STATE_STA_CONNECT_FAILED.
+     * @param timeout_ms    Maximum time to wait, WIFI_C_WAIT_FOREVER to never time out.
+     */
+    state_awaiter wait_for(int states, uint32_t timeout_ms = WIFI_C_WAIT_FOREVER)
+    {
+        return state_awaiter(*this, states, timeout_ms);
+    }
+
+    /**
+     * @brief Run coroutine until its first suspension, e.g. to have more operations in progress at once.
+     *
+     * @note Coroutine already started is not resumed, it continues when what it awaits is done.
+     */
+    template <typename T>
+    void start(task<T> &t)
+    {
+        if (t.h_ && !t.h_.promise().started)
+        {
+            t.h_.promise().started = true;
+            t.h_.resume();
+        }
+    }
+
+    /**
+     * @brief Start coroutine if not started and resume waiting coroutines until it finishes.
+     *
+     * @return Result of coroutine.
+     */
+    template <typename T>
+    T &run(task<T> &t)
+    {
+        owner_ = xTaskGetCurrentTaskHandle();
+        start(t);
+        while (!t.done())
+        {
+            poll();
+        }
+        return t.result();
+    }
+
+    /**
+     * @brief Block until a waiting coroutine can continue, then resume all that can.
+     */
+    void poll()
+    {
+        waiter *ready = nullptr;
+
+        owner_ = xTaskGetCurrentTaskHandle();
+        ready = take_ready();
+        if (ready == nullptr)
+        {
+            ulTaskNotifyTake(pdTRUE, next_timeout());
+            expire(esp_timer_get_time());
+            ready = take_ready();
+        }
+        while (ready != nullptr)
+        {
+            waiter *next = ready->next; // awaiter lives in coroutine frame, it's gone after resume
+            ready->handle.resume();
+            ready = next;
+        }
+    }
+
+private:
+    /*Called from event loop task, only moves waiters to ready list and wakes loop task.*/
+    static void on_state(wifi_c_state_t state, void *arg)
+    {
+        loop *self = static_cast<loop *>(arg);
+        bool woken = false;
+
+        portENTER_CRITICAL(&self->lock_);
+        for (waiter **link = &self->waiting_; *link != nullptr;)
+        {
+            waiter *w = *link;
+            if (w->states & state)
+            {
+                *link = w->next;
+                w->linked = false;
+                w->result = state;
+                self->push_ready(w);
+                woken = true;
+            }
+            else
+            {
+                link = &w->next;
+            }
+        }
+        TaskHandle_t owner = self->owner_;
+        portEXIT_CRITICAL(&self->lock_);
+
+        if (woken && owner != nullptr)
+        {
+            xTaskNotifyGive(owner);
+        }
+    }
+
+    void link(waiter &w)
+    {
+        portENTER_CRITICAL(&lock_);
+        w.next = waiting_;
+        w.linked = true;
+        waiting_ = &w;
+        portEXIT_CRITICAL(&lock_);
+    }
+
+    /*Returns false if handler or timeout took waiter first, it's on ready list then.*/
+    bool unlink(waiter &w)
+    {
+        bool was_linked = false;
+
+        portENTER_CRITICAL(&lock_);
+        was_linked = w.linked;
+        for (waiter **link = &waiting_; was_linked && *link != nullptr; link = &(*link)->next)
+        {
+            if (*link == &w)
+            {
+                *link = w.next;
+                w.linked = false;
+                break;
+            }
+        }
+        portEXIT_CRITICAL(&lock_);
+        return was_linked;
+    }
+
+    void push_ready(waiter *w)
+    {
+        w->next = nullptr;
+        if (ready_tail_ != nullptr)
+        {
+            ready_tail_->next = w;
+        }
+        else
+        {
+            ready_head_ = w;
+        }
+        ready_tail_ = w;
+    }
+
+    waiter *take_ready()
+    {
+        waiter *ready = nullptr;
+
+        portENTER_CRITICAL(&lock_);
+        ready = ready_head_;
+        ready_head_ = nullptr;
+        ready_tail_ = nullptr;
+        portEXIT_CRITICAL(&lock_);
+        return ready;
+    }
+
+    void expire(int64_t now_us)
+    {
+        portENTER_CRITICAL(&lock_);
+        for (waiter **link = &waiting_; *link != nullptr;)
+        {
+            waiter *w = *link;
+            if (w->deadline_us <= now_us)
+            {
+                *link = w->next;
+                w->linked = false;
+                w->result = 0;
+                push_ready(w);
+            }
+            else
+            {
+                link = &w->next;
+            }
+        }
+        portEXIT_CRITICAL(&lock_);
+    }
+
+    TickType_t next_timeout()
+    {
+        int64_t deadline_us = INT64_MAX;
+        int64_t left_us = 0;
+
+        portENTER_CRITICAL(&lock_);
+        for (waiter *w = waiting_; w != nullptr; w = w->next)
+        {
+            deadline_us = std::min(deadline_us, w->deadline_us);
+        }
+        portEXIT_CRITICAL(&lock_);
+
+        if (deadline_us == INT64_MAX)
+        {
+            return portMAX_DELAY;
+        }
+        left_us = deadline_us - esp_timer_get_time();
+        return (left_us <= 0) ? 0 : pdMS_TO_TICKS((left_us + 999) / 1000) + 1;
+    }
+
+    portMUX_TYPE lock_ = portMUX_INITIALIZER_UNLOCKED;
+    TaskHandle_t owner_ = nullptr;
+    waiter *waiting_ = nullptr;
+    waiter *ready_head_ = nullptr;
+    waiter *ready_tail_ = nullptr;
+};
+
+/**
+ * @brief Connect STA, finish when it got IP address or all attempts failed.
+ *
+ * @note ssid and password must stay valid until coroutine is started, they are copied to driver then.
+ *
+ * @retval ERR_C_OK when IP address was assigned
+ * @retval WIFI_C_ERR_STA_CONNECT_FAIL if all attempts failed
+ * @retval WIFI_C_ERR_STA_TIMEOUT_EXPIRE if result didn't come in time
+ * @retval same errors as wifi_c_start_sta_async()
+ */
+inline task<int> connect(loop &l, const char *ssid, const char *password, uint32_t timeout_ms = 60000)
+{
+    int err = wifi_c_start_sta_async(ssid, password);
+    if (err != ERR_C_OK)
+    {
+        co_return err;
+    }
+
+    int state = co_await l.wait_for(WIFI_C_STATE_STA_GOT_IP | WIFI_C_STATE_STA_CONNECT_FAILED, timeout_ms);
+    if (state == WIFI_C_STATE_STA_GOT_IP)
+    {
+        co_return ERR_C_OK;
+    }
+    co_return (state == 0) ? WIFI_C_ERR_STA_TIMEOUT_EXPIRE : WIFI_C_ERR_STA_CONNECT_FAIL;
+}
+
+/**
+ * @brief Wait until STA has IP address, returns WIFI_C_STATE_STA_GOT_IP, or 0 on timeout.
+ */
+inline loop::state_awaiter wait_for_ip(loop &l, uint32_t timeout_ms = WIFI_C_WAIT_FOREVER)
+{
+    return l.wait_for(WIFI_C_STATE_STA_GOT_IP, timeout_ms);
+}
+
+#if WIFI_C_SCAN_ENABLED
+/**
+ * @brief View of scan results kept by controller.
+ *
+ * @note Controller stores driver records (see wifi_c_scan_for_ap_with_ssid()), they are valid until next scan.
+ */
+inline std::span<const wifi_ap_record_t> records(const wifi_c_scan_result_t &result)
+{
+    return {reinterpret_cast<const wifi_ap_record_t *>(result.ap_record), result.ap_record ? result.ap_count : 0u};
+}
+
+/**
+ * @brief Result of scan(), records are empty when error is set.
+ */
+struct scan_result {
+    int error;
+    std::span<const wifi_ap_record_t> records;
+};
+
+/**
+ * @brief Scan all channels, finish when scan is done.
+ *
+ * @retval error ERR_C_OK on success
+ * @retval error WIFI_C_ERR_SCAN_NOT_DONE if scan didn't finish in time
+ * @retval error same errors as wifi_c_scan_start_async() and wifi_c_scan_get_results()
+ */
+inline task<scan_result> scan(loop &l, uint32_t timeout_ms = 10000)
+{
+    wifi_c_scan_result_t result = {};
+    int err = wifi_c_scan_start_async();
+
+    if (err == ERR_C_OK)
+    {
+        int state = co_await l.wait_for(WIFI_C_STATE_SCAN_DONE, timeout_ms);
+        err = (state != 0) ? wifi_c_scan_get_results(&result) : WIFI_C_ERR_SCAN_NOT_DONE;
+    }
+    if (err != ERR_C_OK)
+    {
+        result = {};
+    }
+    co_return scan_result{err, records(result)};
+}
+#endif
+
+} // namespace wifi_c
+#endif
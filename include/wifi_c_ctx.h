@@ -0,0 +1,354 @@
+/**
+ * @file wifi_c_ctx.h
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief Wifi controller context header file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "wifi_controller.h"
+#include "wifi_c_scan_filter.h"
+#include "wifi_c_scan_slice.h"
+#include "wifi_c_channel.h"
+#include "wifi_c_roam.h"
+#include "wifi_c_trace.h"
+
+/**
+ * @brief Opaque controller context, owns status, event group, scan results and netif handles.
+ *
+ * @note Functions from wifi_controller.h work on default context - see wifi_c_ctx_get_default().
+ * @note ESP-IDF WiFi driver is single instance and shared by all contexts. Each interface (STA, AP) is owned by one
+ * context, the one which initialized it, and only its handlers get events of that interface. Scan events belong to STA.
+ * @note Driver is initialized by first context and deinitialized by last one, worker, deferred log and event loop
+ * are stopped when last context is deinitialized.
+ * @note BSSID history, cached DHCP lease, deferred log and callback worker are shared by all contexts.
+ * @note Contexts drive the one radio, so at most two of them (STA and AP owner) can be initialized, others get
+ * WIFI_C_ERR_IFACE_BUSY. STA connection logic of context is wifi_c_link_t, which doesn't touch the driver, many
+ * devices are simulated on host with one link per device, see wifi_c_link.h.
+ */
+typedef struct wifi_c_ctx_obj wifi_c_ctx_t;
+
+/**
+ * @brief Get context used by functions without context argument.
+ *
+ */
+wifi_c_ctx_t *wifi_c_ctx_get_default(void);
+
+/**
+ * @brief Allocate new controller context.
+ *
+ * @return Pointer to context, NULL if allocation failed.
+ */
+wifi_c_ctx_t *wifi_c_ctx_create(void);
+
+/**
+ * @brief Deinit and free controller context.
+ *
+ * @note Default context cannot be destroyed, use wifi_c_ctx_deinit() instead.
+ */
+void wifi_c_ctx_destroy(wifi_c_ctx_t *ctx);
+
+/**
+ * @brief Context version of wifi_c_init_wifi().
+ *
+ * @retval WIFI_C_ERR_IFACE_BUSY if interface of the mode is owned by other context
+ */
+int wifi_c_ctx_init_wifi(wifi_c_ctx_t *ctx, wifi_c_mode_t WIFI_C_WIFI_MODE);
+
+#if WIFI_C_AP_ENABLED
+/**
+ * @brief Context version of wifi_c_start_ap().
+ *
+ */
+int wifi_c_ctx_start_ap(wifi_c_ctx_t *ctx, const char *ssid, const char *password);
+
+/**
+ * @brief Context version of wifi_c_start_ap_with_config().
+ *
+ */
+int wifi_c_ctx_start_ap_with_config(wifi_c_ctx_t *ctx, const wifi_c_ap_config_t *config);
+
+/**
+ * @brief Context version of wifi_c_get_ap_ipv4().
+ *
+ */
+char *wifi_c_ctx_get_ap_ipv4(wifi_c_ctx_t *ctx);
+
+/**
+ * @brief Context version of wifi_c_ap_get_ssid().
+ *
+ */
+char *wifi_c_ctx_ap_get_ssid(wifi_c_ctx_t *ctx);
+
+#if WIFI_C_JSON_ENABLED
+/**
+ * @brief Context version of wifi_c_stream_stations_json().
+ *
+ */
+int wifi_c_ctx_stream_stations_json(wifi_c_ctx_t *ctx, wifi_c_stream_sink_t sink, void *arg);
+#endif
+#endif
+
+#if WIFI_C_STA_ENABLED
+/**
+ * @brief Context version of wifi_c_start_sta().
+ *
+ */
+int wifi_c_ctx_start_sta(wifi_c_ctx_t *ctx, const char *ssid, const char *password);
+
+/**
+ * @brief Context version of wifi_c_start_sta_async().
+ *
+ */
+int wifi_c_ctx_start_sta_async(wifi_c_ctx_t *ctx, const char *ssid, const char *password);
+
+/**
+ * @brief Context version of wifi_c_get_sta_ipv4().
+ *
+ */
+char *wifi_c_ctx_get_sta_ipv4(wifi_c_ctx_t *ctx);
+
+/**
+ * @brief Context version of wifi_c_sta_get_ap_ssid().
+ *
+ */
+char *wifi_c_ctx_sta_get_ap_ssid(wifi_c_ctx_t *ctx);
+
+/**
+ * @brief Context version of wifi_c_disconnect().
+ *
+ */
+int wifi_c_ctx_disconnect(wifi_c_ctx_t *ctx);
+
+/**
+ * @brief Context version of wifi_c_sta_register_connect_handler().
+ *
+ */
+int wifi_c_ctx_sta_register_connect_handler(wifi_c_ctx_t *ctx, void (*connect_handler)(void));
+
+/**
+ * @brief Context version of wifi_c_wait_for().
+ *
+ */
+int wifi_c_ctx_wait_for(wifi_c_ctx_t *ctx, wifi_c_state_t state, uint32_t timeout_ms);
+
+/**
+ * @brief Context version of wifi_c_register_state_handler().
+ *
+ */
+int wifi_c_ctx_register_state_handler(wifi_c_ctx_t *ctx, wifi_c_state_handler_t handler, void *arg);
+
+/**
+ * @brief Context version of wifi_c_sta_set_ip_config().
+ *
+ */
+int wifi_c_ctx_sta_set_ip_config(wifi_c_ctx_t *ctx, const wifi_c_sta_ip_config_t *config);
+
+/**
+ * @brief Context version of wifi_c_sta_set_link_profile().
+ *
+ */
+int wifi_c_ctx_sta_set_link_profile(wifi_c_ctx_t *ctx, const wifi_c_sta_link_profile_t *profile);
+
+/**
+ * @brief Context version of wifi_c_sta_get_lease_conflicts().
+ *
+ */
+uint32_t wifi_c_ctx_sta_get_lease_conflicts(wifi_c_ctx_t *ctx);
+#endif
+
+#if WIFI_C_APSTA_POLICY_ENABLED
+/**
+ * @brief Context version of wifi_c_apsta_set_policy().
+ *
+ */
+int wifi_c_ctx_apsta_set_policy(wifi_c_ctx_t *ctx, const wifi_c_apsta_policy_t *policy);
+
+/**
+ * @brief Context version of wifi_c_apsta_get_stats().
+ *
+ */
+void wifi_c_ctx_apsta_get_stats(wifi_c_ctx_t *ctx, wifi_c_apsta_stats_t *stats);
+#endif
+
+/**
+ * @brief Context version of wifi_c_get_status().
+ *
+ */
+wifi_c_status_t *wifi_c_ctx_get_status(wifi_c_ctx_t *ctx);
+
+#if WIFI_C_JSON_ENABLED
+/**
+ * @brief Context version of wifi_c_get_status_as_json().
+ *
+ */
+int wifi_c_ctx_get_status_as_json(wifi_c_ctx_t *ctx, char *buffer, size_t buflen);
+
+/**
+ * @brief Context version of wifi_c_stream_status_json().
+ *
+ */
+int wifi_c_ctx_stream_status_json(wifi_c_ctx_t *ctx, wifi_c_stream_sink_t sink, void *arg);
+#endif
+
+/**
+ * @brief Context version of wifi_c_create_default_event_loop().
+ *
+ * @note Default event loop is shared by all contexts, it's only created once. The same holds for private loop.
+ */
+int wifi_c_ctx_create_default_event_loop(wifi_c_ctx_t *ctx);
+
+#if WIFI_C_SCAN_ENABLED
+/**
+ * @brief Context version of wifi_c_scan_all_ap().
+ *
+ */
+int wifi_c_ctx_scan_all_ap(wifi_c_ctx_t *ctx, wifi_c_scan_result_t *result_to_return);
+
+/**
+ * @brief Context version of wifi_c_scan_start_async().
+ *
+ */
+int wifi_c_ctx_scan_start_async(wifi_c_ctx_t *ctx);
+
+/**
+ * @brief Context version of wifi_c_scan_get_results().
+ *
+ */
+int wifi_c_ctx_scan_get_results(wifi_c_ctx_t *ctx, wifi_c_scan_result_t *result);
+
+/**
+ * @brief Context version of wifi_c_scan_filtered().
+ *
+ */
+int wifi_c_ctx_scan_filtered(wifi_c_ctx_t *ctx, const wifi_c_scan_filter_t *filter, wifi_ap_record_t *records, uint16_t *count);
+
+/**
+ * @brief Context version of wifi_c_scan_sliced().
+ *
+ */
+int wifi_c_ctx_scan_sliced(wifi_c_ctx_t *ctx, const wifi_c_scan_slice_config_t *config, const wifi_c_scan_filter_t *filter,
+                           wifi_ap_record_t *records, uint16_t *count, wifi_c_scan_slice_report_t *report);
+#endif
+
+#if WIFI_C_AUTO_CHANNEL_ENABLED
+/**
+ * @brief Context version of wifi_c_measure_channels().
+ *
+ */
+int wifi_c_ctx_measure_channels(wifi_c_ctx_t *ctx, wifi_c_channel_scores_t *scores);
+
+/**
+ * @brief Context version of wifi_c_measure_channel().
+ *
+ */
+int wifi_c_ctx_measure_channel(wifi_c_ctx_t *ctx, uint8_t channel, wifi_c_channel_scores_t *scores);
+
+/**
+ * @brief Context version of wifi_c_start_ap_auto_channel().
+ *
+ */
+int wifi_c_ctx_start_ap_auto_channel(wifi_c_ctx_t *ctx, const char *ssid, const char *password, uint16_t channel_mask, uint8_t *channel);
+#endif
+
+#if WIFI_C_SCAN_ENABLED
+/**
+ * @brief Context version of wifi_c_start_sta_best_bssid().
+ *
+ */
+int wifi_c_ctx_start_sta_best_bssid(wifi_c_ctx_t *ctx, const char *ssid, const char *password,
+                                    const wifi_c_bssid_select_config_t *config, wifi_ap_record_t *selected);
+
+/**
+ * @brief Context version of wifi_c_sta_roam_to().
+ *
+ */
+int wifi_c_ctx_sta_roam_to(wifi_c_ctx_t *ctx, const uint8_t bssid[6], uint8_t channel);
+
+/**
+ * @brief Context version of wifi_c_sta_set_11kv().
+ *
+ */
+void wifi_c_ctx_sta_set_11kv(wifi_c_ctx_t *ctx, bool enable);
+#endif
+
+#if WIFI_C_SCAN_ENABLED
+/**
+ * @brief Context version of wifi_c_scan_for_ap_with_ssid().
+ *
+ */
+int wifi_c_ctx_scan_for_ap_with_ssid(wifi_c_ctx_t *ctx, const char *searched_ssid, wifi_c_ap_record_t *ap_record);
+
+/**
+ * @brief Context version of wifi_c_print_scanned_ap().
+ *
+ */
+int wifi_c_ctx_print_scanned_ap(wifi_c_ctx_t *ctx);
+
+#if WIFI_C_JSON_ENABLED
+/**
+ * @brief Context version of wifi_c_store_scan_result_as_json().
+ *
+ */
+int wifi_c_ctx_store_scan_result_as_json(wifi_c_ctx_t *ctx, char *buffer, uint16_t buflen);
+
+/**
+ * @brief Context version of wifi_c_stream_scan_json().
+ *
+ */
+int wifi_c_ctx_stream_scan_json(wifi_c_ctx_t *ctx, wifi_c_stream_sink_t sink, void *arg);
+#endif
+#endif
+
+#if WIFI_C_EVENT_TRACE_ENABLED
+/**
+ * @brief Context version of wifi_c_trace_replay().
+ *
+ * @note Trace is recorded only from events of default context.
+ * @note Context must have event loop created, but WiFi not initialized, e.g. fresh one from wifi_c_ctx_create().
+ * Such context owns no interface, so its handlers get only replayed events.
+ *
+ * @retval WIFI_C_ERR_WIFI_ALREADY_INIT if WiFi of context is initialized
+ */
+int wifi_c_ctx_trace_replay(wifi_c_ctx_t *ctx, const uint8_t *trace, size_t len, wifi_c_trace_speed_t speed, wifi_c_trace_replay_stats_t *stats);
+#endif
+
+/**
+ * @brief Context version of wifi_c_suspend().
+ *
+ * @retval WIFI_C_ERR_IFACE_BUSY if other contexts are initialized, suspend stops the driver for all of them
+ */
+int wifi_c_ctx_suspend(wifi_c_ctx_t *ctx);
+
+/**
+ * @brief Context version of wifi_c_resume().
+ *
+ */
+int wifi_c_ctx_resume(wifi_c_ctx_t *ctx, uint32_t timeout_ms);
+
+/**
+ * @brief Context version of wifi_c_get_resume_stats().
+ *
+ */
+void wifi_c_ctx_get_resume_stats(wifi_c_ctx_t *ctx, wifi_c_resume_stats_t *stats);
+
+/**
+ * @brief Context version of wifi_c_change_mode().
+ *
+ * @retval WIFI_C_ERR_IFACE_BUSY if interface of new mode is owned by other context
+ */
+int wifi_c_ctx_change_mode(wifi_c_ctx_t *ctx, wifi_c_mode_t mode);
+
+/**
+ * @brief Context version of wifi_c_deinit().
+ *
+ * @note Interfaces of context are released, driver, worker, deferred log and default event loop (only if controller
+ * created it) are stopped only by deinit of last context.
+ */
+void wifi_c_ctx_deinit(wifi_c_ctx_t *ctx);
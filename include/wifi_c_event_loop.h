@@ -0,0 +1,120 @@
+/**
+ * @file wifi_c_event_loop.h
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief Private event loop of controller header file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_event.h"
+#include "freertos/FreeRTOS.h"
+#include "wifi_controller.h"
+
+#if WIFI_C_PRIVATE_EVENT_LOOP_ENABLED
+/**
+ * @brief Configuration of private event loop.
+ *
+ */
+struct wifi_c_event_loop_config_obj {
+    uint16_t queue_size;                  /**< Events waiting for loop task, forwarded events which don't fit are dropped. */
+    uint8_t priority;                     /**< Priority of loop task, handlers of all contexts run on it. */
+    uint32_t stack_size;                  /**< Stack size of loop task in bytes, must fit deepest controller handler. */
+    int core_id;                          /**< Core to pin loop task to, or tskNO_AFFINITY. */
+    uint32_t post_timeout_ms;             /**< Time default loop task waits for space in queue, 0 drops event at once. */
+};
+
+/**
+ * @brief Type of private event loop configuration.
+ *
+ */
+typedef struct wifi_c_event_loop_config_obj wifi_c_event_loop_config_t;
+
+#define WIFI_C_EVENT_LOOP_CONFIG_DEFAULT() {                                                                    \
+    .queue_size = CONFIG_WIFI_C_EVENT_LOOP_QUEUE_SIZE,                                                          \
+    .priority = CONFIG_WIFI_C_EVENT_LOOP_TASK_PRIORITY,                                                         \
+    .stack_size = CONFIG_WIFI_C_EVENT_LOOP_TASK_STACK,                                                          \
+    .core_id = (CONFIG_WIFI_C_EVENT_LOOP_TASK_CORE < 0) ? tskNO_AFFINITY : CONFIG_WIFI_C_EVENT_LOOP_TASK_CORE,  \
+    .post_timeout_ms = 0,                                                                                       \
+}
+
+/**
+ * @brief Statistics of private event loop.
+ *
+ * @note Queue depth counts events forwarded and not yet taken by loop task, esp_event doesn't expose its queue.
+ */
+struct wifi_c_event_loop_stats_obj {
+    uint32_t forwarded;                   /**< Events posted from default loop to private loop. */
+    uint32_t dropped;                     /**< Events lost because queue was full. */
+    uint32_t skipped;                     /**< Events not forwarded, their data has size unknown to controller. */
+    uint32_t dispatched;                  /**< Events taken by loop task. */
+    uint16_t queue_size;                  /**< Size of queue, 0 when loop is not running. */
+    uint16_t queue_depth;                 /**< Events currently waiting in queue. */
+    uint16_t queue_max_depth;             /**< Highest number of events waiting in queue. */
+};
+
+/**
+ * @brief Type of private event loop statistics.
+ *
+ */
+typedef struct wifi_c_event_loop_stats_obj wifi_c_event_loop_stats_t;
+
+/**
+ * @brief Set configuration used when private event loop is created by wifi_c_init_wifi().
+ *
+ * @param config Loop configuration, NULL for WIFI_C_EVENT_LOOP_CONFIG_DEFAULT().
+ *
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_EVENT_LOOP_RUNNING if loop already runs, config is applied after last context is deinitialized
+ * @retval ERR_C_INVALID_ARGS if queue size or stack size is zero
+ */
+int wifi_c_event_loop_set_config(const wifi_c_event_loop_config_t *config);
+
+/**
+ * @brief Create private event loop on first call and forward WiFi and IP events of default loop to it.
+ *
+ * @note Events without data and events which controller knows data size of are forwarded, see
+ * wifi_c_event_loop_stats_t::skipped.
+ * @note Called by wifi_c_create_default_event_loop() of every context, default loop must already exist.
+ *
+ * @retval ERR_C_OK on success
+ * @retval ERR_C_MEMORY_ERR if loop could not be created
+ * @retval esp specific error codes
+ */
+int wifi_c_event_loop_start(void);
+
+/**
+ * @brief Stop forwarding and delete private loop when last context stops using it.
+ *
+ * @note Handlers registered on the loop must be unregistered before. Must not be called from a handler.
+ */
+void wifi_c_event_loop_stop(void);
+
+/**
+ * @brief Get handle of private loop, e.g. to register application handlers next to the controller ones.
+ *
+ * @return Loop handle, NULL if loop is not running.
+ */
+esp_event_loop_handle_t wifi_c_event_loop_get(void);
+
+/**
+ * @brief Get forwarding and queue statistics.
+ *
+ * @param stats Pointer to store statistics.
+ *
+ * @retval ERR_C_OK on success
+ * @retval ERR_NULL_POINTER if stats is NULL
+ */
+int wifi_c_event_loop_get_stats(wifi_c_event_loop_stats_t *stats);
+
+/**
+ * @brief Zero counters and high-water mark, events in queue stay counted as forwarded.
+ *
+ */
+void wifi_c_event_loop_reset_stats(void);
+#endif
@@ -0,0 +1,151 @@
+/**
+ * @file wifi_c_heap.h
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief Heap allocation audit of controller header file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "wifi_controller.h"
+#include "wifi_c_cmd.h"
+
+#define WIFI_C_HEAP_AUDIT_SCOPES        4                           ///< Tasks audited at the same time, e.g. controller task, event loop and callers running API directly.
+
+/**
+ * @brief Places where allocations are counted.
+ *
+ * @note Values below WIFI_C_CMD_COUNT are API calls, wifi_c_cmd_id_t of command.
+ */
+typedef enum {
+    WIFI_C_HEAP_SITE_AP_EVENT = WIFI_C_CMD_COUNT, /*AP handler of WIFI_EVENT*/
+    WIFI_C_HEAP_SITE_STA_EVENT,           /*STA handler of WIFI_EVENT*/
+    WIFI_C_HEAP_SITE_IP_EVENT,            /*STA handler of IP_EVENT*/
+    WIFI_C_HEAP_SITE_COUNT
+} wifi_c_heap_site_t;
+
+/**
+ * @brief Allocations of one call site.
+ *
+ * @note Only allocations made by task running API call or handler are counted, the ones which driver
+ * makes in its own task meanwhile are not.
+ */
+struct wifi_c_heap_site_stats_obj {
+    uint32_t calls;                       /**< API calls or handler runs. */
+    uint32_t allocs;                      /**< Allocations, malloc, calloc and realloc of any capabilities. */
+    uint32_t frees;                       /**< Frees, also of memory allocated before. */
+    uint64_t bytes;                       /**< Sum of requested sizes. */
+    uint32_t max_call_bytes;              /**< Most bytes allocated by one call. */
+    uint32_t steady_allocs;               /**< Allocations after wifi_c_heap_audit_set_steady(). */
+};
+
+/**
+ * @brief Type of call site allocations.
+ *
+ */
+typedef struct wifi_c_heap_site_stats_obj wifi_c_heap_site_stats_t;
+
+/**
+ * @brief Allocations of all call sites.
+ *
+ */
+struct wifi_c_heap_report_obj {
+    wifi_c_heap_site_stats_t sites[WIFI_C_HEAP_SITE_COUNT]; /**< Indexed by wifi_c_heap_site_t. */
+    bool steady;                          /**< wifi_c_heap_audit_set_steady() was called. */
+    uint32_t steady_allocs;               /**< Allocations of all sites after it. */
+    uint32_t untracked;                   /**< Calls not audited, more than WIFI_C_HEAP_AUDIT_SCOPES tasks were in calls. */
+};
+
+/**
+ * @brief Type of allocation report.
+ *
+ */
+typedef struct wifi_c_heap_report_obj wifi_c_heap_report_t;
+
+#if WIFI_C_HEAP_AUDIT_ENABLED
+/**
+ * @brief Start counting allocations of calling task for call site, nested calls are counted to outer one.
+ *
+ */
+void wifi_c_heap_audit_enter(wifi_c_heap_site_t site);
+
+/**
+ * @brief Stop counting allocations of calling task.
+ *
+ */
+void wifi_c_heap_audit_exit(void);
+
+/**
+ * @brief Mark end of startup, allocations from now on are steady-state ones.
+ *
+ * @note Call it after controller is initialized and connected, e.g. with CONFIG_WIFI_C_STATIC_ALLOC enabled,
+ * and check later with wifi_c_heap_audit_check().
+ */
+void wifi_c_heap_audit_set_steady(void);
+
+/**
+ * @brief Check that no allocation was made after wifi_c_heap_audit_set_steady(), call sites which allocated are logged.
+ *
+ * @retval ERR_C_OK if there were none
+ * @retval WIFI_C_ERR_HEAP_STEADY_ALLOC if any call site allocated
+ */
+int wifi_c_heap_audit_check(void);
+
+/**
+ * @brief Copy allocations of all call sites.
+ *
+ * @param report Pointer to store report.
+ *
+ * @retval ERR_C_OK on success
+ * @retval ERR_NULL_POINTER if report is NULL
+ */
+int wifi_c_heap_audit_get(wifi_c_heap_report_t *report);
+
+/**
+ * @brief Log call sites which were called, with their allocations.
+ *
+ */
+void wifi_c_heap_audit_print(void);
+
+/**
+ * @brief Zero counters and leave steady state.
+ *
+ */
+void wifi_c_heap_audit_reset(void);
+
+/**
+ * @brief Get name of call site, e.g. for printing report.
+ *
+ * @return Name, "unknown" for site out of range.
+ */
+const char *wifi_c_heap_site_name(wifi_c_heap_site_t site);
+
+/**
+ * @brief Allocation hook of application, called by esp_heap_trace_alloc_hook() which audit defines.
+ *
+ * @note ESP-IDF takes one definition of its heap hooks, with audit enabled application defines this
+ * one instead. It's weak, so it may be left undefined. It runs on every allocation of any task,
+ * so it must be short and must not allocate.
+ */
+void wifi_c_heap_app_alloc_hook(void *ptr, size_t size, uint32_t caps) __attribute__((weak));
+
+/**
+ * @brief Free hook of application, called by esp_heap_trace_free_hook() which audit defines.
+ *
+ * @note Same rules as for wifi_c_heap_app_alloc_hook().
+ */
+void wifi_c_heap_app_free_hook(void *ptr) __attribute__((weak));
+
+#define WIFI_C_HEAP_AUDIT_ENTER(site)   wifi_c_heap_audit_enter(site)
+#define WIFI_C_HEAP_AUDIT_EXIT()        wifi_c_heap_audit_exit()
+#else
+/*Audit is compiled out, call sites are left as they are.*/
+#define WIFI_C_HEAP_AUDIT_ENTER(site)   ((void)0)
+#define WIFI_C_HEAP_AUDIT_EXIT()        ((void)0)
+#endif
@@ -0,0 +1,153 @@
+/**
+ * @file wifi_c_history.h
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief Per-BSSID scan history header file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_wifi.h"
+
+/**
+ * @brief Configuration of scan history table.
+ *
+ * @note All memory used by history is allocated once in wifi_c_history_init().
+ */
+struct wifi_c_history_config_obj {
+    uint16_t max_bssids;        /**< Number of BSSIDs to remember, least recently seen are evicted first. */
+    uint16_t max_ssids;         /**< Number of distinct SSIDs that can be stored at once. */
+};
+
+/**
+ * @brief Type of scan history configuration.
+ *
+ */
+typedef struct wifi_c_history_config_obj wifi_c_history_config_t;
+
+/**
+ * @brief Object containing aggregated statistics of one BSSID.
+ *
+ */
+struct wifi_c_history_record_obj {
+    uint8_t bssid[6];                     /**< MAC address of AP */
+    char ssid[33];                        /**< SSID of AP, empty string if it could not be stored */
+    uint8_t channel;                      /**< channel on which AP was seen last time */
+    int8_t rssi_min;                      /**< weakest signal strength seen */
+    int8_t rssi_max;                      /**< strongest signal strength seen */
+    int8_t rssi_mean;                     /**< mean signal strength of all scans */
+    uint16_t channel_changes;             /**< number of times AP was seen on different channel than before */
+    uint32_t seen_count;                  /**< number of scans in which AP was seen */
+    uint32_t first_seen_ms;               /**< time since boot when AP was seen first time */
+    uint32_t last_seen_ms;                /**< time since boot when AP was seen last time */
+};
+
+/**
+ * @brief Type of BSSID history record.
+ *
+ */
+typedef struct wifi_c_history_record_obj wifi_c_history_record_t;
+
+/**
+ * @brief Callback used to iterate over history records.
+ *
+ * @return false to stop iterating.
+ */
+typedef bool (*wifi_c_history_visitor_t)(const wifi_c_history_record_t *record, void *arg);
+
+/**
+ * @brief Initialize BSSID history, after this every scan result is accumulated in it.
+ *
+ * @param config Size of history table.
+ *
+ * @retval ERR_C_OK on success
+ * @retval ERR_C_INVALID_ARGS if any of sizes is zero
+ * @retval ERR_C_MEMORY_ERR if table could not be allocated
+ * @retval WIFI_C_ERR_HISTORY_ALREADY_INIT if history was already initialized
+ */
+int wifi_c_history_init(const wifi_c_history_config_t *config);
+
+/**
+ * @brief Free memory used by BSSID history.
+ *
+ */
+void wifi_c_history_deinit(void);
+
+/**
+ * @brief Check if BSSID history is initialized.
+ *
+ */
+bool wifi_c_history_is_init(void);
+
+/**
+ * @brief Add results of one scan to history.
+ *
+ * @note Called by wifi_c_scan_all_ap(), it's only needed when scanning without wifi_controller.
+ *
+ * @param records   Scanned AP records.
+ * @param count     Number of records.
+ *
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_HISTORY_NOT_INIT if history was not initialized
+ */
+int wifi_c_history_add_scan(const wifi_ap_record_t *records, uint16_t count);
+
+/**
+ * @brief Get number of BSSIDs currently stored in history.
+ *
+ */
+uint16_t wifi_c_history_get_count(void);
+
+/**
+ * @brief Get number of BSSIDs evicted from history since init.
+ *
+ */
+uint32_t wifi_c_history_get_evicted_count(void);
+
+/**
+ * @brief Find history record of BSSID.
+ *
+ * @param bssid     MAC address of AP.
+ * @param record    Pointer to store record.
+ *
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_AP_NOT_FOUND if BSSID is not in history
+ * @retval WIFI_C_ERR_HISTORY_NOT_INIT if history was not initialized
+ */
+int wifi_c_history_get_record(const uint8_t bssid[6], wifi_c_history_record_t *record);
+
+/**
+ * @brief Call visitor for every record, from most to least recently seen.
+ *
+ * @note History is locked while iterating, visitor should not block.
+ *
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_HISTORY_NOT_INIT if history was not initialized
+ */
+int wifi_c_history_for_each(wifi_c_history_visitor_t visitor, void *arg);
+
+/**
+ * @brief Store history as JSON array, from most to least recently seen.
+ *
+ * @note Output stops at first record which doesn't fit in the buffer, so the most recently seen ones are kept.
+ * @note SSIDs are escaped, any bytes of SSID give valid JSON.
+ *
+ * @param buffer Buffer to store history.
+ * @param buflen Length of the buffer.
+ *
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_HISTORY_NOT_INIT if history was not initialized
+ */
+int wifi_c_history_store_as_json(char *buffer, size_t buflen);
+
+/**
+ * @brief Remove all records from history, without freeing memory.
+ *
+ */
+void wifi_c_history_clear(void);
@@ -0,0 +1,48 @@
+/**
+ * @file wifi_c_http.h
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief HTTP endpoints of controller state header file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+
+#include "esp_http_server.h"
+#include "wifi_controller.h"
+#include "wifi_c_ctx.h"
+
+#define WIFI_C_HTTP_URI_COUNT           (WIFI_C_JSON_ENABLED * (1 + WIFI_C_SCAN_ENABLED + WIFI_C_AP_ENABLED) + WIFI_C_METRICS_ENABLED + WIFI_C_SPAN_TRACE_ENABLED) ///< Number of handlers registered by wifi_c_http_register().
+
+/**
+ * @brief Register GET handlers of controller state on running HTTP server.
+ *
+ * Endpoints, all sent with chunked transfer encoding on HTTP server task:
+ * - /wifi/status    status as JSON object, see wifi_c_stream_status_json()
+ * - /wifi/scan      results of last scan as JSON array, see wifi_c_stream_scan_json()
+ * - /wifi/stations  stations connected to AP as JSON array, see wifi_c_stream_stations_json()
+ * - /wifi/metrics   metrics in Prometheus text format, see wifi_c_metrics_stream_prometheus()
+ * - /wifi/trace     spans as Chrome trace_event JSON, see wifi_c_span_export_chrome()
+ *
+ * Status and scan results of default context are copied on controller task first, slow client doesn't
+ * hold its commands. Endpoints of features compiled out are not registered. When state can't be read, e.g. no scan
+ * was done yet, endpoint answers 503 with {"error": "<name>"}.
+ *
+ * @note Server must allow WIFI_C_HTTP_URI_COUNT more handlers than application registers itself,
+ * see max_uri_handlers of httpd_config_t.
+ *
+ * @param server    Handle of started server, owned by caller.
+ * @param ctx       Controller context to serve, NULL for default one.
+ *
+ * @retval ESP_OK on success
+ * @retval esp specific error codes of httpd_register_uri_handler(), nothing stays registered
+ */
+int wifi_c_http_register(httpd_handle_t server, wifi_c_ctx_t *ctx);
+
+/**
+ * @brief Remove handlers registered by wifi_c_http_register(), server keeps running.
+ *
+ */
+void wifi_c_http_unregister(httpd_handle_t server);
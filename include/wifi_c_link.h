@@ -0,0 +1,78 @@
+/**
+ * @file wifi_c_link.h
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief STA connection state machine header file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_event.h"
+#include "wifi_controller.h"
+
+/**
+ * @brief Connection state of one STA, changed by events passed to wifi_c_link_on_event().
+ *
+ * @note State machine doesn't call WiFi driver, event loop or any object shared between links, caller does what
+ * returned step says. Each context has its own link, links of different contexts can be stepped in parallel,
+ * e.g. on host by threads simulating many devices.
+ */
+struct wifi_c_link_obj {
+    wifi_c_status_t *status;                /**< status updated by events, STA part, scan_done and suspended */
+    const char *ssid;                       /**< SSID of connection in progress, copied to status on IP */
+    uint8_t retry_num;                      /**< reconnects done since link was up, caller may reset it */
+    uint8_t retry_count;                    /**< reconnects done before connection fails */
+};
+
+/**
+ * @brief Type of STA connection state machine.
+ *
+ */
+typedef struct wifi_c_link_obj wifi_c_link_t;
+
+/**
+ * @brief Result of event, what caller must do with event bits and driver.
+ *
+ */
+struct wifi_c_link_step_obj {
+    uint32_t clear_bits;                    /**< event bits to clear */
+    uint32_t set_bits;                      /**< event bits to set after clearing, reached wifi_c_state_t or 0 */
+    bool reconnect;                         /**< link was lost and retry budget is left, call esp_wifi_connect() */
+};
+
+/**
+ * @brief Type of event result.
+ *
+ */
+typedef struct wifi_c_link_step_obj wifi_c_link_step_t;
+
+/**
+ * @brief Prepare link updating status.
+ *
+ * @param link          Link to prepare.
+ * @param status        Status of context, must outlive link.
+ * @param ssid          Buffer with SSID of connection in progress, must outlive link.
+ * @param retry_count   Reconnects before connection fails, WIFI_C_STA_RETRY_COUNT for controller contexts.
+ */
+void wifi_c_link_init(wifi_c_link_t *link, wifi_c_status_t *status, const char *ssid, uint8_t retry_count);
+
+/**
+ * @brief Take WiFi or IP event of STA.
+ *
+ * Handles STA_START, STA_STOP, STA_CONNECTED, STA_DISCONNECTED, IP_EVENT_STA_GOT_IP and SCAN_DONE, other events
+ * give empty step. Disconnect of suspended STA is not reconnected and doesn't fail connection.
+ *
+ * @param link          Link of context which owns STA.
+ * @param event_base    WIFI_EVENT or IP_EVENT.
+ * @param event_id      ID of event.
+ * @param event_data    Data of event, only IP_EVENT_STA_GOT_IP reads it.
+ *
+ * @return What caller must do, nothing is done by link itself.
+ */
+wifi_c_link_step_t wifi_c_link_on_event(wifi_c_link_t *link, esp_event_base_t event_base, int32_t event_id,
+                                        const void *event_data);
@@ -0,0 +1,109 @@
+/**
+ * @file wifi_c_log.h
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief Deferred binary event log header file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * @brief Identifiers of events stored in deferred log.
+ *
+ * @attention Values are part of binary record format, only append new ones.
+ */
+typedef enum {
+    WIFI_C_LOG_NONE = 0,
+    WIFI_C_LOG_AP_STA_JOINED,       /*args: mac[6], aid*/
+    WIFI_C_LOG_AP_STA_LEFT,         /*args: mac[6], aid*/
+    WIFI_C_LOG_SCAN_DONE,           /*args: uint16_t ap_count*/
+    WIFI_C_LOG_STA_STARTED,         /*no args*/
+    WIFI_C_LOG_STA_RETRY,           /*args: uint8_t retry_num, uint8_t reason*/
+    WIFI_C_LOG_STA_CONNECT_FAIL,    /*args: uint8_t retry_num, uint8_t reason*/
+    WIFI_C_LOG_STA_GOT_IP,          /*args: ip[4], network order*/
+    WIFI_C_LOG_STA_LEASE_CONFLICT,  /*args: cached ip[4], renewed ip[4], network order*/
+} wifi_c_log_id_t;
+
+#define WIFI_C_LOG_MAX_ARGS             20                          ///< Maximum number of raw argument bytes in one record.
+
+/**
+ * @brief Binary log record, 32 bytes, little endian.
+ *
+ */
+struct wifi_c_log_record_obj {
+    int64_t timestamp_us;                 /**< time since boot when event was handled */
+    uint16_t id;                          /**< one of wifi_c_log_id_t */
+    uint8_t args_len;                     /**< number of valid bytes in args */
+    uint8_t reserved;
+    uint8_t args[WIFI_C_LOG_MAX_ARGS];    /**< raw event arguments, see wifi_c_log_id_t */
+};
+
+/**
+ * @brief Type of binary log record.
+ *
+ */
+typedef struct wifi_c_log_record_obj wifi_c_log_record_t;
+
+/**
+ * @brief Store event in log ring, never blocks and doesn't format anything.
+ *
+ * @note Safe to call from any task, record is dropped when ring is full.
+ *
+ * @param id        Event identifier.
+ * @param args      Raw arguments, copied into record.
+ * @param args_len  Length of arguments, truncated to WIFI_C_LOG_MAX_ARGS.
+ */
+void wifi_c_log_push(wifi_c_log_id_t id, const void *args, size_t args_len);
+
+/**
+ * @brief Take oldest record from log ring.
+ *
+ * @param record Pointer to store record.
+ *
+ * @retval true if record was taken
+ * @retval false if ring was empty
+ */
+bool wifi_c_log_pop(wifi_c_log_record_t *record);
+
+/**
+ * @brief Format log record as text.
+ *
+ * @note Doesn't depend on ESP-IDF, can be used by host tools reading dumped records.
+ *
+ * @param record Record to format.
+ * @param buffer Buffer to store text.
+ * @param buflen Length of the buffer.
+ *
+ * @return Number of characters that would be written, like snprintf.
+ */
+int wifi_c_log_format(const wifi_c_log_record_t *record, char *buffer, size_t buflen);
+
+/**
+ * @brief Get number of records dropped because ring was full.
+ *
+ */
+uint32_t wifi_c_log_get_dropped(void);
+
+/**
+ * @brief Start low priority task printing log records, called by wifi_c_init_wifi().
+ *
+ * @retval ERR_C_OK on success, also when task was already started
+ * @retval WIFI_C_ERR_LOG_STOPPING if wifi_c_log_stop() is still waiting for task on other task
+ * @retval ERR_C_MEMORY_ERR if task could not be created
+ */
+int wifi_c_log_start(void);
+
+/**
+ * @brief Print all pending records and stop log task, returns when task is gone.
+ *
+ * @note Called while other task is already stopping it, returns at once. Called while other task is
+ * starting it, waits until task is created and stops it then.
+ */
+void wifi_c_log_stop(void);
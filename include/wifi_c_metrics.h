@@ -0,0 +1,184 @@
+/**
+ * @file wifi_c_metrics.h
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief Lock-free metrics counters header file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "wifi_controller.h"
+
+/**
+ * @brief Number of disconnect reason buckets.
+ *
+ * @note Reasons 0-63 (IEEE 802.11) and 200-231 (ESP-IDF specific) have own bucket, all others share the last one.
+ */
+#define WIFI_C_METRICS_REASON_SLOTS     97
+
+/**
+ * @brief Identifiers of counters and gauges.
+ *
+ */
+typedef enum {
+    WIFI_C_METRIC_CONNECT_ATTEMPTS = 0,   /*esp_wifi_connect() calls, including retries*/
+    WIFI_C_METRIC_CONNECT_SUCCESSES,      /*IP address received*/
+    WIFI_C_METRIC_CONNECT_FAILURES,       /*connecting given up after all retries*/
+    WIFI_C_METRIC_DISCONNECTS,            /*STA disconnected events, see reasons*/
+    WIFI_C_METRIC_SCANS,                  /*finished scans*/
+    WIFI_C_METRIC_SCAN_TIME_US,           /*sum of scan durations*/
+    WIFI_C_METRIC_SCAN_LAST_US,           /*gauge: duration of last scan*/
+    WIFI_C_METRIC_SCAN_OFF_CHANNEL_LAST_US, /*gauge: longest continuous time away from home channel in last scan*/
+    WIFI_C_METRIC_SCAN_SLICES,            /*slices of sliced scans*/
+    WIFI_C_METRIC_GOT_IP_TIME_US,         /*sum of times from first connect attempt to IP*/
+    WIFI_C_METRIC_GOT_IP_LAST_US,         /*gauge: time from first connect attempt to IP of last connection*/
+    WIFI_C_METRIC_GOT_IP_MAX_US,          /*gauge: longest time from first connect attempt to IP*/
+    WIFI_C_METRIC_ROAMS,                  /*roams to other BSSID which got IP*/
+    WIFI_C_METRIC_ROAM_FAILURES,          /*roams which didn't get IP in time*/
+    WIFI_C_METRIC_ROAM_LAST_US,           /*gauge: time from leaving old AP to IP of last roam*/
+    WIFI_C_METRIC_ROAM_MAX_US,            /*gauge: longest time from leaving old AP to IP*/
+    WIFI_C_METRIC_RESUMES,                /*STA reconnections after wifi_c_resume() which got IP*/
+    WIFI_C_METRIC_RESUME_LAST_US,         /*gauge: time from wifi_c_resume() call to IP of last resume*/
+    WIFI_C_METRIC_AP_JOINS,               /*stations connected to AP*/
+    WIFI_C_METRIC_AP_LEAVES,              /*stations disconnected from AP*/
+    WIFI_C_METRIC_AP_CLIENTS,             /*gauge: stations currently connected to AP*/
+    WIFI_C_METRIC_COUNT
+} wifi_c_metric_id_t;
+
+/**
+ * @brief Copy of all metrics taken at one moment.
+ *
+ */
+struct wifi_c_metrics_obj {
+    uint32_t value[WIFI_C_METRIC_COUNT];                      /**< counters and gauges, index is wifi_c_metric_id_t */
+    uint32_t disconnect_reasons[WIFI_C_METRICS_REASON_SLOTS]; /**< disconnects per reason bucket */
+};
+
+/**
+ * @brief Type of metrics snapshot.
+ *
+ */
+typedef struct wifi_c_metrics_obj wifi_c_metrics_t;
+
+/**
+ * @brief Increment counter, lock-free, safe from any task.
+ *
+ */
+void wifi_c_metrics_inc(wifi_c_metric_id_t id);
+
+/**
+ * @brief Count STA disconnect with its reason.
+ *
+ */
+void wifi_c_metrics_disconnect(uint8_t reason);
+
+/**
+ * @brief Count connect attempt, first one starts measurement of time to IP.
+ *
+ * @note Retries don't restart measurement.
+ */
+void wifi_c_metrics_connect_attempt(void);
+
+/**
+ * @brief Count connecting given up after all retries.
+ *
+ */
+void wifi_c_metrics_connect_failed(void);
+
+/**
+ * @brief Count successful connection and time since connecting started.
+ *
+ */
+void wifi_c_metrics_got_ip(void);
+
+/**
+ * @brief Count roam to other BSSID, with time from leaving old AP to IP if it succeeded.
+ *
+ */
+void wifi_c_metrics_roam_done(bool success, uint32_t duration_us);
+
+/**
+ * @brief Count STA reconnected after resume, with time from wifi_c_resume() call to IP.
+ *
+ */
+void wifi_c_metrics_resume_done(uint32_t duration_us);
+
+/**
+ * @brief Count finished scan and its duration.
+ *
+ */
+void wifi_c_metrics_scan_done(uint32_t duration_us);
+
+/**
+ * @brief Count finished sliced scan, its duration and longest slice.
+ *
+ */
+void wifi_c_metrics_scan_sliced_done(uint32_t duration_us, uint16_t slices, uint32_t max_off_channel_us);
+
+/**
+ * @brief Count station joining (true) or leaving (false) AP.
+ *
+ */
+void wifi_c_metrics_ap_station(bool joined);
+
+/**
+ * @brief Get reason code of disconnect reason bucket.
+ *
+ * @return Reason code, 0xFFFF for bucket of all other reasons.
+ */
+uint16_t wifi_c_metrics_reason_of_slot(uint8_t slot);
+
+/**
+ * @brief Copy all metrics.
+ *
+ * @note Every value is read atomically, but values can be updated between reads.
+ */
+void wifi_c_metrics_get(wifi_c_metrics_t *metrics);
+
+/**
+ * @brief Set all counters and gauges to zero.
+ *
+ */
+void wifi_c_metrics_reset(void);
+
+/**
+ * @brief Store metrics in Prometheus text exposition format.
+ *
+ * @note Disconnect reasons which never happened are skipped.
+ *
+ * @param buffer Buffer to store text.
+ * @param buflen Length of the buffer.
+ *
+ * @return Number of characters that would be written, like snprintf.
+ */
+int wifi_c_metrics_store_as_prometheus(char *buffer, size_t buflen);
+
+/**
+ * @brief Stream metrics in Prometheus text exposition format, chunk by chunk.
+ *
+ * @param sink  Receiver of chunks.
+ * @param arg   Argument passed to sink.
+ *
+ * @retval ERR_C_OK on success
+ * @retval ERR_NULL_POINTER if sink is NULL
+ * @retval error returned by sink
+ */
+int wifi_c_metrics_stream_prometheus(wifi_c_stream_sink_t sink, void *arg);
+
+#if WIFI_C_JSON_ENABLED
+/**
+ * @brief Store metrics as compact JSON object.
+ *
+ * @param buffer Buffer to store JSON.
+ * @param buflen Length of the buffer.
+ *
+ * @return Number of characters that would be written, like snprintf.
+ */
+int wifi_c_metrics_store_as_json(char *buffer, size_t buflen);
+#endif
@@ -0,0 +1,96 @@
+/**
+ * @file wifi_c_psk.h
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief Cache of WPA2 pre-shared keys derived from passphrases header file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "wifi_controller.h"
+
+#define WIFI_C_PSK_LEN                  32                          ///< Length of PSK in bytes.
+#define WIFI_C_PSK_HEX_LEN              (WIFI_C_PSK_LEN * 2)        ///< Length of PSK as hex digits, driver treats password of this length as PSK.
+#define WIFI_C_PSK_ITERATIONS           4096                        ///< PBKDF2-SHA1 iterations defined by IEEE 802.11i.
+
+/**
+ * @brief PSK cache statistics since boot.
+ *
+ */
+struct wifi_c_psk_stats_obj {
+    uint32_t hits;                        /**< Connects which used cached PSK. */
+    uint32_t misses;                      /**< PSKs derived, SSID or passphrase was not cached or changed. */
+    uint32_t invalidated;                 /**< Entries dropped because connect with them failed or they were forgotten. */
+    uint32_t last_derive_us;              /**< CPU time of last derivation. */
+    uint64_t derive_us;                   /**< Total CPU time spent deriving PSKs. */
+};
+
+/**
+ * @brief Type of PSK cache statistics.
+ *
+ */
+typedef struct wifi_c_psk_stats_obj wifi_c_psk_stats_t;
+
+/**
+ * @brief Derive PSK from SSID and passphrase with PBKDF2-HMAC-SHA1, takes hundreds of ms on ESP32.
+ *
+ * @param ssid          SSID, salt of derivation.
+ * @param passphrase    Passphrase, 8-63 characters.
+ * @param psk           Buffer to store WIFI_C_PSK_LEN bytes.
+ *
+ * @retval ERR_C_OK on success
+ * @retval ERR_C_INVALID_ARGS if passphrase length is out of range
+ * @retval ERR_C_MEMORY_ERR if hash context could not be set up
+ */
+int wifi_c_psk_derive(const char *ssid, const char *passphrase, uint8_t psk[WIFI_C_PSK_LEN]);
+
+#if WIFI_C_PSK_CACHE_ENABLED
+/**
+ * @brief Get PSK of SSID and passphrase as hex digits, derive and store it when not cached.
+ *
+ * @note Entries are matched by SSID and SHA-256 fingerprint of passphrase, so changed passphrase
+ * replaces old entry. Passphrase itself is never stored.
+ * @note Entries are kept in RTC memory (deep sleep) and, with CONFIG_WIFI_C_PSK_CACHE_NVS, in NVS (reset and power loss).
+ * NVS copy is written only when NVS is encrypted.
+ *
+ * @param ssid          SSID.
+ * @param passphrase    Passphrase, 8-63 characters.
+ * @param psk_hex       Buffer to store WIFI_C_PSK_HEX_LEN hex digits, not terminated, same size as wifi_sta_config_t password.
+ *
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_PSK_PASSPHRASE_ONLY if connect with PSK of SSID and passphrase failed, see wifi_c_psk_use_passphrase()
+ * @retval same errors as wifi_c_psk_derive()
+ */
+int wifi_c_psk_get(const char *ssid, const char *passphrase, uint8_t psk_hex[WIFI_C_PSK_HEX_LEN]);
+
+/**
+ * @brief Drop cached PSK of SSID, e.g. after connect with it failed.
+ *
+ */
+void wifi_c_psk_forget(const char *ssid);
+
+/**
+ * @brief Drop cached PSK of SSID and connect with passphrase from now on, e.g. WPA3-only AP rejected PSK.
+ *
+ * @note wifi_c_psk_get() returns WIFI_C_ERR_PSK_PASSPHRASE_ONLY for the same passphrase, changed passphrase
+ * gets PSK derived again.
+ */
+void wifi_c_psk_use_passphrase(const char *ssid);
+
+/**
+ * @brief Drop all cached PSKs.
+ *
+ */
+void wifi_c_psk_clear(void);
+
+/**
+ * @brief Copy PSK cache statistics.
+ *
+ */
+void wifi_c_psk_get_stats(wifi_c_psk_stats_t *stats);
+#endif
@@ -0,0 +1,195 @@
+/**
+ * @file wifi_c_roam.h
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief BSSID selection and roaming within one SSID header file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_wifi.h"
+#include "wifi_c_channel.h"
+
+#define WIFI_C_ROAM_SCAN_RECORDS        16                          ///< Number of strongest APs kept from one candidate scan.
+#define WIFI_C_ROAM_TIMEOUT_MS          10000                       ///< Time from leaving old AP to IP on new one, after which roam counts as failed.
+#define WIFI_C_ROAM_NEIGHBOR_WAIT_MS    300                         ///< Time to wait for 802.11k neighbor report before candidate scan.
+
+/**
+ * @brief Load on BSSID channel which costs one load_penalty_db, same as one other AP on that channel at -50 dBm.
+ *
+ * @note Unit of wifi_c_channel_scores_t score.
+ */
+#define WIFI_C_BSSID_LOAD_UNIT          (WIFI_C_CHANNEL_OVERLAP * 50)
+
+/**
+ * @brief Criteria of choosing one BSSID of SSID served by many APs.
+ *
+ * @note Score of BSSID is its RSSI, lowered by load_penalty_db for every WIFI_C_BSSID_LOAD_UNIT
+ * of congestion caused by other APs on its channel and overlapping ones.
+ */
+struct wifi_c_bssid_select_config_obj {
+    int8_t min_rssi;                      /**< Weakest accepted BSSID, WIFI_C_SCAN_FILTER_ANY_RSSI for any. */
+    uint8_t load_penalty_db;              /**< dB taken from score per unit of channel load, 0 to select by RSSI only. */
+    uint16_t channel_mask;                /**< Allowed channels, bit per channel, 0 for all. */
+};
+
+/**
+ * @brief Type of BSSID selection criteria.
+ *
+ */
+typedef struct wifi_c_bssid_select_config_obj wifi_c_bssid_select_config_t;
+
+#define WIFI_C_BSSID_SELECT_CONFIG_DEFAULT() {  \
+    .min_rssi = INT8_MIN,                       \
+    .load_penalty_db = 0,                       \
+    .channel_mask = 0,                          \
+}
+
+/**
+ * @brief Settings of roaming while connected.
+ *
+ * @note Roam scan looks only on channels where SSID was seen before (BSSID history, earlier roam scans,
+ * 802.11k neighbor reports) and current channel, all channels are scanned only when nothing is known yet.
+ */
+struct wifi_c_roam_config_obj {
+    wifi_c_bssid_select_config_t select;  /**< Criteria of roam candidates. */
+    int8_t rssi_threshold;                /**< Candidates are searched when RSSI of current AP is lower. */
+    uint8_t hysteresis_db;                /**< Candidate score must be higher than score of current AP by this much. */
+    uint32_t check_period_ms;             /**< Time between RSSI checks. */
+    uint32_t scan_backoff_ms;             /**< Shortest time between candidate scans, connection suffers from every scan. */
+    bool assist_11kv;                     /**< Ask AP for neighbor report (802.11k) and accept its BSS transition requests (802.11v). */
+    uint8_t priority;                     /**< Priority of roam task. */
+    uint32_t stack_size;                  /**< Stack size of roam task in bytes, holds WIFI_C_ROAM_SCAN_RECORDS records. */
+};
+
+/**
+ * @brief Type of roaming settings.
+ *
+ */
+typedef struct wifi_c_roam_config_obj wifi_c_roam_config_t;
+
+#define WIFI_C_ROAM_CONFIG_DEFAULT() {                      \
+    .select = WIFI_C_BSSID_SELECT_CONFIG_DEFAULT(),         \
+    .rssi_threshold = -70,                                  \
+    .hysteresis_db = 8,                                     \
+    .check_period_ms = 2000,                                \
+    .scan_backoff_ms = 30000,                               \
+    .assist_11kv = true,                                    \
+    .priority = 1,                                          \
+    .stack_size = 6144,                                     \
+}
+
+/**
+ * @brief Roaming statistics since wifi_c_roam_start().
+ *
+ */
+struct wifi_c_roam_stats_obj {
+    uint32_t scans;                       /**< Candidate scans. */
+    uint32_t roams;                       /**< Roams which got IP on new AP. */
+    uint32_t failures;                    /**< Roams which didn't get IP before WIFI_C_ROAM_TIMEOUT_MS. */
+    uint32_t neighbor_reports;            /**< 802.11k neighbor reports received. */
+    uint32_t last_link_ms;                /**< Last roam, time from leaving old AP to association with new one. */
+    uint32_t last_ip_ms;                  /**< Last roam, time from leaving old AP to IP. */
+    uint32_t max_ip_ms;                   /**< Slowest roam, time from leaving old AP to IP. */
+    uint16_t channel_mask;                /**< Channels where SSID is known to be served. */
+};
+
+/**
+ * @brief Type of roaming statistics.
+ *
+ */
+typedef struct wifi_c_roam_stats_obj wifi_c_roam_stats_t;
+
+/**
+ * @brief Score BSSID, higher is better.
+ *
+ * @param config    Selection criteria, NULL for WIFI_C_BSSID_SELECT_CONFIG_DEFAULT().
+ * @param scores    Channel congestion measured by same scan including BSSID itself, NULL to ignore load.
+ * @param record    Scanned BSSID.
+ *
+ * @return Score in dB, RSSI when load is ignored.
+ */
+int wifi_c_bssid_score(const wifi_c_bssid_select_config_t *config, const wifi_c_channel_scores_t *scores,
+                       const wifi_ap_record_t *record);
+
+/**
+ * @brief Find BSSID of SSID with highest score.
+ *
+ * @param config    Selection criteria, NULL for WIFI_C_BSSID_SELECT_CONFIG_DEFAULT().
+ * @param scores    Channel congestion measured by same scan, NULL to ignore load.
+ * @param ssid      SSID, compared exactly.
+ * @param records   Scanned APs, may contain other SSIDs.
+ * @param count     Number of records.
+ *
+ * @return Best record, NULL if no BSSID of SSID matches criteria.
+ */
+const wifi_ap_record_t *wifi_c_bssid_pick_best(const wifi_c_bssid_select_config_t *config, const wifi_c_channel_scores_t *scores,
+                                               const char *ssid, const wifi_ap_record_t *records, uint16_t count);
+
+/**
+ * @brief Scan for all BSSIDs of SSID, connect to best one and lock STA to it.
+ *
+ * @note Initializes WiFi in STA mode when needed, same as wifi_c_start_sta(). Driver doesn't search
+ * for other BSSIDs on reconnect, roaming is done by wifi_c_roam_start() or by AP (802.11v).
+ *
+ * @param ssid      SSID to connect to.
+ * @param password  Password, NULL or empty for open network.
+ * @param config    Selection criteria, NULL for WIFI_C_BSSID_SELECT_CONFIG_DEFAULT().
+ * @param selected  Pointer to store selected BSSID, can be NULL.
+ *
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_AP_NOT_FOUND if no BSSID of SSID matches criteria
+ * @retval same errors as wifi_c_start_sta() and wifi_c_scan_filtered()
+ */
+int wifi_c_start_sta_best_bssid(const char *ssid, const char *password, const wifi_c_bssid_select_config_t *config,
+                                wifi_ap_record_t *selected);
+
+/**
+ * @brief Move connected STA to other BSSID of the same SSID.
+ *
+ * @note Returns after STA left current AP, wait for WIFI_C_STATE_STA_GOT_IP to know when roam is done.
+ *
+ * @param bssid     BSSID to roam to.
+ * @param channel   Channel of BSSID, 0 if not known.
+ *
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_STA_NOT_CONNECTED if STA is not connected
+ * @retval esp specific error codes
+ */
+int wifi_c_sta_roam_to(const uint8_t bssid[6], uint8_t channel);
+
+/**
+ * @brief Announce 802.11k radio measurement and 802.11v BSS transition support on following associations.
+ *
+ * @note Driver handles BSS transition requests itself when CONFIG_WPA_11KV_SUPPORT is enabled.
+ */
+void wifi_c_sta_set_11kv(bool enable);
+
+/**
+ * @brief Start task checking RSSI of current AP and roaming to better BSSID of the same SSID.
+ *
+ * @param config Roaming settings, NULL for WIFI_C_ROAM_CONFIG_DEFAULT().
+ *
+ * @retval ERR_C_OK on success
+ * @retval ERR_C_INVALID_ARGS if check period is zero
+ * @retval WIFI_C_ERR_ROAM_STARTED if roaming is already running
+ * @retval ERR_C_MEMORY_ERR if task could not be created
+ */
+int wifi_c_roam_start(const wifi_c_roam_config_t *config);
+
+/**
+ * @brief Stop roam task, waits for roam in progress to finish.
+ *
+ */
+void wifi_c_roam_stop(void);
+
+/**
+ * @brief Copy roaming statistics.
+ *
+ */
+void wifi_c_roam_get_stats(wifi_c_roam_stats_t *stats);
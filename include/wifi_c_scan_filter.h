@@ -0,0 +1,132 @@
+/**
+ * @file wifi_c_scan_filter.h
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief Streaming scan filter and top-K selection header file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_wifi.h"
+
+#define WIFI_C_SCAN_FILTER_ANY_RSSI     INT8_MIN                    ///< Don't filter APs by signal strength.
+#define WIFI_C_SCAN_FILTER_ANY_CHANNEL  0                           ///< Don't filter APs by channel.
+#define WIFI_C_SCAN_FILTER_ANY_AUTH     0                           ///< Don't filter APs by auth mode.
+
+/**
+ * @brief Bit of auth mode in wifi_c_scan_filter_t.authmode_mask.
+ *
+ */
+#define WIFI_C_SCAN_FILTER_AUTH_BIT(authmode)   (1UL << (authmode))
+
+/**
+ * @brief Bit of channel in wifi_c_scan_filter_t.channel_mask, channels 1-14.
+ *
+ */
+#define WIFI_C_SCAN_FILTER_CHANNEL_BIT(channel) (1U << (channel))
+
+/**
+ * @brief Filter applied to every scanned AP before it's stored.
+ *
+ */
+struct wifi_c_scan_filter_obj {
+    uint32_t authmode_mask;               /**< Allowed auth modes, WIFI_C_SCAN_FILTER_AUTH_BIT() of each, or WIFI_C_SCAN_FILTER_ANY_AUTH. */
+    int8_t min_rssi;                      /**< Weakest accepted signal strength, or WIFI_C_SCAN_FILTER_ANY_RSSI. */
+    uint16_t channel_mask;                /**< Allowed channels, WIFI_C_SCAN_FILTER_CHANNEL_BIT() of each, or WIFI_C_SCAN_FILTER_ANY_CHANNEL. */
+    const char *ssid_pattern;             /**< SSID pattern, '*' matches any string and '?' any character, NULL for any SSID. */
+    bool dedup_ssid;                      /**< Keep only strongest AP of every SSID. */
+};
+
+/**
+ * @brief Type of scan filter.
+ *
+ */
+typedef struct wifi_c_scan_filter_obj wifi_c_scan_filter_t;
+
+#define WIFI_C_SCAN_FILTER_DEFAULT() {                  \
+    .authmode_mask = WIFI_C_SCAN_FILTER_ANY_AUTH,       \
+    .min_rssi = WIFI_C_SCAN_FILTER_ANY_RSSI,            \
+    .channel_mask = WIFI_C_SCAN_FILTER_ANY_CHANNEL,     \
+    .ssid_pattern = NULL,                               \
+    .dedup_ssid = false,                                \
+}
+
+/**
+ * @brief Top-K selection of scanned APs, records are kept sorted from strongest to weakest.
+ *
+ * @note Uses only memory passed by caller, so its size doesn't depend on number of APs around.
+ */
+struct wifi_c_scan_top_obj {
+    const wifi_c_scan_filter_t *filter;   /**< Filter applied to pushed records, NULL to accept all. */
+    wifi_ap_record_t *records;            /**< Buffer of K records provided by caller. */
+    uint16_t capacity;                    /**< K, number of records in buffer. */
+    uint16_t count;                       /**< Number of records currently kept. */
+    uint16_t seen;                        /**< Number of records pushed. */
+    uint16_t rejected;                    /**< Number of records not matching filter. */
+};
+
+/**
+ * @brief Type of top-K selection.
+ *
+ */
+typedef struct wifi_c_scan_top_obj wifi_c_scan_top_t;
+
+/**
+ * @brief Check if scanned AP matches filter.
+ *
+ * @param filter Filter to check, NULL matches everything.
+ * @param record Scanned AP.
+ *
+ * @retval true if AP matches all criteria
+ */
+bool wifi_c_scan_filter_match(const wifi_c_scan_filter_t *filter, const wifi_ap_record_t *record);
+
+/**
+ * @brief Check if SSID matches pattern with '*' and '?' wildcards.
+ *
+ */
+bool wifi_c_scan_filter_match_ssid(const char *pattern, const char *ssid);
+
+/**
+ * @brief Prepare top-K selection.
+ *
+ * @param top       Selection to prepare.
+ * @param filter    Filter applied to records, must be valid as long as selection is used.
+ * @param records   Buffer for K records.
+ * @param capacity  K, number of records in buffer.
+ */
+void wifi_c_scan_top_init(wifi_c_scan_top_t *top, const wifi_c_scan_filter_t *filter,
+                          wifi_ap_record_t *records, uint16_t capacity);
+
+/**
+ * @brief Pass one scanned AP through filter and keep it if it's among K strongest.
+ *
+ * @retval true if record was stored
+ * @retval false if record was filtered out, weaker than stored ones or duplicate of stronger SSID
+ */
+bool wifi_c_scan_top_push(wifi_c_scan_top_t *top, const wifi_ap_record_t *record);
+
+/**
+ * @brief Scan and pull results one by one through filter, keeping only K strongest.
+ *
+ * @note On ESP-IDF 5.1 and newer records are taken from driver one at a time, so no memory
+ * proportional to number of APs around is needed. On older versions all records are fetched at once.
+ * @note Single channel or SSID without wildcards in filter are also passed to driver, to shorten the scan.
+ *
+ * @param filter    Filter of scanned APs, NULL to keep all.
+ * @param records   Buffer to store matching APs, sorted from strongest to weakest.
+ * @param count     In: number of records in buffer (K), out: number of stored records.
+ *
+ * @retval ERR_C_OK on success
+ * @retval ERR_C_INVALID_ARGS if buffer size is zero
+ * @retval WIFI_C_ERR_WIFI_NOT_INIT Wifi was not initialized
+ * @retval WIFI_C_ERR_WRONG_MODE Wrong Wifi mode, scanning only possible in STA/APSTA mode.
+ * @retval WIFI_C_ERR_STA_NOT_STARTED STA was not started
+ * @retval esp specific error codes
+ */
+int wifi_c_scan_filtered(const wifi_c_scan_filter_t *filter, wifi_ap_record_t *records, uint16_t *count);
@@ -0,0 +1,96 @@
+/**
+ * @file wifi_c_scan_slice.h
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief Sliced scanning while connected header file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_wifi.h"
+#include "wifi_c_scan_filter.h"
+#include "wifi_c_channel.h"
+
+#define WIFI_C_SCAN_SLICE_MIN_CHANNEL_MS    10                      ///< Shortest scan time on one channel, shorter one misses most beacons and probe responses.
+
+/**
+ * @brief Settings of sliced scan.
+ *
+ * @note Sweep is split into slices of few channels, between slices radio returns to home channel
+ * for home_dwell_ms, so traffic of connected STA is delayed by one slice at most, instead of whole sweep.
+ */
+struct wifi_c_scan_slice_config_obj {
+    uint16_t channel_mask;                /**< Channels to sweep, WIFI_C_SCAN_FILTER_CHANNEL_BIT() of each, 0 for all channels allowed in country. */
+    uint8_t channels_per_slice;           /**< Channels scanned back to back before returning to home channel, at least 1. */
+    uint16_t channel_time_ms;             /**< Active scan time on every channel. */
+    uint16_t home_dwell_ms;               /**< Time spent on home channel between slices. */
+    uint16_t max_off_channel_ms;          /**< Cap of planned time away from home channel in one slice, shortens channel_time_ms if needed. */
+    bool show_hidden;                     /**< Report APs with hidden SSID. */
+    wifi_c_channel_scores_t *scores;      /**< Congestion of every scanned AP, also filtered out ones, is added to these, NULL to skip. */
+};
+
+/**
+ * @brief Type of sliced scan settings.
+ *
+ */
+typedef struct wifi_c_scan_slice_config_obj wifi_c_scan_slice_config_t;
+
+#define WIFI_C_SCAN_SLICE_CONFIG_DEFAULT() {    \
+    .channel_mask = 0,                          \
+    .channels_per_slice = 1,                    \
+    .channel_time_ms = 40,                      \
+    .home_dwell_ms = 200,                       \
+    .max_off_channel_ms = 60,                   \
+    .show_hidden = false,                       \
+    .scores = NULL,                             \
+}
+
+/**
+ * @brief Measured cost of one scan, time away from home channel is time without throughput.
+ *
+ */
+struct wifi_c_scan_slice_report_obj {
+    uint16_t slices;                      /**< Number of slices. */
+    uint16_t channels;                    /**< Number of scanned channels. */
+    uint16_t channel_time_ms;             /**< Scan time on every channel after applying cap. */
+    uint32_t duration_us;                 /**< Whole sweep, including time on home channel between slices. */
+    uint32_t off_channel_us;              /**< Sum of time away from home channel. */
+    uint32_t max_off_channel_us;          /**< Longest continuous time away from home channel, longest slice. */
+};
+
+/**
+ * @brief Type of sliced scan report.
+ *
+ */
+typedef struct wifi_c_scan_slice_report_obj wifi_c_scan_slice_report_t;
+
+/**
+ * @brief Scan channel slices with returns to home channel between them, results of all slices go through one top-K selection.
+ *
+ * @note Meant for connected STA, when not connected it works the same, only takes longer than wifi_c_scan_filtered().
+ * @note Scores in config are not cleared before the scan. When they are given, SSID of filter is matched only
+ * after the scan, driver reports APs of all SSIDs.
+ * @note Same as for wifi_c_scan_all_ap(), whole sweep is one off-channel stretch. Its length is in metrics
+ * (WIFI_C_METRIC_SCAN_OFF_CHANNEL_LAST_US), so impact of both modes can be compared.
+ *
+ * @param config    Slice settings, NULL for WIFI_C_SCAN_SLICE_CONFIG_DEFAULT().
+ * @param filter    Filter of scanned APs, NULL to keep all. Its channel mask narrows config channel mask.
+ * @param records   Buffer to store matching APs, sorted from strongest to weakest.
+ * @param count     In: number of records in buffer (K), out: number of stored records.
+ * @param report    Pointer to store measured cost of the scan, can be NULL.
+ *
+ * @retval ERR_C_OK on success
+ * @retval ERR_C_INVALID_ARGS if buffer size or channels per slice is zero, or cap leaves less than
+ * WIFI_C_SCAN_SLICE_MIN_CHANNEL_MS per channel
+ * @retval WIFI_C_ERR_WIFI_NOT_INIT Wifi was not initialized
+ * @retval WIFI_C_ERR_WRONG_MODE Wrong Wifi mode, scanning only possible in STA/APSTA mode.
+ * @retval WIFI_C_ERR_STA_NOT_STARTED STA was not started
+ * @retval esp specific error codes
+ */
+int wifi_c_scan_sliced(const wifi_c_scan_slice_config_t *config, const wifi_c_scan_filter_t *filter,
+                       wifi_ap_record_t *records, uint16_t *count, wifi_c_scan_slice_report_t *report);
@@ -0,0 +1,124 @@
+/**
+ * @file wifi_c_span.h
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief Timing spans of controller operations header file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include "wifi_controller.h"
+#include "wifi_c_stream.h"
+
+#define WIFI_C_SPAN_TASKS               16                          ///< Number of tasks which get own track in exported trace, others share one.
+
+/**
+ * @brief Operations measured by spans.
+ *
+ */
+typedef enum {
+    /*Public API, functions without context argument.*/
+    WIFI_C_SPAN_INIT_WIFI = 0,
+    WIFI_C_SPAN_START_AP,
+    WIFI_C_SPAN_START_STA,
+    WIFI_C_SPAN_START_STA_BEST_BSSID,
+    WIFI_C_SPAN_DISCONNECT,
+    WIFI_C_SPAN_SCAN_ALL_AP,
+    WIFI_C_SPAN_SCAN_FILTERED,
+    WIFI_C_SPAN_SCAN_SLICED,
+    WIFI_C_SPAN_MEASURE_CHANNELS,
+    WIFI_C_SPAN_START_AP_AUTO_CHANNEL,
+    WIFI_C_SPAN_ROAM_TO,
+    WIFI_C_SPAN_SUSPEND,
+    WIFI_C_SPAN_RESUME,
+    WIFI_C_SPAN_CHANGE_MODE,
+    WIFI_C_SPAN_DEINIT,
+    /*Steps inside API calls.*/
+    WIFI_C_SPAN_NETIF_INIT,               /*netif creation*/
+    WIFI_C_SPAN_DRIVER_INIT,              /*esp_wifi_init()*/
+    WIFI_C_SPAN_DRIVER_START,             /*esp_wifi_start()*/
+    WIFI_C_SPAN_DRIVER_SCAN,              /*esp_wifi_scan_start() until scan done*/
+    /*Handlers, arg is event id.*/
+    WIFI_C_SPAN_WIFI_EVENT,
+    WIFI_C_SPAN_IP_EVENT,
+    WIFI_C_SPAN_CALLBACK,                 /*connect handler of application*/
+    /*Async spans, begin and end happen in different tasks.*/
+    WIFI_C_SPAN_CONNECT,                  /*esp_wifi_connect() until association or disconnect*/
+    WIFI_C_SPAN_DHCP,                     /*association until IP or disconnect*/
+    WIFI_C_SPAN_COUNT
+} wifi_c_span_id_t;
+
+/**
+ * @brief Phases of span, values are Chrome trace_event phases.
+ *
+ */
+typedef enum {
+    WIFI_C_SPAN_PHASE_BEGIN = 'B',
+    WIFI_C_SPAN_PHASE_END = 'E',
+    WIFI_C_SPAN_PHASE_ASYNC_BEGIN = 'b',
+    WIFI_C_SPAN_PHASE_ASYNC_END = 'e',
+} wifi_c_span_phase_t;
+
+#if WIFI_C_SPAN_TRACE_ENABLED
+/**
+ * @brief Store span point with current time, task and core, safe from any task.
+ *
+ * @note Recording stops when buffer is full, so the first CONFIG_WIFI_C_SPAN_TRACE_RECORDS points after boot
+ * or wifi_c_span_clear() are kept.
+ *
+ * @param id    Operation.
+ * @param phase Begin or end.
+ * @param arg   Event id of WIFI_C_SPAN_WIFI_EVENT and WIFI_C_SPAN_IP_EVENT, 0 otherwise.
+ */
+void wifi_c_span_record(wifi_c_span_id_t id, wifi_c_span_phase_t phase, uint16_t arg);
+
+/**
+ * @brief End span and pass result through, used by WIFI_C_SPAN_CALL().
+ *
+ */
+int wifi_c_span_end_result(wifi_c_span_id_t id, int result);
+
+/**
+ * @brief Stream recorded spans as Chrome trace_event JSON, chunk by chunk.
+ *
+ * @note Load output in Perfetto UI or chrome://tracing. Every task has own track, core is in event args.
+ * @note Spans recorded during export are included only if they were stored before export reached them.
+ *
+ * @param sink  Receiver of chunks, e.g. HTTP response or file.
+ * @param arg   Argument passed to sink.
+ *
+ * @retval ERR_C_OK on success
+ * @retval ERR_NULL_POINTER if sink is NULL
+ * @retval error returned by sink
+ */
+int wifi_c_span_export_chrome(wifi_c_stream_sink_t sink, void *arg);
+
+/**
+ * @brief Drop all recorded spans and start recording again.
+ *
+ * @note Must not be called during wifi_c_span_export_chrome().
+ */
+void wifi_c_span_clear(void);
+
+#define WIFI_C_SPAN_BEGIN(id)                   wifi_c_span_record((id), WIFI_C_SPAN_PHASE_BEGIN, 0)
+#define WIFI_C_SPAN_END(id)                     wifi_c_span_record((id), WIFI_C_SPAN_PHASE_END, 0)
+#define WIFI_C_SPAN_EVENT_BEGIN(id, event_id)   wifi_c_span_record((id), WIFI_C_SPAN_PHASE_BEGIN, (uint16_t)(event_id))
+#define WIFI_C_SPAN_EVENT_END(id, event_id)     wifi_c_span_record((id), WIFI_C_SPAN_PHASE_END, (uint16_t)(event_id))
+#define WIFI_C_SPAN_ASYNC_BEGIN(id)             wifi_c_span_record((id), WIFI_C_SPAN_PHASE_ASYNC_BEGIN, 0)
+#define WIFI_C_SPAN_ASYNC_END(id)               wifi_c_span_record((id), WIFI_C_SPAN_PHASE_ASYNC_END, 0)
+/*Evaluates to result of call, which runs inside span.*/
+#define WIFI_C_SPAN_CALL(id, call)              wifi_c_span_end_result((id), (WIFI_C_SPAN_BEGIN(id), (call)))
+#else
+/*Span tracing is compiled out, calls are left as they are.*/
+#define WIFI_C_SPAN_BEGIN(id)                   ((void)0)
+#define WIFI_C_SPAN_END(id)                     ((void)0)
+#define WIFI_C_SPAN_EVENT_BEGIN(id, event_id)   ((void)0)
+#define WIFI_C_SPAN_EVENT_END(id, event_id)     ((void)0)
+#define WIFI_C_SPAN_ASYNC_BEGIN(id)             ((void)0)
+#define WIFI_C_SPAN_ASYNC_END(id)               ((void)0)
+#define WIFI_C_SPAN_CALL(id, call)              (call)
+#endif
@@ -0,0 +1,74 @@
+/**
+ * @file wifi_c_stream.h
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief Chunked output of formatted text header file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+
+#include <stddef.h>
+
+#define WIFI_C_STREAM_CHUNK_SIZE        256                         ///< Bytes collected before they are passed to sink, size of one HTTP chunk.
+
+/**
+ * @brief Receives streamed output piece by piece, e.g. to send it as HTTP chunk.
+ *
+ * @return 0 to continue, any other value stops streaming and is returned by wifi_c_stream_finish().
+ */
+typedef int (*wifi_c_stream_sink_t)(const char *data, size_t len, void *arg);
+
+/**
+ * @brief Output collected in small buffer, so whole text never has to be in memory at once.
+ *
+ */
+struct wifi_c_stream_obj {
+    wifi_c_stream_sink_t sink;            /**< Receiver of full chunks. */
+    void *arg;                            /**< Argument passed to sink. */
+    size_t len;                           /**< Bytes waiting in buffer. */
+    int err;                              /**< First error returned by sink, output is dropped after it. */
+    char buffer[WIFI_C_STREAM_CHUNK_SIZE];
+};
+
+/**
+ * @brief Type of chunked output.
+ *
+ */
+typedef struct wifi_c_stream_obj wifi_c_stream_t;
+
+/**
+ * @brief Prepare stream passing chunks to sink.
+ *
+ */
+void wifi_c_stream_init(wifi_c_stream_t *stream, wifi_c_stream_sink_t sink, void *arg);
+
+/**
+ * @brief Append bytes, full chunks are passed to sink.
+ *
+ */
+void wifi_c_stream_write(wifi_c_stream_t *stream, const char *data, size_t len);
+
+/**
+ * @brief Append formatted text, output of one call is cut at WIFI_C_STREAM_CHUNK_SIZE - 1 characters.
+ *
+ */
+void wifi_c_stream_printf(wifi_c_stream_t *stream, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief Append string as quoted JSON string, escaping characters JSON doesn't allow.
+ *
+ * @param stream    Stream to append to.
+ * @param str       String, doesn't have to be null terminated within maxlen, e.g. SSID.
+ * @param maxlen    Maximum number of characters to read.
+ */
+void wifi_c_stream_json_string(wifi_c_stream_t *stream, const char *str, size_t maxlen);
+
+/**
+ * @brief Pass remaining bytes to sink.
+ *
+ * @return 0 on success, or first error returned by sink.
+ */
+int wifi_c_stream_finish(wifi_c_stream_t *stream);
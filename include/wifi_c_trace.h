@@ -0,0 +1,190 @@
+/**
+ * @file wifi_c_trace.h
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief Wifi and IP event trace recorder header file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define WIFI_C_TRACE_MAGIC              0x52544357                  ///< "WCTR", first bytes of dumped trace.
+#define WIFI_C_TRACE_VERSION            1                           ///< Version of binary trace format.
+#define WIFI_C_TRACE_MAX_PAYLOAD        64                          ///< Maximum number of payload bytes in one record.
+
+/**
+ * @brief Event bases stored in trace.
+ *
+ */
+typedef enum {
+    WIFI_C_TRACE_BASE_WIFI = 0,           /*WIFI_EVENT*/
+    WIFI_C_TRACE_BASE_IP,                 /*IP_EVENT*/
+} wifi_c_trace_base_t;
+
+/**
+ * @brief Header of dumped trace, 12 bytes, little endian.
+ *
+ */
+struct wifi_c_trace_header_obj {
+    uint32_t magic;                       /**< WIFI_C_TRACE_MAGIC */
+    uint8_t version;                      /**< WIFI_C_TRACE_VERSION */
+    uint8_t reserved[3];
+    uint32_t dropped;                     /**< records overwritten before dump because buffer was full */
+};
+
+/**
+ * @brief Type of dumped trace header.
+ *
+ */
+typedef struct wifi_c_trace_header_obj wifi_c_trace_header_t;
+
+/**
+ * @brief Header of every record, 8 bytes, followed by payload.
+ *
+ * @note Payload is event data struct as seen by handler, except IP_EVENT_STA_GOT_IP (ip_info, ip_changed)
+ * and IP_EVENT_AP_STAIPASSIGNED (ip, mac), whose netif pointers are left out.
+ */
+struct wifi_c_trace_record_obj {
+    uint32_t delta_us;                    /**< time since previous record, 0 for first one */
+    uint8_t base;                         /**< one of wifi_c_trace_base_t */
+    uint8_t id;                           /**< event id within base */
+    uint8_t len;                          /**< number of payload bytes */
+    uint8_t reserved;
+};
+
+/**
+ * @brief Type of trace record header.
+ *
+ */
+typedef struct wifi_c_trace_record_obj wifi_c_trace_record_t;
+
+/**
+ * @brief Event read from trace.
+ *
+ */
+struct wifi_c_trace_event_obj {
+    wifi_c_trace_record_t record;         /**< record header */
+    const uint8_t *payload;               /**< record.len bytes of payload, points into trace */
+};
+
+/**
+ * @brief Type of event read from trace.
+ *
+ */
+typedef struct wifi_c_trace_event_obj wifi_c_trace_event_t;
+
+/**
+ * @brief Replay speed - see wifi_c_trace_replay().
+ *
+ */
+typedef enum {
+    WIFI_C_TRACE_REPLAY_FULL_SPEED = 0,   /*events are passed to handlers one after another*/
+    WIFI_C_TRACE_REPLAY_REAL_TIME,        /*time between events is kept as recorded*/
+} wifi_c_trace_speed_t;
+
+/**
+ * @brief Result of trace replay.
+ *
+ */
+struct wifi_c_trace_replay_stats_obj {
+    uint32_t events;                      /**< events passed to handlers */
+    uint32_t skipped;                     /**< records with unknown base or truncated payload */
+    uint32_t handler_time_us;             /**< time spent in handlers */
+    uint32_t handler_max_us;              /**< longest single event in handlers */
+    uint32_t duration_us;                 /**< whole replay, including waiting in real time mode */
+};
+
+/**
+ * @brief Type of trace replay result.
+ *
+ */
+typedef struct wifi_c_trace_replay_stats_obj wifi_c_trace_replay_stats_t;
+
+/**
+ * @brief Check header of dumped trace and point to its first record.
+ *
+ * @note Doesn't depend on ESP-IDF, can be used by host tools reading dumped traces.
+ *
+ * @param trace     Dumped trace.
+ * @param len       Length of dumped trace.
+ * @param offset    Pointer to store offset of first record.
+ *
+ * @retval true if header is valid
+ */
+bool wifi_c_trace_begin(const uint8_t *trace, size_t len, size_t *offset);
+
+/**
+ * @brief Read next record of dumped trace.
+ *
+ * @note Doesn't depend on ESP-IDF, can be used by host tools reading dumped traces.
+ *
+ * @param trace     Dumped trace.
+ * @param len       Length of dumped trace.
+ * @param offset    In: offset of record to read, out: offset of following record.
+ * @param event     Pointer to store read event.
+ *
+ * @retval true if event was read
+ * @retval false at end of trace or if last record is truncated
+ */
+bool wifi_c_trace_next(const uint8_t *trace, size_t len, size_t *offset, wifi_c_trace_event_t *event);
+
+/**
+ * @brief Store event handled by controller, oldest records are overwritten when buffer is full.
+ *
+ * @note Called by event handler registered by wifi_c_create_default_event_loop(), safe from any task.
+ *
+ * @param base  Event base.
+ * @param id    Event id.
+ * @param data  Event data passed to handler, can be NULL.
+ */
+void wifi_c_trace_record(wifi_c_trace_base_t base, int32_t id, const void *data);
+
+/**
+ * @brief Copy recorded events as dumped trace, header first, then records from oldest.
+ *
+ * @note Only whole records are copied, records which don't fit are left out. Recording continues,
+ * nothing is removed from buffer.
+ *
+ * @param buffer Buffer to store trace, NULL to only get needed length.
+ * @param buflen Length of the buffer.
+ *
+ * @return Number of bytes stored in buffer, or length of whole trace if buffer is NULL.
+ */
+size_t wifi_c_trace_dump(uint8_t *buffer, size_t buflen);
+
+/**
+ * @brief Log recorded trace as hex lines, which tools/wifi_c_trace.py turns back into binary trace.
+ *
+ */
+void wifi_c_trace_print(void);
+
+/**
+ * @brief Remove all recorded events.
+ *
+ */
+void wifi_c_trace_clear(void);
+
+/**
+ * @brief Pass dumped trace through controller event handlers, as if events came from event loop.
+ *
+ * @note Events are replayed into temporary context, which owns no interface, so live connection isn't affected.
+ * Handlers update state of that context, but skip driver and netif calls, e.g. esp_wifi_connect() on retry.
+ * @note Replayed events are not recorded again. Trace can be also listed on host - see tools/wifi_c_trace_replay.c.
+ *
+ * @param trace Dumped trace - see wifi_c_trace_dump().
+ * @param len   Length of dumped trace.
+ * @param speed Full speed, or keep recorded time between events.
+ * @param stats Pointer to store replay result, can be NULL.
+ *
+ * @retval ERR_C_OK on success
+ * @retval ERR_C_INVALID_ARGS if trace header is not valid
+ * @retval ERR_C_MEMORY_ERR if temporary context could not be allocated
+ * @retval esp specific error codes if its handlers could not be registered
+ */
+int wifi_c_trace_replay(const uint8_t *trace, size_t len, wifi_c_trace_speed_t speed, wifi_c_trace_replay_stats_t *stats);
@@ -0,0 +1,108 @@
+/**
+ * @file wifi_c_worker.h
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief User callback worker header file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+
+/**
+ * @brief Type of user callback, e.g. STA connect handler.
+ *
+ */
+typedef void (*wifi_c_callback_t)(void);
+
+/**
+ * @brief Configuration of worker task running user callbacks.
+ *
+ */
+struct wifi_c_worker_config_obj {
+    uint16_t queue_length;                /**< Number of callbacks waiting to run, more are dropped. */
+    uint8_t priority;                     /**< Priority of worker task. */
+    uint32_t stack_size;                  /**< Stack size of worker task in bytes, must fit user callbacks. */
+    int core_id;                          /**< Core to pin task to, or tskNO_AFFINITY. */
+};
+
+/**
+ * @brief Type of worker configuration.
+ *
+ */
+typedef struct wifi_c_worker_config_obj wifi_c_worker_config_t;
+
+#define WIFI_C_WORKER_CONFIG_DEFAULT() {    \
+    .queue_length = 8,                      \
+    .priority = 5,                          \
+    .stack_size = 4096,                     \
+    .core_id = tskNO_AFFINITY,              \
+}
+
+/**
+ * @brief Statistics of callback queue.
+ *
+ */
+struct wifi_c_worker_stats_obj {
+    uint32_t dispatched;                  /**< Callbacks queued to worker. */
+    uint32_t overflows;                   /**< Callbacks dropped because queue was full. */
+    uint32_t rejected;                    /**< Callbacks dropped because worker was stopping. */
+    uint16_t queue_depth;                 /**< Callbacks currently waiting in queue. */
+    uint16_t queue_max_depth;             /**< Highest number of callbacks waiting in queue. */
+};
+
+/**
+ * @brief Type of worker statistics.
+ *
+ */
+typedef struct wifi_c_worker_stats_obj wifi_c_worker_stats_t;
+
+/**
+ * @brief Start worker task, after this user callbacks are never called from event loop task.
+ *
+ * @note Queue is allocated on first start and reused after wifi_c_worker_stop().
+ *
+ * @param config Worker configuration, NULL for WIFI_C_WORKER_CONFIG_DEFAULT().
+ *
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_WORKER_ALREADY_STARTED if worker is already running
+ * @retval ERR_C_INVALID_ARGS if queue length is zero or differs from the one allocated before
+ * @retval ERR_C_MEMORY_ERR if queue or task could not be created
+ */
+int wifi_c_worker_start(const wifi_c_worker_config_t *config);
+
+/**
+ * @brief Run callbacks already queued and stop worker task.
+ *
+ * @note After this callbacks are called directly from event handlers again. Callbacks dispatched while
+ * worker is stopping are rejected.
+ * @note Called from a callback, e.g. wifi_c_deinit() in connect handler, it returns at once and worker exits
+ * after that callback and the ones queued before stop, worker can be started again only after that.
+ */
+void wifi_c_worker_stop(void);
+
+/**
+ * @brief Run callback on worker task, or directly when worker is not running.
+ *
+ * @note Never blocks, callback is dropped and counted when queue is full or worker is stopping.
+ *
+ * @param callback Callback to run, NULL is ignored.
+ *
+ * @retval true if callback was queued or called
+ * @retval false if callback was dropped
+ */
+bool wifi_c_worker_dispatch(wifi_c_callback_t callback);
+
+/**
+ * @brief Get statistics of callback queue.
+ *
+ * @param stats Pointer to store statistics.
+ *
+ * @retval ERR_C_OK on success
+ */
+int wifi_c_worker_get_stats(wifi_c_worker_stats_t *stats);
@@ -1,369 +1,1038 @@
-/**
- * @file wifi_controller.h
- * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
- * @brief Wifi controller header file.
- * @version 0.1
- * @date 2024-02-07
- * 
- * @copyright Copyright (c) 2024
- * 
- */
-#pragma once
-
-#include <stdbool.h>
-#include "esp_wifi.h"
-
-/**
- * @brief Types of available WiFi modes.
- * 
- */
-typedef enum {
-    WIFI_C_MODE_STA,        /*Use WiFi as STA.*/
-    WIFI_C_MODE_AP,         /*Use WiFi as AP.*/
-    WIFI_C_MODE_APSTA,      /*Use WiFi as AP+STA.*/
-    WIFI_C_NO_MODE          /*No mode currently set.*/
-} wifi_c_mode_t;
-
-struct wifi_c_ap_status_obj {
-    char ip[20];
-    char ssid[64];
-    void (*connect_handler)(void);
-};
-typedef struct wifi_c_ap_status_obj wifi_c_ap_status_t;
-
-struct wifi_c_sta_status_obj {
-    char ip[20];
-    char ssid[64];
-    void (*connect_handler)(void);
-};
-typedef struct wifi_c_sta_status_obj wifi_c_sta_status_t;
-
-/**
- * @brief Object showing and maintaining current status of wifi_controller.
- * 
- */
-struct wifi_c_status_obj {
-    bool wifi_initialized;
-    bool netif_initialized;
-    wifi_c_mode_t wifi_mode;
-    bool even_loop_started;
-    bool sta_started;
-    bool ap_started;
-    bool scan_done;
-    bool sta_connected;
-    wifi_c_sta_status_t sta;
-    wifi_c_ap_status_t ap;
-};
-
-/**
- * @brief Type of wifi_controller status object.
- * 
- */
-typedef struct wifi_c_status_obj wifi_c_status_t;
-
-
-/**
- * @brief Object containing scanned AP records.
- * 
- */
-struct wifi_c_ap_record_obj {
-    uint8_t bssid[6];                     /**< MAC address of AP */
-    uint8_t ssid[33];                     /**< SSID of AP */
-    uint8_t channel;                      /**< channel of AP */
-    int8_t  rssi;                         /**< signal strength of AP */
-};
-
-/**
- * @brief Type of AP scan result.
- * 
- */
-typedef struct wifi_c_ap_record_obj wifi_c_ap_record_t;
-
-/**
- * @brief Object representing scan configuration and results.
- * 
- */
-struct wifi_c_scan_result_obj {
-    wifi_c_ap_record_t* ap_record;
-    uint16_t ap_count;
-};
-
-/**
- * @brief Type of scan results object.
- * 
- */
-typedef struct wifi_c_scan_result_obj wifi_c_scan_result_t;
-
-/**
- * @brief Definitions of error codes for wifi_controller.
- * 
- */
-#define WIFI_C_ERR_BASE                 0x00FF                      ///< Error base used to indicate where wifi_controller errors numbers start.
-#define WIFI_C_ERR_NULL_SSID            WIFI_C_ERR_BASE + 0x01      ///< SSID for WiFi was null or zero length.
-#define WIFI_C_ERR_WRONG_MODE           WIFI_C_ERR_BASE + 0x02      ///< Mode type of WiFI was wrong.
-#define WIFI_C_ERR_NETIF_INIT_FAILED    WIFI_C_ERR_BASE + 0x03      ///< Failed to initialize netif - see wifi_c_init_netif() (CRITICAL).
-#define WIFI_C_ERR_WIFI_ALREADY_INIT    WIFI_C_ERR_BASE + 0x04      ///< WiFi was already initialized once.
-#define WIFI_C_ERR_NETIF_ALREADY_INIT   WIFI_C_ERR_BASE + 0x05      ///< Netif is already initialized.
-#define WIFI_C_ERR_WRONG_PASSWORD       WIFI_C_ERR_BASE + 0x06      ///< Password lenght is too short for WIFI_AUTH_WPA2_PSK (need at least 8 characters).
-#define WIFI_C_ERR_WIFI_NOT_STARTED     WIFI_C_ERR_BASE + 0x07      ///< Wifi was not started.
-#define WIFI_C_ERR_WIFI_NOT_INIT        WIFI_C_ERR_BASE + 0x08      ///< Wifi was not initialized.
-#define WIFI_C_ERR_SCAN_NOT_DONE        WIFI_C_ERR_BASE + 0x09      ///< Trying to read scan results without prior scanning.
-#define WIFI_C_ERR_STA_NOT_STARTED      WIFI_C_ERR_BASE + 0x0A      ///< Trying to scan without configuring nad starting STA.
-#define WIFI_C_ERR_AP_NOT_FOUND         WIFI_C_ERR_BASE + 0x0B      ///< Not found desired AP when scanning.
-#define WIFI_C_ERR_NEITF_NOT_INIT       WIFI_C_ERR_BASE + 0x0C      ///< Netif was not initialized.
-#define WIFI_C_ERR_EVENT_LOOP_NOT_INIT  WIFI_C_ERR_BASE + 0x0D      ///< Event loop was not started.
-#define WIFI_C_ERR_STA_NOT_CONNECTED    WIFI_C_ERR_BASE + 0x0E      ///< STA is not connected to any AP.
-#define WIFI_C_ERR_STA_CONNECT_FAIL     WIFI_C_ERR_BASE + 0x0F      ///< STA failed to connect to AP.
-#define WIFI_C_ERR_STA_TIMEOUT_EXPIRE   WIFI_C_ERR_BASE + 0x10      ///< wifi_c_start_sta function timeout expired, returned without connection to WiFi
-
-
-#define WIFI_C_STA_RETRY_COUNT          4                           ///< Number of times to try to connect to AP as STA.
-#define WIFI_C_DEFAULT_SCAN_SIZE        10                          ///< Number of APs to store when scanning.
-#define WIFI_C_STA_TIMEOUT              60                          ///< Number of seconds for which will wifi_c_start_sta will block before returning
-
-#define WIFI_C_CONNECTED_BIT            0x00000001
-#define WIFI_C_CONNECT_FAIL_BIT         0x00000002
-#define WIFI_C_SCAN_DONE_BIT            0x00000004
-#define WIFI_C_STA_STARTED_BIT          0x00000008
-
-#define WIFI_C_SCAN_BLOCK               true                        ///< if block is true, this API will block the caller until the scan is done
-
-/**
- * @brief Used to initialize and prepare Wifi to work.
- * 
- * @param WIFI_C_WIFI_MODE Mode in which WiFi will work.
- * 
- * @retval ERR_C_OK on success
- * @retval WIFI_C_ERR_WIFI_ALREADY_INIT if already initialized
- * @retval esp specific errors
- */
-int wifi_c_init_wifi(wifi_c_mode_t WIFI_C_WIFI_MODE);
-
-/**
- * @brief Starts WiFi in softAP mode.
- * 
- * @attention
- * Passed SSID of AP cannot be zero length otherwise it will throw error.
- * 
- * @note
- * When passed password length is zero or NULL, the auth mode is set to open.
- * 
- * @param ssid          SSID of AP.
- * @param password      Password of AP.
- * 
- * @retval ERR_C_OK on success
- * @retval WIFI_C_ERR_NULL_SSID if passed ssid was null or zero length
- * @retval ERR_C_MEMORY_ERR if memcpy of password/ssid was not successfull
- * @retval esp specific error codes
- *          
- */
-int wifi_c_start_ap(const char* ssid, const char* password);
-
-/**
- * @brief Starts WiFi in STA mode.
- * 
- * @param ssid          SSID of AP to connect to as station.
- * @param password      password of AP to connect to as station.
- * 
- * @note This function will block for number of seconds specified by WIFI_C_STA_TIMEOUT before returning.
- * 
- * @retval ERR_C_OK on success
- * @retval WIFI_C_ERR_NULL_SSID if passed ssid was null or zero length
- * @retval ERR_C_MEMORY_ERR if memcpy of password/ssid was not successfull
- * @retval esp specific error codes
- */
-int wifi_c_start_sta(const char* ssid, const char* password);
-
-/**
- * @brief Get current wifi_controller status.
- * 
- * @return wifi_status_t* Pointer to wifi_controller status struct.
- */
-wifi_c_status_t *wifi_c_get_status(void);
-
-
-/**
- * @brief Get current wifi_controller status as JSON string.
- * 
-*/
-int wifi_c_get_status_as_json(char* buffer, size_t buflen);
-
-
-/**
- * @brief Translate wifi_c_mode_t enum to string.
- * 
- * @retval "WIFI_C_MODE_AP"
- * @retval "WIFI_C_MODE_STA"
- * @retval "WIFI_C_MODE_APSTA"
- * @retval NULL if wrong value was passed.
-*/
-char* wifi_c_get_wifi_mode_as_string(wifi_c_mode_t wifi_mode);
-
-/**
- * @brief Get current IPv4 address of STA interface.
- * 
- * @retval IPv4 address
- * @retval 0.0.0.0 if no address was currently received
-*/
-char* wifi_c_get_sta_ipv4(void);
-
-/**
- * @brief Get current IPv4 address of AP interface.
- * 
- * @retval IPv4 address
- * @retval 0.0.0.0 if no address
-*/
-char* wifi_c_get_ap_ipv4(void);
-
-/**
- * @brief Get SSID of access point that STA interface is connected to.
- * 
- * @retval SSID of access point
- * @retval "none" if STA is not connected to any access point
-*/
-char* wifi_c_sta_get_ap_ssid(void);
-
-/**
- * @brief Get SSID of access point interface.
- * 
- * @retval SSID of access point
- * @retval "none" if AP is not started
-*/
-char* wifi_c_ap_get_ssid(void);
-
-/**
- * @brief Get Wifi STA connection status.
- * 
- * @retval true If STA is connected to some AP.
- * @retval false If STA is not connected to any AP.
- * @retval true If STA is connected to some AP.
- * @retval false If STA is not connected to any AP.
- */
-bool wifi_c_check_if_sta_is_connected(void);
-
-/**
- * @brief Initializes default event loop and sets callback functions.
- * 
- * @retval ERR_C_OK on success
- * @retval esp specific error codes
- * @retval ERR_C_OK on success
- * @retval esp specific error codes
- */
-int wifi_c_create_default_event_loop(void);
-
-/**
- * @brief Disconnect from AP as STA.
- * 
- * @retval ERR_C_OK on success
- * @retval WIFI_C_ERR_WIFI_NOT_INIT
- * @retval WIFI_C_ERR_WIFI_NOT_STARTED
- * @retval WIFI_C_ERR_STA_NOT_STARTED
- * @retval WIFI_C_ERR_STA_NOT_CONNECTED
- * @retval esp specific error codes
- */
-int wifi_c_disconnect(void);
-
-/**
- * @brief Disconnect from sta, and try to connect with passed credentials.
- * 
- * @param SSID SSID to AP;
- * @param PASSWORD Password to AP.
- * 
- * @retval ERR_C_OK on success
- * @retval WIFI_C_ERR_WIFI_NOT_INIT
- * @retval WIFI_C_ERR_WIFI_NOT_STARTED
- * @retval WIFI_C_ERR_STA_NOT_STARTED
- * @retval WIFI_C_ERR_STA_NOT_CONNECTED
- * @retval esp specific error codes
- * 
- * @retval ERR_C_OK on success
- * @retval WIFI_C_ERR_WIFI_NOT_INIT
- * @retval WIFI_C_ERR_WIFI_NOT_STARTED
- * @retval WIFI_C_ERR_STA_NOT_STARTED
- * @retval WIFI_C_ERR_STA_NOT_CONNECTED
- * @retval esp specific error codes
- */
-int wifi_c_sta_reconnect(const char* SSID, const char* PASSWORD);
-
-/**
- * @brief Scan for AP on all channels.
- * 
- * @param result_to_return Pointer to scan results struct.
- * 
- * @attention Scanning for access points is only possible when station mode is enabled and started.
- * 
- * @retval ERR_C_OK on success
- * @retval WIFI_C_ERR_WRONG_MODE Wrong Wifi mode, scanning only possible in STA/APSTA mode.
- * @retval WIFI_C_ERR_WIFI_NOT_INIT WiFi was not initialized.
- * @retval WIFI_C_ERR_STA_NOT_STARTED STA was not started.
- * @retval ERR_NULL_POINTER Pointer to result buffer was NULL.
- * @retval esp specific error codes
- */
-int wifi_c_scan_all_ap(wifi_c_scan_result_t* result_to_return);
-
-/**
- * @brief Scan for AP with desired SSID.
- * 
- * @param searched_ssid SSID of AP to search for.
- * @param ap_record     Pointer to wifi_ap_record_t to store result.
- * 
- * @retval ERR_C_OK on success
- * @retval WIFI_C_ERR_AP_NOT_FOUND when not found AP
- * @retval esp specific error codes
- * 
- * @retval ERR_C_OK on success
- * @retval WIFI_C_ERR_AP_NOT_FOUND when not found AP
- * @retval esp specific error codes
- */
-int wifi_c_scan_for_ap_with_ssid(const char* searched_ssid, wifi_c_ap_record_t* ap_record);
-
-/**
- * @brief Log results of Wifi scan.
- * 
- * @note It should be called only after scanning is done.
- * 
- */
-int wifi_c_print_scanned_ap (void);
-
-/**
- * @brief Store results of scanning in buffer as json string;
- * 
- * @param buffer Buffer to store scan result.
- * @param buflen Length of the buffer.
- * 
- * @retval ERR_C_OK on success
- * @retval WIFI_C_ERR_SCAN_NOT_DONE Scan not done, init scan before getting results.
- * @retval WIFI_C_ERR_WIFI_NOT_INIT WiFi was not initialized.
- * @retval esp specific error codes
- * 
- * @retval ERR_C_OK on success
- * @retval WIFI_C_ERR_SCAN_NOT_DONE Scan not done, init scan before getting results.
- * @retval WIFI_C_ERR_WIFI_NOT_INIT WiFi was not initialized.
- * @retval esp specific error codes
- */
-int wifi_c_store_scan_result_as_json (char* buffer, uint16_t buflen);
-
-/**
- * @brief Change wifi operating mode.
- * 
- * @param mode wifi operating mode (STA, AP, APSTA)
- * 
- * @retval WIFI_C_ERR_WRONG_MODE If mode is the same as currently set.
- * @retval esp specific error codes
-*/
-int wifi_c_change_mode(wifi_c_mode_t mode);
-
-/**
- * @brief Used to deinit wifi controller, and free all resources.
- * 
- * @note This function deletes default event loop.
- */
-void wifi_c_deinit(void);
-
-/**
- * @brief Register function to be called when STA connects to AP.
- * 
- * @retval 0 on success
- * @retval 
-*/
-int wifi_c_sta_register_connect_handler(void (*connect_handler)(void));
\ No newline at end of file
+/**
+ * @file wifi_controller.h
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief Wifi controller header file.
+ * @version 0.1
+ * @date 2024-02-07
+ * 
+ * @copyright Copyright (c) 2024
+ * 
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "esp_wifi.h"
+#include "esp_netif.h"
+#include "wifi_c_stream.h"
+
+/**
+ * @brief Parts of wifi_controller compiled in, selected with Kconfig (menuconfig -> WiFi controller).
+ *
+ * @note When Kconfig options are not set, everything is compiled in.
+ */
+#if defined(CONFIG_WIFI_C_ROLE_AP_ONLY)
+#define WIFI_C_STA_ENABLED              0                           ///< STA and AP+STA modes are compiled out.
+#else
+#define WIFI_C_STA_ENABLED              1
+#endif
+
+#if defined(CONFIG_WIFI_C_ROLE_STA_ONLY)
+#define WIFI_C_AP_ENABLED               0                           ///< AP and AP+STA modes are compiled out.
+#else
+#define WIFI_C_AP_ENABLED               1
+#endif
+
+#if WIFI_C_STA_ENABLED && !defined(CONFIG_WIFI_C_DISABLE_SCAN)
+#define WIFI_C_SCAN_ENABLED             1
+#else
+#define WIFI_C_SCAN_ENABLED             0                           ///< Scanning is compiled out.
+#endif
+
+#if WIFI_C_AP_ENABLED && WIFI_C_SCAN_ENABLED
+#define WIFI_C_AUTO_CHANNEL_ENABLED     1                           ///< AP channel can be selected by scanning, see wifi_c_channel.h.
+#else
+#define WIFI_C_AUTO_CHANNEL_ENABLED     0
+#endif
+
+#if WIFI_C_AP_ENABLED && WIFI_C_SCAN_ENABLED
+#define WIFI_C_APSTA_POLICY_ENABLED     1                           ///< STA connects in AP+STA mode probe AP channel first, see wifi_c_apsta_policy_t.
+#else
+#define WIFI_C_APSTA_POLICY_ENABLED     0
+#endif
+
+#if !defined(CONFIG_WIFI_C_DISABLE_JSON)
+#define WIFI_C_JSON_ENABLED             1
+#else
+#define WIFI_C_JSON_ENABLED             0                           ///< JSON formatters are compiled out.
+#endif
+
+#if !defined(CONFIG_WIFI_C_DISABLE_METRICS)
+#define WIFI_C_METRICS_ENABLED          1                           ///< Event handlers update counters, see wifi_c_metrics.h.
+#else
+#define WIFI_C_METRICS_ENABLED          0
+#endif
+
+#if defined(CONFIG_WIFI_C_DEFERRED_LOG)
+#define WIFI_C_DEFERRED_LOG_ENABLED     1                           ///< Event handlers store binary records instead of formatting logs, see wifi_c_log.h.
+#else
+#define WIFI_C_DEFERRED_LOG_ENABLED     0
+#endif
+
+#if defined(CONFIG_WIFI_C_EVENT_TRACE)
+#define WIFI_C_EVENT_TRACE_ENABLED      1                           ///< Handled events are recorded for replay, see wifi_c_trace.h.
+#else
+#define WIFI_C_EVENT_TRACE_ENABLED      0
+#endif
+
+#if defined(CONFIG_WIFI_C_HTTP)
+#define WIFI_C_HTTP_ENABLED             1                           ///< Controller state can be served over HTTP, see wifi_c_http.h.
+#else
+#define WIFI_C_HTTP_ENABLED             0
+#endif
+
+#if defined(CONFIG_WIFI_C_SPAN_TRACE)
+#define WIFI_C_SPAN_TRACE_ENABLED       1                           ///< Operations are recorded as timed spans, see wifi_c_span.h.
+#else
+#define WIFI_C_SPAN_TRACE_ENABLED       0
+#endif
+
+#if WIFI_C_STA_ENABLED && defined(CONFIG_WIFI_C_PSK_CACHE)
+#define WIFI_C_PSK_CACHE_ENABLED        1                           ///< STA connects with cached PSK instead of passphrase, see wifi_c_psk.h.
+#else
+#define WIFI_C_PSK_CACHE_ENABLED        0
+#endif
+
+#if defined(CONFIG_WIFI_C_HEAP_AUDIT)
+#define WIFI_C_HEAP_AUDIT_ENABLED       1                           ///< Heap allocations of API calls and event handlers are counted, see wifi_c_heap.h.
+#else
+#define WIFI_C_HEAP_AUDIT_ENABLED       0
+#endif
+
+#if defined(CONFIG_WIFI_C_STATIC_ALLOC)
+#define WIFI_C_STATIC_ALLOC_ENABLED     1                           ///< Controller objects are allocated at init, not on first use.
+#else
+#define WIFI_C_STATIC_ALLOC_ENABLED     0
+#endif
+
+#if defined(CONFIG_WIFI_C_PRIVATE_EVENT_LOOP)
+#define WIFI_C_PRIVATE_EVENT_LOOP_ENABLED 1                         ///< Controller handlers run on its own event loop, see wifi_c_event_loop.h.
+#else
+#define WIFI_C_PRIVATE_EVENT_LOOP_ENABLED 0
+#endif
+
+#if WIFI_C_PSK_CACHE_ENABLED && defined(CONFIG_WIFI_C_PSK_CACHE_NVS) && defined(CONFIG_NVS_ENCRYPTION)
+#define WIFI_C_PSK_CACHE_NVS_ENABLED    1                           ///< Cached PSKs are also stored in encrypted NVS.
+#else
+#define WIFI_C_PSK_CACHE_NVS_ENABLED    0
+#endif
+
+/**
+ * @brief Types of available WiFi modes.
+ * 
+ */
+typedef enum {
+    WIFI_C_MODE_STA,        /*Use WiFi as STA.*/
+    WIFI_C_MODE_AP,         /*Use WiFi as AP.*/
+    WIFI_C_MODE_APSTA,      /*Use WiFi as AP+STA, only when both roles are enabled.*/
+    WIFI_C_NO_MODE          /*No mode currently set.*/
+} wifi_c_mode_t;
+
+struct wifi_c_ap_status_obj {
+    char ip[20];
+    char ssid[64];
+    void (*connect_handler)(void);
+};
+typedef struct wifi_c_ap_status_obj wifi_c_ap_status_t;
+
+struct wifi_c_sta_status_obj {
+    char ip[20];
+    char ssid[64];
+    void (*connect_handler)(void);
+};
+typedef struct wifi_c_sta_status_obj wifi_c_sta_status_t;
+
+/**
+ * @brief Object showing and maintaining current status of wifi_controller.
+ * 
+ */
+struct wifi_c_status_obj {
+    bool wifi_initialized;
+    bool netif_initialized;
+    wifi_c_mode_t wifi_mode;
+    bool even_loop_started;
+    bool sta_started;
+    bool ap_started;
+    bool scan_done;
+    bool sta_connected;
+    bool suspended;
+#if WIFI_C_STA_ENABLED
+    wifi_c_sta_status_t sta;
+#endif
+#if WIFI_C_AP_ENABLED
+    wifi_c_ap_status_t ap;
+#endif
+};
+
+/**
+ * @brief Type of wifi_controller status object.
+ * 
+ */
+typedef struct wifi_c_status_obj wifi_c_status_t;
+
+
+/**
+ * @brief Object containing scanned AP records.
+ * 
+ */
+struct wifi_c_ap_record_obj {
+    uint8_t bssid[6];                     /**< MAC address of AP */
+    uint8_t ssid[33];                     /**< SSID of AP */
+    uint8_t channel;                      /**< channel of AP */
+    int8_t  rssi;                         /**< signal strength of AP */
+};
+
+/**
+ * @brief Type of AP scan result.
+ * 
+ */
+typedef struct wifi_c_ap_record_obj wifi_c_ap_record_t;
+
+/**
+ * @brief Object representing scan configuration and results.
+ * 
+ */
+struct wifi_c_scan_result_obj {
+    wifi_c_ap_record_t* ap_record;
+    uint16_t ap_count;
+};
+
+/**
+ * @brief Type of scan results object.
+ * 
+ */
+typedef struct wifi_c_scan_result_obj wifi_c_scan_result_t;
+
+#if WIFI_C_AP_ENABLED
+/**
+ * @brief Object containing all settings of AP.
+ *
+ */
+struct wifi_c_ap_config_obj {
+    const char *ssid;                     /**< SSID of AP, 1-32 characters */
+    const char *password;                 /**< password of AP, 8-63 characters, NULL or empty for open AP */
+    wifi_auth_mode_t authmode;            /**< WPA2, WPA3 or WPA2/WPA3 PSK, ignored for open AP */
+    bool pmf_required;                    /**< require protected management frames, mandatory for WPA3 only */
+    uint8_t channel;                      /**< 2.4 GHz channel, 0 leaves driver default */
+    wifi_bandwidth_t bandwidth;           /**< WIFI_BW_HT20 or WIFI_BW_HT40, which needs 802.11n */
+    uint8_t protocol;                     /**< mask of WIFI_PROTOCOL_11B/11G/11N/LR */
+    uint8_t max_connection;               /**< max number of clients, up to ESP_WIFI_MAX_CONN_NUM */
+    uint16_t beacon_interval;             /**< beacon interval in TU (1024 us), 100-60000 */
+    uint8_t dtim_period;                  /**< beacons between group traffic deliveries, 1-10 */
+};
+
+/**
+ * @brief Type of AP configuration.
+ *
+ */
+typedef struct wifi_c_ap_config_obj wifi_c_ap_config_t;
+
+/**
+ * @brief Settings used by wifi_c_start_ap().
+ *
+ */
+#define WIFI_C_AP_CONFIG_DEFAULT() {                                            \
+    .ssid = NULL,                                                               \
+    .password = NULL,                                                           \
+    .authmode = WIFI_AUTH_WPA2_PSK,                                             \
+    .pmf_required = false,                                                      \
+    .channel = 0,                                                               \
+    .bandwidth = WIFI_BW_HT20,                                                  \
+    .protocol = WIFI_PROTOCOL_11B | WIFI_PROTOCOL_11G | WIFI_PROTOCOL_11N,      \
+    .max_connection = 6,                                                        \
+    .beacon_interval = 100,                                                     \
+    .dtim_period = 2,                                                           \
+}
+#endif
+
+#if WIFI_C_APSTA_POLICY_ENABLED
+/**
+ * @brief How STA connects in AP+STA mode, where AP and STA share one radio.
+ *
+ * @note Without policy driver sweeps all channels, staying away from AP channel for the whole sweep,
+ * and AP follows STA to channel of its AP without warning, so AP clients stall or drop.
+ * With policy SSID is probed on AP channel first. Only if it's not there, other channels are scanned
+ * in slices with returns to AP channel between them (see wifi_c_scan_sliced()), and STA is locked
+ * to found BSSID, so connect and reconnects don't sweep again.
+ */
+struct wifi_c_apsta_policy_obj {
+    bool enabled;                         /**< false to connect the same way as in STA mode */
+    uint16_t probe_time_ms;               /**< active scan time on AP channel when probing for SSID */
+    uint16_t max_off_channel_ms;          /**< scan time on every other channel, one channel is scanned per trip away from AP channel */
+    uint16_t home_dwell_ms;               /**< time on AP channel between trips, AP clients get beacons and traffic */
+    bool allow_channel_switch;            /**< false to fail with WIFI_C_ERR_AP_CHANNEL_CONFLICT instead of moving AP to channel of STA link */
+    uint8_t csa_count;                    /**< beacons announcing channel switch to AP clients before AP moves, 0 to move without CSA, read at AP start */
+};
+
+/**
+ * @brief Type of AP+STA connect policy.
+ *
+ */
+typedef struct wifi_c_apsta_policy_obj wifi_c_apsta_policy_t;
+
+#define WIFI_C_APSTA_POLICY_DEFAULT() {     \
+    .enabled = true,                        \
+    .probe_time_ms = 120,                   \
+    .max_off_channel_ms = 60,               \
+    .home_dwell_ms = 200,                   \
+    .allow_channel_switch = true,           \
+    .csa_count = 3,                         \
+}
+
+/**
+ * @brief Disruption of AP clients caused by STA (re)connects in AP+STA mode.
+ *
+ */
+struct wifi_c_apsta_stats_obj {
+    uint32_t connects;                    /**< STA connects started in AP+STA mode with AP running. */
+    uint32_t same_channel;                /**< Connects which found SSID on AP channel, AP didn't move. */
+    uint32_t channel_switches;            /**< Connects which moved AP to other channel. */
+    uint32_t csa_announced;               /**< Channel switches of AP started with CSA count above 0, which driver announces to AP clients. */
+    uint32_t reconnects;                  /**< Driver reconnects after STA link was lost, AP is off channel while they scan. */
+    uint32_t clients_dropped;             /**< AP clients which left while STA was (re)connecting. */
+    uint32_t clients_at_switch;           /**< AP clients connected when AP last moved to other channel. */
+    uint32_t last_off_channel_us;         /**< Longest continuous time away from AP channel in last connect scan. */
+    uint32_t max_off_channel_us;          /**< Longest continuous time away from AP channel in any connect scan. */
+};
+
+/**
+ * @brief Type of AP+STA disruption statistics.
+ *
+ */
+typedef struct wifi_c_apsta_stats_obj wifi_c_apsta_stats_t;
+#endif
+
+#if WIFI_C_STA_ENABLED
+/**
+ * @brief Ways STA gets its IPv4 address.
+ *
+ */
+typedef enum {
+    WIFI_C_STA_IP_DHCP = 0,               /*address from DHCP on every connect*/
+    WIFI_C_STA_IP_STATIC,                 /*fixed address, DHCP is not used*/
+    WIFI_C_STA_IP_REUSE_LEASE,            /*last DHCP lease of the same SSID is applied at once, then renewed in background*/
+} wifi_c_sta_ip_mode_t;
+
+/**
+ * @brief Object containing IPv4 settings of STA.
+ *
+ */
+struct wifi_c_sta_ip_config_obj {
+    wifi_c_sta_ip_mode_t mode;            /**< how address is obtained */
+    esp_netif_ip_info_t ip_info;          /**< static mode only: address, netmask and gateway */
+    esp_ip4_addr_t dns;                   /**< static mode only: DNS server, 0 to leave it unset */
+    uint32_t renew_delay_ms;              /**< reuse mode only: time from cached address being up to DHCP renew, 0 disables renew */
+};
+
+/**
+ * @brief Type of STA IPv4 configuration.
+ *
+ */
+typedef struct wifi_c_sta_ip_config_obj wifi_c_sta_ip_config_t;
+
+/**
+ * @brief Settings used when wifi_c_sta_set_ip_config() was never called.
+ *
+ */
+#define WIFI_C_STA_IP_CONFIG_DEFAULT() {        \
+    .mode = WIFI_C_STA_IP_DHCP,                 \
+    .ip_info = {{0}, {0}, {0}},                 \
+    .dns = {0},                                 \
+    .renew_delay_ms = 2000,                     \
+}
+
+/**
+ * @brief Object containing radio and association settings of STA link.
+ *
+ * @note Zero in protocol, bandwidth, max_tx_power and listen_interval keeps driver default.
+ */
+struct wifi_c_sta_link_profile_obj {
+    uint8_t protocol;                     /**< bitmask of WIFI_PROTOCOL_11B/11G/11N/LR, 0 to keep driver default */
+    wifi_bandwidth_t bandwidth;           /**< WIFI_BW_HT20 or WIFI_BW_HT40 (needs 11N), 0 to keep driver default */
+    int8_t max_tx_power;                  /**< TX power limit in 0.25 dBm units, 8-84, 0 to keep driver default */
+    uint16_t listen_interval;             /**< beacon intervals between wakeups in modem sleep, 0 for driver default (3) */
+    wifi_sort_method_t sort_method;       /**< which AP of SSID is chosen when there are more */
+    int8_t min_rssi;                      /**< APs weaker than this are ignored, 0 to accept any */
+    wifi_auth_mode_t min_authmode;        /**< APs with weaker security are ignored */
+};
+
+/**
+ * @brief Type of STA link profile.
+ *
+ */
+typedef struct wifi_c_sta_link_profile_obj wifi_c_sta_link_profile_t;
+
+#define WIFI_C_STA_LINK_PROFILE_MAX_TX_POWER 84                         ///< Highest TX power limit accepted by driver (21 dBm).
+#define WIFI_C_STA_LINK_PROFILE_MIN_TX_POWER 8                          ///< Lowest TX power limit accepted by driver (2 dBm).
+
+/**
+ * @brief Settings used when wifi_c_sta_set_link_profile() was never called, driver defaults stay untouched.
+ *
+ */
+#define WIFI_C_STA_LINK_PROFILE_DEFAULT() {     \
+    .protocol = 0,                              \
+    .bandwidth = 0,                             \
+    .max_tx_power = 0,                          \
+    .listen_interval = 0,                       \
+    .sort_method = WIFI_CONNECT_AP_BY_SIGNAL,   \
+    .min_rssi = 0,                              \
+    .min_authmode = WIFI_AUTH_OPEN,             \
+}
+
+/**
+ * @brief Distant AP: Long Range mode allowed (AP must also be ESP with LR), narrow channel and full TX power.
+ *
+ * @note LR links give at most ~0.5 Mbps.
+ */
+#define WIFI_C_STA_LINK_PROFILE_LONG_RANGE() {                                          \
+    .protocol = WIFI_PROTOCOL_11B | WIFI_PROTOCOL_11G | WIFI_PROTOCOL_11N | WIFI_PROTOCOL_LR, \
+    .bandwidth = WIFI_BW_HT20,                                                          \
+    .max_tx_power = WIFI_C_STA_LINK_PROFILE_MAX_TX_POWER,                               \
+    .listen_interval = 0,                                                               \
+    .sort_method = WIFI_CONNECT_AP_BY_SIGNAL,                                           \
+    .min_rssi = 0,                                                                      \
+    .min_authmode = WIFI_AUTH_OPEN,                                                     \
+}
+
+/**
+ * @brief Nearby AP: 40 MHz channel, wakeup on every beacon, weak and legacy-security APs skipped.
+ *
+ */
+#define WIFI_C_STA_LINK_PROFILE_HIGH_THROUGHPUT() {                                     \
+    .protocol = WIFI_PROTOCOL_11B | WIFI_PROTOCOL_11G | WIFI_PROTOCOL_11N,              \
+    .bandwidth = WIFI_BW_HT40,                                                          \
+    .max_tx_power = 0,                                                                  \
+    .listen_interval = 1,                                                               \
+    .sort_method = WIFI_CONNECT_AP_BY_SIGNAL,                                           \
+    .min_rssi = -67,                                                                    \
+    .min_authmode = WIFI_AUTH_WPA2_PSK,                                                 \
+}
+#endif
+
+/**
+ * @brief Definitions of error codes for wifi_controller.
+ * 
+ */
+#define WIFI_C_ERR_BASE                 0x00FF                      ///< Error base used to indicate where wifi_controller errors numbers start.
+#define WIFI_C_ERR_NULL_SSID            WIFI_C_ERR_BASE + 0x01      ///< SSID for WiFi was null or zero length.
+#define WIFI_C_ERR_WRONG_MODE           WIFI_C_ERR_BASE + 0x02      ///< Mode type of WiFI was wrong.
+#define WIFI_C_ERR_NETIF_INIT_FAILED    WIFI_C_ERR_BASE + 0x03      ///< Failed to initialize netif - see wifi_c_init_netif() (CRITICAL).
+#define WIFI_C_ERR_WIFI_ALREADY_INIT    WIFI_C_ERR_BASE + 0x04      ///< WiFi was already initialized once.
+#define WIFI_C_ERR_NETIF_ALREADY_INIT   WIFI_C_ERR_BASE + 0x05      ///< Netif is already initialized.
+#define WIFI_C_ERR_WRONG_PASSWORD       WIFI_C_ERR_BASE + 0x06      ///< Password lenght is too short for WIFI_AUTH_WPA2_PSK (need at least 8 characters).
+#define WIFI_C_ERR_WIFI_NOT_STARTED     WIFI_C_ERR_BASE + 0x07      ///< Wifi was not started.
+#define WIFI_C_ERR_WIFI_NOT_INIT        WIFI_C_ERR_BASE + 0x08      ///< Wifi was not initialized.
+#define WIFI_C_ERR_SCAN_NOT_DONE        WIFI_C_ERR_BASE + 0x09      ///< Trying to read scan results without prior scanning.
+#define WIFI_C_ERR_STA_NOT_STARTED      WIFI_C_ERR_BASE + 0x0A      ///< Trying to scan without configuring nad starting STA.
+#define WIFI_C_ERR_AP_NOT_FOUND         WIFI_C_ERR_BASE + 0x0B      ///< Not found desired AP when scanning.
+#define WIFI_C_ERR_NEITF_NOT_INIT       WIFI_C_ERR_BASE + 0x0C      ///< Netif was not initialized.
+#define WIFI_C_ERR_EVENT_LOOP_NOT_INIT  WIFI_C_ERR_BASE + 0x0D      ///< Event loop was not started.
+#define WIFI_C_ERR_STA_NOT_CONNECTED    WIFI_C_ERR_BASE + 0x0E      ///< STA is not connected to any AP.
+#define WIFI_C_ERR_STA_CONNECT_FAIL     WIFI_C_ERR_BASE + 0x0F      ///< STA failed to connect to AP.
+#define WIFI_C_ERR_STA_TIMEOUT_EXPIRE   WIFI_C_ERR_BASE + 0x10      ///< wifi_c_start_sta function timeout expired, returned without connection to WiFi
+#define WIFI_C_ERR_HISTORY_NOT_INIT     WIFI_C_ERR_BASE + 0x11      ///< BSSID history was not initialized - see wifi_c_history_init().
+#define WIFI_C_ERR_HISTORY_ALREADY_INIT WIFI_C_ERR_BASE + 0x12      ///< BSSID history was already initialized once.
+#define WIFI_C_ERR_WORKER_ALREADY_STARTED WIFI_C_ERR_BASE + 0x13    ///< Callback worker task is already running.
+#define WIFI_C_ERR_CHANNEL_MONITOR_STARTED WIFI_C_ERR_BASE + 0x14   ///< Channel monitor task is already running.
+#define WIFI_C_ERR_AP_CONFIG_INVALID    WIFI_C_ERR_BASE + 0x15      ///< AP settings out of range or inconsistent - see wifi_c_ap_config_t.
+#define WIFI_C_ERR_AP_CHANNEL_CONFLICT  WIFI_C_ERR_BASE + 0x16      ///< AP channel or width differs from STA link in AP+STA mode.
+#define WIFI_C_ERR_IP_CONFIG_INVALID    WIFI_C_ERR_BASE + 0x17      ///< STA IP mode unknown, or static address or netmask is zero - see wifi_c_sta_ip_config_t.
+#define WIFI_C_ERR_WAIT_TIMEOUT        WIFI_C_ERR_BASE + 0x18      ///< Awaited state was not reached before timeout - see wifi_c_wait_for().
+#define WIFI_C_ERR_ROAM_STARTED         WIFI_C_ERR_BASE + 0x19      ///< Roam task is already running - see wifi_c_roam_start().
+#define WIFI_C_ERR_NOT_SUSPENDED        WIFI_C_ERR_BASE + 0x1A      ///< Resume requested, but WiFi was not suspended - see wifi_c_suspend().
+#define WIFI_C_ERR_CMD_QUEUE_STARTED    WIFI_C_ERR_BASE + 0x1B      ///< Controller task is already running - see wifi_c_cmd_start().
+#define WIFI_C_ERR_LINK_PROFILE_INVALID WIFI_C_ERR_BASE + 0x1C      ///< STA protocol, bandwidth or TX power out of range - see wifi_c_sta_link_profile_t.
+#define WIFI_C_ERR_CONFIG_INVALID       WIFI_C_ERR_BASE + 0x1D      ///< Config document is not valid JSON or settings are out of range - see wifi_c_config_parse().
+#define WIFI_C_ERR_HEAP_STEADY_ALLOC    WIFI_C_ERR_BASE + 0x1E      ///< Controller allocated heap after startup - see wifi_c_heap_audit_check().
+#define WIFI_C_ERR_EVENT_LOOP_RUNNING   WIFI_C_ERR_BASE + 0x1F      ///< Private event loop is running, its config can't be changed - see wifi_c_event_loop_set_config().
+#define WIFI_C_ERR_LOG_STOPPING         WIFI_C_ERR_BASE + 0x20      ///< Deferred log task is being stopped - see wifi_c_log_start().
+#define WIFI_C_ERR_IFACE_BUSY           WIFI_C_ERR_BASE + 0x21      ///< Interface or driver is used by other context - see wifi_c_ctx.h.
+#define WIFI_C_ERR_PSK_PASSPHRASE_ONLY  WIFI_C_ERR_BASE + 0x22      ///< Network was joined only with passphrase, e.g. WPA3-SAE - see wifi_c_psk_get().
+
+
+#define WIFI_C_STA_RETRY_COUNT          4                           ///< Number of times to try to connect to AP as STA.
+#define WIFI_C_DEFAULT_SCAN_SIZE        10                          ///< Number of APs to store when scanning.
+#define WIFI_C_AP_CHANNEL_MAX           14                          ///< Highest channel AP can be started on.
+#define WIFI_C_STA_TIMEOUT              60                          ///< Number of seconds for which will wifi_c_start_sta will block before returning
+#define WIFI_C_LEASE_RENEW_TIMEOUT_MS   10000                       ///< Time DHCP renew of cached lease may take before cached address is restored.
+
+#define WIFI_C_CONNECTED_BIT            0x00000001
+#define WIFI_C_CONNECT_FAIL_BIT         0x00000002
+#define WIFI_C_SCAN_DONE_BIT            0x00000004
+#define WIFI_C_STA_STARTED_BIT          0x00000008
+#define WIFI_C_STA_LINK_UP_BIT          0x00000010                  ///< STA associated with AP, IP may not be assigned yet.
+
+#define WIFI_C_WAIT_FOREVER             UINT32_MAX                  ///< Timeout of wifi_c_wait_for() which never expires.
+
+#define WIFI_C_SCAN_BLOCK               true                        ///< if block is true, this API will block the caller until the scan is done
+
+/**
+ * @brief Used to initialize and prepare Wifi to work.
+ * 
+ * @param WIFI_C_WIFI_MODE Mode in which WiFi will work.
+ * 
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_WIFI_ALREADY_INIT if already initialized
+ * @retval esp specific errors
+ */
+int wifi_c_init_wifi(wifi_c_mode_t WIFI_C_WIFI_MODE);
+
+#if WIFI_C_AP_ENABLED
+/**
+ * @brief Starts WiFi in softAP mode.
+ * 
+ * @attention
+ * Passed SSID of AP cannot be zero length otherwise it will throw error.
+ * 
+ * @note
+ * When passed password length is zero or NULL, the auth mode is set to open.
+ * Other settings are taken from WIFI_C_AP_CONFIG_DEFAULT(), use wifi_c_start_ap_with_config() to change them.
+ * 
+ * @param ssid          SSID of AP.
+ * @param password      Password of AP.
+ * 
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_NULL_SSID if passed ssid was null or zero length
+ * @retval ERR_C_MEMORY_ERR if memcpy of password/ssid was not successfull
+ * @retval esp specific error codes
+ *          
+ */
+int wifi_c_start_ap(const char* ssid, const char* password);
+
+/**
+ * @brief Starts WiFi in softAP mode with all settings given.
+ *
+ * @note
+ * In AP+STA mode with STA connected, AP must use channel of STA (or 0) and can use 40 MHz only if STA link does.
+ *
+ * @param config        AP settings, start from WIFI_C_AP_CONFIG_DEFAULT().
+ *
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_NULL_SSID if ssid was null or zero length
+ * @retval WIFI_C_ERR_WRONG_PASSWORD if password is shorter than 8 or longer than 63 characters
+ * @retval WIFI_C_ERR_AP_CONFIG_INVALID if any setting is out of range or settings are inconsistent
+ * @retval WIFI_C_ERR_AP_CHANNEL_CONFLICT if channel or bandwidth conflicts with connected STA
+ * @retval esp specific error codes
+ */
+int wifi_c_start_ap_with_config(const wifi_c_ap_config_t* config);
+#endif
+
+#if WIFI_C_STA_ENABLED
+/**
+ * @brief Starts WiFi in STA mode.
+ * 
+ * @param ssid          SSID of AP to connect to as station.
+ * @param password      password of AP to connect to as station.
+ * 
+ * @note This function will block for number of seconds specified by WIFI_C_STA_TIMEOUT before returning.
+ * @note In AP+STA mode with AP running, SSID is located according to wifi_c_apsta_set_policy() first.
+ * 
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_NULL_SSID if passed ssid was null or zero length
+ * @retval ERR_C_MEMORY_ERR if memcpy of password/ssid was not successfull
+ * @retval WIFI_C_ERR_AP_NOT_FOUND if AP+STA policy didn't find SSID on any channel
+ * @retval WIFI_C_ERR_AP_CHANNEL_CONFLICT if SSID is on other channel than AP and policy doesn't allow moving AP
+ * @retval esp specific error codes
+ */
+int wifi_c_start_sta(const char* ssid, const char* password);
+
+/**
+ * @brief Configure STA and start connecting, return without waiting for result.
+ *
+ * @param ssid          SSID of AP to connect to as station.
+ * @param password      password of AP to connect to as station.
+ *
+ * @note Result is reported as WIFI_C_STATE_STA_GOT_IP or WIFI_C_STATE_STA_CONNECT_FAILED,
+ * see wifi_c_wait_for() and wifi_c_register_state_handler().
+ *
+ * @retval ERR_C_OK if connecting started
+ * @retval same errors as wifi_c_start_sta(), except the ones reporting result of connection
+ */
+int wifi_c_start_sta_async(const char* ssid, const char* password);
+#endif
+
+/**
+ * @brief Get current wifi_controller status.
+ * 
+ * @return wifi_status_t* Pointer to wifi_controller status struct.
+ */
+wifi_c_status_t *wifi_c_get_status(void);
+
+
+#if WIFI_C_JSON_ENABLED
+/**
+ * @brief Get current wifi_controller status as JSON string.
+ * 
+*/
+int wifi_c_get_status_as_json(char* buffer, size_t buflen);
+
+/**
+ * @brief Stream current wifi_controller status as JSON object, chunk by chunk.
+ *
+ * @note Output is never held in memory as a whole, only WIFI_C_STREAM_CHUNK_SIZE bytes at a time.
+ * @note Status is copied on controller task, when it runs - see wifi_c_cmd.h. Sink gets the copy on caller's
+ * task, so slow sink doesn't delay commands queued behind.
+ *
+ * @param sink  Receiver of chunks.
+ * @param arg   Argument passed to sink.
+ *
+ * @retval ERR_C_OK on success
+ * @retval ERR_NULL_POINTER if sink is NULL
+ * @retval error returned by sink
+ */
+int wifi_c_stream_status_json(wifi_c_stream_sink_t sink, void *arg);
+#endif
+
+
+/**
+ * @brief Translate wifi_c_mode_t enum to string.
+ * 
+ * @retval "WIFI_C_MODE_AP"
+ * @retval "WIFI_C_MODE_STA"
+ * @retval "WIFI_C_MODE_APSTA"
+ * @retval NULL if wrong value was passed.
+*/
+char* wifi_c_get_wifi_mode_as_string(wifi_c_mode_t wifi_mode);
+
+#if WIFI_C_STA_ENABLED
+/**
+ * @brief Get current IPv4 address of STA interface.
+ * 
+ * @retval IPv4 address
+ * @retval 0.0.0.0 if no address was currently received
+*/
+char* wifi_c_get_sta_ipv4(void);
+#endif
+
+#if WIFI_C_AP_ENABLED
+/**
+ * @brief Get current IPv4 address of AP interface.
+ * 
+ * @retval IPv4 address
+ * @retval 0.0.0.0 if no address
+*/
+char* wifi_c_get_ap_ipv4(void);
+#endif
+
+#if WIFI_C_STA_ENABLED
+/**
+ * @brief Get SSID of access point that STA interface is connected to.
+ * 
+ * @retval SSID of access point
+ * @retval "none" if STA is not connected to any access point
+*/
+char* wifi_c_sta_get_ap_ssid(void);
+#endif
+
+#if WIFI_C_AP_ENABLED
+/**
+ * @brief Get SSID of access point interface.
+ * 
+ * @retval SSID of access point
+ * @retval "none" if AP is not started
+*/
+char* wifi_c_ap_get_ssid(void);
+#endif
+
+#if WIFI_C_AP_ENABLED && WIFI_C_JSON_ENABLED
+/**
+ * @brief Stream stations connected to AP as JSON array of MAC, IP and RSSI, chunk by chunk.
+ *
+ * @note IP is 0.0.0.0 until DHCP server assigns one to station.
+ *
+ * @param sink  Receiver of chunks.
+ * @param arg   Argument passed to sink.
+ *
+ * @retval ERR_C_OK on success
+ * @retval ERR_NULL_POINTER if sink is NULL
+ * @retval WIFI_C_ERR_WIFI_NOT_STARTED AP was not started, nothing was passed to sink.
+ * @retval esp specific error codes, nothing was passed to sink.
+ * @retval error returned by sink
+ */
+int wifi_c_stream_stations_json(wifi_c_stream_sink_t sink, void *arg);
+#endif
+
+#if WIFI_C_STA_ENABLED
+/**
+ * @brief Get Wifi STA connection status.
+ * 
+ * @retval true If STA is connected to some AP.
+ * @retval false If STA is not connected to any AP.
+ * @retval true If STA is connected to some AP.
+ * @retval false If STA is not connected to any AP.
+ */
+bool wifi_c_check_if_sta_is_connected(void);
+#endif
+
+/**
+ * @brief Initializes default event loop and sets callback functions.
+ * 
+ * @note With CONFIG_WIFI_C_PRIVATE_EVENT_LOOP callbacks are registered on private loop of controller
+ * and events of default loop are forwarded to it, see wifi_c_event_loop.h.
+ * @note Calling it again before wifi_c_deinit() does nothing, callbacks are registered once.
+ *
+ * @retval ERR_C_OK on success
+ * @retval esp specific error codes
+ * @retval ERR_C_OK on success
+ * @retval esp specific error codes
+ */
+int wifi_c_create_default_event_loop(void);
+
+#if WIFI_C_STA_ENABLED
+/**
+ * @brief Disconnect from AP as STA.
+ * 
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_WIFI_NOT_INIT
+ * @retval WIFI_C_ERR_WIFI_NOT_STARTED
+ * @retval WIFI_C_ERR_STA_NOT_STARTED
+ * @retval WIFI_C_ERR_STA_NOT_CONNECTED
+ * @retval esp specific error codes
+ */
+int wifi_c_disconnect(void);
+#endif
+
+#if WIFI_C_STA_ENABLED
+/**
+ * @brief Disconnect from sta, and try to connect with passed credentials.
+ * 
+ * @param SSID SSID to AP;
+ * @param PASSWORD Password to AP.
+ * 
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_WIFI_NOT_INIT
+ * @retval WIFI_C_ERR_WIFI_NOT_STARTED
+ * @retval WIFI_C_ERR_STA_NOT_STARTED
+ * @retval WIFI_C_ERR_STA_NOT_CONNECTED
+ * @retval esp specific error codes
+ * 
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_WIFI_NOT_INIT
+ * @retval WIFI_C_ERR_WIFI_NOT_STARTED
+ * @retval WIFI_C_ERR_STA_NOT_STARTED
+ * @retval WIFI_C_ERR_STA_NOT_CONNECTED
+ * @retval esp specific error codes
+ */
+int wifi_c_sta_reconnect(const char* SSID, const char* PASSWORD);
+#endif
+
+#if WIFI_C_SCAN_ENABLED
+/**
+ * @brief Scan for AP on all channels.
+ * 
+ * @param result_to_return Pointer to scan results struct, records point to controller buffer valid until next scan.
+ * 
+ * @attention Scanning for access points is only possible when station mode is enabled and started.
+ * @note With controller task running (wifi_c_cmd_start()), scan requested while other task's scan is in progress
+ * returns results of that scan instead of starting another one.
+ * 
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_WRONG_MODE Wrong Wifi mode, scanning only possible in STA/APSTA mode.
+ * @retval WIFI_C_ERR_WIFI_NOT_INIT WiFi was not initialized.
+ * @retval WIFI_C_ERR_STA_NOT_STARTED STA was not started.
+ * @retval ERR_NULL_POINTER Pointer to result buffer was NULL.
+ * @retval esp specific error codes
+ */
+int wifi_c_scan_all_ap(wifi_c_scan_result_t* result_to_return);
+
+/**
+ * @brief Start scan for AP on all channels, return without waiting for it to finish.
+ *
+ * @note When WIFI_C_STATE_SCAN_DONE is reached, results are taken with wifi_c_scan_get_results().
+ *
+ * @retval ERR_C_OK if scan started
+ * @retval WIFI_C_ERR_WRONG_MODE Wrong Wifi mode, scanning only possible in STA/APSTA mode.
+ * @retval WIFI_C_ERR_WIFI_NOT_INIT WiFi was not initialized.
+ * @retval WIFI_C_ERR_STA_NOT_STARTED STA was not started.
+ * @retval esp specific error codes
+ */
+int wifi_c_scan_start_async(void);
+
+/**
+ * @brief Take results of scan started with wifi_c_scan_start_async() from driver.
+ *
+ * @param result Pointer to scan results struct, records point to controller buffer valid until next scan.
+ *
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_SCAN_NOT_DONE Scan is still running or was not started.
+ * @retval ERR_NULL_POINTER Pointer to result buffer was NULL.
+ * @retval esp specific error codes
+ */
+int wifi_c_scan_get_results(wifi_c_scan_result_t* result);
+#endif
+
+#if WIFI_C_SCAN_ENABLED
+/**
+ * @brief Scan for AP with desired SSID.
+ * 
+ * @param searched_ssid SSID of AP to search for.
+ * @param ap_record     Pointer to wifi_ap_record_t to store result.
+ * 
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_AP_NOT_FOUND when not found AP
+ * @retval esp specific error codes
+ * 
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_AP_NOT_FOUND when not found AP
+ * @retval esp specific error codes
+ */
+int wifi_c_scan_for_ap_with_ssid(const char* searched_ssid, wifi_c_ap_record_t* ap_record);
+#endif
+
+#if WIFI_C_SCAN_ENABLED
+/**
+ * @brief Log results of Wifi scan.
+ * 
+ * @note It should be called only after scanning is done.
+ * 
+ */
+int wifi_c_print_scanned_ap (void);
+#endif
+
+#if WIFI_C_SCAN_ENABLED && WIFI_C_JSON_ENABLED
+/**
+ * @brief Store results of scanning in buffer as json string;
+ * 
+ * @param buffer Buffer to store scan result.
+ * @param buflen Length of the buffer.
+ * 
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_SCAN_NOT_DONE Scan not done, init scan before getting results.
+ * @retval WIFI_C_ERR_WIFI_NOT_INIT WiFi was not initialized.
+ * @retval esp specific error codes
+ * 
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_SCAN_NOT_DONE Scan not done, init scan before getting results.
+ * @retval WIFI_C_ERR_WIFI_NOT_INIT WiFi was not initialized.
+ * @retval esp specific error codes
+ */
+int wifi_c_store_scan_result_as_json (char* buffer, uint16_t buflen);
+
+/**
+ * @brief Stream results of last scan as JSON array of SSID, BSSID, channel, RSSI and auth mode, chunk by chunk.
+ *
+ * @note Unlike wifi_c_store_scan_result_as_json() it doesn't wait for scan in progress.
+ * @note Like wifi_c_stream_status_json() records are copied on controller task and passed to sink on caller's,
+ * copy of WIFI_C_DEFAULT_SCAN_SIZE records is on caller's stack.
+ *
+ * @param sink  Receiver of chunks.
+ * @param arg   Argument passed to sink.
+ *
+ * @retval ERR_C_OK on success
+ * @retval ERR_NULL_POINTER if sink is NULL
+ * @retval WIFI_C_ERR_SCAN_NOT_DONE Scan not done, nothing was passed to sink.
+ * @retval WIFI_C_ERR_WIFI_NOT_INIT WiFi was not initialized, nothing was passed to sink.
+ * @retval error returned by sink
+ */
+int wifi_c_stream_scan_json(wifi_c_stream_sink_t sink, void *arg);
+#endif
+
+/**
+ * @brief Change wifi operating mode.
+ * 
+ * @note Netifs of interfaces mode adds are created and the ones of interfaces it removes are destroyed.
+ * On error mode, interfaces and netifs stay as they were.
+ *
+ * @param mode wifi operating mode (STA, AP, APSTA)
+ * 
+ * @retval WIFI_C_ERR_WRONG_MODE If mode is the same as currently set.
+ * @retval WIFI_C_ERR_WIFI_NOT_INIT WiFi was not initialized.
+ * @retval WIFI_C_ERR_IFACE_BUSY Interface of mode is owned by other context.
+ * @retval WIFI_C_ERR_NETIF_INIT_FAILED Netif of added interface could not be created.
+ * @retval esp specific error codes
+*/
+int wifi_c_change_mode(wifi_c_mode_t mode);
+
+/**
+ * @brief Suspend and resume statistics since WiFi was initialized.
+ *
+ * @note Compare last_ip_ms with wifi_c_got_ip_last_us metric of cold start to see what resume saves.
+ */
+struct wifi_c_resume_stats_obj {
+    uint32_t suspends;                    /**< Successful wifi_c_suspend() calls. */
+    uint32_t resumes;                     /**< Resumes which got back to state before suspend. */
+    uint32_t fallbacks;                   /**< Resumes where cached BSSID failed and STA connected to any AP of SSID. */
+    uint32_t failures;                    /**< Resumes where STA didn't get IP before timeout. */
+    uint32_t last_link_ms;                /**< Last resume, time from wifi_c_resume() call to association. */
+    uint32_t last_ip_ms;                  /**< Last resume, time from wifi_c_resume() call to IP. */
+    uint32_t max_ip_ms;                   /**< Slowest resume, time from wifi_c_resume() call to IP. */
+};
+
+/**
+ * @brief Type of suspend and resume statistics.
+ *
+ */
+typedef struct wifi_c_resume_stats_obj wifi_c_resume_stats_t;
+
+/**
+ * @brief Stop radio, keeping driver, netifs, event handlers and last association.
+ *
+ * @note BSSID and channel of AP which STA is connected to are cached, so wifi_c_resume() doesn't have to scan.
+ * @note Only wifi_c_resume(), wifi_c_deinit() and getters may be called while suspended, scans fail with
+ * WIFI_C_ERR_STA_NOT_STARTED.
+ *
+ * @retval ERR_C_OK on success, also when WiFi is already suspended
+ * @retval WIFI_C_ERR_WIFI_NOT_INIT WiFi was not initialized.
+ * @retval esp specific error codes
+ */
+int wifi_c_suspend(void);
+
+/**
+ * @brief Start radio again and reconnect STA to BSSID it was connected to before wifi_c_suspend().
+ *
+ * @note AP is started with its previous settings. STA tries cached BSSID on cached channel once, then any AP of SSID.
+ * STA stays locked to cached BSSID only until next disconnect.
+ * @note Returns after STA got IP, or at once if STA was not connected before suspend. Timings are in
+ * wifi_c_get_resume_stats().
+ *
+ * @param timeout_ms    Maximum time to wait for IP, STA keeps connecting in background after it.
+ *
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_NOT_SUSPENDED WiFi was not suspended.
+ * @retval WIFI_C_ERR_STA_CONNECT_FAIL All attempts to connect failed.
+ * @retval WIFI_C_ERR_STA_TIMEOUT_EXPIRE STA didn't get IP before timeout.
+ * @retval esp specific error codes
+ */
+int wifi_c_resume(uint32_t timeout_ms);
+
+/**
+ * @brief Copy suspend and resume statistics.
+ *
+ */
+void wifi_c_get_resume_stats(wifi_c_resume_stats_t *stats);
+
+/**
+ * @brief Used to deinit wifi controller, and free all resources.
+ * 
+ * @note This function deletes default event loop, only if it was created by wifi_c_create_default_event_loop().
+ * @note With CONFIG_WIFI_C_PRIVATE_EVENT_LOOP private loop is deleted when no context uses it.
+ */
+void wifi_c_deinit(void);
+
+#if WIFI_C_STA_ENABLED
+/**
+ * @brief Register function to be called when STA connects to AP.
+ * 
+ * @note Handler is called from event loop task, unless callback worker is started - see wifi_c_worker_start().
+ * 
+ * @retval 0 on success
+ * @retval 
+*/
+int wifi_c_sta_register_connect_handler(void (*connect_handler)(void));
+
+/**
+ * @brief States which tasks can wait for - see wifi_c_wait_for().
+ *
+ * @note Values are event group bits, so states can be or-ed.
+ */
+typedef enum {
+    WIFI_C_STATE_STA_STARTED = WIFI_C_STA_STARTED_BIT,    /*STA interface started, until it's stopped*/
+    WIFI_C_STATE_STA_CONNECTED = WIFI_C_STA_LINK_UP_BIT,  /*STA associated with AP, until disconnected*/
+    WIFI_C_STATE_STA_GOT_IP = WIFI_C_CONNECTED_BIT,       /*STA got IP address, until disconnected*/
+    WIFI_C_STATE_SCAN_DONE = WIFI_C_SCAN_DONE_BIT,        /*scan finished, until next scan starts*/
+    WIFI_C_STATE_STA_CONNECT_FAILED = WIFI_C_CONNECT_FAIL_BIT, /*all connect attempts failed, until next connect starts*/
+} wifi_c_state_t;
+
+/**
+ * @brief Function called when state is reached - see wifi_c_register_state_handler().
+ *
+ * @param state State reached, single value of wifi_c_state_t.
+ * @param arg   Argument given at registration.
+ */
+typedef void (*wifi_c_state_handler_t)(wifi_c_state_t state, void *arg);
+
+/**
+ * @brief Block calling task until state holds, or return at once if it already does.
+ *
+ * @note Any number of tasks can wait at the same time, all of them are woken when state is reached.
+ * States are kept as bits, not events, so transition happening just before the call is not lost.
+ * @note When states are or-ed, all of them have to hold.
+ *
+ * @param state         State to wait for.
+ * @param timeout_ms    Maximum time to block, WIFI_C_WAIT_FOREVER to never time out.
+ *
+ * @retval ERR_C_OK if state holds
+ * @retval WIFI_C_ERR_WAIT_TIMEOUT if state was not reached in time
+ * @retval WIFI_C_ERR_WIFI_NOT_INIT Wifi was not initialized
+ */
+int wifi_c_wait_for(wifi_c_state_t state, uint32_t timeout_ms);
+
+/**
+ * @brief Register function called every time state is reached, e.g. to resume operations waiting for it.
+ *
+ * @note Handler is called from event loop task after state is already visible to wifi_c_wait_for(),
+ * it must not block. Only one handler is kept, NULL removes it.
+ *
+ * @param handler   Function to call, or NULL.
+ * @param arg       Argument passed to handler.
+ *
+ * @retval ERR_C_OK on success
+ */
+int wifi_c_register_state_handler(wifi_c_state_handler_t handler, void *arg);
+#endif
+
+#if WIFI_C_STA_ENABLED
+/**
+ * @brief Set how STA gets its IPv4 address, applied on next wifi_c_start_sta().
+ *
+ * @note In WIFI_C_STA_IP_REUSE_LEASE mode the lease is cached in RTC memory, so it survives deep sleep.
+ * While DHCP renew runs traffic pauses, connections survive when the address doesn't change.
+ * If renew gives other address, the cached one was stale or taken by other host - it's counted as conflict
+ * and connect handler is called again with the new address.
+ *
+ * @param config IPv4 settings, NULL for WIFI_C_STA_IP_CONFIG_DEFAULT().
+ *
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_IP_CONFIG_INVALID if mode is unknown, or static address or netmask is zero
+ */
+int wifi_c_sta_set_ip_config(const wifi_c_sta_ip_config_t* config);
+
+/**
+ * @brief Set radio and association settings of STA link, applied on next wifi_c_start_sta().
+ *
+ * @note Profile is applied as a whole: if driver rejects any setting, the ones already changed are restored
+ * and connect fails. Driver keeps it for reconnects and roams, and it's applied again after wifi_c_resume().
+ *
+ * @param profile Link settings, NULL for WIFI_C_STA_LINK_PROFILE_DEFAULT().
+ *
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_LINK_PROFILE_INVALID if protocol has unknown bits, HT40 is set without 11N or TX power is out of range
+ */
+int wifi_c_sta_set_link_profile(const wifi_c_sta_link_profile_t* profile);
+
+/**
+ * @brief Drop cached DHCP lease, next connect in WIFI_C_STA_IP_REUSE_LEASE mode will use DHCP.
+ *
+ */
+void wifi_c_sta_forget_lease(void);
+
+/**
+ * @brief Get number of renews which gave address different from cached lease.
+ *
+ */
+uint32_t wifi_c_sta_get_lease_conflicts(void);
+#endif
+
+#if WIFI_C_APSTA_POLICY_ENABLED
+/**
+ * @brief Set how STA connects in AP+STA mode while AP is running, applied on next wifi_c_start_sta().
+ *
+ * @note Connects with BSSID already known (wifi_c_start_sta_best_bssid(), roaming) don't scan and are not affected.
+ * @note CSA count is written to AP config by wifi_c_start_ap_with_config(), so AP started before policy change
+ * keeps the old one, setting AP config again would restart AP and drop its clients. CSA is sent only by drivers having csa_count in AP config (ESP-IDF 5.1 and later),
+ * older drivers move AP without announcing it.
+ *
+ * @param policy Connect policy, NULL for WIFI_C_APSTA_POLICY_DEFAULT().
+ *
+ * @retval ERR_C_OK on success
+ * @retval ERR_C_INVALID_ARGS if probe or off-channel time is shorter than WIFI_C_SCAN_SLICE_MIN_CHANNEL_MS
+ */
+int wifi_c_apsta_set_policy(const wifi_c_apsta_policy_t* policy);
+
+/**
+ * @brief Copy AP+STA disruption statistics, they are zeroed by wifi_c_deinit().
+ *
+ */
+void wifi_c_apsta_get_stats(wifi_c_apsta_stats_t *stats);
+#endif
\ No newline at end of file
@@ -0,0 +1,267 @@
+/**
+ * @file wifi_c_channel.c
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief AP channel congestion scoring source file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*Beginning of ESP-IDF specific code.*/
+#ifdef ESP_PLATFORM
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <string.h>
+#include "err_controller.h"
+#include "errors_list.h"
+#include "wifi_controller.h"
+#include "wifi_c_channel.h"
+#include "logger.h"
+#include "memory_utils.h"
+
+/*Scores are also used to weight BSSID selection, so they are compiled in with scanning.*/
+#if WIFI_C_SCAN_ENABLED
+/**
+ * @brief Add congestion of AP centered on channel to it and its overlapping neighbours.
+ */
+static void wifi_c_channel_add_overlap(wifi_c_channel_scores_t *scores, int center, uint32_t weight)
+{
+    for (int channel = 1; channel <= WIFI_C_CHANNEL_MAX; channel++)
+    {
+        int distance = (channel > center) ? channel - center : center - channel;
+        if (distance < WIFI_C_CHANNEL_OVERLAP)
+        {
+            scores->score[channel] += (uint32_t)(WIFI_C_CHANNEL_OVERLAP - distance) * weight;
+        }
+    }
+}
+
+void wifi_c_channel_scores_clear(wifi_c_channel_scores_t *scores)
+{
+    memutil_zero_memory(scores, sizeof(wifi_c_channel_scores_t));
+}
+
+void wifi_c_channel_scores_add(wifi_c_channel_scores_t *scores, const wifi_ap_record_t *record)
+{
+    int channel = record->primary;
+    int rssi_weight = record->rssi + 100; // -100 dBm barely counts, -30 dBm counts 70 times more
+
+    if (channel < 1 || channel > WIFI_C_CHANNEL_MAX)
+    {
+        return;
+    }
+    if (rssi_weight < 1)
+    {
+        rssi_weight = 1;
+    }
+    else if (rssi_weight > 100)
+    {
+        rssi_weight = 100;
+    }
+
+    scores->ap_count[channel]++;
+    wifi_c_channel_add_overlap(scores, channel, (uint32_t)rssi_weight);
+
+    // 40 MHz AP also occupies secondary channel, 4 channels away
+    if (record->second == WIFI_SECOND_CHAN_ABOVE)
+    {
+        wifi_c_channel_add_overlap(scores, channel + 4, (uint32_t)rssi_weight);
+    }
+    else if (record->second == WIFI_SECOND_CHAN_BELOW)
+    {
+        wifi_c_channel_add_overlap(scores, channel - 4, (uint32_t)rssi_weight);
+    }
+}
+
+uint8_t wifi_c_channel_pick_best(const wifi_c_channel_scores_t *scores, uint16_t channel_mask)
+{
+    uint8_t best = 0;
+
+    if (channel_mask == 0)
+    {
+        channel_mask = WIFI_C_CHANNEL_MASK_DEFAULT;
+    }
+
+    for (uint8_t channel = 1; channel <= WIFI_C_CHANNEL_MAX; channel++)
+    {
+        if (!(channel_mask & (1U << channel)))
+        {
+            continue;
+        }
+        if (best == 0 || scores->score[channel] < scores->score[best] ||
+            (scores->score[channel] == scores->score[best] && scores->ap_count[channel] < scores->ap_count[best]))
+        {
+            best = channel;
+        }
+    }
+    return best;
+}
+
+#if WIFI_C_AUTO_CHANNEL_ENABLED
+static struct {
+    TaskHandle_t task;
+    SemaphoreHandle_t stopped;
+    volatile bool running;
+    wifi_c_channel_monitor_config_t config;
+} wifi_c_channel_monitor = {
+    .task = NULL,
+    .stopped = NULL,
+    .running = false,
+};
+
+/**
+ * @brief Whether whole band may be measured now, sweep takes radio away from AP channel.
+ */
+static bool wifi_c_channel_may_sweep(void)
+{
+    wifi_sta_list_t stations;
+
+    switch (wifi_c_channel_monitor.config.sweep)
+    {
+    case WIFI_C_CHANNEL_SWEEP_ALWAYS:
+        return true;
+    case WIFI_C_CHANNEL_SWEEP_IDLE:
+        // without AP there are no stations to lose service
+        return esp_wifi_ap_get_sta_list(&stations) != ESP_OK || stations.num == 0;
+    default:
+        return false;
+    }
+}
+
+static void wifi_c_channel_monitor_task(void *arg)
+{
+    wifi_c_channel_scores_t scores;
+    wifi_c_channel_report_t report;
+    wifi_second_chan_t second;
+    bool sweep = false;
+    int err = ERR_C_OK;
+
+    memutil_zero_memory(&report, sizeof(report));
+
+    while (wifi_c_channel_monitor.running)
+    {
+        if (esp_wifi_get_channel(&report.channel, &second) == ESP_OK &&
+            report.channel >= 1 && report.channel <= WIFI_C_CHANNEL_MAX)
+        {
+            sweep = wifi_c_channel_may_sweep();
+            err = sweep ? wifi_c_measure_channels(&scores) : wifi_c_measure_channel(report.channel, &scores);
+        }
+        else
+        {
+            err = WIFI_C_ERR_WIFI_NOT_STARTED;
+        }
+
+        if (err == ERR_C_OK)
+        {
+            report.evaluation++;
+            report.previous_score = (report.evaluation > 1) ? report.score : scores.score[report.channel];
+            report.score = scores.score[report.channel];
+            report.ap_count = scores.ap_count[report.channel];
+            report.best_channel = sweep ? wifi_c_channel_pick_best(&scores, wifi_c_channel_monitor.config.channel_mask) : 0;
+            report.best_score = (report.best_channel != 0) ? scores.score[report.best_channel] : 0;
+
+            if (wifi_c_channel_monitor.config.report != NULL)
+            {
+                wifi_c_channel_monitor.config.report(&report, wifi_c_channel_monitor.config.arg);
+            }
+            else
+            {
+                LOG_INFO("Channel %u score %lu (was %lu, %u APs), best channel %u score %lu.",
+                         report.channel, (unsigned long)report.score, (unsigned long)report.previous_score,
+                         report.ap_count, report.best_channel, (unsigned long)report.best_score);
+            }
+        }
+
+        // woken up early by wifi_c_channel_monitor_stop()
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wifi_c_channel_monitor.config.period_ms));
+    }
+
+    wifi_c_channel_monitor.task = NULL;
+    xSemaphoreGive(wifi_c_channel_monitor.stopped);
+    vTaskDelete(NULL);
+}
+
+int wifi_c_channel_monitor_start(const wifi_c_channel_monitor_config_t *config)
+{
+    volatile err_c_t err = ERR_C_OK;
+    wifi_c_channel_monitor_config_t default_config = WIFI_C_CHANNEL_MONITOR_CONFIG_DEFAULT();
+
+    if (config == NULL)
+    {
+        config = &default_config;
+    }
+
+    Try
+    {
+        if (wifi_c_channel_monitor.task != NULL)
+        {
+            ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_CHANNEL_MONITOR_STARTED);
+        }
+
+        if (config->period_ms == 0)
+        {
+            ERR_C_SET_AND_THROW_ERR(err, ERR_C_INVALID_ARGS);
+        }
+
+        if (wifi_c_channel_monitor.stopped == NULL)
+        {
+            wifi_c_channel_monitor.stopped = xSemaphoreCreateBinary();
+            if (wifi_c_channel_monitor.stopped == NULL)
+            {
+                ERR_C_SET_AND_THROW_ERR(err, ERR_C_MEMORY_ERR);
+            }
+        }
+
+        memcpy(&wifi_c_channel_monitor.config, config, sizeof(wifi_c_channel_monitor_config_t));
+        wifi_c_channel_monitor.running = true;
+        if (xTaskCreatePinnedToCore(wifi_c_channel_monitor_task, "wifi_c_channel", config->stack_size, NULL,
+                                    config->priority, &wifi_c_channel_monitor.task, tskNO_AFFINITY) != pdPASS)
+        {
+            wifi_c_channel_monitor.running = false;
+            wifi_c_channel_monitor.task = NULL;
+            ERR_C_SET_AND_THROW_ERR(err, ERR_C_MEMORY_ERR);
+        }
+        LOG_INFO("Channel monitor started, period %lu ms.", (unsigned long)config->period_ms);
+    }
+    Catch(err)
+    {
+        switch (err)
+        {
+        case WIFI_C_ERR_CHANNEL_MONITOR_STARTED:
+            LOG_WARN("Channel monitor already started.");
+            break;
+        case ERR_C_INVALID_ARGS:
+            LOG_ERROR("Period of channel monitor cannot be zero.");
+            break;
+        case ERR_C_MEMORY_ERR:
+            LOG_ERROR("Memory allocation was not successful");
+            break;
+        default:
+            LOG_ERROR("Error when starting channel monitor: %d", err);
+            break;
+        }
+    }
+    return err;
+}
+
+void wifi_c_channel_monitor_stop(void)
+{
+    TaskHandle_t task = wifi_c_channel_monitor.task;
+
+    if (task == NULL)
+    {
+        return;
+    }
+
+    wifi_c_channel_monitor.running = false;
+    xTaskNotifyGive(task);
+    xSemaphoreTake(wifi_c_channel_monitor.stopped, portMAX_DELAY);
+    LOG_DEBUG("Channel monitor stopped.");
+}
+#endif // WIFI_C_AUTO_CHANNEL_ENABLED
+#endif // WIFI_C_SCAN_ENABLED
+#endif // ESP_PLATFORM
@@ -0,0 +1,332 @@
+/**
+ * @file wifi_c_cmd.c
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief Serialized API command queue source file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*Beginning of ESP-IDF specific code.*/
+#ifdef ESP_PLATFORM
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include <string.h>
+#include "err_controller.h"
+#include "errors_list.h"
+#include "wifi_controller.h"
+#include "wifi_c_cmd.h"
+#include "wifi_c_heap.h"
+#include "logger.h"
+
+/**
+ * @brief Command waiting for controller task, lives on stack of caller until done is given.
+ */
+struct wifi_c_cmd_obj {
+    wifi_c_cmd_id_t id;
+    wifi_c_cmd_run_t run;
+    wifi_c_cmd_share_t share;
+    void *args;
+    int result;
+    int64_t queued_us;
+    SemaphoreHandle_t done;
+    StaticSemaphore_t done_buffer;
+};
+
+static const char *const wifi_c_cmd_names[WIFI_C_CMD_COUNT] = {
+    [WIFI_C_CMD_INIT_WIFI] = "init_wifi",
+    [WIFI_C_CMD_START_AP] = "start_ap",
+    [WIFI_C_CMD_START_STA] = "start_sta",
+    [WIFI_C_CMD_START_STA_BEST_BSSID] = "start_sta_best_bssid",
+    [WIFI_C_CMD_START_STA_ASYNC] = "start_sta_async",
+    [WIFI_C_CMD_DISCONNECT] = "disconnect",
+    [WIFI_C_CMD_SCAN_ALL_AP] = "scan_all_ap",
+    [WIFI_C_CMD_SCAN_FILTERED] = "scan_filtered",
+    [WIFI_C_CMD_SCAN_SLICED] = "scan_sliced",
+    [WIFI_C_CMD_SCAN_START] = "scan_start",
+    [WIFI_C_CMD_SCAN_RESULTS] = "scan_results",
+    [WIFI_C_CMD_STATUS] = "status",
+    [WIFI_C_CMD_MEASURE_CHANNELS] = "measure_channels",
+    [WIFI_C_CMD_START_AP_AUTO_CHANNEL] = "start_ap_auto_channel",
+    [WIFI_C_CMD_ROAM_TO] = "roam_to",
+    [WIFI_C_CMD_SUSPEND] = "suspend",
+    [WIFI_C_CMD_RESUME] = "resume",
+    [WIFI_C_CMD_CHANGE_MODE] = "change_mode",
+    [WIFI_C_CMD_DEINIT] = "deinit",
+};
+
+static struct {
+    QueueHandle_t queue;
+    uint16_t queue_length;
+    TaskHandle_t task;                      // set until task has exited, callers queue while it is set
+    SemaphoreHandle_t stopped;
+    uint16_t senders;                       // callers between check of task and end of send
+    uint16_t queue_max_depth;
+    wifi_c_cmd_latency_t latency[WIFI_C_CMD_COUNT];
+    portMUX_TYPE lock;
+} wifi_c_cmd = {
+    .queue = NULL,
+    .task = NULL,
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+static void wifi_c_cmd_account(wifi_c_cmd_id_t id, int64_t wait_us, int64_t run_us, bool coalesced)
+{
+    wifi_c_cmd_latency_t *latency = &wifi_c_cmd.latency[id];
+
+    portENTER_CRITICAL(&wifi_c_cmd.lock);
+    latency->calls++;
+    latency->coalesced += coalesced ? 1 : 0;
+    latency->wait_us += (uint64_t)wait_us;
+    latency->run_us += (uint64_t)run_us;
+    if (wait_us > latency->max_wait_us)
+    {
+        latency->max_wait_us = (wait_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)wait_us;
+    }
+    if (run_us > latency->max_run_us)
+    {
+        latency->max_run_us = (run_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)run_us;
+    }
+    portEXIT_CRITICAL(&wifi_c_cmd.lock);
+}
+
+/**
+ * @brief Run command and answer the same commands which arrived meanwhile, then release callers.
+ */
+static void wifi_c_cmd_execute(struct wifi_c_cmd_obj *cmd)
+{
+    struct wifi_c_cmd_obj *waiting = NULL;
+    int64_t start_us = esp_timer_get_time();
+    int64_t end_us = 0;
+
+    WIFI_C_HEAP_AUDIT_ENTER((wifi_c_heap_site_t)cmd->id);
+    cmd->result = cmd->run(cmd->args);
+    WIFI_C_HEAP_AUDIT_EXIT();
+    end_us = esp_timer_get_time();
+    wifi_c_cmd_account(cmd->id, start_us - cmd->queued_us, end_us - start_us, false);
+
+    // only front of queue, so commands still run in order of arrival
+    while (cmd->share != NULL && xQueuePeek(wifi_c_cmd.queue, &waiting, 0) == pdTRUE && waiting != NULL &&
+           waiting->id == cmd->id && waiting->queued_us >= start_us)
+    {
+        xQueueReceive(wifi_c_cmd.queue, &waiting, 0);
+        cmd->share(cmd->args, waiting->args);
+        waiting->result = cmd->result;
+        wifi_c_cmd_account(waiting->id, end_us - waiting->queued_us, 0, true);
+        xSemaphoreGive(waiting->done);
+    }
+
+    // args of cmd are read by share, caller may return only now
+    xSemaphoreGive(cmd->done);
+}
+
+static void wifi_c_cmd_task(void *arg)
+{
+    struct wifi_c_cmd_obj *cmd = NULL;
+
+    for (;;)
+    {
+        if (xQueueReceive(wifi_c_cmd.queue, &cmd, portMAX_DELAY) != pdTRUE)
+        {
+            continue;
+        }
+        if (cmd == NULL)
+        {
+            break; // stop requested, all commands queued before were already run
+        }
+        wifi_c_cmd_execute(cmd);
+    }
+
+    // callers keep queueing until task is cleared, so API calls never run next to a queued one
+    for (;;)
+    {
+        bool idle = false;
+
+        if (xQueueReceive(wifi_c_cmd.queue, &cmd, 1) == pdTRUE)
+        {
+            if (cmd != NULL)
+            {
+                wifi_c_cmd_execute(cmd);
+            }
+            continue;
+        }
+
+        // senders finished their send and queue is empty, next caller runs directly
+        portENTER_CRITICAL(&wifi_c_cmd.lock);
+        idle = wifi_c_cmd.senders == 0 && uxQueueMessagesWaiting(wifi_c_cmd.queue) == 0;
+        if (idle)
+        {
+            wifi_c_cmd.task = NULL;
+        }
+        portEXIT_CRITICAL(&wifi_c_cmd.lock);
+        if (idle)
+        {
+            break;
+        }
+    }
+
+    xSemaphoreGive(wifi_c_cmd.stopped);
+    vTaskDelete(NULL);
+}
+
+int wifi_c_cmd_start(const wifi_c_cmd_config_t *config)
+{
+    volatile err_c_t err = ERR_C_OK;
+    wifi_c_cmd_config_t default_config = WIFI_C_CMD_CONFIG_DEFAULT();
+
+    if (config == NULL)
+    {
+        config = &default_config;
+    }
+
+    Try
+    {
+        if (wifi_c_cmd.task != NULL)
+        {
+            ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_CMD_QUEUE_STARTED);
+        }
+
+        if (config->queue_length == 0 || (wifi_c_cmd.queue != NULL && config->queue_length != wifi_c_cmd.queue_length))
+        {
+            ERR_C_SET_AND_THROW_ERR(err, ERR_C_INVALID_ARGS);
+        }
+
+        if (wifi_c_cmd.queue == NULL)
+        {
+            wifi_c_cmd.queue = xQueueCreate(config->queue_length, sizeof(struct wifi_c_cmd_obj *));
+            wifi_c_cmd.stopped = xSemaphoreCreateBinary();
+            if (wifi_c_cmd.queue == NULL || wifi_c_cmd.stopped == NULL)
+            {
+                ERR_C_SET_AND_THROW_ERR(err, ERR_C_MEMORY_ERR);
+            }
+            wifi_c_cmd.queue_length = config->queue_length;
+        }
+
+        if (xTaskCreatePinnedToCore(wifi_c_cmd_task, "wifi_c_cmd", config->stack_size, NULL,
+                                    config->priority, &wifi_c_cmd.task, config->core_id) != pdPASS)
+        {
+            wifi_c_cmd.task = NULL;
+            ERR_C_SET_AND_THROW_ERR(err, ERR_C_MEMORY_ERR);
+        }
+        LOG_INFO("Controller task started, priority %u, queue length %u.", config->priority, config->queue_length);
+    }
+    Catch(err)
+    {
+        switch (err)
+        {
+        case WIFI_C_ERR_CMD_QUEUE_STARTED:
+            LOG_WARN("Controller task already started.");
+            break;
+        case ERR_C_INVALID_ARGS:
+            LOG_ERROR("Wrong length of command queue.");
+            break;
+        case ERR_C_MEMORY_ERR:
+            LOG_ERROR("Memory allocation was not successful");
+            break;
+        default:
+            LOG_ERROR("Error when starting controller task: %d", err);
+            break;
+        }
+    }
+    return err;
+}
+
+void wifi_c_cmd_stop(void)
+{
+    struct wifi_c_cmd_obj *stop = NULL;
+
+    if (wifi_c_cmd.task == NULL)
+    {
+        return;
+    }
+    if (xTaskGetCurrentTaskHandle() == wifi_c_cmd.task)
+    {
+        LOG_ERROR("Controller task cannot be stopped from command it runs.");
+        return;
+    }
+
+    // commands queued before and while task stops run on it, calls run directly only after it exited
+    xQueueSend(wifi_c_cmd.queue, &stop, portMAX_DELAY);
+    xSemaphoreTake(wifi_c_cmd.stopped, portMAX_DELAY);
+    LOG_DEBUG("Controller task stopped.");
+}
+
+int wifi_c_cmd_call(wifi_c_cmd_id_t id, wifi_c_cmd_run_t run, wifi_c_cmd_share_t share, void *args)
+{
+    struct wifi_c_cmd_obj cmd = {
+        .id = id,
+        .run = run,
+        .share = share,
+        .args = args,
+        .result = ERR_C_OK,
+    };
+    struct wifi_c_cmd_obj *queued = &cmd;
+    uint16_t depth = 0;
+    bool queue = false;
+
+    // counted as sender under lock, so task stopping meanwhile still takes this command
+    portENTER_CRITICAL(&wifi_c_cmd.lock);
+    queue = wifi_c_cmd.task != NULL && xTaskGetCurrentTaskHandle() != wifi_c_cmd.task;
+    wifi_c_cmd.senders += queue ? 1 : 0;
+    portEXIT_CRITICAL(&wifi_c_cmd.lock);
+
+    if (!queue)
+    {
+        int64_t start_us = esp_timer_get_time();
+
+        WIFI_C_HEAP_AUDIT_ENTER((wifi_c_heap_site_t)id);
+        cmd.result = run(args);
+        WIFI_C_HEAP_AUDIT_EXIT();
+        wifi_c_cmd_account(id, 0, esp_timer_get_time() - start_us, false);
+        return cmd.result;
+    }
+
+    // semaphore on stack, commands don't allocate
+    cmd.done = xSemaphoreCreateBinaryStatic(&cmd.done_buffer);
+    cmd.queued_us = esp_timer_get_time();
+    xQueueSend(wifi_c_cmd.queue, &queued, portMAX_DELAY);
+
+    depth = (uint16_t)uxQueueMessagesWaiting(wifi_c_cmd.queue);
+    portENTER_CRITICAL(&wifi_c_cmd.lock);
+    wifi_c_cmd.senders--;
+    if (depth > wifi_c_cmd.queue_max_depth)
+    {
+        wifi_c_cmd.queue_max_depth = depth;
+    }
+    portEXIT_CRITICAL(&wifi_c_cmd.lock);
+
+    xSemaphoreTake(cmd.done, portMAX_DELAY);
+    return cmd.result;
+}
+
+int wifi_c_cmd_get_stats(wifi_c_cmd_stats_t *stats)
+{
+    ERR_C_CHECK_NULL_PTR(stats, LOG_ERROR("pointer to store command statistics cannot be NULL"));
+
+    portENTER_CRITICAL(&wifi_c_cmd.lock);
+    memcpy(stats->commands, wifi_c_cmd.latency, sizeof(stats->commands));
+    stats->queue_max_depth = wifi_c_cmd.queue_max_depth;
+    portEXIT_CRITICAL(&wifi_c_cmd.lock);
+    stats->queue_depth = (wifi_c_cmd.queue != NULL) ? (uint16_t)uxQueueMessagesWaiting(wifi_c_cmd.queue) : 0;
+    return ERR_C_OK;
+}
+
+void wifi_c_cmd_reset_stats(void)
+{
+    portENTER_CRITICAL(&wifi_c_cmd.lock);
+    memset(wifi_c_cmd.latency, 0, sizeof(wifi_c_cmd.latency));
+    wifi_c_cmd.queue_max_depth = 0;
+    portEXIT_CRITICAL(&wifi_c_cmd.lock);
+}
+
+const char *wifi_c_cmd_name(wifi_c_cmd_id_t id)
+{
+    return ((unsigned)id < WIFI_C_CMD_COUNT) ? wifi_c_cmd_names[id] : "unknown";
+}
+#endif // ESP_PLATFORM
@@ -0,0 +1,850 @@
+/**
+ * @file wifi_c_config.c
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief JSON provisioning config parser source file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*Beginning of ESP-IDF specific code.*/
+#ifdef ESP_PLATFORM
+
+#include <string.h>
+#include "err_controller.h"
+#include "errors_list.h"
+#include "wifi_controller.h"
+#include "wifi_c_config.h"
+#include "logger.h"
+
+/**
+ * @brief Cursor over document being parsed, parsing stops at first error.
+ */
+struct wifi_c_json_obj {
+    char *start;
+    char *pos;
+    char *end;
+    const char *reason;                     // first error, NULL while document is valid
+    char *error_pos;
+};
+
+typedef struct wifi_c_json_obj wifi_c_json_t;
+
+static bool wifi_c_json_fail_at(wifi_c_json_t *json, char *at, const char *reason)
+{
+    if (json->reason == NULL)
+    {
+        json->reason = reason;
+        json->error_pos = at;
+    }
+    return false;
+}
+
+static bool wifi_c_json_fail(wifi_c_json_t *json, const char *reason)
+{
+    return wifi_c_json_fail_at(json, json->pos, reason);
+}
+
+static void wifi_c_json_skip_ws(wifi_c_json_t *json)
+{
+    while (json->pos < json->end &&
+           (*json->pos == ' ' || *json->pos == '\t' || *json->pos == '\n' || *json->pos == '\r'))
+    {
+        json->pos++;
+    }
+}
+
+/**
+ * @brief Consume character if it's next one after whitespace.
+ */
+static bool wifi_c_json_accept(wifi_c_json_t *json, char c)
+{
+    wifi_c_json_skip_ws(json);
+    if (json->pos < json->end && *json->pos == c)
+    {
+        json->pos++;
+        return true;
+    }
+    return false;
+}
+
+static bool wifi_c_json_expect(wifi_c_json_t *json, char c, const char *reason)
+{
+    return wifi_c_json_accept(json, c) || wifi_c_json_fail(json, reason);
+}
+
+static bool wifi_c_json_literal(wifi_c_json_t *json, const char *word)
+{
+    size_t len = strlen(word);
+
+    wifi_c_json_skip_ws(json);
+    if ((size_t)(json->end - json->pos) >= len && memcmp(json->pos, word, len) == 0)
+    {
+        json->pos += len;
+        return true;
+    }
+    return false;
+}
+
+static bool wifi_c_json_hex4(wifi_c_json_t *json, uint32_t *value)
+{
+    *value = 0;
+    if (json->end - json->pos < 4)
+    {
+        return wifi_c_json_fail(json, "truncated \\u escape");
+    }
+    for (int i = 0; i < 4; i++, json->pos++)
+    {
+        char c = *json->pos;
+        uint32_t digit = (c >= '0' && c <= '9') ? (uint32_t)(c - '0') :
+                         (c >= 'a' && c <= 'f') ? (uint32_t)(c - 'a' + 10) :
+                         (c >= 'A' && c <= 'F') ? (uint32_t)(c - 'A' + 10) : 16;
+        if (digit == 16)
+        {
+            return wifi_c_json_fail(json, "hex digit expected in \\u escape");
+        }
+        *value = (*value << 4) | digit;
+    }
+    return true;
+}
+
+/**
+ * @brief Decode \\u escape, with surrogate pair, as UTF-8 at write, which can't overtake read position.
+ */
+static bool wifi_c_json_unicode(wifi_c_json_t *json, char **write)
+{
+    uint32_t cp = 0;
+    uint32_t low = 0;
+    unsigned char *out = (unsigned char *)*write;
+
+    if (!wifi_c_json_hex4(json, &cp))
+    {
+        return false;
+    }
+    if (cp >= 0xD800 && cp <= 0xDBFF)
+    {
+        if (json->end - json->pos < 2 || json->pos[0] != '\\' || json->pos[1] != 'u')
+        {
+            return wifi_c_json_fail(json, "unpaired surrogate in string");
+        }
+        json->pos += 2;
+        if (!wifi_c_json_hex4(json, &low))
+        {
+            return false;
+        }
+        if (low < 0xDC00 || low > 0xDFFF)
+        {
+            return wifi_c_json_fail(json, "unpaired surrogate in string");
+        }
+        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+    }
+    else if (cp >= 0xDC00 && cp <= 0xDFFF)
+    {
+        return wifi_c_json_fail(json, "unpaired surrogate in string");
+    }
+    if (cp == 0)
+    {
+        return wifi_c_json_fail(json, "NUL character in string");
+    }
+
+    if (cp < 0x80)
+    {
+        *out++ = (unsigned char)cp;
+    }
+    else if (cp < 0x800)
+    {
+        *out++ = (unsigned char)(0xC0 | (cp >> 6));
+        *out++ = (unsigned char)(0x80 | (cp & 0x3F));
+    }
+    else if (cp < 0x10000)
+    {
+        *out++ = (unsigned char)(0xE0 | (cp >> 12));
+        *out++ = (unsigned char)(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = (unsigned char)(0x80 | (cp & 0x3F));
+    }
+    else
+    {
+        *out++ = (unsigned char)(0xF0 | (cp >> 18));
+        *out++ = (unsigned char)(0x80 | ((cp >> 12) & 0x3F));
+        *out++ = (unsigned char)(0x80 | ((cp >> 6) & 0x3F));
+        *out++ = (unsigned char)(0x80 | (cp & 0x3F));
+    }
+    *write = (char *)out;
+    return true;
+}
+
+/**
+ * @brief Read string, unescape and terminate it in place, escaped text is never shorter than decoded one.
+ */
+static bool wifi_c_json_string(wifi_c_json_t *json, char **str, size_t *len)
+{
+    char *write = NULL;
+
+    if (!wifi_c_json_expect(json, '"', "string expected"))
+    {
+        return false;
+    }
+    write = json->pos;
+    *str = write;
+
+    while (json->pos < json->end && *json->pos != '"')
+    {
+        char c = *json->pos++;
+
+        if ((unsigned char)c < 0x20)
+        {
+            return wifi_c_json_fail_at(json, json->pos - 1, "control character in string");
+        }
+        if (c != '\\')
+        {
+            *write++ = c;
+            continue;
+        }
+        if (json->pos >= json->end)
+        {
+            break;
+        }
+        switch (*json->pos++)
+        {
+        case '"':
+            *write++ = '"';
+            break;
+        case '\\':
+            *write++ = '\\';
+            break;
+        case '/':
+            *write++ = '/';
+            break;
+        case 'b':
+            *write++ = '\b';
+            break;
+        case 'f':
+            *write++ = '\f';
+            break;
+        case 'n':
+            *write++ = '\n';
+            break;
+        case 'r':
+            *write++ = '\r';
+            break;
+        case 't':
+            *write++ = '\t';
+            break;
+        case 'u':
+            if (!wifi_c_json_unicode(json, &write))
+            {
+                return false;
+            }
+            break;
+        default:
+            return wifi_c_json_fail_at(json, json->pos - 2, "unknown escape in string");
+        }
+    }
+    if (json->pos >= json->end)
+    {
+        return wifi_c_json_fail(json, "unterminated string");
+    }
+    json->pos++;
+    *len = (size_t)(write - *str);
+    *write = '\0'; // at most at closing quote, which was already read
+    return true;
+}
+
+static bool wifi_c_json_integer(wifi_c_json_t *json, long *value)
+{
+    bool negative = false;
+    char *digits = NULL;
+
+    *value = 0;
+    wifi_c_json_skip_ws(json);
+    if (json->pos < json->end && *json->pos == '-')
+    {
+        negative = true;
+        json->pos++;
+    }
+    digits = json->pos;
+    while (json->pos < json->end && *json->pos >= '0' && *json->pos <= '9')
+    {
+        if (*value > 1000000)
+        {
+            return wifi_c_json_fail_at(json, digits, "number out of range");
+        }
+        *value = *value * 10 + (*json->pos++ - '0');
+    }
+    if (json->pos == digits)
+    {
+        return wifi_c_json_fail(json, "number expected");
+    }
+    if (json->pos < json->end && (*json->pos == '.' || *json->pos == 'e' || *json->pos == 'E'))
+    {
+        return wifi_c_json_fail_at(json, digits, "integer expected");
+    }
+    *value = negative ? -*value : *value;
+    return true;
+}
+
+static bool wifi_c_json_range(wifi_c_json_t *json, long min, long max, long *value)
+{
+    char *at = NULL;
+
+    wifi_c_json_skip_ws(json);
+    at = json->pos;
+    if (!wifi_c_json_integer(json, value))
+    {
+        return false;
+    }
+    return (*value >= min && *value <= max) || wifi_c_json_fail_at(json, at, "number out of range");
+}
+
+static bool wifi_c_json_bool(wifi_c_json_t *json, bool *value)
+{
+    if (wifi_c_json_literal(json, "true"))
+    {
+        *value = true;
+        return true;
+    }
+    if (wifi_c_json_literal(json, "false"))
+    {
+        *value = false;
+        return true;
+    }
+    return wifi_c_json_fail(json, "true or false expected");
+}
+
+/**
+ * @brief Skip value of member config doesn't know, so newer documents still parse.
+ */
+static bool wifi_c_json_skip(wifi_c_json_t *json, uint8_t depth)
+{
+    char *str = NULL;
+    size_t len = 0;
+    char *number = NULL;
+
+    if (depth > WIFI_C_CONFIG_MAX_DEPTH)
+    {
+        return wifi_c_json_fail(json, "document nested too deep");
+    }
+    wifi_c_json_skip_ws(json);
+    if (json->pos >= json->end)
+    {
+        return wifi_c_json_fail(json, "value expected");
+    }
+
+    switch (*json->pos)
+    {
+    case '"':
+        return wifi_c_json_string(json, &str, &len);
+    case '{':
+        json->pos++;
+        if (wifi_c_json_accept(json, '}'))
+        {
+            return true;
+        }
+        do
+        {
+            if (!wifi_c_json_string(json, &str, &len) || !wifi_c_json_expect(json, ':', "':' expected") ||
+                !wifi_c_json_skip(json, depth + 1))
+            {
+                return false;
+            }
+        } while (wifi_c_json_accept(json, ','));
+        return wifi_c_json_expect(json, '}', "',' or '}' expected");
+    case '[':
+        json->pos++;
+        if (wifi_c_json_accept(json, ']'))
+        {
+            return true;
+        }
+        do
+        {
+            if (!wifi_c_json_skip(json, depth + 1))
+            {
+                return false;
+            }
+        } while (wifi_c_json_accept(json, ','));
+        return wifi_c_json_expect(json, ']', "',' or ']' expected");
+    default:
+        if (wifi_c_json_literal(json, "true") || wifi_c_json_literal(json, "false") || wifi_c_json_literal(json, "null"))
+        {
+            return true;
+        }
+        number = json->pos;
+        while (json->pos < json->end && strchr("+-0123456789.eE", *json->pos) != NULL && *json->pos != '\0')
+        {
+            json->pos++;
+        }
+        return (json->pos != number) || wifi_c_json_fail(json, "value expected");
+    }
+}
+
+/**
+ * @brief Read SSID and check it has 1-32 bytes.
+ */
+static bool wifi_c_config_ssid(wifi_c_json_t *json, const char **ssid)
+{
+    char *str = NULL;
+    size_t len = 0;
+    char *at = NULL;
+
+    wifi_c_json_skip_ws(json);
+    at = json->pos;
+    if (!wifi_c_json_string(json, &str, &len))
+    {
+        return false;
+    }
+    if (len == 0)
+    {
+        return wifi_c_json_fail_at(json, at, "SSID is empty");
+    }
+    if (len > 32)
+    {
+        return wifi_c_json_fail_at(json, at, "SSID longer than 32 bytes");
+    }
+    *ssid = str;
+    return true;
+}
+
+/**
+ * @brief Read password, empty for open network, 8-63 characters, or 64 hex digits of PSK when allowed.
+ */
+static bool wifi_c_config_password(wifi_c_json_t *json, bool psk_allowed, const char **password)
+{
+    char *str = NULL;
+    size_t len = 0;
+    char *at = NULL;
+
+    wifi_c_json_skip_ws(json);
+    at = json->pos;
+    if (!wifi_c_json_string(json, &str, &len))
+    {
+        return false;
+    }
+    if (len > 0 && len < 8)
+    {
+        return wifi_c_json_fail_at(json, at, "password shorter than 8 characters");
+    }
+    if (len == 64 && psk_allowed)
+    {
+        for (size_t i = 0; i < len; i++)
+        {
+            if (strchr("0123456789abcdefABCDEF", str[i]) == NULL)
+            {
+                return wifi_c_json_fail_at(json, at, "64 character password must be hex PSK");
+            }
+        }
+    }
+    else if (len > 63)
+    {
+        return wifi_c_json_fail_at(json, at, "password longer than 63 characters");
+    }
+    *password = str;
+    return true;
+}
+
+#if WIFI_C_STA_ENABLED
+static bool wifi_c_config_network(wifi_c_json_t *json, wifi_c_config_t *config)
+{
+    wifi_c_config_network_t *network = NULL;
+    char *key = NULL;
+    size_t len = 0;
+    bool ok = true;
+
+    wifi_c_json_skip_ws(json);
+    if (config->network_count >= WIFI_C_CONFIG_MAX_NETWORKS)
+    {
+        return wifi_c_json_fail(json, "too many STA networks");
+    }
+    network = &config->networks[config->network_count];
+    network->ssid = NULL;
+    network->password = "";
+
+    if (!wifi_c_json_expect(json, '{', "STA network object expected"))
+    {
+        return false;
+    }
+    if (!wifi_c_json_accept(json, '}'))
+    {
+        do
+        {
+            if (!wifi_c_json_string(json, &key, &len) || !wifi_c_json_expect(json, ':', "':' expected"))
+            {
+                return false;
+            }
+            if (strcmp(key, "ssid") == 0)
+            {
+                ok = wifi_c_config_ssid(json, &network->ssid);
+            }
+            else if (strcmp(key, "password") == 0)
+            {
+                ok = wifi_c_config_password(json, true, &network->password);
+            }
+            else
+            {
+                ok = wifi_c_json_skip(json, 2);
+            }
+            if (!ok)
+            {
+                return false;
+            }
+        } while (wifi_c_json_accept(json, ','));
+        if (!wifi_c_json_expect(json, '}', "',' or '}' expected"))
+        {
+            return false;
+        }
+    }
+    if (network->ssid == NULL)
+    {
+        return wifi_c_json_fail(json, "STA network without SSID");
+    }
+    config->network_count++;
+    return true;
+}
+
+/**
+ * @brief Read STA networks, given as array or as one object.
+ */
+static bool wifi_c_config_sta(wifi_c_json_t *json, wifi_c_config_t *config)
+{
+    if (!wifi_c_json_accept(json, '['))
+    {
+        return wifi_c_config_network(json, config);
+    }
+    if (wifi_c_json_accept(json, ']'))
+    {
+        return true;
+    }
+    do
+    {
+        if (!wifi_c_config_network(json, config))
+        {
+            return false;
+        }
+    } while (wifi_c_json_accept(json, ','));
+    return wifi_c_json_expect(json, ']', "',' or ']' expected");
+}
+#endif
+
+#if WIFI_C_AP_ENABLED
+static bool wifi_c_config_authmode(wifi_c_json_t *json, wifi_auth_mode_t *authmode)
+{
+    static const struct {
+        const char *name;
+        wifi_auth_mode_t mode;
+    } modes[] = {
+        {"wpa2", WIFI_AUTH_WPA2_PSK},
+        {"wpa3", WIFI_AUTH_WPA3_PSK},
+        {"wpa2_wpa3", WIFI_AUTH_WPA2_WPA3_PSK},
+        {"wpa_wpa2", WIFI_AUTH_WPA_WPA2_PSK},
+    };
+    char *str = NULL;
+    size_t len = 0;
+    char *at = NULL;
+
+    wifi_c_json_skip_ws(json);
+    at = json->pos;
+    if (!wifi_c_json_string(json, &str, &len))
+    {
+        return false;
+    }
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++)
+    {
+        if (strcmp(str, modes[i].name) == 0)
+        {
+            *authmode = modes[i].mode;
+            return true;
+        }
+    }
+    return wifi_c_json_fail_at(json, at, "unknown authmode, use wpa2, wpa3, wpa2_wpa3 or wpa_wpa2");
+}
+
+static bool wifi_c_config_ap(wifi_c_json_t *json, wifi_c_config_t *config)
+{
+    wifi_c_ap_config_t *ap = &config->ap;
+    char *key = NULL;
+    size_t len = 0;
+    long value = 0;
+    bool ok = true;
+    char *at = NULL;
+
+    if (!wifi_c_json_expect(json, '{', "AP object expected"))
+    {
+        return false;
+    }
+    if (!wifi_c_json_accept(json, '}'))
+    {
+        do
+        {
+            if (!wifi_c_json_string(json, &key, &len) || !wifi_c_json_expect(json, ':', "':' expected"))
+            {
+                return false;
+            }
+            if (strcmp(key, "ssid") == 0)
+            {
+                ok = wifi_c_config_ssid(json, &ap->ssid);
+            }
+            else if (strcmp(key, "password") == 0)
+            {
+                ok = wifi_c_config_password(json, false, &ap->password);
+            }
+            else if (strcmp(key, "channel") == 0)
+            {
+                ok = wifi_c_json_range(json, 0, WIFI_C_AP_CHANNEL_MAX, &value);
+                ap->channel = (uint8_t)value;
+            }
+            else if (strcmp(key, "bandwidth") == 0)
+            {
+                wifi_c_json_skip_ws(json);
+                at = json->pos;
+                ok = wifi_c_json_integer(json, &value) &&
+                     ((value == 20 || value == 40) || wifi_c_json_fail_at(json, at, "bandwidth must be 20 or 40"));
+                ap->bandwidth = (value == 40) ? WIFI_BW_HT40 : WIFI_BW_HT20;
+            }
+            else if (strcmp(key, "authmode") == 0)
+            {
+                ok = wifi_c_config_authmode(json, &ap->authmode);
+            }
+            else if (strcmp(key, "pmf_required") == 0)
+            {
+                ok = wifi_c_json_bool(json, &ap->pmf_required);
+            }
+            else if (strcmp(key, "max_connection") == 0)
+            {
+                ok = wifi_c_json_range(json, 1, ESP_WIFI_MAX_CONN_NUM, &value);
+                ap->max_connection = (uint8_t)value;
+            }
+            else if (strcmp(key, "beacon_interval") == 0)
+            {
+                ok = wifi_c_json_range(json, 100, 60000, &value);
+                ap->beacon_interval = (uint16_t)value;
+            }
+            else if (strcmp(key, "dtim_period") == 0)
+            {
+                ok = wifi_c_json_range(json, 1, 10, &value);
+                ap->dtim_period = (uint8_t)value;
+            }
+            else
+            {
+                ok = wifi_c_json_skip(json, 2);
+            }
+            if (!ok)
+            {
+                return false;
+            }
+        } while (wifi_c_json_accept(json, ','));
+        if (!wifi_c_json_expect(json, '}', "',' or '}' expected"))
+        {
+            return false;
+        }
+    }
+    if (ap->ssid == NULL)
+    {
+        return wifi_c_json_fail(json, "AP without SSID");
+    }
+    return true;
+}
+#endif
+
+static bool wifi_c_config_mode(wifi_c_json_t *json, wifi_c_mode_t *mode)
+{
+    char *str = NULL;
+    size_t len = 0;
+    char *at = NULL;
+
+    wifi_c_json_skip_ws(json);
+    at = json->pos;
+    if (!wifi_c_json_string(json, &str, &len))
+    {
+        return false;
+    }
+    if (strcmp(str, "sta") == 0 && WIFI_C_STA_ENABLED)
+    {
+        *mode = WIFI_C_MODE_STA;
+    }
+    else if (strcmp(str, "ap") == 0 && WIFI_C_AP_ENABLED)
+    {
+        *mode = WIFI_C_MODE_AP;
+    }
+    else if (strcmp(str, "apsta") == 0 && WIFI_C_STA_ENABLED && WIFI_C_AP_ENABLED)
+    {
+        *mode = WIFI_C_MODE_APSTA;
+    }
+    else
+    {
+        return wifi_c_json_fail_at(json, at, "mode unknown or not compiled in");
+    }
+    return true;
+}
+
+/**
+ * @brief Derive mode from roles present, or check that given mode has its roles configured.
+ */
+static bool wifi_c_config_check_mode(wifi_c_json_t *json, wifi_c_config_t *config)
+{
+    bool sta = false;
+    bool ap = false;
+
+#if WIFI_C_STA_ENABLED
+    sta = (config->network_count > 0);
+#endif
+#if WIFI_C_AP_ENABLED
+    ap = (config->ap.ssid != NULL);
+#endif
+
+    if (config->mode == WIFI_C_NO_MODE)
+    {
+        if (!sta && !ap)
+        {
+            return wifi_c_json_fail_at(json, json->start, "no STA network or AP in document");
+        }
+        config->mode = (sta && ap) ? WIFI_C_MODE_APSTA : (ap ? WIFI_C_MODE_AP : WIFI_C_MODE_STA);
+        return true;
+    }
+    if ((config->mode == WIFI_C_MODE_STA || config->mode == WIFI_C_MODE_APSTA) && !sta)
+    {
+        return wifi_c_json_fail_at(json, json->start, "mode needs STA network");
+    }
+    if ((config->mode == WIFI_C_MODE_AP || config->mode == WIFI_C_MODE_APSTA) && !ap)
+    {
+        return wifi_c_json_fail_at(json, json->start, "mode needs AP settings");
+    }
+    return true;
+}
+
+static bool wifi_c_config_document(wifi_c_json_t *json, wifi_c_config_t *config)
+{
+    char *key = NULL;
+    size_t len = 0;
+    bool ok = true;
+
+    if (!wifi_c_json_expect(json, '{', "document must be JSON object"))
+    {
+        return false;
+    }
+    if (!wifi_c_json_accept(json, '}'))
+    {
+        do
+        {
+            if (!wifi_c_json_string(json, &key, &len) || !wifi_c_json_expect(json, ':', "':' expected"))
+            {
+                return false;
+            }
+            if (strcmp(key, "mode") == 0)
+            {
+                ok = wifi_c_config_mode(json, &config->mode);
+            }
+#if WIFI_C_STA_ENABLED
+            else if (strcmp(key, "sta") == 0)
+            {
+                ok = wifi_c_config_sta(json, config);
+            }
+#endif
+#if WIFI_C_AP_ENABLED
+            else if (strcmp(key, "ap") == 0)
+            {
+                ok = wifi_c_config_ap(json, config);
+            }
+#endif
+            else
+            {
+                ok = wifi_c_json_skip(json, 1);
+            }
+            if (!ok)
+            {
+                return false;
+            }
+        } while (wifi_c_json_accept(json, ','));
+        if (!wifi_c_json_expect(json, '}', "',' or '}' expected"))
+        {
+            return false;
+        }
+    }
+
+    /*Terminating NUL counted in len is allowed, anything else after document is not.*/
+    wifi_c_json_skip_ws(json);
+    if (json->pos < json->end && !(*json->pos == '\0' && json->pos + 1 == json->end))
+    {
+        return wifi_c_json_fail(json, "data after end of document");
+    }
+    return wifi_c_config_check_mode(json, config);
+}
+
+int wifi_c_config_parse(char *json, size_t len, wifi_c_config_t *config, wifi_c_config_error_t *error)
+{
+    wifi_c_json_t cursor = {
+        .start = json,
+        .pos = json,
+        .end = json + len,
+        .reason = NULL,
+        .error_pos = NULL,
+    };
+#if WIFI_C_AP_ENABLED
+    wifi_c_ap_config_t default_ap = WIFI_C_AP_CONFIG_DEFAULT();
+#endif
+
+    ERR_C_CHECK_NULL_PTR(json, LOG_ERROR("config document cannot be NULL"));
+    ERR_C_CHECK_NULL_PTR(config, LOG_ERROR("pointer to store config cannot be NULL"));
+
+    memset(config, 0, sizeof(wifi_c_config_t));
+    config->mode = WIFI_C_NO_MODE;
+#if WIFI_C_AP_ENABLED
+    config->ap = default_ap;
+#endif
+
+    if (!wifi_c_config_document(&cursor, config))
+    {
+        if (error != NULL)
+        {
+            error->offset = (size_t)(cursor.error_pos - cursor.start);
+            error->reason = cursor.reason;
+        }
+        LOG_WARN("Config rejected at byte %u: %s", (unsigned)(cursor.error_pos - cursor.start), cursor.reason);
+        return WIFI_C_ERR_CONFIG_INVALID;
+    }
+    LOG_DEBUG("Config parsed, mode %d.", config->mode);
+    return ERR_C_OK;
+}
+
+int wifi_c_config_apply(const wifi_c_config_t *config)
+{
+    err_c_t err = ERR_C_OK;
+
+    ERR_C_CHECK_NULL_PTR(config, LOG_ERROR("config to apply cannot be NULL"));
+
+    err = wifi_c_init_wifi(config->mode);
+    if (err != ERR_C_OK && err != WIFI_C_ERR_WIFI_ALREADY_INIT)
+    {
+        return err;
+    }
+    err = ERR_C_OK;
+
+#if WIFI_C_AP_ENABLED
+    if (config->mode == WIFI_C_MODE_AP || config->mode == WIFI_C_MODE_APSTA)
+    {
+        err = wifi_c_start_ap_with_config(&config->ap);
+        if (err != ERR_C_OK)
+        {
+            return err;
+        }
+    }
+#endif
+
+#if WIFI_C_STA_ENABLED
+    if (config->mode == WIFI_C_MODE_STA || config->mode == WIFI_C_MODE_APSTA)
+    {
+        /*Networks are tried in order of document, first one accepting connection is kept.*/
+        for (uint8_t i = 0; i < config->network_count; i++)
+        {
+            err = wifi_c_start_sta(config->networks[i].ssid, config->networks[i].password);
+            if (err == ERR_C_OK)
+            {
+                break;
+            }
+            LOG_WARN("Network %u of config failed: %d", i, err);
+        }
+    }
+#endif
+    return err;
+}
+#endif // ESP_PLATFORM
@@ -0,0 +1,285 @@
+/**
+ * @file wifi_c_event_loop.c
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief Private event loop of controller source file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*Beginning of ESP-IDF specific code.*/
+#ifdef ESP_PLATFORM
+
+#include "esp_event.h"
+#include "esp_wifi.h"
+#include "esp_netif.h"
+#include "freertos/FreeRTOS.h"
+#include <string.h>
+#include "err_controller.h"
+#include "errors_list.h"
+#include "wifi_controller.h"
+#include "wifi_c_event_loop.h"
+#include "logger.h"
+
+#if WIFI_C_PRIVATE_EVENT_LOOP_ENABLED
+
+static struct {
+    esp_event_loop_handle_t loop;
+    wifi_c_event_loop_config_t config;
+    uint8_t users;                          // contexts with handlers on loop
+    esp_event_handler_instance_t forward_wifi_instance;
+    esp_event_handler_instance_t forward_ip_instance;
+    esp_event_handler_instance_t dispatch_instance;
+    wifi_c_event_loop_stats_t stats;
+    portMUX_TYPE lock;
+} wifi_c_event_loop = {
+    .loop = NULL,
+    .config = WIFI_C_EVENT_LOOP_CONFIG_DEFAULT(),
+    .users = 0,
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+/**
+ * @brief Size of event data, handlers don't get it and esp_event_post_to() copies data.
+ *
+ * @return Size in bytes, 0 for events without data, -1 if size is not known.
+ */
+static int wifi_c_event_loop_data_size(esp_event_base_t base, int32_t id, const void *data)
+{
+    if (data == NULL)
+    {
+        return 0;
+    }
+
+    if (base == IP_EVENT)
+    {
+        switch (id)
+        {
+        case IP_EVENT_STA_GOT_IP:
+            return sizeof(ip_event_got_ip_t);
+        case IP_EVENT_AP_STAIPASSIGNED:
+            return sizeof(ip_event_ap_staipassigned_t);
+        default:
+            return -1;
+        }
+    }
+
+    switch (id)
+    {
+    case WIFI_EVENT_SCAN_DONE:
+        return sizeof(wifi_event_sta_scan_done_t);
+    case WIFI_EVENT_STA_CONNECTED:
+        return sizeof(wifi_event_sta_connected_t);
+    case WIFI_EVENT_STA_DISCONNECTED:
+        return sizeof(wifi_event_sta_disconnected_t);
+    case WIFI_EVENT_STA_AUTHMODE_CHANGE:
+        return sizeof(wifi_event_sta_authmode_change_t);
+    case WIFI_EVENT_STA_BSS_RSSI_LOW:
+        return sizeof(wifi_event_bss_rssi_low_t);
+    case WIFI_EVENT_AP_STACONNECTED:
+        return sizeof(wifi_event_ap_staconnected_t);
+    case WIFI_EVENT_AP_STADISCONNECTED:
+        return sizeof(wifi_event_ap_stadisconnected_t);
+    default:
+        return -1;
+    }
+}
+
+/**
+ * @brief Runs on default loop task, posts event to private loop.
+ */
+static void wifi_c_event_loop_forward(void *arg, esp_event_base_t event_base,
+                                      int32_t event_id, void *event_data)
+{
+    int size = wifi_c_event_loop_data_size(event_base, event_id, event_data);
+    uint16_t depth = 0;
+
+    if (size < 0)
+    {
+        // controller handlers don't read data of these, a copy of unknown size can't be made
+        portENTER_CRITICAL(&wifi_c_event_loop.lock);
+        wifi_c_event_loop.stats.skipped++;
+        portEXIT_CRITICAL(&wifi_c_event_loop.lock);
+        return;
+    }
+
+    // counted before post, loop task may take event before this returns
+    portENTER_CRITICAL(&wifi_c_event_loop.lock);
+    wifi_c_event_loop.stats.forwarded++;
+    portEXIT_CRITICAL(&wifi_c_event_loop.lock);
+
+    if (esp_event_post_to(wifi_c_event_loop.loop, event_base, event_id, event_data, (size_t)size,
+                          pdMS_TO_TICKS(wifi_c_event_loop.config.post_timeout_ms)) != ESP_OK)
+    {
+        portENTER_CRITICAL(&wifi_c_event_loop.lock);
+        wifi_c_event_loop.stats.forwarded--;
+        wifi_c_event_loop.stats.dropped++;
+        portEXIT_CRITICAL(&wifi_c_event_loop.lock);
+        return;
+    }
+
+    portENTER_CRITICAL(&wifi_c_event_loop.lock);
+    depth = (uint16_t)(wifi_c_event_loop.stats.forwarded - wifi_c_event_loop.stats.dispatched);
+    if (depth > wifi_c_event_loop.stats.queue_max_depth)
+    {
+        wifi_c_event_loop.stats.queue_max_depth = depth;
+    }
+    portEXIT_CRITICAL(&wifi_c_event_loop.lock);
+}
+
+/**
+ * @brief Runs on private loop task before handlers of every event.
+ */
+static void wifi_c_event_loop_dispatch(void *arg, esp_event_base_t event_base,
+                                       int32_t event_id, void *event_data)
+{
+    portENTER_CRITICAL(&wifi_c_event_loop.lock);
+    wifi_c_event_loop.stats.dispatched++;
+    portEXIT_CRITICAL(&wifi_c_event_loop.lock);
+}
+
+int wifi_c_event_loop_set_config(const wifi_c_event_loop_config_t *config)
+{
+    wifi_c_event_loop_config_t default_config = WIFI_C_EVENT_LOOP_CONFIG_DEFAULT();
+
+    if (config == NULL)
+    {
+        config = &default_config;
+    }
+    if (wifi_c_event_loop.loop != NULL)
+    {
+        LOG_WARN("Private event loop is running, config is not changed.");
+        return WIFI_C_ERR_EVENT_LOOP_RUNNING;
+    }
+    if (config->queue_size == 0 || config->stack_size == 0)
+    {
+        LOG_ERROR("Queue size and stack size of event loop cannot be zero.");
+        return ERR_C_INVALID_ARGS;
+    }
+
+    memcpy(&wifi_c_event_loop.config, config, sizeof(wifi_c_event_loop_config_t));
+    return ERR_C_OK;
+}
+
+int wifi_c_event_loop_start(void)
+{
+    volatile err_c_t err = ERR_C_OK;
+    esp_event_loop_args_t args = {
+        .queue_size = wifi_c_event_loop.config.queue_size,
+        .task_name = "wifi_c_evt",
+        .task_priority = wifi_c_event_loop.config.priority,
+        .task_stack_size = wifi_c_event_loop.config.stack_size,
+        .task_core_id = wifi_c_event_loop.config.core_id,
+    };
+
+    if (wifi_c_event_loop.loop != NULL)
+    {
+        wifi_c_event_loop.users++;
+        return ERR_C_OK;
+    }
+
+    Try
+    {
+        err = esp_event_loop_create(&args, &wifi_c_event_loop.loop);
+        if (err == ESP_ERR_NO_MEM)
+        {
+            ERR_C_SET_AND_THROW_ERR(err, ERR_C_MEMORY_ERR);
+        }
+        ERR_C_CHECK_AND_THROW_ERR(err);
+
+        ERR_C_CHECK_AND_THROW_ERR(esp_event_handler_instance_register_with(wifi_c_event_loop.loop,
+                                                                           ESP_EVENT_ANY_BASE,
+                                                                           ESP_EVENT_ANY_ID,
+                                                                           &wifi_c_event_loop_dispatch,
+                                                                           NULL,
+                                                                           &wifi_c_event_loop.dispatch_instance));
+
+        ERR_C_CHECK_AND_THROW_ERR(esp_event_handler_instance_register(WIFI_EVENT,
+                                                                      ESP_EVENT_ANY_ID,
+                                                                      &wifi_c_event_loop_forward,
+                                                                      NULL,
+                                                                      &wifi_c_event_loop.forward_wifi_instance));
+
+        err = esp_event_handler_instance_register(IP_EVENT,
+                                                  ESP_EVENT_ANY_ID,
+                                                  &wifi_c_event_loop_forward,
+                                                  NULL,
+                                                  &wifi_c_event_loop.forward_ip_instance);
+        if (err != ESP_OK)
+        {
+            esp_event_handler_instance_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, wifi_c_event_loop.forward_wifi_instance);
+            ERR_C_CHECK_AND_THROW_ERR(err);
+        }
+
+        wifi_c_event_loop.users = 1;
+        memset(&wifi_c_event_loop.stats, 0, sizeof(wifi_c_event_loop.stats));
+        wifi_c_event_loop.stats.queue_size = wifi_c_event_loop.config.queue_size;
+        LOG_INFO("Private event loop started, priority %u, queue size %u.", wifi_c_event_loop.config.priority,
+                 wifi_c_event_loop.config.queue_size);
+    }
+    Catch(err)
+    {
+        if (wifi_c_event_loop.loop != NULL)
+        {
+            esp_event_loop_delete(wifi_c_event_loop.loop); // handlers of loop are deleted with it
+            wifi_c_event_loop.loop = NULL;
+        }
+        switch (err)
+        {
+        case ERR_C_MEMORY_ERR:
+            LOG_ERROR("Memory allocation was not successful");
+            break;
+        default:
+            LOG_ERROR("Error when starting private event loop: %d", err);
+            break;
+        }
+    }
+    return err;
+}
+
+void wifi_c_event_loop_stop(void)
+{
+    if (wifi_c_event_loop.loop == NULL || --wifi_c_event_loop.users > 0)
+    {
+        return;
+    }
+
+    esp_event_handler_instance_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, wifi_c_event_loop.forward_wifi_instance);
+    esp_event_handler_instance_unregister(IP_EVENT, ESP_EVENT_ANY_ID, wifi_c_event_loop.forward_ip_instance);
+    esp_event_loop_delete(wifi_c_event_loop.loop); // events still queued are discarded
+    wifi_c_event_loop.loop = NULL;
+    wifi_c_event_loop.stats.queue_size = 0;
+    LOG_DEBUG("Private event loop deleted.");
+}
+
+esp_event_loop_handle_t wifi_c_event_loop_get(void)
+{
+    return wifi_c_event_loop.loop;
+}
+
+int wifi_c_event_loop_get_stats(wifi_c_event_loop_stats_t *stats)
+{
+    ERR_C_CHECK_NULL_PTR(stats, LOG_ERROR("pointer to store event loop statistics cannot be NULL"));
+
+    portENTER_CRITICAL(&wifi_c_event_loop.lock);
+    memcpy(stats, &wifi_c_event_loop.stats, sizeof(wifi_c_event_loop_stats_t));
+    portEXIT_CRITICAL(&wifi_c_event_loop.lock);
+    stats->queue_depth = (uint16_t)(stats->forwarded - stats->dispatched);
+    return ERR_C_OK;
+}
+
+void wifi_c_event_loop_reset_stats(void)
+{
+    portENTER_CRITICAL(&wifi_c_event_loop.lock);
+    // events in flight stay counted, so depth doesn't underflow
+    wifi_c_event_loop.stats.forwarded -= wifi_c_event_loop.stats.dispatched;
+    wifi_c_event_loop.stats.dispatched = 0;
+    wifi_c_event_loop.stats.dropped = 0;
+    wifi_c_event_loop.stats.skipped = 0;
+    wifi_c_event_loop.stats.queue_max_depth = 0;
+    portEXIT_CRITICAL(&wifi_c_event_loop.lock);
+}
+#endif // WIFI_C_PRIVATE_EVENT_LOOP_ENABLED
+#endif // ESP_PLATFORM
@@ -0,0 +1,263 @@
+/**
+ * @file wifi_c_heap.c
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief Heap allocation audit of controller source file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*Beginning of ESP-IDF specific code.*/
+#ifdef ESP_PLATFORM
+
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <string.h>
+#include "err_controller.h"
+#include "errors_list.h"
+#include "wifi_controller.h"
+#include "wifi_c_heap.h"
+#include "logger.h"
+
+#if WIFI_C_HEAP_AUDIT_ENABLED
+
+/**
+ * @brief Task inside API call or handler, allocations of it go to site.
+ */
+struct wifi_c_heap_scope_obj {
+    TaskHandle_t task;                      // NULL when slot is free
+    uint8_t site;
+    uint8_t depth;                          // nested calls of the same task
+    uint32_t bytes;                         // allocated by this call so far
+};
+
+static struct {
+    struct wifi_c_heap_scope_obj scopes[WIFI_C_HEAP_AUDIT_SCOPES];
+    volatile uint8_t active;                // scopes in use, hooks return at once when zero
+    wifi_c_heap_report_t report;
+    portMUX_TYPE lock;
+} wifi_c_heap = {
+    .active = 0,
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+static const char *const wifi_c_heap_event_names[WIFI_C_HEAP_SITE_COUNT - WIFI_C_CMD_COUNT] = {
+    [WIFI_C_HEAP_SITE_AP_EVENT - WIFI_C_CMD_COUNT] = "AP event handler",
+    [WIFI_C_HEAP_SITE_STA_EVENT - WIFI_C_CMD_COUNT] = "STA event handler",
+    [WIFI_C_HEAP_SITE_IP_EVENT - WIFI_C_CMD_COUNT] = "IP event handler",
+};
+
+/**
+ * @brief Find scope of task, must be called with lock taken.
+ */
+static struct wifi_c_heap_scope_obj *wifi_c_heap_scope_of(TaskHandle_t task)
+{
+    for (uint8_t i = 0; i < WIFI_C_HEAP_AUDIT_SCOPES; i++)
+    {
+        if (wifi_c_heap.scopes[i].task == task)
+        {
+            return &wifi_c_heap.scopes[i];
+        }
+    }
+    return NULL;
+}
+
+void wifi_c_heap_audit_enter(wifi_c_heap_site_t site)
+{
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    struct wifi_c_heap_scope_obj *scope = NULL;
+
+    if ((unsigned)site >= WIFI_C_HEAP_SITE_COUNT)
+    {
+        return;
+    }
+
+    portENTER_CRITICAL(&wifi_c_heap.lock);
+    wifi_c_heap.report.sites[site].calls++;
+    scope = wifi_c_heap_scope_of(task);
+    if (scope != NULL)
+    {
+        scope->depth++; // nested API call, allocations stay with outer site
+    }
+    else if ((scope = wifi_c_heap_scope_of(NULL)) != NULL)
+    {
+        scope->task = task;
+        scope->site = (uint8_t)site;
+        scope->depth = 1;
+        scope->bytes = 0;
+        wifi_c_heap.active++;
+    }
+    else
+    {
+        wifi_c_heap.report.untracked++;
+    }
+    portEXIT_CRITICAL(&wifi_c_heap.lock);
+}
+
+void wifi_c_heap_audit_exit(void)
+{
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    struct wifi_c_heap_scope_obj *scope = NULL;
+    wifi_c_heap_site_stats_t *stats = NULL;
+
+    portENTER_CRITICAL(&wifi_c_heap.lock);
+    scope = wifi_c_heap_scope_of(task);
+    if (scope != NULL && --scope->depth == 0)
+    {
+        stats = &wifi_c_heap.report.sites[scope->site];
+        if (scope->bytes > stats->max_call_bytes)
+        {
+            stats->max_call_bytes = scope->bytes;
+        }
+        scope->task = NULL;
+        wifi_c_heap.active--;
+    }
+    portEXIT_CRITICAL(&wifi_c_heap.lock);
+}
+
+/**
+ * @brief Heap hook of ESP-IDF, called after every successful allocation of any task.
+ *
+ * @note Audit takes over the hook, application hook defined as wifi_c_heap_app_alloc_hook() is called first.
+ */
+void esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps)
+{
+    struct wifi_c_heap_scope_obj *scope = NULL;
+    wifi_c_heap_site_stats_t *stats = NULL;
+
+    if (wifi_c_heap_app_alloc_hook != NULL)
+    {
+        wifi_c_heap_app_alloc_hook(ptr, size, caps);
+    }
+    if (wifi_c_heap.active == 0 || xPortInIsrContext())
+    {
+        return;
+    }
+
+    portENTER_CRITICAL_SAFE(&wifi_c_heap.lock);
+    scope = wifi_c_heap_scope_of(xTaskGetCurrentTaskHandle());
+    if (scope != NULL)
+    {
+        stats = &wifi_c_heap.report.sites[scope->site];
+        stats->allocs++;
+        stats->bytes += size;
+        scope->bytes += (uint32_t)size;
+        if (wifi_c_heap.report.steady)
+        {
+            stats->steady_allocs++;
+            wifi_c_heap.report.steady_allocs++;
+        }
+    }
+    portEXIT_CRITICAL_SAFE(&wifi_c_heap.lock);
+}
+
+/**
+ * @brief Heap hook of ESP-IDF, called on every free of any task.
+ *
+ * @note Audit takes over the hook, application hook defined as wifi_c_heap_app_free_hook() is called first.
+ */
+void esp_heap_trace_free_hook(void *ptr)
+{
+    struct wifi_c_heap_scope_obj *scope = NULL;
+
+    if (wifi_c_heap_app_free_hook != NULL)
+    {
+        wifi_c_heap_app_free_hook(ptr);
+    }
+    if (wifi_c_heap.active == 0 || xPortInIsrContext())
+    {
+        return;
+    }
+
+    portENTER_CRITICAL_SAFE(&wifi_c_heap.lock);
+    scope = wifi_c_heap_scope_of(xTaskGetCurrentTaskHandle());
+    if (scope != NULL)
+    {
+        wifi_c_heap.report.sites[scope->site].frees++;
+    }
+    portEXIT_CRITICAL_SAFE(&wifi_c_heap.lock);
+}
+
+void wifi_c_heap_audit_set_steady(void)
+{
+    portENTER_CRITICAL(&wifi_c_heap.lock);
+    wifi_c_heap.report.steady = true;
+    portEXIT_CRITICAL(&wifi_c_heap.lock);
+    LOG_INFO("Heap audit: startup done, further allocations are steady-state.");
+}
+
+int wifi_c_heap_audit_check(void)
+{
+    wifi_c_heap_report_t report;
+
+    wifi_c_heap_audit_get(&report);
+    if (report.steady_allocs == 0)
+    {
+        return ERR_C_OK;
+    }
+    for (uint8_t site = 0; site < WIFI_C_HEAP_SITE_COUNT; site++)
+    {
+        if (report.sites[site].steady_allocs > 0)
+        {
+            LOG_ERROR("Heap audit: %s allocated %lu times after startup.", wifi_c_heap_site_name((wifi_c_heap_site_t)site),
+                      (unsigned long)report.sites[site].steady_allocs);
+        }
+    }
+    return WIFI_C_ERR_HEAP_STEADY_ALLOC;
+}
+
+int wifi_c_heap_audit_get(wifi_c_heap_report_t *report)
+{
+    ERR_C_CHECK_NULL_PTR(report, LOG_ERROR("pointer to store heap report cannot be NULL"));
+
+    portENTER_CRITICAL(&wifi_c_heap.lock);
+    memcpy(report, &wifi_c_heap.report, sizeof(wifi_c_heap_report_t));
+    portEXIT_CRITICAL(&wifi_c_heap.lock);
+    return ERR_C_OK;
+}
+
+void wifi_c_heap_audit_print(void)
+{
+    wifi_c_heap_report_t report;
+
+    wifi_c_heap_audit_get(&report);
+    LOG_INFO("Heap audit%s: %lu steady-state allocations, %lu calls untracked.", report.steady ? " (steady)" : "",
+             (unsigned long)report.steady_allocs, (unsigned long)report.untracked);
+    for (uint8_t site = 0; site < WIFI_C_HEAP_SITE_COUNT; site++)
+    {
+        wifi_c_heap_site_stats_t *stats = &report.sites[site];
+        if (stats->calls == 0)
+        {
+            continue;
+        }
+        LOG_INFO("%-22s calls %5lu allocs %6lu frees %6lu bytes %8llu max/call %6lu steady %lu",
+                 wifi_c_heap_site_name((wifi_c_heap_site_t)site), (unsigned long)stats->calls,
+                 (unsigned long)stats->allocs, (unsigned long)stats->frees, (unsigned long long)stats->bytes,
+                 (unsigned long)stats->max_call_bytes, (unsigned long)stats->steady_allocs);
+    }
+}
+
+void wifi_c_heap_audit_reset(void)
+{
+    portENTER_CRITICAL(&wifi_c_heap.lock);
+    memset(&wifi_c_heap.report, 0, sizeof(wifi_c_heap.report));
+    portEXIT_CRITICAL(&wifi_c_heap.lock);
+}
+
+const char *wifi_c_heap_site_name(wifi_c_heap_site_t site)
+{
+    if ((unsigned)site < WIFI_C_CMD_COUNT)
+    {
+        return wifi_c_cmd_name((wifi_c_cmd_id_t)site);
+    }
+    if ((unsigned)site < WIFI_C_HEAP_SITE_COUNT)
+    {
+        return wifi_c_heap_event_names[site - WIFI_C_CMD_COUNT];
+    }
+    return "unknown";
+}
+#endif
+#endif // ESP_PLATFORM
@@ -0,0 +1,583 @@
+/**
+ * @file wifi_c_history.c
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief Per-BSSID scan history source file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*Beginning of ESP-IDF specific code.*/
+#ifdef ESP_PLATFORM
+
+#include "esp_timer.h"
+#include "esp_mac.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "err_controller.h"
+#include "errors_list.h"
+#include "wifi_controller.h"
+#include "wifi_c_history.h"
+#include "wifi_c_stream.h"
+#include "logger.h"
+#include "memory_utils.h"
+
+#if WIFI_C_SCAN_ENABLED
+#define WIFI_C_HISTORY_NIL  0xFFFF              ///< Index used as end of list.
+
+/**
+ * @brief One BSSID stored in history, linked in LRU list and in hash bucket chain.
+ */
+struct wifi_c_history_entry_obj {
+    uint8_t bssid[6];
+    uint8_t channel;
+    int8_t rssi_min;
+    int8_t rssi_max;
+    uint16_t ssid_slot;
+    uint16_t channel_changes;
+    uint16_t lru_prev;
+    uint16_t lru_next;
+    uint16_t hash_next;
+    int32_t rssi_sum;
+    uint32_t seen_count;
+    uint32_t first_seen_ms;
+    uint32_t last_seen_ms;
+};
+typedef struct wifi_c_history_entry_obj wifi_c_history_entry_t;
+
+/**
+ * @brief Interned SSID, shared by all BSSIDs with the same name.
+ */
+struct wifi_c_history_ssid_obj {
+    char ssid[33];
+    uint16_t refcount;
+    uint32_t hash;
+};
+typedef struct wifi_c_history_ssid_obj wifi_c_history_ssid_t;
+
+struct wifi_c_history_obj {
+    bool initialized;
+    SemaphoreHandle_t lock;
+    void *memory;
+    wifi_c_history_entry_t *entries;
+    wifi_c_history_ssid_t *ssids;
+    uint16_t *buckets;
+    uint16_t bucket_mask;
+    uint16_t max_bssids;
+    uint16_t max_ssids;
+    uint16_t used;
+    uint16_t lru_head;                          // most recently seen
+    uint16_t lru_tail;                          // least recently seen, evicted first
+    uint32_t evicted;
+};
+
+static struct wifi_c_history_obj wifi_c_history = {
+    .initialized = false,
+};
+
+static uint32_t wifi_c_history_hash(const uint8_t *data, size_t len)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++)
+    {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static inline uint16_t wifi_c_history_bucket(const uint8_t bssid[6])
+{
+    return (uint16_t)(wifi_c_history_hash(bssid, 6) & wifi_c_history.bucket_mask);
+}
+
+static void wifi_c_history_lru_unlink(uint16_t index)
+{
+    wifi_c_history_entry_t *entry = &wifi_c_history.entries[index];
+
+    if (entry->lru_prev != WIFI_C_HISTORY_NIL)
+    {
+        wifi_c_history.entries[entry->lru_prev].lru_next = entry->lru_next;
+    }
+    else
+    {
+        wifi_c_history.lru_head = entry->lru_next;
+    }
+
+    if (entry->lru_next != WIFI_C_HISTORY_NIL)
+    {
+        wifi_c_history.entries[entry->lru_next].lru_prev = entry->lru_prev;
+    }
+    else
+    {
+        wifi_c_history.lru_tail = entry->lru_prev;
+    }
+    entry->lru_prev = WIFI_C_HISTORY_NIL;
+    entry->lru_next = WIFI_C_HISTORY_NIL;
+}
+
+static void wifi_c_history_lru_push_front(uint16_t index)
+{
+    wifi_c_history_entry_t *entry = &wifi_c_history.entries[index];
+
+    entry->lru_prev = WIFI_C_HISTORY_NIL;
+    entry->lru_next = wifi_c_history.lru_head;
+    if (wifi_c_history.lru_head != WIFI_C_HISTORY_NIL)
+    {
+        wifi_c_history.entries[wifi_c_history.lru_head].lru_prev = index;
+    }
+    wifi_c_history.lru_head = index;
+    if (wifi_c_history.lru_tail == WIFI_C_HISTORY_NIL)
+    {
+        wifi_c_history.lru_tail = index;
+    }
+}
+
+static void wifi_c_history_hash_unlink(uint16_t index)
+{
+    uint16_t *link = &wifi_c_history.buckets[wifi_c_history_bucket(wifi_c_history.entries[index].bssid)];
+
+    while (*link != WIFI_C_HISTORY_NIL)
+    {
+        if (*link == index)
+        {
+            *link = wifi_c_history.entries[index].hash_next;
+            return;
+        }
+        link = &wifi_c_history.entries[*link].hash_next;
+    }
+}
+
+static uint16_t wifi_c_history_find(const uint8_t bssid[6])
+{
+    uint16_t index = wifi_c_history.buckets[wifi_c_history_bucket(bssid)];
+
+    while (index != WIFI_C_HISTORY_NIL)
+    {
+        if (memcmp(wifi_c_history.entries[index].bssid, bssid, 6) == 0)
+        {
+            break;
+        }
+        index = wifi_c_history.entries[index].hash_next;
+    }
+    return index;
+}
+
+static void wifi_c_history_ssid_release(uint16_t slot)
+{
+    if (slot != WIFI_C_HISTORY_NIL && wifi_c_history.ssids[slot].refcount > 0)
+    {
+        wifi_c_history.ssids[slot].refcount--;
+    }
+}
+
+/**
+ * @brief Find interned SSID or store new one, returns WIFI_C_HISTORY_NIL when pool is full.
+ */
+static uint16_t wifi_c_history_ssid_acquire(const char *ssid)
+{
+    size_t len = strnlen(ssid, 32);
+    uint32_t hash = wifi_c_history_hash((const uint8_t *)ssid, len);
+    uint16_t free_slot = WIFI_C_HISTORY_NIL;
+
+    for (uint16_t i = 0; i < wifi_c_history.max_ssids; i++)
+    {
+        wifi_c_history_ssid_t *slot = &wifi_c_history.ssids[i];
+        if (slot->refcount == 0)
+        {
+            if (free_slot == WIFI_C_HISTORY_NIL)
+            {
+                free_slot = i;
+            }
+            continue;
+        }
+        if (slot->hash == hash && strncmp(slot->ssid, ssid, 32) == 0)
+        {
+            slot->refcount++;
+            return i;
+        }
+    }
+
+    if (free_slot != WIFI_C_HISTORY_NIL)
+    {
+        wifi_c_history_ssid_t *slot = &wifi_c_history.ssids[free_slot];
+        memutil_zero_memory(slot->ssid, sizeof(slot->ssid));
+        memcpy(slot->ssid, ssid, len);
+        slot->hash = hash;
+        slot->refcount = 1;
+    }
+    return free_slot;
+}
+
+static bool wifi_c_history_ssid_matches(uint16_t slot, const char *ssid)
+{
+    if (slot == WIFI_C_HISTORY_NIL)
+    {
+        return false;
+    }
+    return strncmp(wifi_c_history.ssids[slot].ssid, ssid, 32) == 0;
+}
+
+/**
+ * @brief Get free entry, evicting least recently seen BSSID if table is full.
+ */
+static uint16_t wifi_c_history_take_entry(void)
+{
+    uint16_t index;
+
+    if (wifi_c_history.used < wifi_c_history.max_bssids)
+    {
+        return wifi_c_history.used++;
+    }
+
+    index = wifi_c_history.lru_tail;
+    wifi_c_history_lru_unlink(index);
+    wifi_c_history_hash_unlink(index);
+    wifi_c_history_ssid_release(wifi_c_history.entries[index].ssid_slot);
+    wifi_c_history.evicted++;
+    return index;
+}
+
+static void wifi_c_history_update(const wifi_ap_record_t *record, uint32_t now_ms)
+{
+    const char *ssid = (const char *)record->ssid;
+    uint16_t index = wifi_c_history_find(record->bssid);
+    wifi_c_history_entry_t *entry;
+
+    if (index == WIFI_C_HISTORY_NIL)
+    {
+        uint16_t bucket;
+
+        index = wifi_c_history_take_entry();
+        entry = &wifi_c_history.entries[index];
+        memutil_zero_memory(entry, sizeof(wifi_c_history_entry_t));
+        memcpy(entry->bssid, record->bssid, sizeof(entry->bssid));
+        entry->channel = record->primary;
+        entry->rssi_min = record->rssi;
+        entry->rssi_max = record->rssi;
+        entry->first_seen_ms = now_ms;
+        entry->ssid_slot = wifi_c_history_ssid_acquire(ssid);
+
+        bucket = wifi_c_history_bucket(entry->bssid);
+        entry->hash_next = wifi_c_history.buckets[bucket];
+        wifi_c_history.buckets[bucket] = index;
+    }
+    else
+    {
+        entry = &wifi_c_history.entries[index];
+        wifi_c_history_lru_unlink(index);
+
+        if (entry->channel != record->primary)
+        {
+            entry->channel = record->primary;
+            entry->channel_changes++;
+        }
+        if (record->rssi < entry->rssi_min)
+        {
+            entry->rssi_min = record->rssi;
+        }
+        if (record->rssi > entry->rssi_max)
+        {
+            entry->rssi_max = record->rssi;
+        }
+        if (!wifi_c_history_ssid_matches(entry->ssid_slot, ssid))
+        {
+            wifi_c_history_ssid_release(entry->ssid_slot);
+            entry->ssid_slot = wifi_c_history_ssid_acquire(ssid);
+        }
+    }
+
+    entry->rssi_sum += record->rssi;
+    entry->seen_count++;
+    entry->last_seen_ms = now_ms;
+    wifi_c_history_lru_push_front(index);
+}
+
+static void wifi_c_history_to_record(const wifi_c_history_entry_t *entry, wifi_c_history_record_t *record)
+{
+    memutil_zero_memory(record, sizeof(wifi_c_history_record_t));
+    memcpy(record->bssid, entry->bssid, sizeof(record->bssid));
+    if (entry->ssid_slot != WIFI_C_HISTORY_NIL)
+    {
+        memcpy(record->ssid, wifi_c_history.ssids[entry->ssid_slot].ssid, sizeof(record->ssid));
+    }
+    record->channel = entry->channel;
+    record->rssi_min = entry->rssi_min;
+    record->rssi_max = entry->rssi_max;
+    record->rssi_mean = (entry->seen_count > 0) ? (int8_t)(entry->rssi_sum / (int32_t)entry->seen_count) : 0;
+    record->channel_changes = entry->channel_changes;
+    record->seen_count = entry->seen_count;
+    record->first_seen_ms = entry->first_seen_ms;
+    record->last_seen_ms = entry->last_seen_ms;
+}
+
+static void wifi_c_history_reset(void)
+{
+    for (uint16_t i = 0; i <= wifi_c_history.bucket_mask; i++)
+    {
+        wifi_c_history.buckets[i] = WIFI_C_HISTORY_NIL;
+    }
+    memutil_zero_memory(wifi_c_history.ssids, sizeof(wifi_c_history_ssid_t) * wifi_c_history.max_ssids);
+    wifi_c_history.used = 0;
+    wifi_c_history.lru_head = WIFI_C_HISTORY_NIL;
+    wifi_c_history.lru_tail = WIFI_C_HISTORY_NIL;
+}
+
+int wifi_c_history_init(const wifi_c_history_config_t *config)
+{
+    volatile err_c_t err = ERR_C_OK;
+    ERR_C_CHECK_NULL_PTR(config, LOG_ERROR("history config cannot be NULL"));
+
+    Try
+    {
+        if (wifi_c_history.initialized)
+        {
+            ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_HISTORY_ALREADY_INIT);
+        }
+
+        if (config->max_bssids == 0 || config->max_bssids >= WIFI_C_HISTORY_NIL || config->max_ssids == 0 || config->max_ssids >= WIFI_C_HISTORY_NIL)
+        {
+            ERR_C_SET_AND_THROW_ERR(err, ERR_C_INVALID_ARGS);
+        }
+
+        uint32_t buckets = 1;
+        while (buckets < config->max_bssids)
+        {
+            buckets <<= 1;
+        }
+
+        size_t entries_size = sizeof(wifi_c_history_entry_t) * config->max_bssids;
+        size_t ssids_size = sizeof(wifi_c_history_ssid_t) * config->max_ssids;
+        size_t buckets_size = sizeof(uint16_t) * buckets;
+
+        wifi_c_history.memory = calloc(1, entries_size + ssids_size + buckets_size);
+        if (wifi_c_history.memory == NULL)
+        {
+            ERR_C_SET_AND_THROW_ERR(err, ERR_C_MEMORY_ERR);
+        }
+
+        wifi_c_history.lock = xSemaphoreCreateMutex();
+        if (wifi_c_history.lock == NULL)
+        {
+            ERR_C_SET_AND_THROW_ERR(err, ERR_C_MEMORY_ERR);
+        }
+
+        wifi_c_history.entries = (wifi_c_history_entry_t *)wifi_c_history.memory;
+        wifi_c_history.ssids = (wifi_c_history_ssid_t *)((uint8_t *)wifi_c_history.memory + entries_size);
+        wifi_c_history.buckets = (uint16_t *)((uint8_t *)wifi_c_history.memory + entries_size + ssids_size);
+        wifi_c_history.bucket_mask = (uint16_t)(buckets - 1);
+        wifi_c_history.max_bssids = config->max_bssids;
+        wifi_c_history.max_ssids = config->max_ssids;
+        wifi_c_history.evicted = 0;
+        wifi_c_history_reset();
+        wifi_c_history.initialized = true;
+        LOG_INFO("BSSID history initialized, %u BSSIDs, %u SSIDs, %u bytes.", config->max_bssids, config->max_ssids, (unsigned)(entries_size + ssids_size + buckets_size));
+    }
+    Catch(err)
+    {
+        switch (err)
+        {
+        case WIFI_C_ERR_HISTORY_ALREADY_INIT:
+            LOG_WARN("BSSID history already initialized.");
+            break;
+        case ERR_C_INVALID_ARGS:
+            LOG_ERROR("Wrong size of BSSID history.");
+            break;
+        case ERR_C_MEMORY_ERR:
+            LOG_ERROR("Memory allocation was not successful");
+            free(wifi_c_history.memory);
+            wifi_c_history.memory = NULL;
+            break;
+        default:
+            LOG_ERROR("Error when initializing BSSID history: %d", err);
+            break;
+        }
+    }
+    return err;
+}
+
+void wifi_c_history_deinit(void)
+{
+    if (!wifi_c_history.initialized)
+    {
+        return;
+    }
+    xSemaphoreTake(wifi_c_history.lock, portMAX_DELAY);
+    wifi_c_history.initialized = false;
+    xSemaphoreGive(wifi_c_history.lock);
+
+    vSemaphoreDelete(wifi_c_history.lock);
+    free(wifi_c_history.memory);
+    memutil_zero_memory(&wifi_c_history, sizeof(wifi_c_history));
+    LOG_DEBUG("BSSID history deinitialized");
+}
+
+bool wifi_c_history_is_init(void)
+{
+    return wifi_c_history.initialized;
+}
+
+int wifi_c_history_add_scan(const wifi_ap_record_t *records, uint16_t count)
+{
+    ERR_C_CHECK_NULL_PTR(records, LOG_ERROR("scan records cannot be NULL"));
+    if (!wifi_c_history.initialized)
+    {
+        return WIFI_C_ERR_HISTORY_NOT_INIT;
+    }
+
+    uint32_t now_ms = (uint32_t)(esp_timer_get_time() / 1000);
+
+    xSemaphoreTake(wifi_c_history.lock, portMAX_DELAY);
+    for (uint16_t i = 0; i < count; i++)
+    {
+        wifi_c_history_update(&records[i], now_ms);
+    }
+    xSemaphoreGive(wifi_c_history.lock);
+    return ERR_C_OK;
+}
+
+uint16_t wifi_c_history_get_count(void)
+{
+    return wifi_c_history.initialized ? wifi_c_history.used : 0;
+}
+
+uint32_t wifi_c_history_get_evicted_count(void)
+{
+    return wifi_c_history.evicted;
+}
+
+int wifi_c_history_get_record(const uint8_t bssid[6], wifi_c_history_record_t *record)
+{
+    err_c_t err = ERR_C_OK;
+    ERR_C_CHECK_NULL_PTR(bssid, LOG_ERROR("BSSID cannot be NULL"));
+    ERR_C_CHECK_NULL_PTR(record, LOG_ERROR("pointer to store history record cannot be NULL"));
+    if (!wifi_c_history.initialized)
+    {
+        return WIFI_C_ERR_HISTORY_NOT_INIT;
+    }
+
+    xSemaphoreTake(wifi_c_history.lock, portMAX_DELAY);
+    uint16_t index = wifi_c_history_find(bssid);
+    if (index != WIFI_C_HISTORY_NIL)
+    {
+        wifi_c_history_to_record(&wifi_c_history.entries[index], record);
+    }
+    else
+    {
+        err = WIFI_C_ERR_AP_NOT_FOUND;
+    }
+    xSemaphoreGive(wifi_c_history.lock);
+    return err;
+}
+
+int wifi_c_history_for_each(wifi_c_history_visitor_t visitor, void *arg)
+{
+    wifi_c_history_record_t record;
+    ERR_C_CHECK_NULL_PTR(visitor, LOG_ERROR("history visitor cannot be NULL"));
+    if (!wifi_c_history.initialized)
+    {
+        return WIFI_C_ERR_HISTORY_NOT_INIT;
+    }
+
+    xSemaphoreTake(wifi_c_history.lock, portMAX_DELAY);
+    for (uint16_t index = wifi_c_history.lru_head; index != WIFI_C_HISTORY_NIL; index = wifi_c_history.entries[index].lru_next)
+    {
+        wifi_c_history_to_record(&wifi_c_history.entries[index], &record);
+        if (!visitor(&record, arg))
+        {
+            break;
+        }
+    }
+    xSemaphoreGive(wifi_c_history.lock);
+    return ERR_C_OK;
+}
+
+struct wifi_c_history_json_obj {
+    char *buffer;
+    size_t buflen;
+    size_t index;
+    char ap[400];                           // one record, SSID escaped as \uXXXX takes 6 bytes per character
+    size_t ap_len;
+};
+
+/**
+ * @brief Sink of stream collecting one record, drops bytes which don't fit.
+ */
+static int wifi_c_history_json_sink(const char *data, size_t len, void *arg)
+{
+    struct wifi_c_history_json_obj *json = (struct wifi_c_history_json_obj *)arg;
+
+    if (json->ap_len + len > sizeof(json->ap))
+    {
+        return ERR_C_MEMORY_ERR;
+    }
+    memcpy(&json->ap[json->ap_len], data, len);
+    json->ap_len += len;
+    return 0;
+}
+
+static bool wifi_c_history_json_visitor(const wifi_c_history_record_t *record, void *arg)
+{
+    struct wifi_c_history_json_obj *json = (struct wifi_c_history_json_obj *)arg;
+    wifi_c_stream_t stream;
+
+    json->ap_len = 0;
+    wifi_c_stream_init(&stream, wifi_c_history_json_sink, json);
+    wifi_c_stream_printf(&stream, "%s{\"bssid\": \"" MACSTR "\", \"ssid\": ", (json->index > 1) ? ", " : "",
+                         MAC2STR(record->bssid));
+    wifi_c_stream_json_string(&stream, record->ssid, sizeof(record->ssid));
+    wifi_c_stream_printf(&stream, ", \"channel\": %u, \"rssi_min\": %d, \"rssi_max\": %d, \"rssi_mean\": %d, \"seen\": %lu, \"channel_changes\": %u, \"first_seen_ms\": %lu, \"last_seen_ms\": %lu}",
+                         record->channel, record->rssi_min, record->rssi_max, record->rssi_mean,
+                         (unsigned long)record->seen_count, record->channel_changes,
+                         (unsigned long)record->first_seen_ms, (unsigned long)record->last_seen_ms);
+
+    // leave space for closing bracket and null terminator
+    if (wifi_c_stream_finish(&stream) != 0 || json->index + json->ap_len + 2 > json->buflen)
+    {
+        return false;
+    }
+    memcpy(&json->buffer[json->index], json->ap, json->ap_len);
+    json->index += json->ap_len;
+    return true;
+}
+
+int wifi_c_history_store_as_json(char *buffer, size_t buflen)
+{
+    err_c_t err = ERR_C_OK;
+    ERR_C_CHECK_NULL_PTR(buffer, LOG_ERROR("buffer to store BSSID history cannot be NULL"));
+    if (buflen < 3)
+    {
+        return ERR_C_INVALID_ARGS;
+    }
+
+    struct wifi_c_history_json_obj json = {
+        .buffer = buffer,
+        .buflen = buflen,
+        .index = 1,
+    };
+
+    buffer[0] = '[';
+    err = wifi_c_history_for_each(wifi_c_history_json_visitor, &json);
+    buffer[json.index++] = ']';
+    buffer[json.index] = '\0';
+    return err;
+}
+
+void wifi_c_history_clear(void)
+{
+    if (!wifi_c_history.initialized)
+    {
+        return;
+    }
+    xSemaphoreTake(wifi_c_history.lock, portMAX_DELAY);
+    wifi_c_history_reset();
+    xSemaphoreGive(wifi_c_history.lock);
+}
+#endif // WIFI_C_SCAN_ENABLED
+#endif // ESP_PLATFORM
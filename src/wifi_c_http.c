@@ -0,0 +1,217 @@
+/**
+ * @file wifi_c_http.c
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief HTTP endpoints of controller state source file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*Beginning of ESP-IDF specific code.*/
+#ifdef ESP_PLATFORM
+
+#include "esp_http_server.h"
+#include <stdio.h>
+#include <string.h>
+#include "err_controller.h"
+#include "errors_list.h"
+#include "wifi_controller.h"
+#include "wifi_c_ctx.h"
+#include "wifi_c_http.h"
+#include "wifi_c_stream.h"
+#include "logger.h"
+
+#if WIFI_C_METRICS_ENABLED
+#include "wifi_c_metrics.h"
+#endif
+
+#if WIFI_C_SPAN_TRACE_ENABLED
+#include "wifi_c_span.h"
+#endif
+
+#if WIFI_C_HTTP_ENABLED
+
+/**
+ * @brief Writes controller state to sink, same signature as wifi_c_ctx_stream_*_json().
+ */
+typedef int (*wifi_c_http_source_t)(wifi_c_ctx_t *ctx, wifi_c_stream_sink_t sink, void *arg);
+
+/**
+ * @brief Request being answered, counts sent bytes to know if error status can still be sent.
+ */
+struct wifi_c_http_response_obj {
+    httpd_req_t *req;
+    size_t sent;
+};
+
+#if WIFI_C_JSON_ENABLED
+/*Controller task changes default context, copy of its state is taken there and streamed here. Other contexts are used by application itself.*/
+static int wifi_c_http_status_source(wifi_c_ctx_t *ctx, wifi_c_stream_sink_t sink, void *arg)
+{
+    return (ctx == wifi_c_ctx_get_default()) ? wifi_c_stream_status_json(sink, arg)
+                                             : wifi_c_ctx_stream_status_json(ctx, sink, arg);
+}
+
+#if WIFI_C_SCAN_ENABLED
+static int wifi_c_http_scan_source(wifi_c_ctx_t *ctx, wifi_c_stream_sink_t sink, void *arg)
+{
+    return (ctx == wifi_c_ctx_get_default()) ? wifi_c_stream_scan_json(sink, arg)
+                                             : wifi_c_ctx_stream_scan_json(ctx, sink, arg);
+}
+#endif
+#endif
+
+#if WIFI_C_METRICS_ENABLED
+static int wifi_c_http_metrics_source(wifi_c_ctx_t *ctx, wifi_c_stream_sink_t sink, void *arg)
+{
+    (void)ctx;
+    return wifi_c_metrics_stream_prometheus(sink, arg);
+}
+#endif
+
+#if WIFI_C_SPAN_TRACE_ENABLED
+static int wifi_c_http_trace_source(wifi_c_ctx_t *ctx, wifi_c_stream_sink_t sink, void *arg)
+{
+    (void)ctx;
+    return wifi_c_span_export_chrome(sink, arg);
+}
+#endif
+
+/**
+ * @brief Endpoints in order of registration.
+ */
+static const struct {
+    const char *uri;
+    const char *type;
+    wifi_c_http_source_t source;
+} wifi_c_http_endpoints[] = {
+#if WIFI_C_JSON_ENABLED
+    {"/wifi/status", "application/json", wifi_c_http_status_source},
+#if WIFI_C_SCAN_ENABLED
+    {"/wifi/scan", "application/json", wifi_c_http_scan_source},
+#endif
+#if WIFI_C_AP_ENABLED
+    {"/wifi/stations", "application/json", wifi_c_ctx_stream_stations_json},
+#endif
+#endif
+#if WIFI_C_METRICS_ENABLED
+    {"/wifi/metrics", "text/plain; version=0.0.4", wifi_c_http_metrics_source},
+#endif
+#if WIFI_C_SPAN_TRACE_ENABLED
+    {"/wifi/trace", "application/json", wifi_c_http_trace_source},
+#endif
+};
+
+_Static_assert(sizeof(wifi_c_http_endpoints) / sizeof(wifi_c_http_endpoints[0]) == WIFI_C_HTTP_URI_COUNT,
+               "WIFI_C_HTTP_URI_COUNT doesn't match endpoints");
+
+static int wifi_c_http_sink(const char *data, size_t len, void *arg)
+{
+    struct wifi_c_http_response_obj *response = arg;
+    esp_err_t err = httpd_resp_send_chunk(response->req, data, (ssize_t)len);
+
+    if (err == ESP_OK)
+    {
+        response->sent += len;
+    }
+    return err;
+}
+
+static esp_err_t wifi_c_http_handler(httpd_req_t *req)
+{
+    struct wifi_c_http_response_obj response = {
+        .req = req,
+        .sent = 0,
+    };
+    const char *uri = req->uri;
+    size_t index = 0;
+    int err = ERR_C_OK;
+
+    for (; index < WIFI_C_HTTP_URI_COUNT; index++)
+    {
+        if (strncmp(uri, wifi_c_http_endpoints[index].uri, strlen(wifi_c_http_endpoints[index].uri)) == 0)
+        {
+            break;
+        }
+    }
+    if (index == WIFI_C_HTTP_URI_COUNT)
+    {
+        return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, NULL);
+    }
+
+    httpd_resp_set_type(req, wifi_c_http_endpoints[index].type);
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+    err = wifi_c_http_endpoints[index].source((wifi_c_ctx_t *)req->user_ctx, wifi_c_http_sink, &response);
+
+    if (err == ERR_C_OK)
+    {
+        // zero length chunk ends chunked response
+        return httpd_resp_send_chunk(req, NULL, 0);
+    }
+    if (response.sent == 0)
+    {
+        char body[64];
+        const char *name = error_to_name(err);
+
+        LOG_WARN("%s not available: %s", wifi_c_http_endpoints[index].uri, (name != NULL) ? name : "unknown error");
+        snprintf(body, sizeof(body), "{\"error\": \"%s\"}", (name != NULL) ? name : "unknown error");
+        httpd_resp_set_status(req, "503 Service Unavailable");
+        httpd_resp_set_type(req, "application/json");
+        return httpd_resp_sendstr(req, body);
+    }
+
+    // part of body is already sent, only closing connection tells client it's truncated
+    LOG_ERROR("%s failed after %u bytes: %s", wifi_c_http_endpoints[index].uri, (unsigned)response.sent, esp_err_to_name((esp_err_t)err));
+    return ESP_FAIL;
+}
+
+int wifi_c_http_register(httpd_handle_t server, wifi_c_ctx_t *ctx)
+{
+    volatile err_c_t err = ERR_C_OK;
+    volatile size_t registered = 0;
+
+    ERR_C_CHECK_NULL_PTR(server, LOG_ERROR("HTTP server handle cannot be NULL"));
+    Try
+    {
+        for (; registered < WIFI_C_HTTP_URI_COUNT; registered++)
+        {
+            httpd_uri_t uri = {
+                .uri = wifi_c_http_endpoints[registered].uri,
+                .method = HTTP_GET,
+                .handler = wifi_c_http_handler,
+                .user_ctx = (ctx != NULL) ? ctx : wifi_c_ctx_get_default(),
+            };
+            ERR_C_CHECK_AND_THROW_ERR(httpd_register_uri_handler(server, &uri));
+        }
+        LOG_INFO("%u WiFi endpoints registered on HTTP server", (unsigned)registered);
+    }
+    Catch(err)
+    {
+        LOG_ERROR("Error %d when registering %s on HTTP server: %s", err, wifi_c_http_endpoints[registered].uri,
+                  esp_err_to_name((esp_err_t)err));
+        while (registered > 0)
+        {
+            registered--;
+            httpd_unregister_uri_handler(server, wifi_c_http_endpoints[registered].uri, HTTP_GET);
+        }
+    }
+
+    return err;
+}
+
+void wifi_c_http_unregister(httpd_handle_t server)
+{
+    if (server == NULL)
+    {
+        return;
+    }
+    for (size_t i = 0; i < WIFI_C_HTTP_URI_COUNT; i++)
+    {
+        // handlers missing after failed registration are fine
+        httpd_unregister_uri_handler(server, wifi_c_http_endpoints[i].uri, HTTP_GET);
+    }
+}
+#endif // WIFI_C_HTTP_ENABLED
+#endif // ESP_PLATFORM
@@ -0,0 +1,110 @@
+/**
+ * @file wifi_c_link.c
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief STA connection state machine source file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*Beginning of ESP-IDF specific code.*/
+#ifdef ESP_PLATFORM
+
+#include "esp_wifi.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+#include <stdio.h>
+#include <string.h>
+#include "wifi_controller.h"
+#include "wifi_c_link.h"
+
+#if WIFI_C_STA_ENABLED
+void wifi_c_link_init(wifi_c_link_t *link, wifi_c_status_t *status, const char *ssid, uint8_t retry_count)
+{
+    link->status = status;
+    link->ssid = ssid;
+    link->retry_num = 0;
+    link->retry_count = retry_count;
+}
+
+static void wifi_c_link_on_disconnected(wifi_c_link_t *link, wifi_c_link_step_t *step)
+{
+    step->clear_bits = WIFI_C_STA_LINK_UP_BIT | WIFI_C_CONNECTED_BIT;
+    if (link->status->suspended)
+    {
+        return; // radio stopped by suspend, nothing to reconnect
+    }
+    if (link->retry_num < link->retry_count)
+    {
+        link->retry_num++;
+        step->reconnect = true;
+    }
+    else
+    {
+        step->set_bits = WIFI_C_CONNECT_FAIL_BIT;
+    }
+}
+
+static void wifi_c_link_on_got_ip(wifi_c_link_t *link, const ip_event_got_ip_t *event, wifi_c_link_step_t *step)
+{
+    wifi_c_status_t *status = link->status;
+
+    snprintf(status->sta.ip, sizeof(status->sta.ip), IPSTR, IP2STR(&event->ip_info.ip));
+    status->sta_connected = true;
+    /*Link is up, next disconnect gets whole retry budget.*/
+    link->retry_num = 0;
+    /*Also connects which didn't wait for result show SSID in status.*/
+    memset(status->sta.ssid, 0, sizeof(status->sta.ssid));
+    strncpy(status->sta.ssid, link->ssid, sizeof(status->sta.ssid) - 1);
+    step->set_bits = WIFI_C_CONNECTED_BIT;
+}
+
+wifi_c_link_step_t wifi_c_link_on_event(wifi_c_link_t *link, esp_event_base_t event_base, int32_t event_id,
+                                        const void *event_data)
+{
+    wifi_c_link_step_t step = {0};
+
+    if (event_base == IP_EVENT)
+    {
+        if (event_id == IP_EVENT_STA_GOT_IP)
+        {
+            wifi_c_link_on_got_ip(link, (const ip_event_got_ip_t *)event_data, &step);
+        }
+        return step;
+    }
+    if (event_base != WIFI_EVENT)
+    {
+        return step;
+    }
+
+    switch (event_id)
+    {
+    case WIFI_EVENT_STA_START:
+        link->status->sta_started = true;
+        step.set_bits = WIFI_C_STA_STARTED_BIT;
+        break;
+    case WIFI_EVENT_STA_STOP:
+        link->status->sta_started = false;
+        step.clear_bits = WIFI_C_STA_STARTED_BIT | WIFI_C_STA_LINK_UP_BIT | WIFI_C_CONNECTED_BIT;
+        break;
+    case WIFI_EVENT_STA_CONNECTED:
+        step.set_bits = WIFI_C_STA_LINK_UP_BIT;
+        break;
+    case WIFI_EVENT_STA_DISCONNECTED:
+        wifi_c_link_on_disconnected(link, &step);
+        break;
+#if WIFI_C_SCAN_ENABLED
+    case WIFI_EVENT_SCAN_DONE:
+        link->status->scan_done = true;
+        step.set_bits = WIFI_C_SCAN_DONE_BIT;
+        break;
+#endif
+    default:
+        break;
+    }
+    return step;
+}
+#endif // WIFI_C_STA_ENABLED
+#endif // ESP_PLATFORM
@@ -0,0 +1,325 @@
+/**
+ * @file wifi_c_log.c
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief Deferred binary event log source file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*Beginning of ESP-IDF specific code.*/
+#ifdef ESP_PLATFORM
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <stdatomic.h>
+#include <string.h>
+#include <stdio.h>
+#include "err_controller.h"
+#include "errors_list.h"
+#include "wifi_controller.h"
+#include "wifi_c_log.h"
+#include "logger.h"
+
+#if WIFI_C_DEFERRED_LOG_ENABLED
+
+#define WIFI_C_LOG_RING_SIZE            CONFIG_WIFI_C_DEFERRED_LOG_RECORDS
+#define WIFI_C_LOG_RING_MASK            (WIFI_C_LOG_RING_SIZE - 1)
+
+_Static_assert((WIFI_C_LOG_RING_SIZE & WIFI_C_LOG_RING_MASK) == 0, "CONFIG_WIFI_C_DEFERRED_LOG_RECORDS must be power of two");
+_Static_assert(sizeof(wifi_c_log_record_t) == 32, "wifi_c_log_record_t binary format changed");
+
+/**
+ * @brief Slot of log ring, sequence tells producers and consumer who owns it.
+ */
+struct wifi_c_log_slot_obj {
+    atomic_uint_fast32_t sequence;
+    wifi_c_log_record_t record;
+};
+
+/**
+ * @brief Bounded multi-producer single-consumer ring, no locks on push.
+ */
+static struct {
+    struct wifi_c_log_slot_obj slots[WIFI_C_LOG_RING_SIZE];
+    atomic_uint_fast32_t head;
+    uint_fast32_t tail;
+    atomic_uint_fast32_t dropped;
+    bool initialized;
+} wifi_c_log_ring;
+
+/**
+ * @brief States of log task, start and stop change them under lock.
+ */
+typedef enum {
+    WIFI_C_LOG_TASK_STOPPED = 0,
+    WIFI_C_LOG_TASK_STARTING,             /*task is being created, handle is not published yet*/
+    WIFI_C_LOG_TASK_RUNNING,
+    WIFI_C_LOG_TASK_STOPPING,             /*stop waits for task to print pending records*/
+} wifi_c_log_task_state_t;
+
+static struct {
+    TaskHandle_t handle;
+    SemaphoreHandle_t stopped;
+    StaticSemaphore_t stopped_buffer;
+    volatile wifi_c_log_task_state_t state;
+    portMUX_TYPE lock;
+} wifi_c_log_task_ctl = {
+    .handle = NULL,
+    .stopped = NULL,
+    .state = WIFI_C_LOG_TASK_STOPPED,
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+static void wifi_c_log_ring_init(void)
+{
+    if (wifi_c_log_ring.initialized)
+    {
+        return;
+    }
+    for (uint32_t i = 0; i < WIFI_C_LOG_RING_SIZE; i++)
+    {
+        atomic_init(&wifi_c_log_ring.slots[i].sequence, i);
+    }
+    atomic_init(&wifi_c_log_ring.head, 0);
+    atomic_init(&wifi_c_log_ring.dropped, 0);
+    wifi_c_log_ring.tail = 0;
+    wifi_c_log_ring.initialized = true;
+}
+
+void wifi_c_log_push(wifi_c_log_id_t id, const void *args, size_t args_len)
+{
+    struct wifi_c_log_slot_obj *slot;
+    uint_fast32_t position = atomic_load_explicit(&wifi_c_log_ring.head, memory_order_relaxed);
+
+    if (!wifi_c_log_ring.initialized)
+    {
+        return;
+    }
+
+    for (;;)
+    {
+        slot = &wifi_c_log_ring.slots[position & WIFI_C_LOG_RING_MASK];
+        uint_fast32_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        int32_t diff = (int32_t)(sequence - position);
+
+        if (diff == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&wifi_c_log_ring.head, &position, position + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // ring is full, consumer didn't take this slot yet
+            atomic_fetch_add_explicit(&wifi_c_log_ring.dropped, 1, memory_order_relaxed);
+            return;
+        }
+        else
+        {
+            position = atomic_load_explicit(&wifi_c_log_ring.head, memory_order_relaxed);
+        }
+    }
+
+    if (args_len > WIFI_C_LOG_MAX_ARGS)
+    {
+        args_len = WIFI_C_LOG_MAX_ARGS;
+    }
+    slot->record.timestamp_us = esp_timer_get_time();
+    slot->record.id = (uint16_t)id;
+    slot->record.args_len = (uint8_t)args_len;
+    slot->record.reserved = 0;
+    if (args != NULL && args_len > 0)
+    {
+        memcpy(slot->record.args, args, args_len);
+    }
+    atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+}
+
+bool wifi_c_log_pop(wifi_c_log_record_t *record)
+{
+    uint_fast32_t position = wifi_c_log_ring.tail;
+    struct wifi_c_log_slot_obj *slot = &wifi_c_log_ring.slots[position & WIFI_C_LOG_RING_MASK];
+
+    if (!wifi_c_log_ring.initialized || record == NULL)
+    {
+        return false;
+    }
+
+    if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != position + 1)
+    {
+        return false;
+    }
+
+    memcpy(record, &slot->record, sizeof(wifi_c_log_record_t));
+    atomic_store_explicit(&slot->sequence, position + WIFI_C_LOG_RING_SIZE, memory_order_release);
+    wifi_c_log_ring.tail = position + 1;
+    return true;
+}
+
+uint32_t wifi_c_log_get_dropped(void)
+{
+    return (uint32_t)atomic_load_explicit(&wifi_c_log_ring.dropped, memory_order_relaxed);
+}
+
+static void wifi_c_log_flush(uint32_t *reported_dropped)
+{
+    wifi_c_log_record_t record;
+    char line[96];
+    uint32_t dropped = wifi_c_log_get_dropped();
+
+    while (wifi_c_log_pop(&record))
+    {
+        wifi_c_log_format(&record, line, sizeof(line));
+        LOG_INFO("%s", line);
+    }
+
+    if (dropped != *reported_dropped)
+    {
+        LOG_WARN("%lu log records dropped, ring is full.", (unsigned long)(dropped - *reported_dropped));
+        *reported_dropped = dropped;
+    }
+}
+
+static void wifi_c_log_task(void *arg)
+{
+    uint32_t reported_dropped = 0;
+
+    while (wifi_c_log_task_ctl.state != WIFI_C_LOG_TASK_STOPPING) // task may run before start publishes RUNNING
+    {
+        wifi_c_log_flush(&reported_dropped);
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CONFIG_WIFI_C_DEFERRED_LOG_PERIOD_MS)); // stop wakes task early
+    }
+    wifi_c_log_flush(&reported_dropped);
+    // ring and task state are not touched after this, next task may already start
+    xSemaphoreGive(wifi_c_log_task_ctl.stopped);
+    vTaskDelete(NULL);
+}
+
+int wifi_c_log_start(void)
+{
+    wifi_c_log_task_state_t state;
+    TaskHandle_t task = NULL;
+
+    portENTER_CRITICAL(&wifi_c_log_task_ctl.lock);
+    state = wifi_c_log_task_ctl.state;
+    if (state == WIFI_C_LOG_TASK_STOPPED)
+    {
+        wifi_c_log_task_ctl.state = WIFI_C_LOG_TASK_STARTING; // claimed, concurrent start returns at once
+    }
+    portEXIT_CRITICAL(&wifi_c_log_task_ctl.lock);
+
+    if (state == WIFI_C_LOG_TASK_RUNNING || state == WIFI_C_LOG_TASK_STARTING)
+    {
+        return ERR_C_OK;
+    }
+    if (state == WIFI_C_LOG_TASK_STOPPING)
+    {
+        LOG_WARN("Deferred log task is stopping, it can't be started now.");
+        return WIFI_C_ERR_LOG_STOPPING;
+    }
+
+    wifi_c_log_ring_init();
+    if (wifi_c_log_task_ctl.stopped == NULL)
+    {
+        wifi_c_log_task_ctl.stopped = xSemaphoreCreateBinaryStatic(&wifi_c_log_task_ctl.stopped_buffer);
+    }
+    if (xTaskCreatePinnedToCore(wifi_c_log_task, "wifi_c_log", CONFIG_WIFI_C_DEFERRED_LOG_TASK_STACK, NULL,
+                                CONFIG_WIFI_C_DEFERRED_LOG_TASK_PRIORITY, &task, tskNO_AFFINITY) != pdPASS)
+    {
+        portENTER_CRITICAL(&wifi_c_log_task_ctl.lock);
+        wifi_c_log_task_ctl.state = WIFI_C_LOG_TASK_STOPPED;
+        portEXIT_CRITICAL(&wifi_c_log_task_ctl.lock);
+        LOG_ERROR("Failed to create deferred log task.");
+        return ERR_C_MEMORY_ERR;
+    }
+
+    /*Handle and state are published together, stop sees either STARTING or RUNNING with handle.*/
+    portENTER_CRITICAL(&wifi_c_log_task_ctl.lock);
+    wifi_c_log_task_ctl.handle = task;
+    wifi_c_log_task_ctl.state = WIFI_C_LOG_TASK_RUNNING;
+    portEXIT_CRITICAL(&wifi_c_log_task_ctl.lock);
+    return ERR_C_OK;
+}
+
+void wifi_c_log_stop(void)
+{
+    TaskHandle_t task = NULL;
+    wifi_c_log_task_state_t state;
+
+    do
+    {
+        portENTER_CRITICAL(&wifi_c_log_task_ctl.lock);
+        state = wifi_c_log_task_ctl.state;
+        if (state == WIFI_C_LOG_TASK_RUNNING)
+        {
+            wifi_c_log_task_ctl.state = WIFI_C_LOG_TASK_STOPPING;
+            task = wifi_c_log_task_ctl.handle;
+        }
+        portEXIT_CRITICAL(&wifi_c_log_task_ctl.lock);
+        if (state == WIFI_C_LOG_TASK_STARTING)
+        {
+            vTaskDelay(1); // start publishes handle right after task is created
+        }
+    } while (state == WIFI_C_LOG_TASK_STARTING);
+
+    if (task == NULL)
+    {
+        return; // not running, or other caller is already stopping it
+    }
+
+    // task prints pending records before deleting itself
+    xTaskNotifyGive(task);
+    xSemaphoreTake(wifi_c_log_task_ctl.stopped, portMAX_DELAY);
+
+    portENTER_CRITICAL(&wifi_c_log_task_ctl.lock);
+    wifi_c_log_task_ctl.handle = NULL;
+    wifi_c_log_task_ctl.state = WIFI_C_LOG_TASK_STOPPED;
+    portEXIT_CRITICAL(&wifi_c_log_task_ctl.lock);
+}
+#endif // WIFI_C_DEFERRED_LOG_ENABLED
+#endif // ESP_PLATFORM
+
+/*Formatting doesn't depend on ESP-IDF, so dumped records can be formatted on host.*/
+#include <stdio.h>
+#include <string.h>
+#include "wifi_c_log.h"
+
+#if !defined(ESP_PLATFORM) || WIFI_C_DEFERRED_LOG_ENABLED
+int wifi_c_log_format(const wifi_c_log_record_t *record, char *buffer, size_t buflen)
+{
+    const uint8_t *a = record->args;
+    unsigned long ms = (unsigned long)(record->timestamp_us / 1000);
+
+    switch (record->id)
+    {
+    case WIFI_C_LOG_AP_STA_JOINED:
+        return snprintf(buffer, buflen, "[%lu] Station %02x:%02x:%02x:%02x:%02x:%02x joined, AID=%d",
+                        ms, a[0], a[1], a[2], a[3], a[4], a[5], a[6]);
+    case WIFI_C_LOG_AP_STA_LEFT:
+        return snprintf(buffer, buflen, "[%lu] Station %02x:%02x:%02x:%02x:%02x:%02x left, AID=%d",
+                        ms, a[0], a[1], a[2], a[3], a[4], a[5], a[6]);
+    case WIFI_C_LOG_SCAN_DONE:
+        return snprintf(buffer, buflen, "[%lu] Total APs scanned: %u", ms, (unsigned)(a[0] | (a[1] << 8)));
+    case WIFI_C_LOG_STA_STARTED:
+        return snprintf(buffer, buflen, "[%lu] Station started, connecting to WiFi.", ms);
+    case WIFI_C_LOG_STA_RETRY:
+        return snprintf(buffer, buflen, "[%lu] Failed to connect to AP (reason %u), trying again, retry %u.", ms, a[1], a[0]);
+    case WIFI_C_LOG_STA_CONNECT_FAIL:
+        return snprintf(buffer, buflen, "[%lu] Failed to connect to AP (reason %u) after %u retries.", ms, a[1], a[0]);
+    case WIFI_C_LOG_STA_GOT_IP:
+        return snprintf(buffer, buflen, "[%lu] Got IP:%u.%u.%u.%u", ms, a[0], a[1], a[2], a[3]);
+    case WIFI_C_LOG_STA_LEASE_CONFLICT:
+        return snprintf(buffer, buflen, "[%lu] Cached address %u.%u.%u.%u replaced by %u.%u.%u.%u after renew.",
+                        ms, a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7]);
+    default:
+        return snprintf(buffer, buflen, "[%lu] Unknown event %u", ms, record->id);
+    }
+}
+#endif
@@ -0,0 +1,372 @@
+/**
+ * @file wifi_c_metrics.c
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief Lock-free metrics counters source file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*Beginning of ESP-IDF specific code.*/
+#ifdef ESP_PLATFORM
+
+#include "esp_timer.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include "err_controller.h"
+#include "wifi_controller.h"
+#include "wifi_c_metrics.h"
+#include "logger.h"
+
+#if WIFI_C_METRICS_ENABLED
+#define WIFI_C_METRICS_OTHER_REASON     (WIFI_C_METRICS_REASON_SLOTS - 1)
+
+/**
+ * @brief All values are 32 bit, so updates are lock-free on every target.
+ */
+static struct {
+    atomic_uint_fast32_t value[WIFI_C_METRIC_COUNT];
+    atomic_uint_fast32_t disconnect_reasons[WIFI_C_METRICS_REASON_SLOTS];
+    atomic_uint_fast32_t connect_start_us;        // wraps after 71 minutes, differences stay valid
+    atomic_bool connect_pending;
+} wifi_c_metrics;
+
+/**
+ * @brief Name, type and description of every metric, in order of wifi_c_metric_id_t.
+ */
+static const struct {
+    const char *name;
+    const char *type;
+    const char *help;
+} wifi_c_metrics_info[WIFI_C_METRIC_COUNT] = {
+    {"wifi_c_connect_attempts_total", "counter", "STA connect attempts, including retries."},
+    {"wifi_c_connect_successes_total", "counter", "STA connections which received IP address."},
+    {"wifi_c_connect_failures_total", "counter", "STA connections given up after all retries."},
+    {"wifi_c_disconnects_total", "counter", "STA disconnect events."},
+    {"wifi_c_scans_total", "counter", "Finished scans."},
+    {"wifi_c_scan_time_us_total", "counter", "Time spent scanning."},
+    {"wifi_c_scan_last_us", "gauge", "Duration of last scan."},
+    {"wifi_c_scan_off_channel_last_us", "gauge", "Longest continuous time away from home channel in last scan."},
+    {"wifi_c_scan_slices_total", "counter", "Slices of sliced scans."},
+    {"wifi_c_got_ip_time_us_total", "counter", "Time from first connect attempt to IP, all connections."},
+    {"wifi_c_got_ip_last_us", "gauge", "Time from first connect attempt to IP, last connection."},
+    {"wifi_c_got_ip_max_us", "gauge", "Time from first connect attempt to IP, slowest connection."},
+    {"wifi_c_roams_total", "counter", "Roams to other BSSID which got IP."},
+    {"wifi_c_roam_failures_total", "counter", "Roams which didn't get IP in time."},
+    {"wifi_c_roam_last_us", "gauge", "Time from leaving old AP to IP, last roam."},
+    {"wifi_c_roam_max_us", "gauge", "Time from leaving old AP to IP, slowest roam."},
+    {"wifi_c_resumes_total", "counter", "STA reconnections after resume which got IP."},
+    {"wifi_c_resume_last_us", "gauge", "Time from resume call to IP, last resume."},
+    {"wifi_c_ap_joins_total", "counter", "Stations connected to AP."},
+    {"wifi_c_ap_leaves_total", "counter", "Stations disconnected from AP."},
+    {"wifi_c_ap_clients", "gauge", "Stations currently connected to AP."},
+};
+
+static inline void wifi_c_metrics_set(wifi_c_metric_id_t id, uint32_t value)
+{
+    atomic_store_explicit(&wifi_c_metrics.value[id], value, memory_order_relaxed);
+}
+
+static inline void wifi_c_metrics_add(wifi_c_metric_id_t id, uint32_t value)
+{
+    atomic_fetch_add_explicit(&wifi_c_metrics.value[id], value, memory_order_relaxed);
+}
+
+static void wifi_c_metrics_set_max(wifi_c_metric_id_t id, uint32_t value)
+{
+    uint_fast32_t current = atomic_load_explicit(&wifi_c_metrics.value[id], memory_order_relaxed);
+
+    while (value > current &&
+           !atomic_compare_exchange_weak_explicit(&wifi_c_metrics.value[id], &current, value,
+                                                  memory_order_relaxed, memory_order_relaxed))
+    {
+    }
+}
+
+static uint8_t wifi_c_metrics_slot_of_reason(uint8_t reason)
+{
+    if (reason < 64)
+    {
+        return reason;
+    }
+    if (reason >= 200 && reason < 232)
+    {
+        return (uint8_t)(64 + reason - 200);
+    }
+    return WIFI_C_METRICS_OTHER_REASON;
+}
+
+uint16_t wifi_c_metrics_reason_of_slot(uint8_t slot)
+{
+    if (slot < 64)
+    {
+        return slot;
+    }
+    if (slot < WIFI_C_METRICS_OTHER_REASON)
+    {
+        return (uint16_t)(200 + slot - 64);
+    }
+    return 0xFFFF;
+}
+
+void wifi_c_metrics_inc(wifi_c_metric_id_t id)
+{
+    if (id < WIFI_C_METRIC_COUNT)
+    {
+        wifi_c_metrics_add(id, 1);
+    }
+}
+
+void wifi_c_metrics_disconnect(uint8_t reason)
+{
+    wifi_c_metrics_add(WIFI_C_METRIC_DISCONNECTS, 1);
+    atomic_fetch_add_explicit(&wifi_c_metrics.disconnect_reasons[wifi_c_metrics_slot_of_reason(reason)], 1, memory_order_relaxed);
+}
+
+void wifi_c_metrics_connect_attempt(void)
+{
+    bool pending = false;
+
+    wifi_c_metrics_add(WIFI_C_METRIC_CONNECT_ATTEMPTS, 1);
+    if (atomic_compare_exchange_strong(&wifi_c_metrics.connect_pending, &pending, true))
+    {
+        atomic_store_explicit(&wifi_c_metrics.connect_start_us, (uint32_t)esp_timer_get_time(), memory_order_release);
+    }
+}
+
+void wifi_c_metrics_connect_failed(void)
+{
+    wifi_c_metrics_add(WIFI_C_METRIC_CONNECT_FAILURES, 1);
+    atomic_store(&wifi_c_metrics.connect_pending, false);
+}
+
+void wifi_c_metrics_got_ip(void)
+{
+    wifi_c_metrics_add(WIFI_C_METRIC_CONNECT_SUCCESSES, 1);
+    if (atomic_exchange(&wifi_c_metrics.connect_pending, false))
+    {
+        uint32_t start = (uint32_t)atomic_load_explicit(&wifi_c_metrics.connect_start_us, memory_order_acquire);
+        uint32_t latency = (uint32_t)esp_timer_get_time() - start;
+
+        wifi_c_metrics_add(WIFI_C_METRIC_GOT_IP_TIME_US, latency);
+        wifi_c_metrics_set(WIFI_C_METRIC_GOT_IP_LAST_US, latency);
+        wifi_c_metrics_set_max(WIFI_C_METRIC_GOT_IP_MAX_US, latency);
+    }
+}
+
+void wifi_c_metrics_roam_done(bool success, uint32_t duration_us)
+{
+    if (!success)
+    {
+        wifi_c_metrics_add(WIFI_C_METRIC_ROAM_FAILURES, 1);
+        return;
+    }
+    wifi_c_metrics_add(WIFI_C_METRIC_ROAMS, 1);
+    wifi_c_metrics_set(WIFI_C_METRIC_ROAM_LAST_US, duration_us);
+    wifi_c_metrics_set_max(WIFI_C_METRIC_ROAM_MAX_US, duration_us);
+}
+
+void wifi_c_metrics_resume_done(uint32_t duration_us)
+{
+    wifi_c_metrics_add(WIFI_C_METRIC_RESUMES, 1);
+    wifi_c_metrics_set(WIFI_C_METRIC_RESUME_LAST_US, duration_us);
+}
+
+void wifi_c_metrics_scan_done(uint32_t duration_us)
+{
+    wifi_c_metrics_add(WIFI_C_METRIC_SCANS, 1);
+    wifi_c_metrics_add(WIFI_C_METRIC_SCAN_TIME_US, duration_us);
+    wifi_c_metrics_set(WIFI_C_METRIC_SCAN_LAST_US, duration_us);
+    wifi_c_metrics_set(WIFI_C_METRIC_SCAN_OFF_CHANNEL_LAST_US, duration_us); // whole sweep away from home channel
+}
+
+void wifi_c_metrics_scan_sliced_done(uint32_t duration_us, uint16_t slices, uint32_t max_off_channel_us)
+{
+    wifi_c_metrics_add(WIFI_C_METRIC_SCANS, 1);
+    wifi_c_metrics_add(WIFI_C_METRIC_SCAN_TIME_US, duration_us);
+    wifi_c_metrics_set(WIFI_C_METRIC_SCAN_LAST_US, duration_us);
+    wifi_c_metrics_set(WIFI_C_METRIC_SCAN_OFF_CHANNEL_LAST_US, max_off_channel_us);
+    wifi_c_metrics_add(WIFI_C_METRIC_SCAN_SLICES, slices);
+}
+
+void wifi_c_metrics_ap_station(bool joined)
+{
+    if (joined)
+    {
+        wifi_c_metrics_add(WIFI_C_METRIC_AP_JOINS, 1);
+        wifi_c_metrics_add(WIFI_C_METRIC_AP_CLIENTS, 1);
+        return;
+    }
+
+    uint_fast32_t clients = atomic_load_explicit(&wifi_c_metrics.value[WIFI_C_METRIC_AP_CLIENTS], memory_order_relaxed);
+    wifi_c_metrics_add(WIFI_C_METRIC_AP_LEAVES, 1);
+    // don't go below zero if station joined before metrics were reset
+    while (clients > 0 &&
+           !atomic_compare_exchange_weak_explicit(&wifi_c_metrics.value[WIFI_C_METRIC_AP_CLIENTS], &clients, clients - 1,
+                                                  memory_order_relaxed, memory_order_relaxed))
+    {
+    }
+}
+
+void wifi_c_metrics_get(wifi_c_metrics_t *metrics)
+{
+    if (metrics == NULL)
+    {
+        return;
+    }
+    for (int i = 0; i < WIFI_C_METRIC_COUNT; i++)
+    {
+        metrics->value[i] = (uint32_t)atomic_load_explicit(&wifi_c_metrics.value[i], memory_order_relaxed);
+    }
+    for (int i = 0; i < WIFI_C_METRICS_REASON_SLOTS; i++)
+    {
+        metrics->disconnect_reasons[i] = (uint32_t)atomic_load_explicit(&wifi_c_metrics.disconnect_reasons[i], memory_order_relaxed);
+    }
+}
+
+void wifi_c_metrics_reset(void)
+{
+    for (int i = 0; i < WIFI_C_METRIC_COUNT; i++)
+    {
+        atomic_store_explicit(&wifi_c_metrics.value[i], 0, memory_order_relaxed);
+    }
+    for (int i = 0; i < WIFI_C_METRICS_REASON_SLOTS; i++)
+    {
+        atomic_store_explicit(&wifi_c_metrics.disconnect_reasons[i], 0, memory_order_relaxed);
+    }
+    atomic_store(&wifi_c_metrics.connect_pending, false);
+}
+
+/**
+ * @brief Append formatted text, keeping count of characters that would be written like snprintf.
+ */
+#define WIFI_C_METRICS_APPEND(buffer, buflen, len, ...)                                                          \
+    do                                                                                                          \
+    {                                                                                                           \
+        int written = snprintf(((size_t)(len) < (buflen)) ? &(buffer)[len] : NULL,                              \
+                               ((size_t)(len) < (buflen)) ? (buflen) - (size_t)(len) : 0, __VA_ARGS__);         \
+        if (written > 0)                                                                                        \
+        {                                                                                                       \
+            (len) += written;                                                                                   \
+        }                                                                                                       \
+    } while (0)
+
+int wifi_c_metrics_store_as_prometheus(char *buffer, size_t buflen)
+{
+    wifi_c_metrics_t metrics;
+    int len = 0;
+
+    wifi_c_metrics_get(&metrics);
+
+    for (int i = 0; i < WIFI_C_METRIC_COUNT; i++)
+    {
+        WIFI_C_METRICS_APPEND(buffer, buflen, len, "# HELP %s %s\n# TYPE %s %s\n%s %lu\n",
+                              wifi_c_metrics_info[i].name, wifi_c_metrics_info[i].help,
+                              wifi_c_metrics_info[i].name, wifi_c_metrics_info[i].type,
+                              wifi_c_metrics_info[i].name, (unsigned long)metrics.value[i]);
+    }
+
+    WIFI_C_METRICS_APPEND(buffer, buflen, len, "# HELP wifi_c_disconnect_reasons_total STA disconnect events by reason.\n"
+                                               "# TYPE wifi_c_disconnect_reasons_total counter\n");
+    for (int i = 0; i < WIFI_C_METRICS_REASON_SLOTS; i++)
+    {
+        if (metrics.disconnect_reasons[i] == 0)
+        {
+            continue;
+        }
+        if (i == WIFI_C_METRICS_OTHER_REASON)
+        {
+            WIFI_C_METRICS_APPEND(buffer, buflen, len, "wifi_c_disconnect_reasons_total{reason=\"other\"} %lu\n",
+                                  (unsigned long)metrics.disconnect_reasons[i]);
+        }
+        else
+        {
+            WIFI_C_METRICS_APPEND(buffer, buflen, len, "wifi_c_disconnect_reasons_total{reason=\"%u\"} %lu\n",
+                                  wifi_c_metrics_reason_of_slot((uint8_t)i), (unsigned long)metrics.disconnect_reasons[i]);
+        }
+    }
+    return len;
+}
+
+int wifi_c_metrics_stream_prometheus(wifi_c_stream_sink_t sink, void *arg)
+{
+    wifi_c_metrics_t metrics;
+    wifi_c_stream_t stream;
+
+    ERR_C_CHECK_NULL_PTR(sink, LOG_ERROR("sink of metrics cannot be NULL"));
+    wifi_c_metrics_get(&metrics);
+    wifi_c_stream_init(&stream, sink, arg);
+
+    for (int i = 0; i < WIFI_C_METRIC_COUNT; i++)
+    {
+        wifi_c_stream_printf(&stream, "# HELP %s %s\n# TYPE %s %s\n%s %lu\n",
+                             wifi_c_metrics_info[i].name, wifi_c_metrics_info[i].help,
+                             wifi_c_metrics_info[i].name, wifi_c_metrics_info[i].type,
+                             wifi_c_metrics_info[i].name, (unsigned long)metrics.value[i]);
+    }
+
+    wifi_c_stream_printf(&stream, "# HELP wifi_c_disconnect_reasons_total STA disconnect events by reason.\n"
+                                  "# TYPE wifi_c_disconnect_reasons_total counter\n");
+    for (int i = 0; i < WIFI_C_METRICS_REASON_SLOTS; i++)
+    {
+        if (metrics.disconnect_reasons[i] == 0)
+        {
+            continue;
+        }
+        if (i == WIFI_C_METRICS_OTHER_REASON)
+        {
+            wifi_c_stream_printf(&stream, "wifi_c_disconnect_reasons_total{reason=\"other\"} %lu\n",
+                                 (unsigned long)metrics.disconnect_reasons[i]);
+        }
+        else
+        {
+            wifi_c_stream_printf(&stream, "wifi_c_disconnect_reasons_total{reason=\"%u\"} %lu\n",
+                                 wifi_c_metrics_reason_of_slot((uint8_t)i), (unsigned long)metrics.disconnect_reasons[i]);
+        }
+    }
+    return wifi_c_stream_finish(&stream);
+}
+
+#if WIFI_C_JSON_ENABLED
+int wifi_c_metrics_store_as_json(char *buffer, size_t buflen)
+{
+    wifi_c_metrics_t metrics;
+    int len = 0;
+    bool first = true;
+
+    wifi_c_metrics_get(&metrics);
+
+    WIFI_C_METRICS_APPEND(buffer, buflen, len, "{");
+    for (int i = 0; i < WIFI_C_METRIC_COUNT; i++)
+    {
+        // names without "wifi_c_" prefix
+        WIFI_C_METRICS_APPEND(buffer, buflen, len, "%s\"%s\":%lu", (i > 0) ? "," : "",
+                              wifi_c_metrics_info[i].name + 7, (unsigned long)metrics.value[i]);
+    }
+    WIFI_C_METRICS_APPEND(buffer, buflen, len, ",\"disconnect_reasons\":{");
+    for (int i = 0; i < WIFI_C_METRICS_REASON_SLOTS; i++)
+    {
+        if (metrics.disconnect_reasons[i] == 0)
+        {
+            continue;
+        }
+        if (i == WIFI_C_METRICS_OTHER_REASON)
+        {
+            WIFI_C_METRICS_APPEND(buffer, buflen, len, "%s\"other\":%lu", first ? "" : ",", (unsigned long)metrics.disconnect_reasons[i]);
+        }
+        else
+        {
+            WIFI_C_METRICS_APPEND(buffer, buflen, len, "%s\"%u\":%lu", first ? "" : ",",
+                                  wifi_c_metrics_reason_of_slot((uint8_t)i), (unsigned long)metrics.disconnect_reasons[i]);
+        }
+        first = false;
+    }
+    WIFI_C_METRICS_APPEND(buffer, buflen, len, "}}");
+    return len;
+}
+#endif
+#endif // WIFI_C_METRICS_ENABLED
+#endif // ESP_PLATFORM
@@ -0,0 +1,388 @@
+/**
+ * @file wifi_c_psk.c
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief Cache of WPA2 pre-shared keys derived from passphrases source file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*Beginning of ESP-IDF specific code.*/
+#ifdef ESP_PLATFORM
+
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include "freertos/FreeRTOS.h"
+#include "mbedtls/version.h"
+#include "mbedtls/md.h"
+#include "mbedtls/pkcs5.h"
+#include "mbedtls/sha256.h"
+#include <string.h>
+#include "err_controller.h"
+#include "errors_list.h"
+#include "wifi_controller.h"
+#include "wifi_c_psk.h"
+#include "logger.h"
+
+#if WIFI_C_PSK_CACHE_NVS_ENABLED
+#include "nvs.h"
+#if !defined(CONFIG_NVS_SEC_KEY_PROTECT_USING_HMAC)
+#include "esp_flash_encrypt.h"
+#endif
+#endif
+
+int wifi_c_psk_derive(const char *ssid, const char *passphrase, uint8_t psk[WIFI_C_PSK_LEN])
+{
+    size_t ssid_len = strnlen(ssid, 32);
+    size_t passphrase_len = strlen(passphrase);
+    int ret = 0;
+
+    if (passphrase_len < 8 || passphrase_len > WIFI_C_PSK_HEX_LEN - 1)
+    {
+        return ERR_C_INVALID_ARGS;
+    }
+
+#if MBEDTLS_VERSION_NUMBER >= 0x03030000
+    ret = mbedtls_pkcs5_pbkdf2_hmac_ext(MBEDTLS_MD_SHA1, (const unsigned char *)passphrase, passphrase_len,
+                                        (const unsigned char *)ssid, ssid_len, WIFI_C_PSK_ITERATIONS, WIFI_C_PSK_LEN, psk);
+#else
+    mbedtls_md_context_t md;
+
+    mbedtls_md_init(&md);
+    ret = mbedtls_md_setup(&md, mbedtls_md_info_from_type(MBEDTLS_MD_SHA1), 1);
+    if (ret == 0)
+    {
+        ret = mbedtls_pkcs5_pbkdf2_hmac(&md, (const unsigned char *)passphrase, passphrase_len,
+                                        (const unsigned char *)ssid, ssid_len, WIFI_C_PSK_ITERATIONS, WIFI_C_PSK_LEN, psk);
+    }
+    mbedtls_md_free(&md);
+#endif
+    return (ret == 0) ? ERR_C_OK : ERR_C_MEMORY_ERR;
+}
+
+#if WIFI_C_PSK_CACHE_ENABLED
+
+#define WIFI_C_PSK_ENTRIES              CONFIG_WIFI_C_PSK_CACHE_ENTRIES
+#define WIFI_C_PSK_MAGIC                0x50534B32  // "PSK2", marks valid cache after deep sleep
+#define WIFI_C_PSK_FINGERPRINT_LEN      16
+#define WIFI_C_PSK_NVS_NAMESPACE        "wifi_c_psk"
+#define WIFI_C_PSK_NVS_KEY              "cache"
+
+/**
+ * @brief PSK of one SSID, passphrase is represented only by fingerprint.
+ */
+struct wifi_c_psk_entry_obj {
+    char ssid[33];
+    uint8_t valid;
+    uint8_t passphrase_only;                // connect with PSK failed, psk is zeroed
+    uint8_t fingerprint[WIFI_C_PSK_FINGERPRINT_LEN];
+    uint8_t psk[WIFI_C_PSK_LEN];
+};
+
+/**
+ * @brief Cached PSKs, kept in RTC memory to survive deep sleep, oldest entry is replaced when full.
+ */
+struct wifi_c_psk_cache_obj {
+    uint32_t magic;
+    uint32_t next;
+    struct wifi_c_psk_entry_obj entries[WIFI_C_PSK_ENTRIES];
+};
+
+static RTC_DATA_ATTR struct wifi_c_psk_cache_obj wifi_c_psk_cache;
+
+static wifi_c_psk_stats_t wifi_c_psk_stats;
+static portMUX_TYPE wifi_c_psk_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void wifi_c_psk_fingerprint(const char *ssid, const char *passphrase, uint8_t fingerprint[WIFI_C_PSK_FINGERPRINT_LEN])
+{
+    mbedtls_sha256_context sha;
+    uint8_t hash[32];
+
+    // SSID is hashed too, so equal passphrases of different networks have different fingerprints
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts(&sha, 0);
+    mbedtls_sha256_update(&sha, (const unsigned char *)ssid, strnlen(ssid, 32) + 1);
+    mbedtls_sha256_update(&sha, (const unsigned char *)passphrase, strlen(passphrase));
+    mbedtls_sha256_finish(&sha, hash);
+    mbedtls_sha256_free(&sha);
+    memcpy(fingerprint, hash, WIFI_C_PSK_FINGERPRINT_LEN);
+}
+
+#if WIFI_C_PSK_CACHE_NVS_ENABLED
+/**
+ * @brief Check that NVS is encrypted, PSK is as good as passphrase and is not written to plain flash.
+ *
+ * @note Keys protected by flash encryption are used only when flash encryption is enabled,
+ * otherwise nvs_flash_init() initializes NVS without encryption.
+ */
+static bool wifi_c_psk_nvs_encrypted(void)
+{
+#if defined(CONFIG_NVS_SEC_KEY_PROTECT_USING_HMAC)
+    return true;
+#else
+    static bool warned = false;
+
+    if (esp_flash_encryption_enabled())
+    {
+        return true;
+    }
+    if (!warned)
+    {
+        LOG_WARN("Flash encryption is off, so NVS is not encrypted, PSK cache is kept only in RTC memory.");
+        warned = true;
+    }
+    return false;
+#endif
+}
+
+static void wifi_c_psk_nvs_load(void)
+{
+    nvs_handle_t handle;
+    size_t len = sizeof(wifi_c_psk_cache);
+
+    if (!wifi_c_psk_nvs_encrypted() || nvs_open(WIFI_C_PSK_NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK)
+    {
+        return;
+    }
+    // blob of other entry count or version is ignored, cache starts empty
+    if (nvs_get_blob(handle, WIFI_C_PSK_NVS_KEY, &wifi_c_psk_cache, &len) != ESP_OK || len != sizeof(wifi_c_psk_cache) ||
+        wifi_c_psk_cache.magic != WIFI_C_PSK_MAGIC)
+    {
+        memset(&wifi_c_psk_cache, 0, sizeof(wifi_c_psk_cache));
+    }
+    nvs_close(handle);
+}
+
+static void wifi_c_psk_nvs_save(void)
+{
+    nvs_handle_t handle;
+    struct wifi_c_psk_cache_obj snapshot;
+    esp_err_t err = ESP_OK;
+
+    if (!wifi_c_psk_nvs_encrypted())
+    {
+        return;
+    }
+
+    // flash is not written inside critical section
+    portENTER_CRITICAL(&wifi_c_psk_lock);
+    memcpy(&snapshot, &wifi_c_psk_cache, sizeof(snapshot));
+    portEXIT_CRITICAL(&wifi_c_psk_lock);
+
+    err = nvs_open(WIFI_C_PSK_NVS_NAMESPACE, NVS_READWRITE, &handle);
+    if (err == ESP_OK)
+    {
+        err = nvs_set_blob(handle, WIFI_C_PSK_NVS_KEY, &snapshot, sizeof(snapshot));
+        if (err == ESP_OK)
+        {
+            err = nvs_commit(handle);
+        }
+        nvs_close(handle);
+    }
+    memset(&snapshot, 0, sizeof(snapshot));
+    if (err != ESP_OK)
+    {
+        LOG_WARN("PSK cache not saved to NVS: %s", esp_err_to_name(err));
+    }
+}
+#endif
+
+/**
+ * @brief Validate cache after cold boot, must be called outside critical section before any other access.
+ */
+static void wifi_c_psk_cache_load(void)
+{
+    if (wifi_c_psk_cache.magic == WIFI_C_PSK_MAGIC)
+    {
+        return;
+    }
+    memset(&wifi_c_psk_cache, 0, sizeof(wifi_c_psk_cache));
+#if WIFI_C_PSK_CACHE_NVS_ENABLED
+    wifi_c_psk_nvs_load();
+#endif
+    wifi_c_psk_cache.magic = WIFI_C_PSK_MAGIC;
+}
+
+static void wifi_c_psk_to_hex(const uint8_t psk[WIFI_C_PSK_LEN], uint8_t psk_hex[WIFI_C_PSK_HEX_LEN])
+{
+    static const char digits[] = "0123456789abcdef";
+
+    for (size_t i = 0; i < WIFI_C_PSK_LEN; i++)
+    {
+        psk_hex[i * 2] = digits[psk[i] >> 4];
+        psk_hex[i * 2 + 1] = digits[psk[i] & 0x0F];
+    }
+}
+
+int wifi_c_psk_get(const char *ssid, const char *passphrase, uint8_t psk_hex[WIFI_C_PSK_HEX_LEN])
+{
+    uint8_t fingerprint[WIFI_C_PSK_FINGERPRINT_LEN];
+    uint8_t psk[WIFI_C_PSK_LEN];
+    struct wifi_c_psk_entry_obj *entry = NULL;
+    int64_t start_us = 0;
+    int64_t derive_us = 0;
+    int err = ERR_C_OK;
+
+    ERR_C_CHECK_NULL_PTR(ssid, LOG_ERROR("SSID cannot be NULL"));
+    ERR_C_CHECK_NULL_PTR(passphrase, LOG_ERROR("Passphrase cannot be NULL"));
+    ERR_C_CHECK_NULL_PTR(psk_hex, LOG_ERROR("PSK buffer cannot be NULL"));
+
+    wifi_c_psk_fingerprint(ssid, passphrase, fingerprint);
+    wifi_c_psk_cache_load();
+
+    portENTER_CRITICAL(&wifi_c_psk_lock);
+    for (size_t i = 0; i < WIFI_C_PSK_ENTRIES; i++)
+    {
+        entry = &wifi_c_psk_cache.entries[i];
+        if (entry->valid && strncmp(entry->ssid, ssid, sizeof(entry->ssid)) == 0 &&
+            memcmp(entry->fingerprint, fingerprint, sizeof(fingerprint)) == 0)
+        {
+            err = entry->passphrase_only ? WIFI_C_ERR_PSK_PASSPHRASE_ONLY : ERR_C_OK;
+            if (err == ERR_C_OK)
+            {
+                wifi_c_psk_to_hex(entry->psk, psk_hex);
+                wifi_c_psk_stats.hits++;
+            }
+            portEXIT_CRITICAL(&wifi_c_psk_lock);
+            return err;
+        }
+    }
+    portEXIT_CRITICAL(&wifi_c_psk_lock);
+
+    start_us = esp_timer_get_time();
+    err = wifi_c_psk_derive(ssid, passphrase, psk);
+    derive_us = esp_timer_get_time() - start_us;
+    if (err != ERR_C_OK)
+    {
+        LOG_ERROR("Failed to derive PSK: %d", err);
+        return err;
+    }
+    wifi_c_psk_to_hex(psk, psk_hex);
+
+    portENTER_CRITICAL(&wifi_c_psk_lock);
+    wifi_c_psk_stats.misses++;
+    wifi_c_psk_stats.last_derive_us = (uint32_t)derive_us;
+    wifi_c_psk_stats.derive_us += (uint64_t)derive_us;
+
+    // entry of SSID with old passphrase is replaced, otherwise the oldest one
+    entry = &wifi_c_psk_cache.entries[wifi_c_psk_cache.next];
+    for (size_t i = 0; i < WIFI_C_PSK_ENTRIES; i++)
+    {
+        if (wifi_c_psk_cache.entries[i].valid && strncmp(wifi_c_psk_cache.entries[i].ssid, ssid, sizeof(entry->ssid)) == 0)
+        {
+            entry = &wifi_c_psk_cache.entries[i];
+            break;
+        }
+    }
+    if (entry == &wifi_c_psk_cache.entries[wifi_c_psk_cache.next])
+    {
+        wifi_c_psk_cache.next = (wifi_c_psk_cache.next + 1) % WIFI_C_PSK_ENTRIES;
+    }
+    memset(entry->ssid, 0, sizeof(entry->ssid));
+    strncpy(entry->ssid, ssid, sizeof(entry->ssid) - 1);
+    memcpy(entry->fingerprint, fingerprint, sizeof(fingerprint));
+    memcpy(entry->psk, psk, sizeof(psk));
+    entry->valid = 1;
+    entry->passphrase_only = 0;
+    portEXIT_CRITICAL(&wifi_c_psk_lock);
+    memset(psk, 0, sizeof(psk));
+
+#if WIFI_C_PSK_CACHE_NVS_ENABLED
+    wifi_c_psk_nvs_save();
+#endif
+    LOG_DEBUG("PSK of %s derived in %lu us.", ssid, (unsigned long)derive_us);
+    return ERR_C_OK;
+}
+
+void wifi_c_psk_forget(const char *ssid)
+{
+    bool changed = false;
+
+    if (ssid == NULL)
+    {
+        return;
+    }
+    wifi_c_psk_cache_load();
+    portENTER_CRITICAL(&wifi_c_psk_lock);
+    for (size_t i = 0; i < WIFI_C_PSK_ENTRIES; i++)
+    {
+        struct wifi_c_psk_entry_obj *entry = &wifi_c_psk_cache.entries[i];
+        if (entry->valid && strncmp(entry->ssid, ssid, sizeof(entry->ssid)) == 0)
+        {
+            memset(entry, 0, sizeof(*entry));
+            wifi_c_psk_stats.invalidated++;
+            changed = true;
+        }
+    }
+    portEXIT_CRITICAL(&wifi_c_psk_lock);
+
+#if WIFI_C_PSK_CACHE_NVS_ENABLED
+    if (changed)
+    {
+        wifi_c_psk_nvs_save();
+    }
+#else
+    (void)changed;
+#endif
+}
+
+void wifi_c_psk_use_passphrase(const char *ssid)
+{
+    bool changed = false;
+
+    if (ssid == NULL)
+    {
+        return;
+    }
+    wifi_c_psk_cache_load();
+    portENTER_CRITICAL(&wifi_c_psk_lock);
+    for (size_t i = 0; i < WIFI_C_PSK_ENTRIES; i++)
+    {
+        struct wifi_c_psk_entry_obj *entry = &wifi_c_psk_cache.entries[i];
+        if (entry->valid && !entry->passphrase_only && strncmp(entry->ssid, ssid, sizeof(entry->ssid)) == 0)
+        {
+            // fingerprint stays, changed passphrase gets PSK derived again
+            memset(entry->psk, 0, sizeof(entry->psk));
+            entry->passphrase_only = 1;
+            wifi_c_psk_stats.invalidated++;
+            changed = true;
+        }
+    }
+    portEXIT_CRITICAL(&wifi_c_psk_lock);
+
+#if WIFI_C_PSK_CACHE_NVS_ENABLED
+    if (changed)
+    {
+        wifi_c_psk_nvs_save();
+    }
+#else
+    (void)changed;
+#endif
+}
+
+void wifi_c_psk_clear(void)
+{
+    portENTER_CRITICAL(&wifi_c_psk_lock);
+    memset(&wifi_c_psk_cache, 0, sizeof(wifi_c_psk_cache));
+    wifi_c_psk_cache.magic = WIFI_C_PSK_MAGIC;
+    portEXIT_CRITICAL(&wifi_c_psk_lock);
+
+#if WIFI_C_PSK_CACHE_NVS_ENABLED
+    wifi_c_psk_nvs_save();
+#endif
+}
+
+void wifi_c_psk_get_stats(wifi_c_psk_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+    portENTER_CRITICAL(&wifi_c_psk_lock);
+    memcpy(stats, &wifi_c_psk_stats, sizeof(*stats));
+    portEXIT_CRITICAL(&wifi_c_psk_lock);
+}
+#endif // WIFI_C_PSK_CACHE_ENABLED
+#endif // ESP_PLATFORM
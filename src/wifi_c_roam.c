@@ -0,0 +1,484 @@
+/**
+ * @file wifi_c_roam.c
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief BSSID selection and roaming within one SSID source file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*Beginning of ESP-IDF specific code.*/
+#ifdef ESP_PLATFORM
+
+#include "sdkconfig.h"
+#include "esp_event.h"
+#include "esp_timer.h"
+#include "esp_mac.h"
+#include "esp_idf_version.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <string.h>
+#include "err_controller.h"
+#include "errors_list.h"
+#include "wifi_controller.h"
+#include "wifi_c_roam.h"
+#include "wifi_c_channel.h"
+#include "wifi_c_history.h"
+#include "wifi_c_scan_filter.h"
+#include "wifi_c_scan_slice.h"
+#include "logger.h"
+#include "memory_utils.h"
+
+#if WIFI_C_METRICS_ENABLED
+#include "wifi_c_metrics.h"
+#endif
+
+#if WIFI_C_SCAN_ENABLED
+/*Neighbor reports come as event since ESP-IDF 5.1, supplicant has to be built with 802.11k/v.*/
+#if defined(CONFIG_WPA_11KV_SUPPORT) && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+#include "esp_rrm.h"
+#define WIFI_C_ROAM_NEIGHBOR_REPORTS    1
+#else
+#define WIFI_C_ROAM_NEIGHBOR_REPORTS    0
+#endif
+
+#define WIFI_C_ROAM_NEIGHBOR_ELEMENT_ID 52                          // IEEE 802.11 Neighbor Report element
+#define WIFI_C_ROAM_NEIGHBOR_MIN_LEN    13                          // BSSID, BSSID info, operating class, channel, PHY type
+#define WIFI_C_ROAM_NEIGHBOR_CHANNEL    11                          // offset of channel in element body
+
+static struct {
+    TaskHandle_t task;
+    SemaphoreHandle_t stopped;
+    volatile bool running;
+    wifi_c_roam_config_t config;
+    wifi_c_roam_stats_t stats;              // also updated by neighbor report handler
+    portMUX_TYPE lock;
+#if WIFI_C_ROAM_NEIGHBOR_REPORTS
+    esp_event_handler_instance_t neighbor_instance;
+#endif
+} wifi_c_roam = {
+    .task = NULL,
+    .stopped = NULL,
+    .running = false,
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+/**
+ * @brief Channels of SSID collected from BSSID history.
+ */
+struct wifi_c_roam_channels_obj {
+    const char *ssid;
+    uint16_t mask;
+};
+
+int wifi_c_bssid_score(const wifi_c_bssid_select_config_t *config, const wifi_c_channel_scores_t *scores,
+                       const wifi_ap_record_t *record)
+{
+    wifi_c_bssid_select_config_t default_config = WIFI_C_BSSID_SELECT_CONFIG_DEFAULT();
+    wifi_c_channel_scores_t own;
+    uint8_t channel = record->primary;
+    uint32_t load = 0;
+
+    if (config == NULL)
+    {
+        config = &default_config;
+    }
+    if (scores == NULL || config->load_penalty_db == 0 || channel < 1 || channel > WIFI_C_CHANNEL_MAX)
+    {
+        return record->rssi;
+    }
+
+    /*Load is caused by other APs, congestion added by BSSID itself is taken out.*/
+    wifi_c_channel_scores_clear(&own);
+    wifi_c_channel_scores_add(&own, record);
+    if (scores->score[channel] > own.score[channel])
+    {
+        load = scores->score[channel] - own.score[channel];
+    }
+    return record->rssi - (int)((load * config->load_penalty_db + WIFI_C_BSSID_LOAD_UNIT / 2) / WIFI_C_BSSID_LOAD_UNIT);
+}
+
+const wifi_ap_record_t *wifi_c_bssid_pick_best(const wifi_c_bssid_select_config_t *config, const wifi_c_channel_scores_t *scores,
+                                               const char *ssid, const wifi_ap_record_t *records, uint16_t count)
+{
+    wifi_c_bssid_select_config_t default_config = WIFI_C_BSSID_SELECT_CONFIG_DEFAULT();
+    const wifi_ap_record_t *best = NULL;
+    int best_score = 0;
+
+    if (config == NULL)
+    {
+        config = &default_config;
+    }
+    if (ssid == NULL || records == NULL)
+    {
+        return NULL;
+    }
+
+    for (uint16_t i = 0; i < count; i++)
+    {
+        const wifi_ap_record_t *record = &records[i];
+        int score = 0;
+
+        if (strncmp((const char *)record->ssid, ssid, sizeof(record->ssid)) != 0 || record->rssi < config->min_rssi)
+        {
+            continue;
+        }
+        if (config->channel_mask != 0 && !(config->channel_mask & (1U << record->primary)))
+        {
+            continue;
+        }
+
+        score = wifi_c_bssid_score(config, scores, record);
+        // stronger signal wins ties, load estimate is less certain than RSSI
+        if (best == NULL || score > best_score || (score == best_score && record->rssi > best->rssi))
+        {
+            best = record;
+            best_score = score;
+        }
+    }
+    return best;
+}
+
+static bool wifi_c_roam_history_channel(const wifi_c_history_record_t *record, void *arg)
+{
+    struct wifi_c_roam_channels_obj *channels = (struct wifi_c_roam_channels_obj *)arg;
+
+    if (strcmp(record->ssid, channels->ssid) == 0 && record->channel >= 1 && record->channel <= WIFI_C_CHANNEL_MAX)
+    {
+        channels->mask |= (uint16_t)(1U << record->channel);
+    }
+    return true;
+}
+
+/**
+ * @brief Channels worth scanning for other BSSIDs of SSID, 0 if nothing is known besides home channel.
+ */
+static uint16_t wifi_c_roam_known_channels(const char *ssid, uint8_t home_channel)
+{
+    struct wifi_c_roam_channels_obj channels = {
+        .ssid = ssid,
+        .mask = 0,
+    };
+
+    portENTER_CRITICAL(&wifi_c_roam.lock);
+    channels.mask = wifi_c_roam.stats.channel_mask;
+    portEXIT_CRITICAL(&wifi_c_roam.lock);
+
+    if (wifi_c_history_is_init())
+    {
+        wifi_c_history_for_each(wifi_c_roam_history_channel, &channels);
+    }
+
+    channels.mask &= (uint16_t)~(1U << home_channel);
+    if (channels.mask == 0)
+    {
+        return 0; // first scan has to sweep all channels
+    }
+    return channels.mask | (uint16_t)(1U << home_channel);
+}
+
+#if WIFI_C_ROAM_NEIGHBOR_REPORTS
+/**
+ * @brief Add channels of neighbor report to known channels and wake roam task waiting for it.
+ */
+static void wifi_c_roam_neighbor_handler(void *arg, esp_event_base_t event_base,
+                                         int32_t event_id, void *event_data)
+{
+    wifi_event_neighbor_report_t *event = (wifi_event_neighbor_report_t *)event_data;
+    const uint8_t *element = event->report;
+    size_t left = (event->report_len < sizeof(event->report)) ? event->report_len : sizeof(event->report);
+    uint16_t mask = 0;
+
+    while (left >= 2 && element[0] == WIFI_C_ROAM_NEIGHBOR_ELEMENT_ID && element[1] >= WIFI_C_ROAM_NEIGHBOR_MIN_LEN &&
+           left >= 2U + element[1])
+    {
+        uint8_t channel = element[2 + WIFI_C_ROAM_NEIGHBOR_CHANNEL];
+        if (channel >= 1 && channel <= WIFI_C_CHANNEL_MAX)
+        {
+            mask |= (uint16_t)(1U << channel);
+        }
+        left -= 2U + element[1];
+        element += 2U + element[1];
+    }
+
+    portENTER_CRITICAL(&wifi_c_roam.lock);
+    wifi_c_roam.stats.neighbor_reports++;
+    wifi_c_roam.stats.channel_mask |= mask;
+    portEXIT_CRITICAL(&wifi_c_roam.lock);
+
+    LOG_DEBUG("Neighbor report, channel mask 0x%04x.", mask);
+    if (wifi_c_roam.task != NULL)
+    {
+        xTaskNotifyGive(wifi_c_roam.task);
+    }
+}
+#endif
+
+/**
+ * @brief Move to new BSSID and measure time to association and to IP.
+ */
+static void wifi_c_roam_move(const wifi_ap_record_t *target)
+{
+    int64_t start_us = esp_timer_get_time();
+    uint32_t link_ms = 0;
+    uint32_t ip_ms = 0;
+    bool success = false;
+
+    if (wifi_c_sta_roam_to(target->bssid, target->primary) != ERR_C_OK)
+    {
+        return;
+    }
+
+    if (wifi_c_wait_for(WIFI_C_STATE_STA_CONNECTED, WIFI_C_ROAM_TIMEOUT_MS) == ERR_C_OK)
+    {
+        link_ms = (uint32_t)((esp_timer_get_time() - start_us) / 1000);
+        success = (link_ms < WIFI_C_ROAM_TIMEOUT_MS &&
+                   wifi_c_wait_for(WIFI_C_STATE_STA_GOT_IP, WIFI_C_ROAM_TIMEOUT_MS - link_ms) == ERR_C_OK);
+    }
+    ip_ms = (uint32_t)((esp_timer_get_time() - start_us) / 1000);
+
+    portENTER_CRITICAL(&wifi_c_roam.lock);
+    if (success)
+    {
+        wifi_c_roam.stats.roams++;
+        wifi_c_roam.stats.last_link_ms = link_ms;
+        wifi_c_roam.stats.last_ip_ms = ip_ms;
+        if (ip_ms > wifi_c_roam.stats.max_ip_ms)
+        {
+            wifi_c_roam.stats.max_ip_ms = ip_ms;
+        }
+    }
+    else
+    {
+        wifi_c_roam.stats.failures++;
+    }
+    portEXIT_CRITICAL(&wifi_c_roam.lock);
+#if WIFI_C_METRICS_ENABLED
+    wifi_c_metrics_roam_done(success, ip_ms * 1000);
+#endif
+
+    if (success)
+    {
+        LOG_INFO("Roamed to " MACSTR ", associated after %lu ms, IP after %lu ms.",
+                 MAC2STR(target->bssid), (unsigned long)link_ms, (unsigned long)ip_ms);
+    }
+    else
+    {
+        LOG_WARN("Roam to " MACSTR " didn't get IP in %u ms.", MAC2STR(target->bssid), WIFI_C_ROAM_TIMEOUT_MS);
+    }
+}
+
+/**
+ * @brief Scan known channels and roam if any BSSID of current SSID is better enough than current one.
+ */
+static void wifi_c_roam_evaluate(const wifi_ap_record_t *current)
+{
+    const wifi_c_roam_config_t *config = &wifi_c_roam.config;
+    const char *ssid = (const char *)current->ssid;
+    bool weight_load = (config->select.load_penalty_db != 0);
+    wifi_ap_record_t records[WIFI_C_ROAM_SCAN_RECORDS];
+    uint16_t count = WIFI_C_ROAM_SCAN_RECORDS;
+    wifi_c_scan_slice_config_t slice_config = WIFI_C_SCAN_SLICE_CONFIG_DEFAULT();
+    wifi_c_scan_filter_t filter = WIFI_C_SCAN_FILTER_DEFAULT();
+    wifi_c_channel_scores_t scores;
+    const wifi_ap_record_t *best = NULL;
+    const wifi_ap_record_t *home = current;
+    uint16_t seen_channels = 0;
+
+#if WIFI_C_ROAM_NEIGHBOR_REPORTS
+    /*AP knows its neighbors, asking is cheaper than scanning channels where SSID isn't served.*/
+    if (config->assist_11kv && esp_rrm_is_rrm_supported_connection() && esp_rrm_send_neighbor_report_request() == 0)
+    {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(WIFI_C_ROAM_NEIGHBOR_WAIT_MS));
+    }
+#endif
+
+    slice_config.channel_mask = wifi_c_roam_known_channels(ssid, current->primary);
+    filter.ssid_pattern = ssid; // SSID with wildcard characters matches more, exact match is checked when picking
+    /*Load counts APs of all SSIDs, scan scores them before filter, so top-K keeps only candidates.*/
+    wifi_c_channel_scores_clear(&scores);
+    slice_config.scores = weight_load ? &scores : NULL;
+    if (wifi_c_scan_sliced(&slice_config, &filter, records, &count, NULL) != ERR_C_OK)
+    {
+        return;
+    }
+
+    for (uint16_t i = 0; i < count; i++)
+    {
+        if (strncmp((const char *)records[i].ssid, ssid, sizeof(records[i].ssid)) != 0)
+        {
+            continue;
+        }
+        if (records[i].primary >= 1 && records[i].primary <= WIFI_C_CHANNEL_MAX)
+        {
+            seen_channels |= (uint16_t)(1U << records[i].primary);
+        }
+        if (memcmp(records[i].bssid, current->bssid, sizeof(current->bssid)) == 0)
+        {
+            home = &records[i]; // fresh RSSI, measured the same way as candidates
+        }
+    }
+
+    portENTER_CRITICAL(&wifi_c_roam.lock);
+    wifi_c_roam.stats.scans++;
+    wifi_c_roam.stats.channel_mask |= seen_channels;
+    portEXIT_CRITICAL(&wifi_c_roam.lock);
+
+    best = wifi_c_bssid_pick_best(&config->select, weight_load ? &scores : NULL, ssid, records, count);
+    if (best == NULL || memcmp(best->bssid, current->bssid, sizeof(current->bssid)) == 0 ||
+        wifi_c_bssid_score(&config->select, weight_load ? &scores : NULL, best) <
+            wifi_c_bssid_score(&config->select, weight_load ? &scores : NULL, home) + config->hysteresis_db)
+    {
+        LOG_DEBUG("No BSSID better than current one by %u dB.", config->hysteresis_db);
+        return;
+    }
+
+    LOG_INFO("RSSI %d below %d, roaming from " MACSTR " to " MACSTR " (RSSI %d, channel %u).",
+             current->rssi, config->rssi_threshold, MAC2STR(current->bssid), MAC2STR(best->bssid), best->rssi, best->primary);
+    wifi_c_roam_move(best);
+}
+
+static void wifi_c_roam_task(void *arg)
+{
+    wifi_ap_record_t current;
+    int64_t last_scan_us = 0;
+    bool scanned = false;
+
+    while (wifi_c_roam.running)
+    {
+        // get_ap_info fails when STA is not connected
+        if (esp_wifi_sta_get_ap_info(&current) == ESP_OK && current.rssi < wifi_c_roam.config.rssi_threshold &&
+            (!scanned || esp_timer_get_time() - last_scan_us >= (int64_t)wifi_c_roam.config.scan_backoff_ms * 1000))
+        {
+            wifi_c_roam_evaluate(&current);
+            last_scan_us = esp_timer_get_time();
+            scanned = true;
+        }
+
+        // woken up early by wifi_c_roam_stop()
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wifi_c_roam.config.check_period_ms));
+    }
+
+    wifi_c_roam.task = NULL;
+    xSemaphoreGive(wifi_c_roam.stopped);
+    vTaskDelete(NULL);
+}
+
+int wifi_c_roam_start(const wifi_c_roam_config_t *config)
+{
+    volatile err_c_t err = ERR_C_OK;
+    wifi_c_roam_config_t default_config = WIFI_C_ROAM_CONFIG_DEFAULT();
+
+    if (config == NULL)
+    {
+        config = &default_config;
+    }
+
+    Try
+    {
+        if (wifi_c_roam.task != NULL)
+        {
+            ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_ROAM_STARTED);
+        }
+
+        if (config->check_period_ms == 0)
+        {
+            ERR_C_SET_AND_THROW_ERR(err, ERR_C_INVALID_ARGS);
+        }
+
+        if (wifi_c_roam.stopped == NULL)
+        {
+            wifi_c_roam.stopped = xSemaphoreCreateBinary();
+            if (wifi_c_roam.stopped == NULL)
+            {
+                ERR_C_SET_AND_THROW_ERR(err, ERR_C_MEMORY_ERR);
+            }
+        }
+
+        memcpy(&wifi_c_roam.config, config, sizeof(wifi_c_roam_config_t));
+        memutil_zero_memory(&wifi_c_roam.stats, sizeof(wifi_c_roam.stats));
+        wifi_c_sta_set_11kv(config->assist_11kv); // capabilities are announced from next association
+#if WIFI_C_ROAM_NEIGHBOR_REPORTS
+        if (config->assist_11kv)
+        {
+            ERR_C_CHECK_AND_THROW_ERR(esp_event_handler_instance_register(WIFI_EVENT,
+                                                                          WIFI_EVENT_STA_NEIGHBOR_REP,
+                                                                          &wifi_c_roam_neighbor_handler,
+                                                                          NULL,
+                                                                          &wifi_c_roam.neighbor_instance));
+        }
+#endif
+
+        wifi_c_roam.running = true;
+        if (xTaskCreatePinnedToCore(wifi_c_roam_task, "wifi_c_roam", config->stack_size, NULL,
+                                    config->priority, &wifi_c_roam.task, tskNO_AFFINITY) != pdPASS)
+        {
+            wifi_c_roam.running = false;
+            wifi_c_roam.task = NULL;
+#if WIFI_C_ROAM_NEIGHBOR_REPORTS
+            if (config->assist_11kv)
+            {
+                esp_event_handler_instance_unregister(WIFI_EVENT, WIFI_EVENT_STA_NEIGHBOR_REP, wifi_c_roam.neighbor_instance);
+            }
+#endif
+            ERR_C_SET_AND_THROW_ERR(err, ERR_C_MEMORY_ERR);
+        }
+        LOG_INFO("Roaming started, threshold %d dBm, hysteresis %u dB.", config->rssi_threshold, config->hysteresis_db);
+    }
+    Catch(err)
+    {
+        switch (err)
+        {
+        case WIFI_C_ERR_ROAM_STARTED:
+            LOG_WARN("Roaming already started.");
+            break;
+        case ERR_C_INVALID_ARGS:
+            LOG_ERROR("Period of RSSI check cannot be zero.");
+            break;
+        case ERR_C_MEMORY_ERR:
+            LOG_ERROR("Memory allocation was not successful");
+            break;
+        default:
+            LOG_ERROR("Error when starting roaming: %d", err);
+            break;
+        }
+    }
+    return err;
+}
+
+void wifi_c_roam_stop(void)
+{
+    TaskHandle_t task = wifi_c_roam.task;
+
+    if (task == NULL)
+    {
+        return;
+    }
+
+    wifi_c_roam.running = false;
+    xTaskNotifyGive(task);
+    xSemaphoreTake(wifi_c_roam.stopped, portMAX_DELAY);
+#if WIFI_C_ROAM_NEIGHBOR_REPORTS
+    if (wifi_c_roam.config.assist_11kv)
+    {
+        esp_event_handler_instance_unregister(WIFI_EVENT, WIFI_EVENT_STA_NEIGHBOR_REP, wifi_c_roam.neighbor_instance);
+    }
+#endif
+    LOG_DEBUG("Roaming stopped.");
+}
+
+void wifi_c_roam_get_stats(wifi_c_roam_stats_t *stats)
+{
+    if (stats == NULL)
+    {
+        return;
+    }
+    portENTER_CRITICAL(&wifi_c_roam.lock);
+    memcpy(stats, &wifi_c_roam.stats, sizeof(wifi_c_roam_stats_t));
+    portEXIT_CRITICAL(&wifi_c_roam.lock);
+}
+#endif // WIFI_C_SCAN_ENABLED
+#endif // ESP_PLATFORM
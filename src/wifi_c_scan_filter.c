@@ -0,0 +1,149 @@
+/**
+ * @file wifi_c_scan_filter.c
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief Streaming scan filter and top-K selection source file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*Beginning of ESP-IDF specific code.*/
+#ifdef ESP_PLATFORM
+
+#include <string.h>
+#include "wifi_controller.h"
+#include "wifi_c_scan_filter.h"
+
+#if WIFI_C_SCAN_ENABLED
+bool wifi_c_scan_filter_match_ssid(const char *pattern, const char *ssid)
+{
+    const char *star = NULL;
+    const char *resume = NULL;
+
+    while (*ssid != '\0')
+    {
+        if (*pattern == '?' || *pattern == *ssid)
+        {
+            pattern++;
+            ssid++;
+        }
+        else if (*pattern == '*')
+        {
+            // remember position, first try to match empty string
+            star = pattern++;
+            resume = ssid;
+        }
+        else if (star != NULL)
+        {
+            // let last '*' swallow one more character
+            pattern = star + 1;
+            ssid = ++resume;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    while (*pattern == '*')
+    {
+        pattern++;
+    }
+    return *pattern == '\0';
+}
+
+bool wifi_c_scan_filter_match(const wifi_c_scan_filter_t *filter, const wifi_ap_record_t *record)
+{
+    if (filter == NULL)
+    {
+        return true;
+    }
+
+    if (record->rssi < filter->min_rssi)
+    {
+        return false;
+    }
+
+    if (filter->authmode_mask != WIFI_C_SCAN_FILTER_ANY_AUTH &&
+        !(filter->authmode_mask & WIFI_C_SCAN_FILTER_AUTH_BIT(record->authmode)))
+    {
+        return false;
+    }
+
+    if (filter->channel_mask != WIFI_C_SCAN_FILTER_ANY_CHANNEL &&
+        (record->primary > 15 || !(filter->channel_mask & WIFI_C_SCAN_FILTER_CHANNEL_BIT(record->primary))))
+    {
+        return false;
+    }
+
+    if (filter->ssid_pattern != NULL && !wifi_c_scan_filter_match_ssid(filter->ssid_pattern, (const char *)record->ssid))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+void wifi_c_scan_top_init(wifi_c_scan_top_t *top, const wifi_c_scan_filter_t *filter,
+                          wifi_ap_record_t *records, uint16_t capacity)
+{
+    top->filter = filter;
+    top->records = records;
+    top->capacity = capacity;
+    top->count = 0;
+    top->seen = 0;
+    top->rejected = 0;
+}
+
+bool wifi_c_scan_top_push(wifi_c_scan_top_t *top, const wifi_ap_record_t *record)
+{
+    uint16_t position = 0;
+
+    top->seen++;
+    if (!wifi_c_scan_filter_match(top->filter, record))
+    {
+        top->rejected++;
+        return false;
+    }
+
+    if (top->filter != NULL && top->filter->dedup_ssid)
+    {
+        for (uint16_t i = 0; i < top->count; i++)
+        {
+            if (strncmp((const char *)top->records[i].ssid, (const char *)record->ssid, sizeof(record->ssid)) != 0)
+            {
+                continue;
+            }
+            if (record->rssi <= top->records[i].rssi)
+            {
+                return false;
+            }
+            // weaker AP with same SSID is replaced, remove it first
+            memmove(&top->records[i], &top->records[i + 1], (top->count - i - 1) * sizeof(wifi_ap_record_t));
+            top->count--;
+            break;
+        }
+    }
+
+    // records are sorted from strongest, APs with equal signal keep scan order
+    while (position < top->count && top->records[position].rssi >= record->rssi)
+    {
+        position++;
+    }
+    if (position >= top->capacity)
+    {
+        return false;
+    }
+
+    if (top->count < top->capacity)
+    {
+        top->count++;
+    }
+    memmove(&top->records[position + 1], &top->records[position], (top->count - position - 1) * sizeof(wifi_ap_record_t));
+    memcpy(&top->records[position], record, sizeof(wifi_ap_record_t));
+    return true;
+}
+#endif // WIFI_C_SCAN_ENABLED
+#endif // ESP_PLATFORM
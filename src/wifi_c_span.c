@@ -0,0 +1,209 @@
+/**
+ * @file wifi_c_span.c
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief Timing spans of controller operations source file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*Beginning of ESP-IDF specific code.*/
+#ifdef ESP_PLATFORM
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <string.h>
+#include <inttypes.h>
+#include "err_controller.h"
+#include "errors_list.h"
+#include "wifi_controller.h"
+#include "wifi_c_span.h"
+#include "logger.h"
+
+#if WIFI_C_SPAN_TRACE_ENABLED
+
+#define WIFI_C_SPAN_RECORDS             CONFIG_WIFI_C_SPAN_TRACE_RECORDS
+#define WIFI_C_SPAN_TASK_OTHER          WIFI_C_SPAN_TASKS           // task index shared by tasks which didn't fit
+
+/**
+ * @brief One begin or end point, 16 bytes.
+ */
+struct wifi_c_span_record_obj {
+    int64_t time_us;
+    uint16_t arg;
+    uint8_t id;
+    uint8_t phase;
+    uint8_t task;
+    uint8_t core;
+    uint8_t reserved[2];
+};
+
+_Static_assert(sizeof(struct wifi_c_span_record_obj) == 16, "span record grew");
+_Static_assert(WIFI_C_SPAN_COUNT <= UINT8_MAX, "span id doesn't fit record");
+
+static const char *const wifi_c_span_names[WIFI_C_SPAN_COUNT] = {
+    [WIFI_C_SPAN_INIT_WIFI] = "wifi_c_init_wifi",
+    [WIFI_C_SPAN_START_AP] = "wifi_c_start_ap",
+    [WIFI_C_SPAN_START_STA] = "wifi_c_start_sta",
+    [WIFI_C_SPAN_START_STA_BEST_BSSID] = "wifi_c_start_sta_best_bssid",
+    [WIFI_C_SPAN_DISCONNECT] = "wifi_c_sta_disconnect",
+    [WIFI_C_SPAN_SCAN_ALL_AP] = "wifi_c_scan_all_ap",
+    [WIFI_C_SPAN_SCAN_FILTERED] = "wifi_c_scan_filtered",
+    [WIFI_C_SPAN_SCAN_SLICED] = "wifi_c_scan_sliced",
+    [WIFI_C_SPAN_MEASURE_CHANNELS] = "wifi_c_measure_channels",
+    [WIFI_C_SPAN_START_AP_AUTO_CHANNEL] = "wifi_c_start_ap_auto_channel",
+    [WIFI_C_SPAN_ROAM_TO] = "wifi_c_sta_roam_to",
+    [WIFI_C_SPAN_SUSPEND] = "wifi_c_suspend",
+    [WIFI_C_SPAN_RESUME] = "wifi_c_resume",
+    [WIFI_C_SPAN_CHANGE_MODE] = "wifi_c_change_mode",
+    [WIFI_C_SPAN_DEINIT] = "wifi_c_deinit",
+    [WIFI_C_SPAN_NETIF_INIT] = "netif init",
+    [WIFI_C_SPAN_DRIVER_INIT] = "esp_wifi_init",
+    [WIFI_C_SPAN_DRIVER_START] = "esp_wifi_start",
+    [WIFI_C_SPAN_DRIVER_SCAN] = "driver scan",
+    [WIFI_C_SPAN_WIFI_EVENT] = "WIFI_EVENT",
+    [WIFI_C_SPAN_IP_EVENT] = "IP_EVENT",
+    [WIFI_C_SPAN_CALLBACK] = "connect handler",
+    [WIFI_C_SPAN_CONNECT] = "connect",
+    [WIFI_C_SPAN_DHCP] = "DHCP",
+};
+
+/**
+ * @brief Records in order of time, tasks get index on first record.
+ */
+static struct {
+    struct wifi_c_span_record_obj records[WIFI_C_SPAN_RECORDS];
+    size_t count;
+    uint32_t dropped;
+    struct {
+        TaskHandle_t handle;
+        char name[configMAX_TASK_NAME_LEN];
+    } tasks[WIFI_C_SPAN_TASKS];
+    size_t task_count;
+    portMUX_TYPE lock;
+} wifi_c_span = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+/**
+ * @brief Find or add task index, must be called inside critical section.
+ */
+static uint8_t wifi_c_span_task_index(TaskHandle_t task)
+{
+    for (size_t i = 0; i < wifi_c_span.task_count; i++)
+    {
+        if (wifi_c_span.tasks[i].handle == task)
+        {
+            return (uint8_t)i;
+        }
+    }
+    if (wifi_c_span.task_count == WIFI_C_SPAN_TASKS)
+    {
+        return WIFI_C_SPAN_TASK_OTHER;
+    }
+    wifi_c_span.tasks[wifi_c_span.task_count].handle = task;
+    // name is copied, task may be deleted before export
+    strncpy(wifi_c_span.tasks[wifi_c_span.task_count].name, pcTaskGetName(task), configMAX_TASK_NAME_LEN - 1);
+    wifi_c_span.tasks[wifi_c_span.task_count].name[configMAX_TASK_NAME_LEN - 1] = '\0';
+    return (uint8_t)wifi_c_span.task_count++;
+}
+
+void wifi_c_span_record(wifi_c_span_id_t id, wifi_c_span_phase_t phase, uint16_t arg)
+{
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    int64_t now_us = esp_timer_get_time();
+
+    portENTER_CRITICAL(&wifi_c_span.lock);
+    if (wifi_c_span.count == WIFI_C_SPAN_RECORDS)
+    {
+        wifi_c_span.dropped++;
+    }
+    else
+    {
+        struct wifi_c_span_record_obj *record = &wifi_c_span.records[wifi_c_span.count++];
+
+        record->time_us = now_us;
+        record->arg = arg;
+        record->id = (uint8_t)id;
+        record->phase = (uint8_t)phase;
+        record->task = wifi_c_span_task_index(task);
+        record->core = (uint8_t)xPortGetCoreID();
+    }
+    portEXIT_CRITICAL(&wifi_c_span.lock);
+}
+
+int wifi_c_span_end_result(wifi_c_span_id_t id, int result)
+{
+    wifi_c_span_record(id, WIFI_C_SPAN_PHASE_END, 0);
+    return result;
+}
+
+int wifi_c_span_export_chrome(wifi_c_stream_sink_t sink, void *arg)
+{
+    wifi_c_stream_t stream;
+    struct wifi_c_span_record_obj record;
+    size_t count = 0;
+    size_t task_count = 0;
+    uint32_t dropped = 0;
+
+    ERR_C_CHECK_NULL_PTR(sink, LOG_ERROR("Sink of span trace cannot be NULL"));
+
+    portENTER_CRITICAL(&wifi_c_span.lock);
+    count = wifi_c_span.count;
+    task_count = wifi_c_span.task_count;
+    dropped = wifi_c_span.dropped;
+    portEXIT_CRITICAL(&wifi_c_span.lock);
+
+    // records below count and their tasks don't change until clear, so they are read without lock
+    wifi_c_stream_init(&stream, sink, arg);
+    wifi_c_stream_printf(&stream, "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":%" PRIu32 "},\"traceEvents\":[", dropped);
+    wifi_c_stream_printf(&stream, "{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\",\"args\":{\"name\":\"wifi_controller\"}}");
+    for (size_t i = 0; i < task_count; i++)
+    {
+        wifi_c_stream_printf(&stream, ",{\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":", (unsigned)i);
+        wifi_c_stream_json_string(&stream, wifi_c_span.tasks[i].name, configMAX_TASK_NAME_LEN);
+        wifi_c_stream_write(&stream, "}}", 2);
+    }
+    if (task_count == WIFI_C_SPAN_TASKS)
+    {
+        wifi_c_stream_printf(&stream, ",{\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":\"other\"}}",
+                             WIFI_C_SPAN_TASK_OTHER);
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        record = wifi_c_span.records[i];
+        wifi_c_stream_printf(&stream, ",{\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%lld,\"cat\":\"wifi_c\",\"name\":\"%s\"",
+                             record.phase, record.task, (long long)record.time_us, wifi_c_span_names[record.id]);
+        if (record.phase == WIFI_C_SPAN_PHASE_ASYNC_BEGIN || record.phase == WIFI_C_SPAN_PHASE_ASYNC_END)
+        {
+            // one connect and one DHCP at a time, id only pairs begin with end
+            wifi_c_stream_printf(&stream, ",\"id\":%u", record.id);
+        }
+        if (record.id == WIFI_C_SPAN_WIFI_EVENT || record.id == WIFI_C_SPAN_IP_EVENT)
+        {
+            wifi_c_stream_printf(&stream, ",\"args\":{\"core\":%u,\"event\":%u}}", record.core, record.arg);
+        }
+        else
+        {
+            wifi_c_stream_printf(&stream, ",\"args\":{\"core\":%u}}", record.core);
+        }
+    }
+    wifi_c_stream_write(&stream, "]}", 2);
+
+    return wifi_c_stream_finish(&stream);
+}
+
+void wifi_c_span_clear(void)
+{
+    portENTER_CRITICAL(&wifi_c_span.lock);
+    wifi_c_span.count = 0;
+    wifi_c_span.dropped = 0;
+    wifi_c_span.task_count = 0;
+    portEXIT_CRITICAL(&wifi_c_span.lock);
+}
+#endif // WIFI_C_SPAN_TRACE_ENABLED
+#endif // ESP_PLATFORM
@@ -0,0 +1,101 @@
+/**
+ * @file wifi_c_stream.c
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief Chunked output of formatted text source file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*Streaming doesn't depend on ESP-IDF, so output can be checked on host with any sink.*/
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include "wifi_c_stream.h"
+
+static void wifi_c_stream_flush(wifi_c_stream_t *stream)
+{
+    if (stream->len > 0 && stream->err == 0)
+    {
+        stream->err = stream->sink(stream->buffer, stream->len, stream->arg);
+    }
+    stream->len = 0;
+}
+
+void wifi_c_stream_init(wifi_c_stream_t *stream, wifi_c_stream_sink_t sink, void *arg)
+{
+    stream->sink = sink;
+    stream->arg = arg;
+    stream->len = 0;
+    stream->err = 0;
+}
+
+void wifi_c_stream_write(wifi_c_stream_t *stream, const char *data, size_t len)
+{
+    while (len > 0 && stream->err == 0)
+    {
+        size_t space = sizeof(stream->buffer) - stream->len;
+        size_t part = (len < space) ? len : space;
+
+        memcpy(&stream->buffer[stream->len], data, part);
+        stream->len += part;
+        data += part;
+        len -= part;
+        if (stream->len == sizeof(stream->buffer))
+        {
+            wifi_c_stream_flush(stream);
+        }
+    }
+}
+
+void wifi_c_stream_printf(wifi_c_stream_t *stream, const char *format, ...)
+{
+    char line[WIFI_C_STREAM_CHUNK_SIZE];
+    va_list args;
+    int len = 0;
+
+    va_start(args, format);
+    len = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+
+    if (len > 0)
+    {
+        wifi_c_stream_write(stream, line, ((size_t)len < sizeof(line)) ? (size_t)len : sizeof(line) - 1);
+    }
+}
+
+void wifi_c_stream_json_string(wifi_c_stream_t *stream, const char *str, size_t maxlen)
+{
+    char escaped[7];
+
+    wifi_c_stream_write(stream, "\"", 1);
+    for (size_t i = 0; i < maxlen && str[i] != '\0'; i++)
+    {
+        unsigned char c = (unsigned char)str[i];
+
+        if (c == '"' || c == '\\')
+        {
+            escaped[0] = '\\';
+            escaped[1] = (char)c;
+            wifi_c_stream_write(stream, escaped, 2);
+        }
+        else if (c < 0x20)
+        {
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            wifi_c_stream_write(stream, escaped, 6);
+        }
+        else
+        {
+            wifi_c_stream_write(stream, (const char *)&str[i], 1);
+        }
+    }
+    wifi_c_stream_write(stream, "\"", 1);
+}
+
+int wifi_c_stream_finish(wifi_c_stream_t *stream)
+{
+    wifi_c_stream_flush(stream);
+    return stream->err;
+}
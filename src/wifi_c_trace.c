@@ -0,0 +1,294 @@
+/**
+ * @file wifi_c_trace.c
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief Wifi and IP event trace recorder source file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*Beginning of ESP-IDF specific code.*/
+#ifdef ESP_PLATFORM
+
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "esp_netif.h"
+#include "freertos/FreeRTOS.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "wifi_controller.h"
+#include "wifi_c_trace.h"
+#include "logger.h"
+
+#if WIFI_C_EVENT_TRACE_ENABLED
+
+#define WIFI_C_TRACE_BUFFER_SIZE        CONFIG_WIFI_C_EVENT_TRACE_BUFFER_SIZE
+#define WIFI_C_TRACE_PRINT_BYTES        32                          // bytes of trace in one printed line
+
+_Static_assert(sizeof(wifi_c_trace_header_t) == 12, "wifi_c_trace_header_t binary format changed");
+_Static_assert(sizeof(wifi_c_trace_record_t) == 8, "wifi_c_trace_record_t binary format changed");
+_Static_assert(WIFI_C_TRACE_BUFFER_SIZE >= sizeof(wifi_c_trace_record_t) + WIFI_C_TRACE_MAX_PAYLOAD, "trace buffer too small");
+
+/**
+ * @brief Byte ring of variable length records, oldest records are dropped to make space.
+ */
+static struct {
+    uint8_t buffer[WIFI_C_TRACE_BUFFER_SIZE];
+    size_t head;                            // offset where next record is written
+    size_t tail;                            // offset of oldest record
+    size_t used;
+    int64_t last_us;
+    uint32_t dropped;
+    portMUX_TYPE lock;
+} wifi_c_trace = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+static void wifi_c_trace_ring_write(const void *data, size_t len)
+{
+    size_t first = WIFI_C_TRACE_BUFFER_SIZE - wifi_c_trace.head;
+
+    if (first > len)
+    {
+        first = len;
+    }
+    memcpy(&wifi_c_trace.buffer[wifi_c_trace.head], data, first);
+    memcpy(&wifi_c_trace.buffer[0], (const uint8_t *)data + first, len - first);
+    wifi_c_trace.head = (wifi_c_trace.head + len) % WIFI_C_TRACE_BUFFER_SIZE;
+    wifi_c_trace.used += len;
+}
+
+static void wifi_c_trace_ring_read(size_t position, void *data, size_t len)
+{
+    size_t first = WIFI_C_TRACE_BUFFER_SIZE - position;
+
+    if (first > len)
+    {
+        first = len;
+    }
+    memcpy(data, &wifi_c_trace.buffer[position], first);
+    memcpy((uint8_t *)data + first, &wifi_c_trace.buffer[0], len - first);
+}
+
+static void wifi_c_trace_drop_oldest(void)
+{
+    wifi_c_trace_record_t record;
+
+    wifi_c_trace_ring_read(wifi_c_trace.tail, &record, sizeof(record));
+    wifi_c_trace.tail = (wifi_c_trace.tail + sizeof(record) + record.len) % WIFI_C_TRACE_BUFFER_SIZE;
+    wifi_c_trace.used -= sizeof(record) + record.len;
+    wifi_c_trace.dropped++;
+}
+
+/**
+ * @brief Copy event data to payload, pointers are left out so trace can be replayed on other architecture.
+ */
+static uint8_t wifi_c_trace_encode(wifi_c_trace_base_t base, int32_t id, const void *data, uint8_t *payload)
+{
+    size_t len = 0;
+
+    if (data == NULL)
+    {
+        return 0;
+    }
+
+    if (base == WIFI_C_TRACE_BASE_IP)
+    {
+        switch (id)
+        {
+        case IP_EVENT_STA_GOT_IP:
+            memcpy(payload, &((const ip_event_got_ip_t *)data)->ip_info, sizeof(esp_netif_ip_info_t));
+            payload[sizeof(esp_netif_ip_info_t)] = ((const ip_event_got_ip_t *)data)->ip_changed;
+            return sizeof(esp_netif_ip_info_t) + 1;
+        case IP_EVENT_AP_STAIPASSIGNED:
+            memcpy(payload, &((const ip_event_ap_staipassigned_t *)data)->ip, sizeof(esp_ip4_addr_t));
+            memcpy(&payload[sizeof(esp_ip4_addr_t)], ((const ip_event_ap_staipassigned_t *)data)->mac, 6);
+            return sizeof(esp_ip4_addr_t) + 6;
+        default:
+            return 0;
+        }
+    }
+
+    switch (id)
+    {
+    case WIFI_EVENT_SCAN_DONE:
+        len = sizeof(wifi_event_sta_scan_done_t);
+        break;
+    case WIFI_EVENT_STA_CONNECTED:
+        len = sizeof(wifi_event_sta_connected_t);
+        break;
+    case WIFI_EVENT_STA_DISCONNECTED:
+        len = sizeof(wifi_event_sta_disconnected_t);
+        break;
+    case WIFI_EVENT_AP_STACONNECTED:
+        len = sizeof(wifi_event_ap_staconnected_t);
+        break;
+    case WIFI_EVENT_AP_STADISCONNECTED:
+        len = sizeof(wifi_event_ap_stadisconnected_t);
+        break;
+    default:
+        return 0;
+    }
+    if (len > WIFI_C_TRACE_MAX_PAYLOAD)
+    {
+        len = WIFI_C_TRACE_MAX_PAYLOAD;
+    }
+    memcpy(payload, data, len);
+    return (uint8_t)len;
+}
+
+void wifi_c_trace_record(wifi_c_trace_base_t base, int32_t id, const void *data)
+{
+    uint8_t payload[WIFI_C_TRACE_MAX_PAYLOAD];
+    wifi_c_trace_record_t record = {
+        .base = (uint8_t)base,
+        .id = (uint8_t)id,
+        .len = wifi_c_trace_encode(base, id, data, payload),
+        .reserved = 0,
+    };
+    int64_t now_us = esp_timer_get_time();
+
+    portENTER_CRITICAL(&wifi_c_trace.lock);
+    if (wifi_c_trace.used == 0 && wifi_c_trace.dropped == 0)
+    {
+        record.delta_us = 0;
+    }
+    else
+    {
+        record.delta_us = (now_us - wifi_c_trace.last_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)(now_us - wifi_c_trace.last_us);
+    }
+    wifi_c_trace.last_us = now_us;
+
+    while (wifi_c_trace.used + sizeof(record) + record.len > WIFI_C_TRACE_BUFFER_SIZE)
+    {
+        wifi_c_trace_drop_oldest();
+    }
+    wifi_c_trace_ring_write(&record, sizeof(record));
+    wifi_c_trace_ring_write(payload, record.len);
+    portEXIT_CRITICAL(&wifi_c_trace.lock);
+}
+
+size_t wifi_c_trace_dump(uint8_t *buffer, size_t buflen)
+{
+    wifi_c_trace_header_t header = {
+        .magic = WIFI_C_TRACE_MAGIC,
+        .version = WIFI_C_TRACE_VERSION,
+    };
+    wifi_c_trace_record_t record;
+    size_t position = 0;
+    size_t copied = 0;
+    size_t len = sizeof(header);
+
+    portENTER_CRITICAL(&wifi_c_trace.lock);
+    header.dropped = wifi_c_trace.dropped;
+    if (buffer != NULL && buflen >= sizeof(header))
+    {
+        memcpy(buffer, &header, sizeof(header));
+        copied = sizeof(header);
+    }
+
+    position = wifi_c_trace.tail;
+    for (size_t done = 0; done < wifi_c_trace.used; done += sizeof(record) + record.len)
+    {
+        wifi_c_trace_ring_read(position, &record, sizeof(record));
+        if (done == 0)
+        {
+            record.delta_us = 0; // previous record was dropped
+        }
+        // only whole records, so trace stays readable
+        if (buffer != NULL && copied == len && copied + sizeof(record) + record.len <= buflen)
+        {
+            memcpy(&buffer[copied], &record, sizeof(record));
+            wifi_c_trace_ring_read((position + sizeof(record)) % WIFI_C_TRACE_BUFFER_SIZE, &buffer[copied + sizeof(record)], record.len);
+            copied += sizeof(record) + record.len;
+        }
+        len += sizeof(record) + record.len;
+        position = (position + sizeof(record) + record.len) % WIFI_C_TRACE_BUFFER_SIZE;
+    }
+    portEXIT_CRITICAL(&wifi_c_trace.lock);
+
+    return (buffer != NULL) ? copied : len;
+}
+
+void wifi_c_trace_print(void)
+{
+    char line[WIFI_C_TRACE_PRINT_BYTES * 2 + 1];
+    size_t size = wifi_c_trace_dump(NULL, 0);
+    size_t len = 0;
+    uint8_t *trace = calloc(1, size);
+
+    if (trace == NULL)
+    {
+        LOG_ERROR("Memory allocation was not successful");
+        return;
+    }
+
+    // events recorded in between may not fit, they are left for next print
+    len = wifi_c_trace_dump(trace, size);
+    LOG_INFO("Event trace, %u bytes:", (unsigned)len);
+    for (size_t offset = 0; offset < len; offset += WIFI_C_TRACE_PRINT_BYTES)
+    {
+        size_t i = 0;
+        for (; i < WIFI_C_TRACE_PRINT_BYTES && offset + i < len; i++)
+        {
+            sprintf(&line[i * 2], "%02x", trace[offset + i]);
+        }
+        line[i * 2] = '\0';
+        LOG_INFO("WCTR %04x %s", (unsigned)offset, line);
+    }
+    free(trace);
+}
+
+void wifi_c_trace_clear(void)
+{
+    portENTER_CRITICAL(&wifi_c_trace.lock);
+    wifi_c_trace.head = 0;
+    wifi_c_trace.tail = 0;
+    wifi_c_trace.used = 0;
+    wifi_c_trace.dropped = 0;
+    portEXIT_CRITICAL(&wifi_c_trace.lock);
+}
+#endif // WIFI_C_EVENT_TRACE_ENABLED
+#endif // ESP_PLATFORM
+
+/*Reading dumped trace doesn't depend on ESP-IDF, so traces can be read on host.*/
+#include <string.h>
+#include "wifi_c_trace.h"
+
+#if !defined(ESP_PLATFORM) || WIFI_C_EVENT_TRACE_ENABLED
+bool wifi_c_trace_begin(const uint8_t *trace, size_t len, size_t *offset)
+{
+    wifi_c_trace_header_t header;
+
+    if (trace == NULL || len < sizeof(header))
+    {
+        return false;
+    }
+    memcpy(&header, trace, sizeof(header));
+    if (header.magic != WIFI_C_TRACE_MAGIC || header.version != WIFI_C_TRACE_VERSION)
+    {
+        return false;
+    }
+    *offset = sizeof(header);
+    return true;
+}
+
+bool wifi_c_trace_next(const uint8_t *trace, size_t len, size_t *offset, wifi_c_trace_event_t *event)
+{
+    if (*offset + sizeof(wifi_c_trace_record_t) > len)
+    {
+        return false;
+    }
+    memcpy(&event->record, &trace[*offset], sizeof(wifi_c_trace_record_t));
+    if (*offset + sizeof(wifi_c_trace_record_t) + event->record.len > len)
+    {
+        return false;
+    }
+    event->payload = &trace[*offset + sizeof(wifi_c_trace_record_t)];
+    *offset += sizeof(wifi_c_trace_record_t) + event->record.len;
+    return true;
+}
+#endif
@@ -0,0 +1,282 @@
+/**
+ * @file wifi_c_worker.c
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief User callback worker source file.
+ * @version 0.1
+ * @date 2024-02-07
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+/*Beginning of ESP-IDF specific code.*/
+#ifdef ESP_PLATFORM
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "err_controller.h"
+#include "errors_list.h"
+#include "wifi_controller.h"
+#include "wifi_c_worker.h"
+#include "wifi_c_span.h"
+#include "logger.h"
+
+/**
+ * @brief States of worker, changed under lock.
+ */
+typedef enum {
+    WIFI_C_WORKER_STOPPED = 0,            /*callbacks are called directly*/
+    WIFI_C_WORKER_RUNNING,
+    WIFI_C_WORKER_STOPPING,               /*queued callbacks still run, new ones are rejected*/
+} wifi_c_worker_state_t;
+
+static struct {
+    QueueHandle_t queue;
+    uint16_t queue_length;
+    TaskHandle_t task;
+    SemaphoreHandle_t stopped;
+    volatile wifi_c_worker_state_t state;
+    volatile bool stop_self;                // stop was called from callback, nobody waits for task
+    volatile uint16_t dispatching;          // dispatch calls between state check and queue send
+    uint32_t dispatched;
+    uint32_t overflows;
+    uint32_t rejected;
+    uint16_t queue_max_depth;
+    portMUX_TYPE lock;
+} wifi_c_worker = {
+    .queue = NULL,
+    .task = NULL,
+    .state = WIFI_C_WORKER_STOPPED,
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+static void wifi_c_worker_call(wifi_c_callback_t callback)
+{
+    WIFI_C_SPAN_BEGIN(WIFI_C_SPAN_CALLBACK);
+    callback();
+    WIFI_C_SPAN_END(WIFI_C_SPAN_CALLBACK);
+}
+
+/**
+ * @brief Wait until dispatch calls which saw running worker have queued their callbacks.
+ */
+static void wifi_c_worker_wait_dispatching(void)
+{
+    while (wifi_c_worker.dispatching > 0)
+    {
+        vTaskDelay(1);
+    }
+}
+
+static void wifi_c_worker_task(void *arg)
+{
+    wifi_c_callback_t callback = NULL;
+    bool stop_self = false;
+
+    for (;;)
+    {
+        if (xQueueReceive(wifi_c_worker.queue, &callback, portMAX_DELAY) != pdTRUE)
+        {
+            continue;
+        }
+        if (callback == NULL)
+        {
+            break; // stop requested, all callbacks queued before were already called
+        }
+        wifi_c_worker_call(callback);
+
+        if (wifi_c_worker.stop_self)
+        {
+            // no sentinel could be queued by callback itself, remaining callbacks are drained here
+            wifi_c_worker_wait_dispatching();
+            while (xQueueReceive(wifi_c_worker.queue, &callback, 0) == pdTRUE)
+            {
+                if (callback != NULL)
+                {
+                    wifi_c_worker_call(callback);
+                }
+            }
+            break;
+        }
+    }
+
+    portENTER_CRITICAL(&wifi_c_worker.lock);
+    stop_self = wifi_c_worker.stop_self;
+    wifi_c_worker.stop_self = false;
+    wifi_c_worker.task = NULL;
+    wifi_c_worker.state = WIFI_C_WORKER_STOPPED;
+    portEXIT_CRITICAL(&wifi_c_worker.lock);
+    if (!stop_self)
+    {
+        xSemaphoreGive(wifi_c_worker.stopped);
+    }
+    vTaskDelete(NULL);
+}
+
+int wifi_c_worker_start(const wifi_c_worker_config_t *config)
+{
+    volatile err_c_t err = ERR_C_OK;
+    wifi_c_worker_config_t default_config = WIFI_C_WORKER_CONFIG_DEFAULT();
+
+    if (config == NULL)
+    {
+        config = &default_config;
+    }
+
+    Try
+    {
+        if (wifi_c_worker.state != WIFI_C_WORKER_STOPPED)
+        {
+            ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_WORKER_ALREADY_STARTED);
+        }
+
+        if (config->queue_length == 0 || (wifi_c_worker.queue != NULL && config->queue_length != wifi_c_worker.queue_length))
+        {
+            ERR_C_SET_AND_THROW_ERR(err, ERR_C_INVALID_ARGS);
+        }
+
+        if (wifi_c_worker.queue == NULL)
+        {
+            wifi_c_worker.queue = xQueueCreate(config->queue_length, sizeof(wifi_c_callback_t));
+            wifi_c_worker.stopped = xSemaphoreCreateBinary();
+            if (wifi_c_worker.queue == NULL || wifi_c_worker.stopped == NULL)
+            {
+                ERR_C_SET_AND_THROW_ERR(err, ERR_C_MEMORY_ERR);
+            }
+            wifi_c_worker.queue_length = config->queue_length;
+        }
+
+        wifi_c_worker.state = WIFI_C_WORKER_RUNNING;
+        if (xTaskCreatePinnedToCore(wifi_c_worker_task, "wifi_c_worker", config->stack_size, NULL,
+                                    config->priority, &wifi_c_worker.task, config->core_id) != pdPASS)
+        {
+            wifi_c_worker.task = NULL;
+            wifi_c_worker.state = WIFI_C_WORKER_STOPPED; // callbacks queued meanwhile run on next start
+            ERR_C_SET_AND_THROW_ERR(err, ERR_C_MEMORY_ERR);
+        }
+        LOG_INFO("Callback worker started, priority %u, queue length %u.", config->priority, config->queue_length);
+    }
+    Catch(err)
+    {
+        switch (err)
+        {
+        case WIFI_C_ERR_WORKER_ALREADY_STARTED:
+            LOG_WARN("Callback worker already started.");
+            break;
+        case ERR_C_INVALID_ARGS:
+            LOG_ERROR("Wrong length of callback queue.");
+            break;
+        case ERR_C_MEMORY_ERR:
+            LOG_ERROR("Memory allocation was not successful");
+            break;
+        default:
+            LOG_ERROR("Error when starting callback worker: %d", err);
+            break;
+        }
+    }
+    return err;
+}
+
+void wifi_c_worker_stop(void)
+{
+    wifi_c_callback_t stop = NULL;
+    TaskHandle_t task = NULL;
+
+    portENTER_CRITICAL(&wifi_c_worker.lock);
+    if (wifi_c_worker.state == WIFI_C_WORKER_RUNNING)
+    {
+        wifi_c_worker.state = WIFI_C_WORKER_STOPPING;
+        task = wifi_c_worker.task;
+    }
+    portEXIT_CRITICAL(&wifi_c_worker.lock);
+
+    if (task == NULL)
+    {
+        return; // not running, or already stopping
+    }
+
+    if (xTaskGetCurrentTaskHandle() == task)
+    {
+        // called from callback, e.g. deinit in connect handler, worker can't wait for itself
+        wifi_c_worker.stop_self = true;
+        LOG_DEBUG("Callback worker stops after current callback.");
+        return;
+    }
+
+    // queued callbacks run before worker exits, sentinel must come after all of them
+    wifi_c_worker_wait_dispatching();
+    xQueueSend(wifi_c_worker.queue, &stop, portMAX_DELAY);
+    xSemaphoreTake(wifi_c_worker.stopped, portMAX_DELAY);
+    LOG_DEBUG("Callback worker stopped.");
+}
+
+bool wifi_c_worker_dispatch(wifi_c_callback_t callback)
+{
+    wifi_c_worker_state_t state;
+    uint16_t depth = 0;
+    bool queued = false;
+
+    if (callback == NULL)
+    {
+        return true;
+    }
+
+    portENTER_CRITICAL(&wifi_c_worker.lock);
+    state = wifi_c_worker.state;
+    if (state == WIFI_C_WORKER_RUNNING)
+    {
+        wifi_c_worker.dispatching++;
+    }
+    else if (state == WIFI_C_WORKER_STOPPING)
+    {
+        wifi_c_worker.rejected++;
+    }
+    portEXIT_CRITICAL(&wifi_c_worker.lock);
+
+    if (state == WIFI_C_WORKER_STOPPED)
+    {
+        wifi_c_worker_call(callback);
+        return true;
+    }
+    if (state == WIFI_C_WORKER_STOPPING)
+    {
+        return false; // would land after stop sentinel and never run
+    }
+
+    queued = (xQueueSend(wifi_c_worker.queue, &callback, 0) == pdTRUE);
+    depth = (uint16_t)uxQueueMessagesWaiting(wifi_c_worker.queue);
+
+    portENTER_CRITICAL(&wifi_c_worker.lock);
+    wifi_c_worker.dispatching--;
+    if (queued)
+    {
+        wifi_c_worker.dispatched++;
+        if (depth > wifi_c_worker.queue_max_depth)
+        {
+            wifi_c_worker.queue_max_depth = depth;
+        }
+    }
+    else
+    {
+        wifi_c_worker.overflows++;
+    }
+    portEXIT_CRITICAL(&wifi_c_worker.lock);
+    return queued;
+}
+
+int wifi_c_worker_get_stats(wifi_c_worker_stats_t *stats)
+{
+    ERR_C_CHECK_NULL_PTR(stats, LOG_ERROR("pointer to store worker statistics cannot be NULL"));
+
+    portENTER_CRITICAL(&wifi_c_worker.lock);
+    stats->dispatched = wifi_c_worker.dispatched;
+    stats->overflows = wifi_c_worker.overflows;
+    stats->rejected = wifi_c_worker.rejected;
+    stats->queue_max_depth = wifi_c_worker.queue_max_depth;
+    portEXIT_CRITICAL(&wifi_c_worker.lock);
+    stats->queue_depth = (wifi_c_worker.queue != NULL) ? (uint16_t)uxQueueMessagesWaiting(wifi_c_worker.queue) : 0;
+    return ERR_C_OK;
+}
+#endif // ESP_PLATFORM
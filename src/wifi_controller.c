@@ -1,934 +1,4281 @@
-/**
- * @file wifi_controller.c
- * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
- * @brief Wifi controller source file.
- * @version 0.1
- * @date 2024-02-07
- * 
- * @copyright Copyright (c) 2024
- * 
- */
-
-/*Beginning of ESP-IDF specific code.*/
-#ifdef ESP_PLATFORM
-
-#define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
-#include "esp_log.h"
-#include "esp_wifi.h"
-#include "esp_err.h"
-#include "esp_event.h"
-#include "esp_mac.h"
-#include "freertos/task.h"
-#include "freertos/event_groups.h"
-/*
-#include "ping/ping_sock.h"
-#include "lwip/inet.h"
-#include "lwip/netdb.h"
-#include "lwip/sockets.h"
-*/
-#include <string.h>
-#include "err_controller.h"
-#include "errors_list.h"
-#include "wifi_controller.h"
-#include "logger.h"
-#include "memory_utils.h"
-
-/**
- * @brief Initialize network interface.
- */
-static err_c_t wifi_c_init_netif(wifi_c_mode_t WIFI_C_WIFI_MODE);
-
-/**
- * @brief Default event handler for AP mode.
- */
-static void wifi_c_ap_event_handler(void *arg, esp_event_base_t event_base,
-                                    int32_t event_id, void *event_data);
-
-/**
- * @brief Default event handler for STA mode.
- */
-static void wifi_c_sta_event_handler(void *arg, esp_event_base_t event_base,
-                                     int32_t event_id, void *event_data);
-
-/**
- * @brief Check event group bits of connection status, and return result.
- */
-static err_c_t wifi_c_check_sta_connection_result(uint16_t timeout_sec);
-
-/**
- * @brief Deinit netif interfaces.
- */
-static void wifi_c_netif_deinit(wifi_c_mode_t mode);
-
-static wifi_c_status_t wifi_c_status = {
-    .wifi_initialized = false,
-    .netif_initialized = false,
-    .wifi_mode = WIFI_C_NO_MODE,
-    .even_loop_started = false,
-    .sta_started = false,
-    .ap_started = false,
-    .scan_done = false,
-    .sta_connected = false,
-    .ap.ip = "0.0.0.0",
-    .ap.ssid = "none",
-    .ap.connect_handler = NULL,
-    .sta.ip = "0.0.0.0",
-    .sta.ssid = "none",
-    .sta.connect_handler = NULL,
-};
-
-static EventGroupHandle_t wifi_c_event_group;
-
-static uint8_t wifi_sta_retry_num;
-
-/*Variables needed for scan.*/
-static wifi_ap_record_t ap_info[WIFI_C_DEFAULT_SCAN_SIZE];
-static wifi_c_scan_result_t wifi_scan_info;
-
-// netif handles, needed for deinitialization
-static esp_netif_t *netif_handle_sta = NULL;
-static esp_netif_t *netif_handle_ap = NULL;
-
-static void wifi_c_ap_event_handler(void *arg, esp_event_base_t event_base,
-                                    int32_t event_id, void *event_data)
-{
-    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_AP_STACONNECTED)
-    {
-        wifi_event_ap_staconnected_t *event = (wifi_event_ap_staconnected_t *)event_data;
-        LOG_INFO("Station " MACSTR " joined, AID=%d",
-                 MAC2STR(event->mac), event->aid);
-    }
-    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_AP_STADISCONNECTED)
-    {
-        wifi_event_ap_stadisconnected_t *event = (wifi_event_ap_stadisconnected_t *)event_data;
-        LOG_INFO("Station " MACSTR " left, AID=%d",
-                 MAC2STR(event->mac), event->aid);
-    }
-    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_SCAN_DONE)
-    {
-        LOG_INFO("Total APs scanned: %u", wifi_scan_info.ap_count);
-        xEventGroupSetBits(wifi_c_event_group, WIFI_C_SCAN_DONE_BIT);
-        wifi_c_status.scan_done = true;
-    }
-}
-
-static void wifi_c_sta_event_handler(void *arg, esp_event_base_t event_base,
-                                     int32_t event_id, void *event_data)
-{
-
-    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START)
-    {
-        LOG_INFO("Station started, connecting to WiFi.");
-        wifi_c_status.sta_started = true;
-        xEventGroupSetBits(wifi_c_event_group, WIFI_C_STA_STARTED_BIT);
-    }
-    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED)
-    {
-        if (wifi_sta_retry_num < WIFI_C_STA_RETRY_COUNT)
-        {
-            esp_wifi_connect();
-            wifi_sta_retry_num++;
-            LOG_WARN("Failed to connect to AP, trying again.");
-        }
-        else
-        {
-            xEventGroupSetBits(wifi_c_event_group, WIFI_C_CONNECT_FAIL_BIT);
-        }
-    }
-    else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP)
-    {
-        ip_event_got_ip_t *event = (ip_event_got_ip_t *)event_data;
-        sprintf(&(wifi_c_status.sta.ip[0]), IPSTR, IP2STR(&event->ip_info.ip));
-        LOG_INFO("Got IP:" IPSTR, IP2STR(&event->ip_info.ip));
-        wifi_c_status.sta_connected = true;
-        xEventGroupSetBits(wifi_c_event_group, WIFI_C_CONNECTED_BIT);
-        wifi_c_status.sta.connect_handler();
-    }
-}
-
-static err_c_t wifi_c_check_sta_connection_result(uint16_t timeout_sec)
-{
-    /*Wait for sta to finish connecting or timeout*/
-    EventBits_t bits = xEventGroupWaitBits(wifi_c_event_group, WIFI_C_CONNECTED_BIT | WIFI_C_CONNECT_FAIL_BIT, pdFALSE, pdFALSE, pdMS_TO_TICKS(timeout_sec * 1000));
-    switch (bits)
-    {
-    case WIFI_C_CONNECTED_BIT | WIFI_C_STA_STARTED_BIT:
-        LOG_DEBUG("WIFI_C_CONNECTED_BIT is set!");
-        return 0;
-    case WIFI_C_CONNECT_FAIL_BIT | WIFI_C_STA_STARTED_BIT:
-        LOG_DEBUG("WIFI_C_CONNECT_FAIL_BIT is set!");
-        return WIFI_C_ERR_STA_CONNECT_FAIL;
-    case WIFI_C_STA_STARTED_BIT:
-        LOG_DEBUG("WIFI_C_STA_STARTED_BIT is set, but timeout expired, connection failed");
-        return WIFI_C_ERR_STA_TIMEOUT_EXPIRE;
-    case 0:
-        LOG_DEBUG("WIFI_C_STA_STARTED_BIT not set");
-        return WIFI_C_ERR_STA_NOT_STARTED;
-    default:
-        LOG_DEBUG("i don't know which bits are set, see: %u", bits);
-        return ERR_C_INVALID_ARGS;
-    }
-}
-
-static err_c_t wifi_c_init_netif(wifi_c_mode_t WIFI_C_WIFI_MODE)
-{
-    volatile err_c_t err = ERR_C_OK;
-
-    switch (WIFI_C_WIFI_MODE)
-    {
-    case WIFI_C_MODE_AP:
-        netif_handle_ap = esp_netif_create_default_wifi_ap();
-        assert(netif_handle_ap);
-        wifi_c_status.wifi_mode = WIFI_C_MODE_AP;
-        LOG_DEBUG("netif initialized as AP");
-        break;
-    case WIFI_C_MODE_STA:
-        netif_handle_sta = esp_netif_create_default_wifi_sta();
-        assert(netif_handle_sta);
-        wifi_c_status.wifi_mode = WIFI_C_MODE_STA;
-        LOG_DEBUG("netif initialized as STA");
-        break;
-    case WIFI_C_MODE_APSTA:
-        netif_handle_ap = esp_netif_create_default_wifi_ap();
-        assert(netif_handle_ap);
-
-        netif_handle_sta = esp_netif_create_default_wifi_sta();
-        assert(netif_handle_sta);
-
-        wifi_c_status.wifi_mode = WIFI_C_MODE_APSTA;
-        LOG_DEBUG("netif initialized as AP+STA");
-        break;
-    default:
-        LOG_ERROR("wifi_c_init_netif: Wrong wifi mode.");
-        err = WIFI_C_ERR_NETIF_INIT_FAILED;
-        break;
-    }
-
-    wifi_c_status.netif_initialized = true;
-    return err;
-}
-
-static wifi_mode_t wifi_c_select_wifi_mode(wifi_c_mode_t WIFI_C_WIFI_MODE)
-{
-    switch (WIFI_C_WIFI_MODE)
-    {
-    case WIFI_C_MODE_AP:
-        return WIFI_MODE_AP;
-        break;
-    case WIFI_C_MODE_STA:
-        return WIFI_MODE_STA;
-        break;
-    case WIFI_C_MODE_APSTA:
-        return WIFI_MODE_APSTA;
-        break;
-    default:
-        return WIFI_MODE_NULL;
-        break;
-    }
-}
-
-int wifi_c_create_default_event_loop(void)
-{
-    volatile err_c_t err = ERR_C_OK;
-
-    Try
-    {
-        ERR_C_CHECK_AND_THROW_ERR(esp_event_loop_create_default());
-
-        ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT,
-                                                            ESP_EVENT_ANY_ID,
-                                                            &wifi_c_ap_event_handler,
-                                                            NULL,
-                                                            NULL));
-
-        ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT,
-                                                            ESP_EVENT_ANY_ID,
-                                                            &wifi_c_sta_event_handler,
-                                                            NULL,
-                                                            NULL));
-
-        ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT,
-                                                            IP_EVENT_STA_GOT_IP,
-                                                            &wifi_c_sta_event_handler,
-                                                            NULL,
-                                                            NULL));
-
-        wifi_c_status.even_loop_started = true;
-    }
-    Catch(err)
-    {
-        LOG_ERROR("Error when creating default event loop: %d", err);
-    }
-    return err;
-}
-
-int wifi_c_sta_register_connect_handler(void (*connect_handler)(void))
-{
-    err_c_t err = 0;
-    ERR_C_CHECK_NULL_PTR(connect_handler, LOG_ERROR("connect handler function cannot be NULL"));
-
-    wifi_c_status.sta.connect_handler = connect_handler;
-    LOG_INFO("connect handler function of wifi controller changed!");
-    return err;
-}
-
-wifi_c_status_t *wifi_c_get_status(void)
-{
-    return &wifi_c_status;
-}
-
-static inline char *wifi_c_get_bool_as_char(bool value)
-{
-    return (value) ? "true" : "false";
-}
-
-int wifi_c_get_status_as_json(char *buffer, size_t buflen)
-{
-    err_c_t err = 0;
-
-    ERR_C_CHECK_NULL_PTR(buffer, LOG_ERROR("buffer to store wifi_c_status as JSON cannot be NULL"));
-    memutil_zero_memory(buffer, buflen);
-
-    LOG_DEBUG("storing wifi_c_status structure as JSON string...");
-
-    snprintf(buffer, buflen, "{\"wifi_initialized\": %s, \"netif_initialized\":%s, \"wifi_mode\": \"%s\", \"event_loop_started\": %s, \"sta_started\": %s, \"ap_started\": %s, \"scan_done\": %s, \"sta_connected\":%s, \"sta_ip\": \"%s\", \"sta_ssid\": \"%s\", \"ap_ip\": \"%s\", \"ap_ssid\": \"%s\"}",
-             wifi_c_get_bool_as_char(wifi_c_status.wifi_initialized),
-             wifi_c_get_bool_as_char(wifi_c_status.netif_initialized),
-             wifi_c_get_wifi_mode_as_string(wifi_c_status.wifi_mode),
-             wifi_c_get_bool_as_char(wifi_c_status.even_loop_started),
-             wifi_c_get_bool_as_char(wifi_c_status.sta_started),
-             wifi_c_get_bool_as_char(wifi_c_status.ap_started),
-             wifi_c_get_bool_as_char(wifi_c_status.scan_done),
-             wifi_c_get_bool_as_char(wifi_c_status.sta_connected),
-             wifi_c_get_sta_ipv4(),
-             wifi_c_sta_get_ap_ssid(),
-             wifi_c_get_ap_ipv4(),
-             wifi_c_ap_get_ssid());
-    LOG_DEBUG("wifi_c_status structure as JSON: \n%s", buffer);
-    return err;
-}
-
-char *wifi_c_get_wifi_mode_as_string(wifi_c_mode_t wifi_mode)
-{
-    switch (wifi_mode)
-    {
-    case WIFI_C_MODE_AP:
-        return "WIFI_C_MODE_AP";
-    case WIFI_C_MODE_STA:
-        return "WIFI_C_MODE_STA";
-    case WIFI_C_MODE_APSTA:
-        return "WIFI_C_MODE_APSTA";
-    default:
-        LOG_ERROR("not known wifi_c_mode_t: %d, cannot translate to string.", wifi_mode);
-        break;
-    }
-    return NULL;
-}
-
-char *wifi_c_get_sta_ipv4(void)
-{
-    return wifi_c_status.sta.ip;
-}
-
-char *wifi_c_get_ap_ipv4(void)
-{
-    return wifi_c_status.ap.ip;
-}
-
-char *wifi_c_sta_get_ap_ssid(void)
-{
-    return wifi_c_status.sta.ssid;
-}
-
-char *wifi_c_ap_get_ssid(void)
-{
-    return wifi_c_status.ap.ssid;
-}
-
-int wifi_c_init_wifi(wifi_c_mode_t WIFI_C_WIFI_MODE)
-{
-    volatile err_c_t err = ERR_C_OK;
-    wifi_init_config_t wifi_init_config = WIFI_INIT_CONFIG_DEFAULT();
-    Try
-    {
-        if (wifi_c_status.wifi_initialized == true && wifi_c_status.wifi_mode == WIFI_C_WIFI_MODE)
-        {
-            ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_WIFI_ALREADY_INIT);
-        } else if(wifi_c_status.wifi_initialized == true && wifi_c_status.wifi_mode != WIFI_C_WIFI_MODE) {
-            wifi_c_deinit();    //if it's init with different mode, deinit and init with new wanted mode
-        }
-
-        ESP_ERROR_CHECK(esp_netif_init());
-        wifi_c_event_group = xEventGroupCreate();
-        ERR_C_CHECK_AND_THROW_ERR(wifi_c_create_default_event_loop());
-        ERR_C_CHECK_AND_THROW_ERR(wifi_c_init_netif(WIFI_C_WIFI_MODE));
-        ERR_C_CHECK_AND_THROW_ERR(esp_wifi_init(&wifi_init_config));
-        LOG_INFO("Wifi initialized.");
-        ERR_C_CHECK_AND_THROW_ERR(esp_wifi_set_storage(WIFI_STORAGE_FLASH));
-        ERR_C_CHECK_AND_THROW_ERR(esp_wifi_set_mode(wifi_c_select_wifi_mode(WIFI_C_WIFI_MODE)));
-        ERR_C_CHECK_AND_THROW_ERR(esp_wifi_start());
-        LOG_DEBUG("wifi successfully initialized");
-        // Update wifi controller status.
-        wifi_c_status.wifi_initialized = true;
-        wifi_c_status.wifi_mode = WIFI_C_WIFI_MODE;
-    }
-    Catch(err)
-    {
-        if (err == WIFI_C_ERR_WIFI_ALREADY_INIT)
-        {
-            LOG_WARN("WiFi already initialized.");
-        }
-        else
-        {
-            LOG_ERROR("Error when initializing WiFi: %d", err);
-        }
-    }
-    return err;
-}
-
-int wifi_c_start_ap(const char *ssid, const char *password)
-{
-    volatile err_c_t err = ERR_C_OK;
-    wifi_config_t wifi_ap_config = {
-        .ap = {
-            .authmode = WIFI_AUTH_WPA2_PSK,
-            .max_connection = 6,
-        }};
-
-    Try
-    {
-        if (wifi_c_status.wifi_initialized != true)
-        {
-            LOG_WARN("WiFi not init, initializing...");
-            ERR_C_CHECK_AND_THROW_ERR(wifi_c_init_wifi(WIFI_C_MODE_AP));
-        }
-
-        if (wifi_c_status.wifi_mode == WIFI_C_MODE_STA)
-        {
-            ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_WRONG_MODE);
-        }
-
-        if (strlen(ssid) == 0)
-        {
-            ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_NULL_SSID);
-        }
-
-        if(password == NULL) {
-            LOG_WARN("No password, setting wifi_auth_mode_t to WIFI_AUTH_OPEN.");
-            wifi_ap_config.ap.authmode = WIFI_AUTH_OPEN;            
-        }
-        else if (strlen(password) == 0)
-        {
-            LOG_WARN("No password, setting wifi_auth_mode_t to WIFI_AUTH_OPEN.");
-            wifi_ap_config.ap.authmode = WIFI_AUTH_OPEN;
-        }
-        else if (strlen(password) < 8)
-        {
-            ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_WRONG_PASSWORD);
-        }
-        else
-        {
-            if ((memcpy(&(wifi_ap_config.ap.password), password, sizeof(wifi_ap_config.ap.password))) != &(wifi_ap_config.ap.password))
-            {
-                ERR_C_SET_AND_THROW_ERR(err, ERR_C_MEMORY_ERR);
-            }
-        }
-
-        if ((memcpy(&(wifi_ap_config.ap.ssid), ssid, sizeof(wifi_ap_config.ap.ssid))) != &(wifi_ap_config.ap.ssid))
-        {
-            ERR_C_SET_AND_THROW_ERR(err, ERR_C_MEMORY_ERR);
-        }
-
-        ERR_C_CHECK_AND_THROW_ERR(esp_wifi_set_config(WIFI_IF_AP, &wifi_ap_config));
-        // ERR_C_CHECK_AND_THROW_ERR(esp_wifi_start());
-        if(password != NULL) {
-            LOG_INFO("Started AP: \nSSID: %s \nPassword: %s", ssid, password);
-        } else {
-            LOG_INFO("Started AP: \nSSID: %s \nNo Password", ssid);
-        }
-
-        // update wifi_c_status
-        wifi_c_status.ap_started = true;
-
-        memutil_zero_memory(&(wifi_c_status.ap.ssid), sizeof(wifi_c_status.ap.ssid));
-        memcpy(&(wifi_c_status.ap.ssid), ssid, strlen(ssid));
-
-        memutil_zero_memory(&(wifi_c_status.ap.ip), sizeof(wifi_c_status.ap.ip));
-        memcpy(&(wifi_c_status.ap.ip), "192.168.4.1", strlen("192.168.4.1")); // use standard address got by DHCP
-    }
-    Catch(err)
-    {
-        switch (err)
-        {
-        case WIFI_C_ERR_WRONG_MODE:
-            LOG_ERROR("Wrong Wifi mode.");
-            break;
-        case WIFI_C_ERR_NULL_SSID:
-            LOG_ERROR("SSID cannot be null");
-            break;
-        case ERR_C_MEMORY_ERR:
-            LOG_ERROR("Memory allocation was not successful");
-            break;
-        case WIFI_C_ERR_WRONG_PASSWORD:
-            LOG_ERROR("Password too short for WIFI_AUTH_WPA2_PSK.");
-            break;
-        default:
-            LOG_ERROR("Error when starting STA: %d, \nESP-IDF error: %s", err, esp_err_to_name(err));
-            break;
-        }
-
-        memset(&wifi_ap_config, 0, sizeof(wifi_ap_config));
-    }
-
-    return err;
-}
-
-/**
- * @todo changing connection timeout time
- */
-int wifi_c_start_sta(const char *ssid, const char *password)
-{
-    volatile err_c_t err = ERR_C_OK;
-    wifi_config_t wifi_sta_config = {
-        .sta = {
-            .failure_retry_cnt = 1, // WIFI_C_STA_RETRY_COUNT,
-            .scan_method = WIFI_ALL_CHANNEL_SCAN,
-        },
-    };
-    assert(ssid);
-
-    Try
-    {
-
-        if (wifi_c_status.wifi_initialized != true)
-        {
-            LOG_WARN("WiFi not init, initializing...");
-            ERR_C_CHECK_AND_THROW_ERR(wifi_c_init_wifi(WIFI_C_MODE_STA));
-        }
-
-        if (wifi_c_status.wifi_mode == WIFI_C_MODE_AP)
-        {
-            ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_WRONG_MODE);
-        }
-
-        if (strlen(ssid) == 0)
-        {
-            ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_NULL_SSID);
-        }
-
-        if ((memcpy(&(wifi_sta_config.sta.ssid), ssid, sizeof(wifi_sta_config.sta.ssid))) != &(wifi_sta_config.sta.ssid))
-        {
-            ERR_C_SET_AND_THROW_ERR(err, ERR_C_MEMORY_ERR);
-        }
-
-        if ((memcpy(&(wifi_sta_config.sta.password), password, sizeof(wifi_sta_config.sta.password))) != &(wifi_sta_config.sta.password))
-        {
-            ERR_C_SET_AND_THROW_ERR(err, ERR_C_MEMORY_ERR);
-        }
-
-        ERR_C_CHECK_AND_THROW_ERR(esp_wifi_set_config(WIFI_IF_STA, &wifi_sta_config));
-        LOG_DEBUG("WiFi successfully configured as STA.");
-        wifi_c_status.sta_started = true;
-
-        /*Wait till sta started before trying to connect.*/
-        xEventGroupWaitBits(wifi_c_event_group, WIFI_C_STA_STARTED_BIT, pdFALSE, pdFALSE, pdMS_TO_TICKS(2000));
-
-        ERR_C_CHECK_AND_THROW_ERR(esp_wifi_connect());
-
-        /*Wait for sta to finish connecting or timeout*/
-        ERR_C_CHECK_AND_THROW_ERR(wifi_c_check_sta_connection_result(60));
-
-        // update AP of ssid we are connected to in status
-        memutil_zero_memory(&(wifi_c_status.sta.ssid), sizeof(wifi_c_status.sta.ssid));
-        memcpy(&(wifi_c_status.sta.ssid), ssid, strlen(ssid));
-    }
-    Catch(err)
-    {
-        switch (err)
-        {
-        case WIFI_C_ERR_WRONG_MODE:
-            LOG_ERROR("Wrong Wifi mode.");
-            break;
-        case WIFI_C_ERR_NULL_SSID:
-            LOG_ERROR("SSID cannot be null");
-            break;
-        case ERR_C_MEMORY_ERR:
-            LOG_ERROR("Memory allocation was not successful");
-            break;
-        case WIFI_C_ERR_STA_NOT_STARTED:
-            LOG_ERROR("STA didn't start properly");
-            break;
-        case WIFI_C_ERR_STA_CONNECT_FAIL:
-            LOG_ERROR("All attempts to connect to Wifi failed");
-            break;
-        case WIFI_C_ERR_STA_TIMEOUT_EXPIRE:
-            LOG_ERROR("Failed to connect before timeout expired, returning...");
-            break;
-        default:
-            LOG_ERROR("Error when starting STA: %d, \nESP-IDF error: %s", err, esp_err_to_name(err));
-            break;
-        }
-        memset(&wifi_sta_config, 0, sizeof(wifi_sta_config));
-    }
-
-    return err;
-}
-
-/**
- * @todo return only needed number of scan results
- * @todo use memory arena for storing scan results
- */
-int wifi_c_scan_all_ap(wifi_c_scan_result_t *result_to_return)
-{
-    volatile err_c_t err = ERR_C_OK;
-    wifi_scan_config_t scan_config = {
-        .show_hidden = 0 // Don't  show hidden AP.
-    };
-
-    wifi_scan_info.ap_count = WIFI_C_DEFAULT_SCAN_SIZE;
-
-    Try
-    {
-        ERR_C_CHECK_NULL_PTR(result_to_return, LOG_ERROR("pointer to scan result buffer cannot be NULL"));
-
-        if (!wifi_c_status.wifi_initialized)
-        {
-            ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_WIFI_NOT_INIT);
-        }
-
-        if (wifi_c_status.wifi_mode == WIFI_C_MODE_AP)
-        {
-            ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_WRONG_MODE); // scans are only allowed in STA mode.
-        }
-
-        if (!wifi_c_status.sta_started)
-        {
-            ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_STA_NOT_STARTED);
-        }
-
-        memset(&ap_info, 0, sizeof(ap_info));
-        LOG_DEBUG("scanning for Access Points...");
-
-        err = esp_wifi_scan_start(&scan_config, WIFI_C_SCAN_BLOCK);
-
-        /*If ESP_ERR_WIFI_STATE was returned, it is possible that sta was connecting, then wait and try again.*/
-        if (err == ESP_ERR_WIFI_STATE)
-        {
-            vTaskDelay(1000);
-            ERR_C_CHECK_AND_THROW_ERR(esp_wifi_scan_start(&scan_config, WIFI_C_SCAN_BLOCK));
-        }
-        else
-        {
-            ERR_C_CHECK_AND_THROW_ERR(err);
-        }
-        /*Wait for scan to finish before reading results.*/
-        xEventGroupWaitBits(wifi_c_event_group, WIFI_C_SCAN_DONE_BIT, pdTRUE, pdFALSE, pdMS_TO_TICKS(2000));
-        ERR_C_CHECK_AND_THROW_ERR(esp_wifi_scan_get_ap_records(&wifi_scan_info.ap_count, &ap_info[0]));
-        ERR_C_CHECK_AND_THROW_ERR(esp_wifi_scan_get_ap_num(&(wifi_scan_info.ap_count)));
-        wifi_scan_info.ap_record = &ap_info[0];
-
-        /*Point passed pointer to scan results*/
-        result_to_return = &wifi_scan_info;
-    }
-    Catch(err)
-    {
-        switch (err)
-        {
-        case WIFI_C_ERR_WRONG_MODE:
-            LOG_ERROR("Wrong Wifi mode, scanning only possible in STA mode.");
-            break;
-        case WIFI_C_ERR_WIFI_NOT_INIT:
-            LOG_ERROR("WiFi was not initialized.");
-            break;
-        case WIFI_C_ERR_STA_NOT_STARTED:
-            LOG_ERROR("STA was not started.");
-            break;
-        default:
-            LOG_ERROR("Error when scanning: %d \nESP-IDF error: %s", err, esp_err_to_name((esp_err_t)err));
-            break;
-        }
-        // Clear AP list found in last scan
-        memset(&ap_info, 0, sizeof(ap_info));
-        memset(&wifi_scan_info, 0, sizeof(wifi_scan_info));
-        esp_wifi_clear_ap_list();
-    }
-
-    return err;
-}
-
-int wifi_c_scan_for_ap_with_ssid(const char *searched_ssid, wifi_c_ap_record_t *ap_record)
-{
-    volatile err_c_t err = ERR_C_OK;
-    assert(searched_ssid);
-    wifi_ap_record_t *record;
-    bool success = false;
-
-    Try
-    {
-        assert(&wifi_scan_info);
-        record = wifi_scan_info.ap_record;
-        uint8_t ssid_len = strlen(searched_ssid);
-
-        for (uint16_t i = 0; i < wifi_scan_info.ap_count; i++)
-        {
-            const char *ssid = (char *)(record->ssid);
-            if (strncmp(searched_ssid, ssid, ssid_len) == 0)
-            {
-                LOG_INFO("Found %s AP.", searched_ssid);
-                success = true;
-                break;
-            }
-            record++;
-        }
-        if (success)
-        {
-            memcpy(ap_record, record, sizeof(wifi_ap_record_t));
-        }
-        else
-        {
-            ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_AP_NOT_FOUND);
-        }
-    }
-    Catch(err)
-    {
-        switch (err)
-        {
-        case WIFI_C_ERR_AP_NOT_FOUND:
-            LOG_WARN("Not found desired AP.");
-            break;
-        default:
-            LOG_ERROR("Error when scanning: %d \nESP-IDF error: %s", err, esp_err_to_name((esp_err_t)err));
-            esp_wifi_clear_ap_list(); // Clear AP list found in last scan
-            break;
-        }
-    }
-
-    return err;
-}
-
-/**
- * @todo Change print format.
- */
-int wifi_c_print_scanned_ap(void)
-{
-    volatile err_c_t err = ERR_C_OK;
-    Try
-    {
-        if (!(wifi_c_status.wifi_initialized))
-        {
-            ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_WIFI_NOT_INIT);
-        }
-
-        /*If scan is not yet done, wait for a while before continuing
-        Then bits, if it's again not done, then throw errror.*/
-        if (!(wifi_c_status.scan_done))
-        {
-            EventBits_t bits = xEventGroupWaitBits(wifi_c_event_group, WIFI_C_SCAN_DONE_BIT, pdTRUE, pdFALSE, pdMS_TO_TICKS(1000));
-            if ((bits & WIFI_C_SCAN_DONE_BIT) != WIFI_C_SCAN_DONE_BIT)
-            {
-                ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_SCAN_NOT_DONE);
-            }
-        }
-
-        wifi_ap_record_t *record = wifi_scan_info.ap_record;
-        for (uint16_t i = 0; i < WIFI_C_DEFAULT_SCAN_SIZE; i++)
-        {
-            const char *ssid = (char *)(record->ssid);
-            int8_t rssi = record->rssi;
-            LOG_INFO("SSID \t%s", ssid);
-            LOG_INFO("RSSI \t%d", rssi);
-            record++;
-        }
-    }
-    Catch(err)
-    {
-        switch (err)
-        {
-        case WIFI_C_ERR_SCAN_NOT_DONE:
-            LOG_ERROR("Scan not done, init scan before getting results.");
-            break;
-        case WIFI_C_ERR_WIFI_NOT_INIT:
-            LOG_ERROR("WiFi was not initialized.");
-            break;
-        default:
-            LOG_ERROR("Error when getting scan results: %d \nESP-IDF error: %s", err, esp_err_to_name((esp_err_t)err));
-            break;
-        }
-    }
-
-    return err;
-}
-
-int wifi_c_store_scan_result_as_json(char *buffer, uint16_t buflen)
-{
-    volatile err_c_t err = ERR_C_OK;
-    ERR_C_CHECK_NULL_PTR(buffer, LOG_ERROR("buffer to store scanned APs cannot be NULL"));
-    Try
-    {
-        if (!(wifi_c_status.wifi_initialized))
-        {
-            ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_WIFI_NOT_INIT);
-        }
-
-        /*If scan is not yet done, wait for a while before continuing
-        Then bits, if it's again not done, then throw errror.*/
-        if (!(wifi_c_status.scan_done))
-        {
-            EventBits_t bits = xEventGroupWaitBits(wifi_c_event_group, WIFI_C_SCAN_DONE_BIT, pdTRUE, pdFALSE, pdMS_TO_TICKS(1000));
-            if ((bits & WIFI_C_SCAN_DONE_BIT) != WIFI_C_SCAN_DONE_BIT)
-            {
-                ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_SCAN_NOT_DONE);
-            }
-        }
-
-        char ap[100];
-        uint16_t ap_len = 0;
-        uint16_t space_left = buflen;
-        uint16_t index = 0;
-        wifi_ap_record_t *record = wifi_scan_info.ap_record;
-        for (uint16_t i = 0; i < WIFI_C_DEFAULT_SCAN_SIZE; i++)
-        {
-            memutil_zero_memory(&ap, sizeof(ap));
-            char *ssid = (char *)(record->ssid);
-
-            sprintf(&ap[0], ", {\"ssid\": \"%s\", \"rssi\": %d}", ssid, record->rssi);
-            ap_len = strlen(&ap[0]);
-            memcpy(&(buffer[index]), &ap[0], ap_len);
-            space_left -= ap_len;
-            index += ap_len;
-            record++;
-        }
-        // delete first comma nad insert json array
-        buffer[index++] = ']';
-        buffer[0] = '[';
-
-        // null terminate end result
-        buffer[index] = '\0';
-    }
-    Catch(err)
-    {
-        switch (err)
-        {
-        case WIFI_C_ERR_SCAN_NOT_DONE:
-            LOG_ERROR("Scan not done, init scan before getting results.");
-            break;
-        case WIFI_C_ERR_WIFI_NOT_INIT:
-            LOG_ERROR("WiFi was not initialized.");
-            break;
-        default:
-            LOG_ERROR("Error when getting scan results: %d \nESP-IDF error: %s", err, esp_err_to_name((esp_err_t)err));
-            break;
-        }
-    }
-
-    return err;
-}
-
-int wifi_c_disconnect(void)
-{
-    err_c_t err = 0;
-    err = esp_wifi_disconnect();
-    if (err != ESP_OK)
-    {
-        LOG_ERROR("error %d when trying to disconnect: %s", err, error_to_name(err));
-        return err;
-    }
-    wifi_c_status.sta_connected = false;
-
-    // update IP
-    memutil_zero_memory(&(wifi_c_status.sta.ip), sizeof(wifi_c_status.sta.ip));
-    memcpy(&(wifi_c_status.sta.ip), "0.0.0.0", strlen("0.0.0.0"));
-
-    // update ap_ssid
-    memutil_zero_memory((&wifi_c_status.sta.ssid), sizeof(wifi_c_status.sta.ssid));
-    memcpy(&(wifi_c_status.sta.ssid), "none", strlen("none"));
-
-    return err;
-}
-
-int wifi_c_change_mode(wifi_c_mode_t mode)
-{
-    err_c_t err = 0;
-    if (wifi_c_status.wifi_mode == mode)
-    {
-        LOG_WARN("mode to set is the same as current mode");
-        return WIFI_C_ERR_WRONG_MODE;
-    }
-    err = esp_wifi_set_mode(wifi_c_select_wifi_mode(mode));
-    if (err != ERR_C_OK)
-    {
-        LOG_ERROR("error %d when changing wifi mode: %s", err, error_to_name(err));
-        return err;
-    }
-    return err;
-}
-
-static void wifi_c_netif_deinit(wifi_c_mode_t mode)
-{
-    switch (mode)
-    {
-    case WIFI_C_MODE_STA:
-        esp_netif_destroy_default_wifi(netif_handle_sta);
-        break;
-    case WIFI_C_MODE_AP:
-        esp_netif_destroy_default_wifi(netif_handle_ap);
-        break;
-    case WIFI_C_MODE_APSTA:
-        esp_netif_destroy_default_wifi(netif_handle_ap);
-        esp_netif_destroy_default_wifi(netif_handle_sta);
-        break;
-    default:
-        break;
-    }
-}
-
-/**
- * Mostly when we are deinitializing wifi interface in our application, it means something
- * somewhere has gone really bad, and we are doing panic exit.
- * This function was also created with this assumption, so no error checking is done here.
- */
-void wifi_c_deinit(void)
-{
-    LOG_DEBUG("Deinitializing wifi_controller...");
-    if (wifi_c_status.sta_connected)
-    {
-        esp_wifi_disconnect();
-        LOG_DEBUG("disconnected sta from AP...");
-    }
-    if (wifi_c_status.wifi_initialized)
-    {
-        esp_wifi_stop();
-        esp_wifi_deinit();
-        LOG_DEBUG("stopped and deinitialized wifi...");
-    }
-    if (wifi_c_status.netif_initialized)
-    {
-        wifi_c_netif_deinit(wifi_c_status.wifi_mode);
-        LOG_DEBUG("netif deinitialized...");
-    }
-
-    if (wifi_c_status.even_loop_started)
-    {
-        vEventGroupDelete(wifi_c_event_group);
-        esp_event_loop_delete_default();
-        LOG_DEBUG("wifi_c_event loop destroyed...");
-    }
-
-    // at least clear wifi_c_status state
-    wifi_c_status.wifi_initialized = false;
-    wifi_c_status.netif_initialized = false;
-    wifi_c_status.wifi_mode = WIFI_C_NO_MODE;
-    wifi_c_status.even_loop_started = false;
-    wifi_c_status.sta_started = false;
-    wifi_c_status.ap_started = false;
-    wifi_c_status.scan_done = false;
-    wifi_c_status.sta_connected = false;
-    wifi_c_status.sta.connect_handler = NULL;
-    wifi_c_status.ap.connect_handler = NULL;
-    memcpy(wifi_c_status.ap.ip, "0.0.0.0", 8);
-    memcpy(wifi_c_status.sta.ip, "0.0.0.0", 8);
-    memcpy(wifi_c_status.ap.ssid, "none", 5);
-    memcpy(wifi_c_status.sta.ssid, "none", 5);
-    LOG_WARN("wifi_controller deinitialized");
-}
-#endif // ESP_PLATFORM
+/**
+ * @file wifi_controller.c
+ * @author Wojciech Mytych (wojciech.lukasz.mytych@gmail.com)
+ * @brief Wifi controller source file.
+ * @version 0.1
+ * @date 2024-02-07
+ * 
+ * @copyright Copyright (c) 2024
+ * 
+ */
+
+/*Beginning of ESP-IDF specific code.*/
+#ifdef ESP_PLATFORM
+
+#include "sdkconfig.h"
+#ifdef CONFIG_WIFI_C_LOG_LEVEL
+#define LOG_LOCAL_LEVEL CONFIG_WIFI_C_LOG_LEVEL
+#endif
+#include "esp_log.h"
+#include "esp_wifi.h"
+#include "esp_err.h"
+#include "esp_event.h"
+#include "esp_mac.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
+#include "esp_wifi_ap_get_sta_list.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+/*
+#include "ping/ping_sock.h"
+#include "lwip/inet.h"
+#include "lwip/netdb.h"
+#include "lwip/sockets.h"
+*/
+#include <string.h>
+#include <stdlib.h>
+#include "err_controller.h"
+#include "errors_list.h"
+#include "wifi_controller.h"
+#include "wifi_c_ctx.h"
+#include "wifi_c_worker.h"
+#include "wifi_c_cmd.h"
+#include "wifi_c_link.h"
+#if WIFI_C_SCAN_ENABLED
+#include "wifi_c_history.h"
+#include "wifi_c_scan_filter.h"
+#include "wifi_c_scan_slice.h"
+#include "wifi_c_channel.h"
+#include "wifi_c_roam.h"
+#include "esp_idf_version.h"
+#endif
+#include "logger.h"
+#include "memory_utils.h"
+
+#if WIFI_C_METRICS_ENABLED
+#include "wifi_c_metrics.h"
+#define WIFI_C_METRIC(call) call
+#else
+#define WIFI_C_METRIC(call)
+#endif
+
+#if WIFI_C_APSTA_POLICY_ENABLED
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+#define WIFI_C_APSTA_CSA_SUPPORTED      1   // driver announces AP channel switch, beacon count is in AP config
+#else
+#define WIFI_C_APSTA_CSA_SUPPORTED      0
+#endif
+#endif
+
+#if WIFI_C_DEFERRED_LOG_ENABLED
+#include "wifi_c_log.h"
+/*Event handlers only store binary record, it's formatted later by log task.*/
+#define WIFI_C_LOG_EVENT(LOG_MACRO, id, args, args_len, ...) wifi_c_log_push(id, args, args_len)
+#else
+#define WIFI_C_LOG_EVENT(LOG_MACRO, id, args, args_len, ...) LOG_MACRO(__VA_ARGS__)
+#endif
+
+#if WIFI_C_EVENT_TRACE_ENABLED
+#include "wifi_c_trace.h"
+#endif
+
+#if WIFI_C_PSK_CACHE_ENABLED
+#include "wifi_c_psk.h"
+#endif
+
+#if WIFI_C_PRIVATE_EVENT_LOOP_ENABLED
+#include "wifi_c_event_loop.h"
+/*Controller handlers run on private loop, driver events are forwarded to it from default loop.*/
+#define WIFI_C_EVENT_REGISTER(base, id, handler, arg, instance) \
+    esp_event_handler_instance_register_with(wifi_c_event_loop_get(), base, id, handler, arg, instance)
+#define WIFI_C_EVENT_UNREGISTER(base, id, instance) \
+    esp_event_handler_instance_unregister_with(wifi_c_event_loop_get(), base, id, instance)
+#define WIFI_C_EVENT_POST(base, id, data, size) \
+    esp_event_post_to(wifi_c_event_loop_get(), base, id, data, size, 0)
+#else
+#define WIFI_C_EVENT_REGISTER(base, id, handler, arg, instance) \
+    esp_event_handler_instance_register(base, id, handler, arg, instance)
+#define WIFI_C_EVENT_UNREGISTER(base, id, instance) \
+    esp_event_handler_instance_unregister(base, id, instance)
+#define WIFI_C_EVENT_POST(base, id, data, size) \
+    esp_event_post(base, id, data, size, 0)
+#endif
+
+/*Span macros compile to nothing when span tracing is disabled.*/
+#include "wifi_c_span.h"
+#define WIFI_C_SPAN_OF_EVENT(base) (((base) == IP_EVENT) ? WIFI_C_SPAN_IP_EVENT : WIFI_C_SPAN_WIFI_EVENT)
+/*Audit macros compile to nothing when heap audit is disabled.*/
+#include "wifi_c_heap.h"
+#define WIFI_C_HEAP_SITE_OF_EVENT(base) (((base) == IP_EVENT) ? WIFI_C_HEAP_SITE_IP_EVENT : WIFI_C_HEAP_SITE_STA_EVENT)
+
+/*Handlers skip driver and netif calls for events of replayed trace - see wifi_c_ctx_trace_replay().*/
+#if WIFI_C_EVENT_TRACE_ENABLED
+#define WIFI_C_REPLAYING(ctx) ((ctx)->replaying)
+#else
+#define WIFI_C_REPLAYING(ctx) false
+#endif
+
+/**
+ * @brief Initialize network interface.
+ */
+static err_c_t wifi_c_init_netif(wifi_c_ctx_t *ctx, wifi_c_mode_t WIFI_C_WIFI_MODE);
+
+#if WIFI_C_AP_ENABLED
+/**
+ * @brief Default event handler for AP mode.
+ */
+static void wifi_c_ap_event_handler(void *arg, esp_event_base_t event_base,
+                                    int32_t event_id, void *event_data);
+#endif
+
+#if WIFI_C_STA_ENABLED
+/**
+ * @brief Default event handler for STA mode.
+ */
+static void wifi_c_sta_event_handler(void *arg, esp_event_base_t event_base,
+                                     int32_t event_id, void *event_data);
+
+/**
+ * @brief Check event group bits of connection status, and return result.
+ */
+static err_c_t wifi_c_check_sta_connection_result(wifi_c_ctx_t *ctx, uint16_t timeout_sec);
+
+/**
+ * @brief State of cached DHCP lease on current connection.
+ */
+typedef enum {
+    WIFI_C_LEASE_NONE = 0,                  // address from DHCP or static, nothing to track
+    WIFI_C_LEASE_APPLIED,                   // cached address set, waiting for link
+    WIFI_C_LEASE_RENEW_PENDING,             // cached address up, renew timer armed
+    WIFI_C_LEASE_RENEWING,                  // DHCP running, timeout timer armed
+    WIFI_C_LEASE_RESTORED,                  // renew timed out, cached address set again
+} wifi_c_lease_state_t;
+
+#define WIFI_C_LEASE_MAGIC              0x4C454153  // "LEAS", marks valid cache after deep sleep
+#endif
+
+#if WIFI_C_APSTA_POLICY_ENABLED
+/**
+ * @brief Find BSSID of SSID for STA connect in AP+STA mode, scanning AP channel first.
+ */
+static err_c_t wifi_c_apsta_locate(wifi_c_ctx_t *ctx, const char *ssid, wifi_ap_record_t *found);
+#endif
+
+/**
+ * @brief Deinit netif interfaces.
+ */
+static void wifi_c_netif_deinit(wifi_c_ctx_t *ctx, wifi_c_mode_t mode);
+
+#if WIFI_C_EVENT_TRACE_ENABLED
+/**
+ * @brief Event handler recording all WiFi and IP events, registered before other handlers.
+ */
+static void wifi_c_trace_event_handler(void *arg, esp_event_base_t event_base,
+                                       int32_t event_id, void *event_data);
+#endif
+
+/**
+ * @brief Default values of wifi_controller status.
+ */
+#define WIFI_C_STATUS_DEFAULT_AP        .ap.ip = "0.0.0.0", .ap.ssid = "none", .ap.connect_handler = NULL,
+#define WIFI_C_STATUS_DEFAULT_STA       .sta.ip = "0.0.0.0", .sta.ssid = "none", .sta.connect_handler = NULL,
+#if !WIFI_C_AP_ENABLED
+#undef WIFI_C_STATUS_DEFAULT_AP
+#define WIFI_C_STATUS_DEFAULT_AP
+#endif
+#if !WIFI_C_STA_ENABLED
+#undef WIFI_C_STATUS_DEFAULT_STA
+#define WIFI_C_STATUS_DEFAULT_STA
+#endif
+#define WIFI_C_STATUS_DEFAULT() {       \
+    .wifi_initialized = false,          \
+    .netif_initialized = false,         \
+    .wifi_mode = WIFI_C_NO_MODE,        \
+    .even_loop_started = false,         \
+    .sta_started = false,               \
+    .ap_started = false,                \
+    .scan_done = false,                 \
+    .sta_connected = false,             \
+    .suspended = false,                 \
+    WIFI_C_STATUS_DEFAULT_AP            \
+    WIFI_C_STATUS_DEFAULT_STA           \
+}
+
+/**
+ * @brief Controller context, owns all state of one wifi_controller instance.
+ */
+struct wifi_c_ctx_obj {
+    wifi_c_status_t status;
+    EventGroupHandle_t event_group;
+#if WIFI_C_STATIC_ALLOC_ENABLED
+    StaticEventGroup_t event_group_buffer;
+#if WIFI_C_SCAN_ENABLED && ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 1, 0)
+    wifi_ap_record_t scan_records[WIFI_C_DEFAULT_SCAN_SIZE]; // driver list is copied here, older drivers have no API to take single record
+#endif
+#endif
+    esp_event_handler_instance_t wifi_event_instance;
+    esp_event_handler_instance_t ip_event_instance;
+#if WIFI_C_EVENT_TRACE_ENABLED
+    esp_event_handler_instance_t trace_wifi_instance;
+    esp_event_handler_instance_t trace_ip_instance;
+    bool replaying;                         // handlers get events of trace, driver must not be touched
+#endif
+#if WIFI_C_AP_ENABLED
+    esp_event_handler_instance_t ap_event_instance;
+    esp_netif_t *netif_handle_ap;           // netif handles, needed for deinitialization
+#endif
+#if WIFI_C_STA_ENABLED
+    wifi_c_link_t sta_link;                 // connection state machine, updates status
+    esp_netif_t *netif_handle_sta;
+    /*Variables needed for static IP and cached lease.*/
+    wifi_c_sta_ip_config_t sta_ip_config;
+    volatile wifi_c_lease_state_t lease_state;
+    esp_timer_handle_t lease_timer;
+    esp_event_handler_instance_t lease_event_instance;
+    char lease_ssid[33];                    // SSID of connection in progress, lease is valid only for it
+    uint32_t lease_conflicts;
+    wifi_c_sta_link_profile_t sta_link_profile;
+    wifi_c_state_handler_t state_handler;   // called from event loop task when state is reached
+    void *state_handler_arg;
+    bool sta_11kv;                          // announce 802.11k/v support when associating
+#if WIFI_C_PSK_CACHE_ENABLED
+    bool psk_used;                          // STA config has cached PSK instead of passphrase
+#endif
+    /*Association cached by wifi_c_ctx_suspend().*/
+    wifi_config_t resume_config;            // STA config before suspend, restored after first disconnect on resumed link
+    uint8_t resume_bssid[6];
+    uint8_t resume_channel;
+    bool resume_connect;                    // STA was connected before suspend
+    bool resume_pinned;                     // STA locked to cached BSSID by resume
+#endif
+    bool resume_ap;                         // AP was started before suspend
+    wifi_c_resume_stats_t resume_stats;
+#if WIFI_C_SCAN_ENABLED
+    /*Variables needed for scan.*/
+    wifi_ap_record_t ap_info[WIFI_C_DEFAULT_SCAN_SIZE];
+    wifi_c_scan_result_t scan_info;
+#endif
+#if WIFI_C_APSTA_POLICY_ENABLED
+    wifi_c_apsta_policy_t apsta_policy;
+    wifi_c_apsta_stats_t apsta_stats;
+    volatile bool apsta_connecting;         // STA (re)connect in progress while AP runs, AP clients leaving are counted
+#endif
+};
+
+/**
+ * @brief Instance used by functions without context argument.
+ */
+static wifi_c_ctx_t wifi_c_default_ctx = {
+    .status = WIFI_C_STATUS_DEFAULT(),
+#if WIFI_C_STA_ENABLED
+    .sta_link = {
+        .status = &wifi_c_default_ctx.status,
+        .ssid = wifi_c_default_ctx.lease_ssid,
+        .retry_count = WIFI_C_STA_RETRY_COUNT,
+    },
+    .sta_ip_config = WIFI_C_STA_IP_CONFIG_DEFAULT(),
+    .sta_link_profile = WIFI_C_STA_LINK_PROFILE_DEFAULT(),
+#endif
+#if WIFI_C_APSTA_POLICY_ENABLED
+    .apsta_policy = WIFI_C_APSTA_POLICY_DEFAULT(),
+#endif
+};
+
+/**
+ * @brief Default event loop was created by controller, not by application or other component.
+ */
+static bool wifi_c_default_loop_owned = false;
+
+/**
+ * @brief Driver, tasks and interfaces shared by contexts.
+ *
+ * Driver is set up by first initialized context and torn down by last one, worker, deferred log and default
+ * event loop are stopped when last context with handlers is deinitialized. Every interface is owned by one
+ * context, only it gets events of the interface. Scans need STA, so SCAN_DONE goes to STA owner.
+ */
+static struct {
+    uint8_t users;                          // contexts with registered handlers
+    uint8_t driver_users;                   // initialized contexts
+    wifi_c_ctx_t *sta_owner;
+    wifi_c_ctx_t *ap_owner;
+    portMUX_TYPE lock;
+} wifi_c_shared = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+/**
+ * @brief Make context owner of interfaces of mode and release the ones it owns outside of it.
+ *
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_IFACE_BUSY if interface of mode is owned by other context, nothing is changed then
+ */
+static err_c_t wifi_c_shared_claim(wifi_c_ctx_t *ctx, wifi_c_mode_t mode)
+{
+    bool sta = (mode == WIFI_C_MODE_STA || mode == WIFI_C_MODE_APSTA);
+    bool ap = (mode == WIFI_C_MODE_AP || mode == WIFI_C_MODE_APSTA);
+    err_c_t err = ERR_C_OK;
+
+    portENTER_CRITICAL(&wifi_c_shared.lock);
+    if ((sta && wifi_c_shared.sta_owner != NULL && wifi_c_shared.sta_owner != ctx) ||
+        (ap && wifi_c_shared.ap_owner != NULL && wifi_c_shared.ap_owner != ctx))
+    {
+        err = WIFI_C_ERR_IFACE_BUSY;
+    }
+    else
+    {
+        if (sta || wifi_c_shared.sta_owner == ctx)
+        {
+            wifi_c_shared.sta_owner = sta ? ctx : NULL;
+        }
+        if (ap || wifi_c_shared.ap_owner == ctx)
+        {
+            wifi_c_shared.ap_owner = ap ? ctx : NULL;
+        }
+    }
+    portEXIT_CRITICAL(&wifi_c_shared.lock);
+
+    if (err != ERR_C_OK)
+    {
+        LOG_ERROR("Interface of mode %d is owned by other context.", mode);
+    }
+    return err;
+}
+
+/**
+ * @brief Driver mode with interfaces of all contexts.
+ */
+static wifi_mode_t wifi_c_shared_driver_mode(void)
+{
+    bool sta = (wifi_c_shared.sta_owner != NULL);
+    bool ap = (wifi_c_shared.ap_owner != NULL);
+
+    return (sta && ap) ? WIFI_MODE_APSTA : (sta ? WIFI_MODE_STA : (ap ? WIFI_MODE_AP : WIFI_MODE_NULL));
+}
+
+#if WIFI_C_STA_ENABLED
+/**
+ * @brief Last DHCP lease, kept in RTC memory to survive deep sleep.
+ */
+static RTC_DATA_ATTR struct {
+    uint32_t magic;
+    char ssid[33];
+    esp_netif_ip_info_t ip_info;
+    esp_ip4_addr_t dns;
+} wifi_c_lease_cache;
+
+static bool wifi_c_lease_valid_for(const char *ssid)
+{
+    return wifi_c_lease_cache.magic == WIFI_C_LEASE_MAGIC &&
+           strncmp(wifi_c_lease_cache.ssid, ssid, sizeof(wifi_c_lease_cache.ssid)) == 0;
+}
+
+/**
+ * @brief Stop DHCP client and set fixed address, DNS is left untouched when zero.
+ */
+static esp_err_t wifi_c_sta_set_fixed_ip(wifi_c_ctx_t *ctx, const esp_netif_ip_info_t *ip_info, const esp_ip4_addr_t *dns)
+{
+    esp_netif_dns_info_t dns_info;
+    esp_err_t err = esp_netif_dhcpc_stop(ctx->netif_handle_sta);
+
+    if (err != ESP_OK && err != ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED)
+    {
+        return err;
+    }
+    err = esp_netif_set_ip_info(ctx->netif_handle_sta, ip_info);
+    if (err != ESP_OK || dns->addr == 0)
+    {
+        return err;
+    }
+    memutil_zero_memory(&dns_info, sizeof(dns_info));
+    dns_info.ip.u_addr.ip4.addr = dns->addr;
+    dns_info.ip.type = ESP_IPADDR_TYPE_V4;
+    return esp_netif_set_dns_info(ctx->netif_handle_sta, ESP_NETIF_DNS_MAIN, &dns_info);
+}
+
+/*Lease timer expiry is handled on event loop task, so lease state and DHCP client are changed only next to handlers.*/
+ESP_EVENT_DEFINE_BASE(WIFI_C_LEASE_EVENT);
+#define WIFI_C_LEASE_EVENT_TIMER        0           // data is pointer to context of timer
+
+/**
+ * @brief Renew timer, first expiry starts DHCP, second one means DHCP didn't answer in time.
+ *
+ * @note Runs in esp_timer task, only posts expiry to event loop.
+ */
+static void wifi_c_lease_timer_cb(void *arg)
+{
+    wifi_c_ctx_t *ctx = (wifi_c_ctx_t *)arg;
+
+    if (WIFI_C_EVENT_POST(WIFI_C_LEASE_EVENT, WIFI_C_LEASE_EVENT_TIMER, &ctx, sizeof(ctx)) != ESP_OK)
+    {
+        LOG_WARN("Event queue full, lease timer expiry lost.");
+    }
+}
+
+/**
+ * @brief Handle lease timer expiry, runs on event loop task like other handlers of context.
+ *
+ * @note Expiry posted before timer was stopped finds state already moved on and does nothing.
+ */
+static void wifi_c_lease_event_handler(void *arg, esp_event_base_t event_base,
+                                       int32_t event_id, void *event_data)
+{
+    wifi_c_ctx_t *ctx = (wifi_c_ctx_t *)arg;
+
+    if (event_id != WIFI_C_LEASE_EVENT_TIMER || *(wifi_c_ctx_t **)event_data != ctx)
+    {
+        return; // timer of other context
+    }
+
+    if (ctx->lease_state == WIFI_C_LEASE_RENEW_PENDING)
+    {
+        ctx->lease_state = WIFI_C_LEASE_RENEWING;
+        LOG_DEBUG("Renewing cached lease " IPSTR ".", IP2STR(&wifi_c_lease_cache.ip_info.ip));
+        if (esp_netif_dhcpc_start(ctx->netif_handle_sta) == ESP_OK)
+        {
+            esp_timer_start_once(ctx->lease_timer, (uint64_t)WIFI_C_LEASE_RENEW_TIMEOUT_MS * 1000);
+            return;
+        }
+    }
+
+    if (ctx->lease_state == WIFI_C_LEASE_RENEWING)
+    {
+        LOG_WARN("DHCP renew failed, restoring cached address " IPSTR ".", IP2STR(&wifi_c_lease_cache.ip_info.ip));
+        ctx->lease_state = WIFI_C_LEASE_RESTORED;
+        if (wifi_c_sta_set_fixed_ip(ctx, &wifi_c_lease_cache.ip_info, &wifi_c_lease_cache.dns) != ESP_OK)
+        {
+            ctx->lease_state = WIFI_C_LEASE_NONE;
+        }
+    }
+}
+
+/**
+ * @brief Create renew timer of cached lease, if it doesn't exist yet.
+ */
+static esp_err_t wifi_c_lease_timer_create(wifi_c_ctx_t *ctx)
+{
+    esp_timer_create_args_t timer_args = {
+        .callback = wifi_c_lease_timer_cb,
+        .arg = ctx,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "wifi_c_lease",
+    };
+    esp_err_t err = ESP_OK;
+
+    if (ctx->lease_timer == NULL)
+    {
+        err = esp_timer_create(&timer_args, &ctx->lease_timer);
+        if (err != ESP_OK)
+        {
+            ctx->lease_timer = NULL;
+        }
+    }
+    return err;
+}
+
+/**
+ * @brief Set address according to IP config, called before every connect.
+ */
+static esp_err_t wifi_c_sta_apply_ip_config(wifi_c_ctx_t *ctx, const char *ssid)
+{
+    esp_err_t err = ESP_OK;
+
+    if (ctx->lease_timer != NULL)
+    {
+        esp_timer_stop(ctx->lease_timer);
+    }
+    ctx->lease_state = WIFI_C_LEASE_NONE;
+    memutil_zero_memory(ctx->lease_ssid, sizeof(ctx->lease_ssid));
+    strncpy(ctx->lease_ssid, ssid, sizeof(ctx->lease_ssid) - 1);
+
+    switch (ctx->sta_ip_config.mode)
+    {
+    case WIFI_C_STA_IP_STATIC:
+        LOG_DEBUG("Using static IP " IPSTR ".", IP2STR(&ctx->sta_ip_config.ip_info.ip));
+        return wifi_c_sta_set_fixed_ip(ctx, &ctx->sta_ip_config.ip_info, &ctx->sta_ip_config.dns);
+    case WIFI_C_STA_IP_REUSE_LEASE:
+        if (wifi_c_lease_timer_create(ctx) != ESP_OK)
+        {
+            LOG_WARN("Lease renew timer could not be created, using DHCP.");
+        }
+        else if (wifi_c_lease_valid_for(ssid))
+        {
+            LOG_DEBUG("Reusing cached lease " IPSTR ".", IP2STR(&wifi_c_lease_cache.ip_info.ip));
+            err = wifi_c_sta_set_fixed_ip(ctx, &wifi_c_lease_cache.ip_info, &wifi_c_lease_cache.dns);
+            if (err == ESP_OK)
+            {
+                ctx->lease_state = WIFI_C_LEASE_APPLIED;
+            }
+            return err;
+        }
+        // fall through
+    default:
+        err = esp_netif_dhcpc_start(ctx->netif_handle_sta);
+        return (err == ESP_ERR_ESP_NETIF_DHCP_ALREADY_STARTED) ? ESP_OK : err;
+    }
+}
+
+/**
+ * @brief Track cached lease when STA got IP, store leases given by DHCP.
+ *
+ * @return true if address is new to application, false after renew confirmed the cached one.
+ */
+static bool wifi_c_lease_on_got_ip(wifi_c_ctx_t *ctx, const ip_event_got_ip_t *event)
+{
+    esp_netif_dns_info_t dns_info;
+    bool new_address = true;
+
+    if (ctx->sta_ip_config.mode != WIFI_C_STA_IP_REUSE_LEASE)
+    {
+        return true;
+    }
+
+    switch (ctx->lease_state)
+    {
+    case WIFI_C_LEASE_APPLIED:
+        // cached address is up, let DHCP confirm it in background
+        ctx->lease_state = WIFI_C_LEASE_NONE;
+        if (ctx->sta_ip_config.renew_delay_ms != 0)
+        {
+            ctx->lease_state = WIFI_C_LEASE_RENEW_PENDING;
+            esp_timer_start_once(ctx->lease_timer, (uint64_t)ctx->sta_ip_config.renew_delay_ms * 1000);
+        }
+        return true;
+    case WIFI_C_LEASE_RESTORED:
+        ctx->lease_state = WIFI_C_LEASE_NONE;
+        return false;
+    case WIFI_C_LEASE_RENEWING:
+        esp_timer_stop(ctx->lease_timer);
+        if (event->ip_info.ip.addr != wifi_c_lease_cache.ip_info.ip.addr)
+        {
+            ctx->lease_conflicts++;
+            WIFI_C_LOG_EVENT(LOG_WARN, WIFI_C_LOG_STA_LEASE_CONFLICT,
+                             ((uint32_t[]){wifi_c_lease_cache.ip_info.ip.addr, event->ip_info.ip.addr}), 8,
+                             "Cached address " IPSTR " replaced by " IPSTR " after renew.",
+                             IP2STR(&wifi_c_lease_cache.ip_info.ip), IP2STR(&event->ip_info.ip));
+        }
+        else
+        {
+            new_address = false;
+        }
+        break;
+    default:
+        break;
+    }
+    ctx->lease_state = WIFI_C_LEASE_NONE;
+
+    wifi_c_lease_cache.magic = WIFI_C_LEASE_MAGIC;
+    memcpy(wifi_c_lease_cache.ssid, ctx->lease_ssid, sizeof(wifi_c_lease_cache.ssid));
+    memcpy(&wifi_c_lease_cache.ip_info, &event->ip_info, sizeof(esp_netif_ip_info_t));
+    wifi_c_lease_cache.dns.addr = 0;
+    if (esp_netif_get_dns_info(ctx->netif_handle_sta, ESP_NETIF_DNS_MAIN, &dns_info) == ESP_OK &&
+        dns_info.ip.type == ESP_IPADDR_TYPE_V4)
+    {
+        wifi_c_lease_cache.dns.addr = dns_info.ip.u_addr.ip4.addr;
+    }
+    return new_address;
+}
+#endif
+
+#if WIFI_C_AP_ENABLED
+static void wifi_c_ap_event_handler(void *arg, esp_event_base_t event_base,
+                                    int32_t event_id, void *event_data)
+{
+    WIFI_C_SPAN_EVENT_BEGIN(WIFI_C_SPAN_WIFI_EVENT, event_id);
+    WIFI_C_HEAP_AUDIT_ENTER(WIFI_C_HEAP_SITE_AP_EVENT);
+    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_AP_STACONNECTED)
+    {
+        wifi_event_ap_staconnected_t *event = (wifi_event_ap_staconnected_t *)event_data;
+        WIFI_C_METRIC(wifi_c_metrics_ap_station(true));
+        WIFI_C_LOG_EVENT(LOG_INFO, WIFI_C_LOG_AP_STA_JOINED, event, sizeof(event->mac) + 1,
+                         "Station " MACSTR " joined, AID=%d", MAC2STR(event->mac), event->aid);
+    }
+    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_AP_STADISCONNECTED)
+    {
+        wifi_event_ap_stadisconnected_t *event = (wifi_event_ap_stadisconnected_t *)event_data;
+        WIFI_C_METRIC(wifi_c_metrics_ap_station(false));
+#if WIFI_C_APSTA_POLICY_ENABLED
+        if (((wifi_c_ctx_t *)arg)->apsta_connecting)
+        {
+            ((wifi_c_ctx_t *)arg)->apsta_stats.clients_dropped++;
+        }
+#endif
+        WIFI_C_LOG_EVENT(LOG_INFO, WIFI_C_LOG_AP_STA_LEFT, event, sizeof(event->mac) + 1,
+                         "Station " MACSTR " left, AID=%d", MAC2STR(event->mac), event->aid);
+    }
+    WIFI_C_HEAP_AUDIT_EXIT();
+    WIFI_C_SPAN_EVENT_END(WIFI_C_SPAN_WIFI_EVENT, event_id);
+}
+#endif
+
+#if WIFI_C_STA_ENABLED
+/**
+ * @brief Tell registered state handler that state was reached, its bit must be already set.
+ */
+static void wifi_c_notify_state(wifi_c_ctx_t *ctx, wifi_c_state_t state)
+{
+    wifi_c_state_handler_t handler = ctx->state_handler;
+
+    if (handler != NULL)
+    {
+        handler(state, ctx->state_handler_arg);
+    }
+}
+
+/**
+ * @brief Apply event bits of link step and tell state handler about reached state.
+ */
+static void wifi_c_apply_link_step(wifi_c_ctx_t *ctx, const wifi_c_link_step_t *step)
+{
+    if (step->clear_bits != 0)
+    {
+        xEventGroupClearBits(ctx->event_group, step->clear_bits);
+    }
+    if (step->set_bits != 0)
+    {
+        xEventGroupSetBits(ctx->event_group, step->set_bits);
+        wifi_c_notify_state(ctx, (wifi_c_state_t)step->set_bits);
+    }
+}
+
+static void wifi_c_sta_event_handler(void *arg, esp_event_base_t event_base,
+                                     int32_t event_id, void *event_data)
+{
+    wifi_c_ctx_t *ctx = (wifi_c_ctx_t *)arg;
+    wifi_c_link_step_t step;
+
+    WIFI_C_SPAN_EVENT_BEGIN(WIFI_C_SPAN_OF_EVENT(event_base), event_id);
+    WIFI_C_HEAP_AUDIT_ENTER(WIFI_C_HEAP_SITE_OF_EVENT(event_base));
+    /*Link updates status and retry count, here are only side effects of its step.*/
+    step = wifi_c_link_on_event(&ctx->sta_link, event_base, event_id, event_data);
+    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START)
+    {
+        WIFI_C_LOG_EVENT(LOG_INFO, WIFI_C_LOG_STA_STARTED, NULL, 0, "Station started, connecting to WiFi.");
+        wifi_c_apply_link_step(ctx, &step);
+    }
+    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_STOP)
+    {
+        wifi_c_apply_link_step(ctx, &step);
+    }
+    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED)
+    {
+        WIFI_C_SPAN_ASYNC_END(WIFI_C_SPAN_CONNECT);
+        WIFI_C_SPAN_ASYNC_BEGIN(WIFI_C_SPAN_DHCP);
+        wifi_c_apply_link_step(ctx, &step);
+    }
+    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED)
+    {
+        wifi_event_sta_disconnected_t *event = (wifi_event_sta_disconnected_t *)event_data;
+        WIFI_C_METRIC(wifi_c_metrics_disconnect(event->reason));
+#if WIFI_C_SPAN_TRACE_ENABLED
+        /*Close only the phase which was still running.*/
+        EventBits_t bits = xEventGroupGetBits(ctx->event_group);
+        if (!(bits & WIFI_C_STA_LINK_UP_BIT))
+        {
+            WIFI_C_SPAN_ASYNC_END(WIFI_C_SPAN_CONNECT);
+        }
+        else if (!(bits & WIFI_C_CONNECTED_BIT))
+        {
+            WIFI_C_SPAN_ASYNC_END(WIFI_C_SPAN_DHCP);
+        }
+#endif
+        xEventGroupClearBits(ctx->event_group, step.clear_bits);
+        if (ctx->lease_timer != NULL && !WIFI_C_REPLAYING(ctx))
+        {
+            esp_timer_stop(ctx->lease_timer); // renew of lost link is pointless, DHCP runs again on reconnect
+        }
+        if (ctx->lease_state != WIFI_C_LEASE_APPLIED)
+        {
+            ctx->lease_state = WIFI_C_LEASE_NONE;
+        }
+        if (ctx->status.suspended)
+        {
+            WIFI_C_HEAP_AUDIT_EXIT();
+            WIFI_C_SPAN_EVENT_END(WIFI_C_SPAN_OF_EVENT(event_base), event_id);
+            return; // radio stopped by wifi_c_ctx_suspend(), nothing to reconnect
+        }
+        if (ctx->resume_pinned)
+        {
+            /*Cached BSSID was only for fast resume, reconnects may pick any AP of SSID again.*/
+            ctx->resume_pinned = false;
+            if (!WIFI_C_REPLAYING(ctx))
+            {
+                esp_wifi_set_config(WIFI_IF_STA, &ctx->resume_config);
+            }
+        }
+        if (step.reconnect)
+        {
+            WIFI_C_METRIC(wifi_c_metrics_connect_attempt());
+#if WIFI_C_APSTA_POLICY_ENABLED
+            if (ctx->status.wifi_mode == WIFI_C_MODE_APSTA && ctx->status.ap_started)
+            {
+                ctx->apsta_stats.reconnects++;
+                ctx->apsta_connecting = true;
+            }
+#endif
+            WIFI_C_SPAN_ASYNC_BEGIN(WIFI_C_SPAN_CONNECT);
+            if (!WIFI_C_REPLAYING(ctx))
+            {
+                esp_wifi_connect();
+            }
+            WIFI_C_LOG_EVENT(LOG_WARN, WIFI_C_LOG_STA_RETRY, ((uint8_t[]){ctx->sta_link.retry_num, event->reason}), 2,
+                             "Failed to connect to AP, trying again.");
+        }
+        else
+        {
+            WIFI_C_LOG_EVENT(LOG_ERROR, WIFI_C_LOG_STA_CONNECT_FAIL, ((uint8_t[]){ctx->sta_link.retry_num, event->reason}), 2,
+                             "Failed to connect to AP, reason: %u.", event->reason);
+            WIFI_C_METRIC(wifi_c_metrics_connect_failed());
+#if WIFI_C_APSTA_POLICY_ENABLED
+            ctx->apsta_connecting = false;
+#endif
+#if WIFI_C_PSK_CACHE_ENABLED
+            if (ctx->psk_used && !WIFI_C_REPLAYING(ctx))
+            {
+                /*AP may need WPA3-SAE, next connect passes passphrase instead of PSK.*/
+                wifi_c_psk_use_passphrase(ctx->lease_ssid);
+            }
+#endif
+            xEventGroupSetBits(ctx->event_group, step.set_bits);
+            wifi_c_notify_state(ctx, WIFI_C_STATE_STA_CONNECT_FAILED);
+        }
+    }
+    else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP)
+    {
+        ip_event_got_ip_t *event = (ip_event_got_ip_t *)event_data;
+        bool new_address = WIFI_C_REPLAYING(ctx) || wifi_c_lease_on_got_ip(ctx, event);
+        WIFI_C_SPAN_ASYNC_END(WIFI_C_SPAN_DHCP);
+        WIFI_C_LOG_EVENT(LOG_INFO, WIFI_C_LOG_STA_GOT_IP, &event->ip_info.ip, sizeof(event->ip_info.ip),
+                         "Got IP:" IPSTR, IP2STR(&event->ip_info.ip));
+        /*Link has set IP and SSID of status, also of connects which didn't wait for result, e.g. wifi_c_ctx_start_sta_async(),
+        and gave back whole retry budget, also after resume used it up on cached BSSID.*/
+#if WIFI_C_APSTA_POLICY_ENABLED
+        ctx->apsta_connecting = false;
+#endif
+        wifi_c_apply_link_step(ctx, &step);
+        if (new_address)
+        {
+            WIFI_C_METRIC(wifi_c_metrics_got_ip());
+            wifi_c_worker_dispatch(ctx->status.sta.connect_handler);
+        }
+    }
+#if WIFI_C_SCAN_ENABLED
+    else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_SCAN_DONE)
+    {
+        WIFI_C_LOG_EVENT(LOG_INFO, WIFI_C_LOG_SCAN_DONE, &ctx->scan_info.ap_count, sizeof(ctx->scan_info.ap_count),
+                         "Total APs scanned: %u", ctx->scan_info.ap_count);
+        wifi_c_apply_link_step(ctx, &step);
+    }
+#endif
+    WIFI_C_HEAP_AUDIT_EXIT();
+    WIFI_C_SPAN_EVENT_END(WIFI_C_SPAN_OF_EVENT(event_base), event_id);
+}
+
+static err_c_t wifi_c_check_sta_connection_result(wifi_c_ctx_t *ctx, uint16_t timeout_sec)
+{
+    /*Wait for sta to finish connecting or timeout*/
+    EventBits_t bits = xEventGroupWaitBits(ctx->event_group, WIFI_C_CONNECTED_BIT | WIFI_C_CONNECT_FAIL_BIT, pdFALSE, pdFALSE, pdMS_TO_TICKS(timeout_sec * 1000));
+
+    /*Other bits, e.g. WIFI_C_SCAN_DONE_BIT, can be set too, check only the ones that matter.*/
+    if (bits & WIFI_C_CONNECTED_BIT)
+    {
+        LOG_DEBUG("WIFI_C_CONNECTED_BIT is set!");
+        return 0;
+    }
+    if (bits & WIFI_C_CONNECT_FAIL_BIT)
+    {
+        LOG_DEBUG("WIFI_C_CONNECT_FAIL_BIT is set!");
+        return WIFI_C_ERR_STA_CONNECT_FAIL;
+    }
+    if (bits & WIFI_C_STA_STARTED_BIT)
+    {
+        LOG_DEBUG("WIFI_C_STA_STARTED_BIT is set, but timeout expired, connection failed");
+        return WIFI_C_ERR_STA_TIMEOUT_EXPIRE;
+    }
+    LOG_DEBUG("WIFI_C_STA_STARTED_BIT not set");
+    return WIFI_C_ERR_STA_NOT_STARTED;
+}
+#endif
+
+#if WIFI_C_EVENT_TRACE_ENABLED
+static void wifi_c_trace_event_handler(void *arg, esp_event_base_t event_base,
+                                       int32_t event_id, void *event_data)
+{
+    wifi_c_trace_record((event_base == IP_EVENT) ? WIFI_C_TRACE_BASE_IP : WIFI_C_TRACE_BASE_WIFI, event_id, event_data);
+}
+#endif
+
+/**
+ * @brief Check if event belongs to interface owned by context, handlers of all contexts get every event.
+ */
+static bool wifi_c_ctx_owns_event(wifi_c_ctx_t *ctx, esp_event_base_t event_base, int32_t event_id)
+{
+    if (event_base == IP_EVENT)
+    {
+        return ctx == wifi_c_shared.sta_owner; // only STA events of IP_EVENT are registered
+    }
+    switch (event_id)
+    {
+    case WIFI_EVENT_AP_START:
+    case WIFI_EVENT_AP_STOP:
+    case WIFI_EVENT_AP_STACONNECTED:
+    case WIFI_EVENT_AP_STADISCONNECTED:
+    case WIFI_EVENT_AP_PROBEREQRECVED:
+        return ctx == wifi_c_shared.ap_owner;
+    default:
+        return ctx == wifi_c_shared.sta_owner;
+    }
+}
+
+#if WIFI_C_AP_ENABLED
+/**
+ * @brief Registered in place of AP handler, replay calls handler directly.
+ */
+static void wifi_c_ap_event_filter(void *arg, esp_event_base_t event_base,
+                                   int32_t event_id, void *event_data)
+{
+    if (wifi_c_ctx_owns_event((wifi_c_ctx_t *)arg, event_base, event_id))
+    {
+        wifi_c_ap_event_handler(arg, event_base, event_id, event_data);
+    }
+}
+#endif
+
+#if WIFI_C_STA_ENABLED
+/**
+ * @brief Registered in place of STA handler, replay calls handler directly.
+ */
+static void wifi_c_sta_event_filter(void *arg, esp_event_base_t event_base,
+                                    int32_t event_id, void *event_data)
+{
+    if (wifi_c_ctx_owns_event((wifi_c_ctx_t *)arg, event_base, event_id))
+    {
+        wifi_c_sta_event_handler(arg, event_base, event_id, event_data);
+    }
+}
+#endif
+
+static err_c_t wifi_c_init_netif(wifi_c_ctx_t *ctx, wifi_c_mode_t WIFI_C_WIFI_MODE)
+{
+    volatile err_c_t err = ERR_C_OK;
+
+    switch (WIFI_C_WIFI_MODE)
+    {
+#if WIFI_C_AP_ENABLED
+    case WIFI_C_MODE_AP:
+        ctx->netif_handle_ap = esp_netif_create_default_wifi_ap();
+        assert(ctx->netif_handle_ap);
+        ctx->status.wifi_mode = WIFI_C_MODE_AP;
+        LOG_DEBUG("netif initialized as AP");
+        break;
+#endif
+#if WIFI_C_STA_ENABLED
+    case WIFI_C_MODE_STA:
+        ctx->netif_handle_sta = esp_netif_create_default_wifi_sta();
+        assert(ctx->netif_handle_sta);
+        ctx->status.wifi_mode = WIFI_C_MODE_STA;
+        LOG_DEBUG("netif initialized as STA");
+        break;
+#endif
+#if WIFI_C_AP_ENABLED && WIFI_C_STA_ENABLED
+    case WIFI_C_MODE_APSTA:
+        ctx->netif_handle_ap = esp_netif_create_default_wifi_ap();
+        assert(ctx->netif_handle_ap);
+
+        ctx->netif_handle_sta = esp_netif_create_default_wifi_sta();
+        assert(ctx->netif_handle_sta);
+
+        ctx->status.wifi_mode = WIFI_C_MODE_APSTA;
+        LOG_DEBUG("netif initialized as AP+STA");
+        break;
+#endif
+    default:
+        LOG_ERROR("wifi_c_init_netif: Wrong wifi mode.");
+        err = WIFI_C_ERR_NETIF_INIT_FAILED;
+        break;
+    }
+
+    ctx->status.netif_initialized = true;
+    return err;
+}
+
+static wifi_mode_t wifi_c_select_wifi_mode(wifi_c_mode_t WIFI_C_WIFI_MODE)
+{
+    switch (WIFI_C_WIFI_MODE)
+    {
+#if WIFI_C_AP_ENABLED
+    case WIFI_C_MODE_AP:
+        return WIFI_MODE_AP;
+        break;
+#endif
+#if WIFI_C_STA_ENABLED
+    case WIFI_C_MODE_STA:
+        return WIFI_MODE_STA;
+        break;
+#endif
+#if WIFI_C_AP_ENABLED && WIFI_C_STA_ENABLED
+    case WIFI_C_MODE_APSTA:
+        return WIFI_MODE_APSTA;
+        break;
+#endif
+    default:
+        return WIFI_MODE_NULL;
+        break;
+    }
+}
+
+int wifi_c_ctx_create_default_event_loop(wifi_c_ctx_t *ctx)
+{
+    volatile err_c_t err = ERR_C_OK;
+
+    /*Context holds one reference of shared state and private loop and one set of handlers, wifi_c_deinit() drops them once.*/
+    if (ctx->status.even_loop_started)
+    {
+        LOG_DEBUG("Event loop of context already created.");
+        return ERR_C_OK;
+    }
+
+    Try
+    {
+        err = esp_event_loop_create_default();
+        if (err == ESP_ERR_INVALID_STATE)
+        {
+            err = ERR_C_OK; // default event loop was already created, by application or other context
+        }
+        else if (err == ESP_OK)
+        {
+            wifi_c_default_loop_owned = true;
+        }
+        ERR_C_CHECK_AND_THROW_ERR(err);
+#if WIFI_C_PRIVATE_EVENT_LOOP_ENABLED
+        ERR_C_CHECK_AND_THROW_ERR(wifi_c_event_loop_start()); // driver still posts to default loop
+#endif
+
+#if WIFI_C_EVENT_TRACE_ENABLED
+        if (ctx == &wifi_c_default_ctx) // trace buffer is shared, other contexts would record same events twice
+        {
+            ESP_ERROR_CHECK(esp_event_handler_instance_register(WIFI_EVENT,
+                                                                ESP_EVENT_ANY_ID,
+                                                                &wifi_c_trace_event_handler,
+                                                                NULL,
+                                                                &ctx->trace_wifi_instance));
+
+            ESP_ERROR_CHECK(esp_event_handler_instance_register(IP_EVENT,
+                                                                ESP_EVENT_ANY_ID,
+                                                                &wifi_c_trace_event_handler,
+                                                                NULL,
+                                                                &ctx->trace_ip_instance));
+        }
+#endif
+
+#if WIFI_C_AP_ENABLED
+        ESP_ERROR_CHECK(WIFI_C_EVENT_REGISTER(WIFI_EVENT,
+                                              ESP_EVENT_ANY_ID,
+                                              &wifi_c_ap_event_filter,
+                                              ctx,
+                                              &ctx->ap_event_instance));
+#endif
+
+#if WIFI_C_STA_ENABLED
+        ESP_ERROR_CHECK(WIFI_C_EVENT_REGISTER(WIFI_EVENT,
+                                              ESP_EVENT_ANY_ID,
+                                              &wifi_c_sta_event_filter,
+                                              ctx,
+                                              &ctx->wifi_event_instance));
+
+        ESP_ERROR_CHECK(WIFI_C_EVENT_REGISTER(IP_EVENT,
+                                              IP_EVENT_STA_GOT_IP,
+                                              &wifi_c_sta_event_filter,
+                                              ctx,
+                                              &ctx->ip_event_instance));
+
+        ESP_ERROR_CHECK(WIFI_C_EVENT_REGISTER(WIFI_C_LEASE_EVENT,
+                                              ESP_EVENT_ANY_ID,
+                                              &wifi_c_lease_event_handler,
+                                              ctx,
+                                              &ctx->lease_event_instance));
+#endif
+
+        portENTER_CRITICAL(&wifi_c_shared.lock);
+        wifi_c_shared.users++;
+        portEXIT_CRITICAL(&wifi_c_shared.lock);
+        ctx->status.even_loop_started = true;
+    }
+    Catch(err)
+    {
+        LOG_ERROR("Error when creating default event loop: %d", err);
+    }
+    return err;
+}
+
+#if WIFI_C_STA_ENABLED
+int wifi_c_ctx_sta_register_connect_handler(wifi_c_ctx_t *ctx, void (*connect_handler)(void))
+{
+    err_c_t err = 0;
+    ERR_C_CHECK_NULL_PTR(connect_handler, LOG_ERROR("connect handler function cannot be NULL"));
+
+    ctx->status.sta.connect_handler = connect_handler;
+    LOG_INFO("connect handler function of wifi controller changed!");
+    return err;
+}
+
+int wifi_c_ctx_wait_for(wifi_c_ctx_t *ctx, wifi_c_state_t state, uint32_t timeout_ms)
+{
+    EventGroupHandle_t event_group = ctx->event_group;
+    EventBits_t bits = 0;
+
+    if (event_group == NULL)
+    {
+        LOG_ERROR("WiFi was not initialized.");
+        return WIFI_C_ERR_WIFI_NOT_INIT;
+    }
+
+    /*Event group wakes all waiting tasks when bits are set, and bits set before call are seen at once.*/
+    bits = xEventGroupWaitBits(event_group, (EventBits_t)state, pdFALSE, pdTRUE,
+                               (timeout_ms == WIFI_C_WAIT_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms));
+    if ((bits & (EventBits_t)state) != (EventBits_t)state)
+    {
+        return WIFI_C_ERR_WAIT_TIMEOUT;
+    }
+    return ERR_C_OK;
+}
+
+int wifi_c_ctx_register_state_handler(wifi_c_ctx_t *ctx, wifi_c_state_handler_t handler, void *arg)
+{
+    /*Handler is cleared first, so event loop never calls new handler with old argument.*/
+    ctx->state_handler = NULL;
+    ctx->state_handler_arg = arg;
+    ctx->state_handler = handler;
+    LOG_DEBUG("state handler of wifi controller changed.");
+    return ERR_C_OK;
+}
+
+int wifi_c_ctx_sta_set_ip_config(wifi_c_ctx_t *ctx, const wifi_c_sta_ip_config_t *config)
+{
+    wifi_c_sta_ip_config_t default_config = WIFI_C_STA_IP_CONFIG_DEFAULT();
+
+    if (config == NULL)
+    {
+        config = &default_config;
+    }
+
+    if (config->mode > WIFI_C_STA_IP_REUSE_LEASE)
+    {
+        LOG_ERROR("Unknown STA IP mode: %d", config->mode);
+        return WIFI_C_ERR_IP_CONFIG_INVALID;
+    }
+
+    if (config->mode == WIFI_C_STA_IP_STATIC && (config->ip_info.ip.addr == 0 || config->ip_info.netmask.addr == 0))
+    {
+        LOG_ERROR("Static IP address and netmask cannot be zero.");
+        return WIFI_C_ERR_IP_CONFIG_INVALID;
+    }
+
+    memcpy(&ctx->sta_ip_config, config, sizeof(wifi_c_sta_ip_config_t));
+    LOG_INFO("STA IP config changed, used from next connect.");
+    return ERR_C_OK;
+}
+
+/**
+ * @brief Apply link profile to driver, all settings or none, called before every connect.
+ *
+ * @param config STA config to fill with association settings of profile, NULL to apply only radio settings.
+ */
+static esp_err_t wifi_c_sta_apply_link_profile(wifi_c_ctx_t *ctx, wifi_config_t *config)
+{
+    const wifi_c_sta_link_profile_t *profile = &ctx->sta_link_profile;
+    esp_err_t err = ESP_OK;
+    uint8_t old_protocol = 0;
+    wifi_bandwidth_t old_bandwidth = 0;
+    int8_t old_tx_power = 0;
+
+    if (config != NULL)
+    {
+        config->sta.listen_interval = profile->listen_interval;
+        config->sta.sort_method = profile->sort_method;
+        config->sta.threshold.rssi = profile->min_rssi;
+        config->sta.threshold.authmode = profile->min_authmode;
+    }
+
+    /*Previous values are restored if driver rejects any of new ones, so link never runs half-configured.*/
+    esp_wifi_get_protocol(WIFI_IF_STA, &old_protocol);
+    esp_wifi_get_bandwidth(WIFI_IF_STA, &old_bandwidth);
+    esp_wifi_get_max_tx_power(&old_tx_power);
+
+    if (profile->protocol != 0)
+    {
+        err = esp_wifi_set_protocol(WIFI_IF_STA, profile->protocol);
+    }
+    if (err == ESP_OK && profile->bandwidth != 0)
+    {
+        err = esp_wifi_set_bandwidth(WIFI_IF_STA, profile->bandwidth);
+    }
+    if (err == ESP_OK && profile->max_tx_power != 0)
+    {
+        err = esp_wifi_set_max_tx_power(profile->max_tx_power);
+    }
+
+    if (err != ESP_OK)
+    {
+        LOG_ERROR("error %d when applying STA link profile: %s", err, error_to_name(err));
+        esp_wifi_set_protocol(WIFI_IF_STA, old_protocol);
+        esp_wifi_set_bandwidth(WIFI_IF_STA, old_bandwidth);
+        esp_wifi_set_max_tx_power(old_tx_power);
+    }
+    return err;
+}
+
+int wifi_c_ctx_sta_set_link_profile(wifi_c_ctx_t *ctx, const wifi_c_sta_link_profile_t *profile)
+{
+    wifi_c_sta_link_profile_t default_profile = WIFI_C_STA_LINK_PROFILE_DEFAULT();
+
+    if (profile == NULL)
+    {
+        profile = &default_profile;
+    }
+
+    if ((profile->protocol & ~(WIFI_PROTOCOL_11B | WIFI_PROTOCOL_11G | WIFI_PROTOCOL_11N | WIFI_PROTOCOL_LR)) != 0)
+    {
+        LOG_ERROR("Unknown STA protocol bits: 0x%02x", profile->protocol);
+        return WIFI_C_ERR_LINK_PROFILE_INVALID;
+    }
+
+    if (profile->bandwidth != 0 && profile->bandwidth != WIFI_BW_HT20 && profile->bandwidth != WIFI_BW_HT40)
+    {
+        LOG_ERROR("Unknown STA bandwidth: %d", profile->bandwidth);
+        return WIFI_C_ERR_LINK_PROFILE_INVALID;
+    }
+
+    if (profile->bandwidth == WIFI_BW_HT40 && profile->protocol != 0 && !(profile->protocol & WIFI_PROTOCOL_11N))
+    {
+        LOG_ERROR("HT40 bandwidth needs 802.11n protocol.");
+        return WIFI_C_ERR_LINK_PROFILE_INVALID;
+    }
+
+    if (profile->max_tx_power != 0 &&
+        (profile->max_tx_power < WIFI_C_STA_LINK_PROFILE_MIN_TX_POWER || profile->max_tx_power > WIFI_C_STA_LINK_PROFILE_MAX_TX_POWER))
+    {
+        LOG_ERROR("STA TX power %d out of range %d-%d.", profile->max_tx_power,
+                  WIFI_C_STA_LINK_PROFILE_MIN_TX_POWER, WIFI_C_STA_LINK_PROFILE_MAX_TX_POWER);
+        return WIFI_C_ERR_LINK_PROFILE_INVALID;
+    }
+
+    memcpy(&ctx->sta_link_profile, profile, sizeof(wifi_c_sta_link_profile_t));
+    LOG_INFO("STA link profile changed, used from next connect.");
+    return ERR_C_OK;
+}
+
+uint32_t wifi_c_ctx_sta_get_lease_conflicts(wifi_c_ctx_t *ctx)
+{
+    return ctx->lease_conflicts;
+}
+
+void wifi_c_sta_forget_lease(void)
+{
+    wifi_c_lease_cache.magic = 0;
+}
+#endif
+
+wifi_c_status_t *wifi_c_ctx_get_status(wifi_c_ctx_t *ctx)
+{
+    return &ctx->status;
+}
+
+#if WIFI_C_JSON_ENABLED
+static inline char *wifi_c_get_bool_as_char(bool value)
+{
+    return (value) ? "true" : "false";
+}
+
+int wifi_c_ctx_get_status_as_json(wifi_c_ctx_t *ctx, char *buffer, size_t buflen)
+{
+    err_c_t err = 0;
+    int len = 0;
+
+    ERR_C_CHECK_NULL_PTR(buffer, LOG_ERROR("buffer to store wifi_c_status as JSON cannot be NULL"));
+    memutil_zero_memory(buffer, buflen);
+
+    LOG_DEBUG("storing wifi_c_status structure as JSON string...");
+
+    len = snprintf(buffer, buflen, "{\"wifi_initialized\": %s, \"netif_initialized\":%s, \"wifi_mode\": \"%s\", \"event_loop_started\": %s, \"sta_started\": %s, \"ap_started\": %s, \"scan_done\": %s, \"sta_connected\":%s, \"suspended\": %s",
+                   wifi_c_get_bool_as_char(ctx->status.wifi_initialized),
+                   wifi_c_get_bool_as_char(ctx->status.netif_initialized),
+                   wifi_c_get_wifi_mode_as_string(ctx->status.wifi_mode),
+                   wifi_c_get_bool_as_char(ctx->status.even_loop_started),
+                   wifi_c_get_bool_as_char(ctx->status.sta_started),
+                   wifi_c_get_bool_as_char(ctx->status.ap_started),
+                   wifi_c_get_bool_as_char(ctx->status.scan_done),
+                   wifi_c_get_bool_as_char(ctx->status.sta_connected),
+                   wifi_c_get_bool_as_char(ctx->status.suspended));
+#if WIFI_C_STA_ENABLED
+    if (len > 0 && (size_t)len < buflen)
+    {
+        len += snprintf(&buffer[len], buflen - len, ", \"sta_ip\": \"%s\", \"sta_ssid\": \"%s\"",
+                        wifi_c_ctx_get_sta_ipv4(ctx),
+                        wifi_c_ctx_sta_get_ap_ssid(ctx));
+    }
+#endif
+#if WIFI_C_AP_ENABLED
+    if (len > 0 && (size_t)len < buflen)
+    {
+        len += snprintf(&buffer[len], buflen - len, ", \"ap_ip\": \"%s\", \"ap_ssid\": \"%s\"",
+                        wifi_c_ctx_get_ap_ipv4(ctx),
+                        wifi_c_ctx_ap_get_ssid(ctx));
+    }
+#endif
+    if (len > 0 && (size_t)len < buflen)
+    {
+        snprintf(&buffer[len], buflen - len, "}");
+    }
+    LOG_DEBUG("wifi_c_status structure as JSON: \n%s", buffer);
+    return err;
+}
+
+/**
+ * @brief Stream status as JSON, status may be copy taken on controller task.
+ */
+static int wifi_c_status_stream_json(const wifi_c_status_t *status, wifi_c_stream_sink_t sink, void *arg)
+{
+    wifi_c_stream_t stream;
+
+    wifi_c_stream_init(&stream, sink, arg);
+
+    wifi_c_stream_printf(&stream, "{\"wifi_initialized\": %s, \"netif_initialized\": %s, \"wifi_mode\": \"%s\", \"event_loop_started\": %s",
+                         wifi_c_get_bool_as_char(status->wifi_initialized),
+                         wifi_c_get_bool_as_char(status->netif_initialized),
+                         wifi_c_get_wifi_mode_as_string(status->wifi_mode),
+                         wifi_c_get_bool_as_char(status->even_loop_started));
+    wifi_c_stream_printf(&stream, ", \"sta_started\": %s, \"ap_started\": %s, \"scan_done\": %s, \"sta_connected\": %s, \"suspended\": %s",
+                         wifi_c_get_bool_as_char(status->sta_started),
+                         wifi_c_get_bool_as_char(status->ap_started),
+                         wifi_c_get_bool_as_char(status->scan_done),
+                         wifi_c_get_bool_as_char(status->sta_connected),
+                         wifi_c_get_bool_as_char(status->suspended));
+#if WIFI_C_STA_ENABLED
+    wifi_c_stream_printf(&stream, ", \"sta_ip\": \"%s\", \"sta_ssid\": ", status->sta.ip);
+    wifi_c_stream_json_string(&stream, status->sta.ssid, sizeof(status->sta.ssid));
+#endif
+#if WIFI_C_AP_ENABLED
+    wifi_c_stream_printf(&stream, ", \"ap_ip\": \"%s\", \"ap_ssid\": ", status->ap.ip);
+    wifi_c_stream_json_string(&stream, status->ap.ssid, sizeof(status->ap.ssid));
+#endif
+    wifi_c_stream_write(&stream, "}", 1);
+
+    return wifi_c_stream_finish(&stream);
+}
+
+int wifi_c_ctx_stream_status_json(wifi_c_ctx_t *ctx, wifi_c_stream_sink_t sink, void *arg)
+{
+    ERR_C_CHECK_NULL_PTR(sink, LOG_ERROR("sink of wifi_c_status JSON cannot be NULL"));
+    return wifi_c_status_stream_json(&ctx->status, sink, arg);
+}
+#endif
+
+char *wifi_c_get_wifi_mode_as_string(wifi_c_mode_t wifi_mode)
+{
+    switch (wifi_mode)
+    {
+    case WIFI_C_MODE_AP:
+        return "WIFI_C_MODE_AP";
+    case WIFI_C_MODE_STA:
+        return "WIFI_C_MODE_STA";
+    case WIFI_C_MODE_APSTA:
+        return "WIFI_C_MODE_APSTA";
+    default:
+        LOG_ERROR("not known wifi_c_mode_t: %d, cannot translate to string.", wifi_mode);
+        break;
+    }
+    return NULL;
+}
+
+#if WIFI_C_STA_ENABLED
+char *wifi_c_ctx_get_sta_ipv4(wifi_c_ctx_t *ctx)
+{
+    return ctx->status.sta.ip;
+}
+
+char *wifi_c_ctx_sta_get_ap_ssid(wifi_c_ctx_t *ctx)
+{
+    return ctx->status.sta.ssid;
+}
+#endif
+
+#if WIFI_C_AP_ENABLED
+char *wifi_c_ctx_get_ap_ipv4(wifi_c_ctx_t *ctx)
+{
+    return ctx->status.ap.ip;
+}
+
+char *wifi_c_ctx_ap_get_ssid(wifi_c_ctx_t *ctx)
+{
+    return ctx->status.ap.ssid;
+}
+
+#if WIFI_C_JSON_ENABLED
+int wifi_c_ctx_stream_stations_json(wifi_c_ctx_t *ctx, wifi_c_stream_sink_t sink, void *arg)
+{
+    wifi_c_stream_t stream;
+    wifi_sta_list_t sta_list;
+    wifi_sta_mac_ip_list_t ip_list;
+    esp_err_t esp_err = ESP_OK;
+
+    ERR_C_CHECK_NULL_PTR(sink, LOG_ERROR("sink of connected stations cannot be NULL"));
+
+    // nothing is sent on error, so caller can still answer with error status
+    if (!(ctx->status.ap_started))
+    {
+        LOG_ERROR("AP was not started.");
+        return WIFI_C_ERR_WIFI_NOT_STARTED;
+    }
+    esp_err = esp_wifi_ap_get_sta_list(&sta_list);
+    if (esp_err == ESP_OK)
+    {
+        esp_err = esp_wifi_ap_get_sta_list_with_ip(&sta_list, &ip_list);
+    }
+    if (esp_err != ESP_OK)
+    {
+        LOG_ERROR("Error when getting connected stations: %s", esp_err_to_name(esp_err));
+        return esp_err;
+    }
+
+    wifi_c_stream_init(&stream, sink, arg);
+    wifi_c_stream_write(&stream, "[", 1);
+    for (int i = 0; i < sta_list.num; i++)
+    {
+        wifi_c_stream_printf(&stream, "%s{\"mac\": \"" MACSTR "\", \"ip\": \"" IPSTR "\", \"rssi\": %d}",
+                             (i > 0) ? ", " : "", MAC2STR(sta_list.sta[i].mac), IP2STR(&ip_list.sta[i].ip),
+                             sta_list.sta[i].rssi);
+    }
+    wifi_c_stream_write(&stream, "]", 1);
+
+    return wifi_c_stream_finish(&stream);
+}
+#endif
+#endif
+
+int wifi_c_ctx_init_wifi(wifi_c_ctx_t *ctx, wifi_c_mode_t WIFI_C_WIFI_MODE)
+{
+    volatile err_c_t err = ERR_C_OK;
+    wifi_init_config_t wifi_init_config = WIFI_INIT_CONFIG_DEFAULT();
+    Try
+    {
+        if (ctx->status.wifi_initialized == true && ctx->status.wifi_mode == WIFI_C_WIFI_MODE)
+        {
+            ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_WIFI_ALREADY_INIT);
+        } else if(ctx->status.wifi_initialized == true && ctx->status.wifi_mode != WIFI_C_WIFI_MODE) {
+            wifi_c_ctx_deinit(ctx);    //if it's init with different mode, deinit and init with new wanted mode
+        }
+
+        if (wifi_c_select_wifi_mode(WIFI_C_WIFI_MODE) == WIFI_MODE_NULL)
+        {
+            ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_WRONG_MODE);    // mode not known or compiled out
+        }
+        ERR_C_CHECK_AND_THROW_ERR(wifi_c_shared_claim(ctx, WIFI_C_WIFI_MODE));
+
+#if WIFI_C_DEFERRED_LOG_ENABLED
+        ERR_C_CHECK_AND_THROW_ERR(wifi_c_log_start());
+#endif
+        ESP_ERROR_CHECK(esp_netif_init());
+#if WIFI_C_STATIC_ALLOC_ENABLED
+        ctx->event_group = xEventGroupCreateStatic(&ctx->event_group_buffer);
+#if WIFI_C_STA_ENABLED
+        if (WIFI_C_WIFI_MODE != WIFI_C_MODE_AP)
+        {
+            /*Created now, so first connect reusing lease doesn't allocate.*/
+            ERR_C_CHECK_AND_THROW_ERR(wifi_c_lease_timer_create(ctx));
+        }
+#endif
+#else
+        ctx->event_group = xEventGroupCreate();
+#endif
+        ERR_C_CHECK_AND_THROW_ERR(wifi_c_ctx_create_default_event_loop(ctx));
+        ERR_C_CHECK_AND_THROW_ERR(WIFI_C_SPAN_CALL(WIFI_C_SPAN_NETIF_INIT, wifi_c_init_netif(ctx, WIFI_C_WIFI_MODE)));
+        if (wifi_c_shared.driver_users == 0)
+        {
+            ERR_C_CHECK_AND_THROW_ERR(WIFI_C_SPAN_CALL(WIFI_C_SPAN_DRIVER_INIT, esp_wifi_init(&wifi_init_config)));
+            LOG_INFO("Wifi initialized.");
+            ERR_C_CHECK_AND_THROW_ERR(esp_wifi_set_storage(WIFI_STORAGE_FLASH));
+            ERR_C_CHECK_AND_THROW_ERR(esp_wifi_set_mode(wifi_c_shared_driver_mode()));
+            ERR_C_CHECK_AND_THROW_ERR(WIFI_C_SPAN_CALL(WIFI_C_SPAN_DRIVER_START, esp_wifi_start()));
+        }
+        else
+        {
+            // driver already runs for other context, only interfaces of this one are added
+            ERR_C_CHECK_AND_THROW_ERR(esp_wifi_set_mode(wifi_c_shared_driver_mode()));
+        }
+        LOG_DEBUG("wifi successfully initialized");
+        // Update wifi controller status.
+        portENTER_CRITICAL(&wifi_c_shared.lock);
+        wifi_c_shared.driver_users++;
+        portEXIT_CRITICAL(&wifi_c_shared.lock);
+        ctx->status.wifi_initialized = true;
+        ctx->status.wifi_mode = WIFI_C_WIFI_MODE;
+    }
+    Catch(err)
+    {
+        if (err == WIFI_C_ERR_WIFI_ALREADY_INIT)
+        {
+            LOG_WARN("WiFi already initialized.");
+        }
+        else if (err == WIFI_C_ERR_WRONG_MODE)
+        {
+            LOG_ERROR("Wrong Wifi mode.");
+        }
+        else
+        {
+            LOG_ERROR("Error when initializing WiFi: %d", err);
+        }
+        if (err != WIFI_C_ERR_WIFI_ALREADY_INIT)
+        {
+            wifi_c_shared_claim(ctx, WIFI_C_NO_MODE); // interfaces are free for other contexts again
+        }
+    }
+    return err;
+}
+
+#if WIFI_C_AP_ENABLED
+/**
+ * @brief Check if AP settings are consistent with each other and with STA link in AP+STA mode.
+ */
+static err_c_t wifi_c_ap_config_validate(wifi_c_ctx_t *ctx, const wifi_c_ap_config_t *config)
+{
+    uint8_t sta_channel = 0;
+    wifi_second_chan_t sta_second = WIFI_SECOND_CHAN_NONE;
+    bool open = (config->password == NULL || strlen(config->password) == 0);
+
+    if (config->ssid == NULL || strlen(config->ssid) == 0)
+    {
+        return WIFI_C_ERR_NULL_SSID;
+    }
+
+    if (strlen(config->ssid) > 32)
+    {
+        LOG_ERROR("SSID longer than 32 characters.");
+        return WIFI_C_ERR_AP_CONFIG_INVALID;
+    }
+
+    if (!open && (strlen(config->password) < 8 || strlen(config->password) > 63))
+    {
+        return WIFI_C_ERR_WRONG_PASSWORD;
+    }
+
+    if (open && config->authmode != WIFI_AUTH_OPEN)
+    {
+        LOG_WARN("No password, setting wifi_auth_mode_t to WIFI_AUTH_OPEN.");
+    }
+    else if (!open && config->authmode != WIFI_AUTH_WPA2_PSK && config->authmode != WIFI_AUTH_WPA3_PSK &&
+             config->authmode != WIFI_AUTH_WPA2_WPA3_PSK && config->authmode != WIFI_AUTH_WPA_WPA2_PSK)
+    {
+        LOG_ERROR("Auth mode %d is not supported by AP.", config->authmode);
+        return WIFI_C_ERR_AP_CONFIG_INVALID;
+    }
+
+    if (!open && config->authmode == WIFI_AUTH_WPA3_PSK && !config->pmf_required)
+    {
+        LOG_ERROR("WPA3 requires protected management frames, set pmf_required.");
+        return WIFI_C_ERR_AP_CONFIG_INVALID;
+    }
+
+    if (config->channel > WIFI_C_AP_CHANNEL_MAX)
+    {
+        LOG_ERROR("Channel %u is not 2.4 GHz channel.", config->channel);
+        return WIFI_C_ERR_AP_CONFIG_INVALID;
+    }
+
+    if (config->max_connection == 0 || config->max_connection > ESP_WIFI_MAX_CONN_NUM)
+    {
+        LOG_ERROR("Max number of clients must be between 1 and %d.", ESP_WIFI_MAX_CONN_NUM);
+        return WIFI_C_ERR_AP_CONFIG_INVALID;
+    }
+
+    if (config->beacon_interval < 100 || config->beacon_interval > 60000)
+    {
+        LOG_ERROR("Beacon interval must be between 100 and 60000 TU.");
+        return WIFI_C_ERR_AP_CONFIG_INVALID;
+    }
+
+    if (config->dtim_period < 1 || config->dtim_period > 10)
+    {
+        LOG_ERROR("DTIM period must be between 1 and 10 beacons.");
+        return WIFI_C_ERR_AP_CONFIG_INVALID;
+    }
+
+    if (config->protocol == 0 || (config->protocol & ~(WIFI_PROTOCOL_11B | WIFI_PROTOCOL_11G | WIFI_PROTOCOL_11N | WIFI_PROTOCOL_LR)))
+    {
+        LOG_ERROR("Unknown protocol mask 0x%02x.", config->protocol);
+        return WIFI_C_ERR_AP_CONFIG_INVALID;
+    }
+
+    if (config->bandwidth == WIFI_BW_HT40 && !(config->protocol & WIFI_PROTOCOL_11N))
+    {
+        LOG_ERROR("40 MHz channel width requires 802.11n.");
+        return WIFI_C_ERR_AP_CONFIG_INVALID;
+    }
+
+    /*In AP+STA mode both interfaces share one radio, AP has to stay on channel of STA link.*/
+    if (ctx->status.wifi_mode == WIFI_C_MODE_APSTA && ctx->status.sta_connected &&
+        esp_wifi_get_channel(&sta_channel, &sta_second) == ESP_OK)
+    {
+        if (config->channel != 0 && config->channel != sta_channel)
+        {
+            LOG_ERROR("STA is connected on channel %u, AP cannot use channel %u.", sta_channel, config->channel);
+            return WIFI_C_ERR_AP_CHANNEL_CONFLICT;
+        }
+        if (config->bandwidth == WIFI_BW_HT40 && sta_second == WIFI_SECOND_CHAN_NONE)
+        {
+            LOG_ERROR("STA link uses 20 MHz channel, AP cannot use 40 MHz.");
+            return WIFI_C_ERR_AP_CHANNEL_CONFLICT;
+        }
+    }
+
+    return ERR_C_OK;
+}
+
+int wifi_c_ctx_start_ap_with_config(wifi_c_ctx_t *ctx, const wifi_c_ap_config_t *config)
+{
+    volatile err_c_t err = ERR_C_OK;
+    wifi_config_t wifi_ap_config = {0};
+
+    ERR_C_CHECK_NULL_PTR(config, LOG_ERROR("AP configuration cannot be NULL"));
+
+    Try
+    {
+        if (ctx->status.wifi_initialized != true)
+        {
+            LOG_WARN("WiFi not init, initializing...");
+            ERR_C_CHECK_AND_THROW_ERR(wifi_c_ctx_init_wifi(ctx, WIFI_C_MODE_AP));
+        }
+
+        if (ctx->status.wifi_mode == WIFI_C_MODE_STA)
+        {
+            ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_WRONG_MODE);
+        }
+
+        ERR_C_CHECK_AND_THROW_ERR(wifi_c_ap_config_validate(ctx, config));
+
+        memcpy(&(wifi_ap_config.ap.ssid), config->ssid, strlen(config->ssid));
+        wifi_ap_config.ap.ssid_len = (uint8_t)strlen(config->ssid);
+        if (config->password == NULL || strlen(config->password) == 0)
+        {
+            wifi_ap_config.ap.authmode = WIFI_AUTH_OPEN;
+        }
+        else
+        {
+            memcpy(&(wifi_ap_config.ap.password), config->password, strlen(config->password));
+            wifi_ap_config.ap.authmode = config->authmode;
+        }
+        wifi_ap_config.ap.channel = config->channel;
+        wifi_ap_config.ap.max_connection = config->max_connection;
+        wifi_ap_config.ap.beacon_interval = config->beacon_interval;
+        wifi_ap_config.ap.dtim_period = config->dtim_period;
+        wifi_ap_config.ap.pmf_cfg.capable = true;
+        wifi_ap_config.ap.pmf_cfg.required = config->pmf_required;
+#if WIFI_C_APSTA_POLICY_ENABLED && WIFI_C_APSTA_CSA_SUPPORTED
+        wifi_ap_config.ap.csa_count = ctx->apsta_policy.csa_count; // announced when STA link moves AP to other channel
+#endif
+
+        ERR_C_CHECK_AND_THROW_ERR(esp_wifi_set_protocol(WIFI_IF_AP, config->protocol));
+        ERR_C_CHECK_AND_THROW_ERR(esp_wifi_set_bandwidth(WIFI_IF_AP, config->bandwidth));
+        ERR_C_CHECK_AND_THROW_ERR(esp_wifi_set_config(WIFI_IF_AP, &wifi_ap_config));
+        // ERR_C_CHECK_AND_THROW_ERR(esp_wifi_start());
+        LOG_INFO("Started AP: \nSSID: %s", config->ssid);
+        LOG_DEBUG("AP channel: %u, bandwidth: %s, max clients: %u, beacon interval: %u TU, DTIM: %u",
+                  config->channel, (config->bandwidth == WIFI_BW_HT40) ? "HT40" : "HT20",
+                  config->max_connection, config->beacon_interval, config->dtim_period);
+
+        // update wifi_c_status
+        ctx->status.ap_started = true;
+
+        memutil_zero_memory(&(ctx->status.ap.ssid), sizeof(ctx->status.ap.ssid));
+        memcpy(&(ctx->status.ap.ssid), config->ssid, strlen(config->ssid));
+
+        memutil_zero_memory(&(ctx->status.ap.ip), sizeof(ctx->status.ap.ip));
+        memcpy(&(ctx->status.ap.ip), "192.168.4.1", strlen("192.168.4.1")); // use standard address got by DHCP
+    }
+    Catch(err)
+    {
+        switch (err)
+        {
+        case WIFI_C_ERR_WRONG_MODE:
+            LOG_ERROR("Wrong Wifi mode.");
+            break;
+        case WIFI_C_ERR_NULL_SSID:
+            LOG_ERROR("SSID cannot be null");
+            break;
+        case WIFI_C_ERR_WRONG_PASSWORD:
+            LOG_ERROR("Password must have between 8 and 63 characters.");
+            break;
+        case WIFI_C_ERR_AP_CONFIG_INVALID:
+            LOG_ERROR("Invalid AP configuration.");
+            break;
+        case WIFI_C_ERR_AP_CHANNEL_CONFLICT:
+            LOG_ERROR("AP configuration conflicts with STA link.");
+            break;
+        default:
+            LOG_ERROR("Error when starting AP: %d, \nESP-IDF error: %s", err, esp_err_to_name(err));
+            break;
+        }
+
+        memset(&wifi_ap_config, 0, sizeof(wifi_ap_config));
+    }
+
+    return err;
+}
+
+int wifi_c_ctx_start_ap(wifi_c_ctx_t *ctx, const char *ssid, const char *password)
+{
+    wifi_c_ap_config_t config = WIFI_C_AP_CONFIG_DEFAULT();
+
+    config.ssid = ssid;
+    config.password = password;
+    return wifi_c_ctx_start_ap_with_config(ctx, &config);
+}
+#endif
+
+#if WIFI_C_STA_ENABLED
+/**
+ * @brief Check if STA can be started, initialize WiFi in STA mode when needed.
+ */
+static err_c_t wifi_c_sta_prepare(wifi_c_ctx_t *ctx, const char *ssid)
+{
+    err_c_t err = ERR_C_OK;
+
+    if (ctx->status.wifi_initialized != true)
+    {
+        LOG_WARN("WiFi not init, initializing...");
+        err = wifi_c_ctx_init_wifi(ctx, WIFI_C_MODE_STA);
+        if (err != ERR_C_OK)
+        {
+            return err;
+        }
+    }
+
+    if (ctx->status.wifi_mode == WIFI_C_MODE_AP)
+    {
+        return WIFI_C_ERR_WRONG_MODE;
+    }
+
+    if (strlen(ssid) == 0)
+    {
+        return WIFI_C_ERR_NULL_SSID;
+    }
+    return ERR_C_OK;
+}
+
+/**
+ * @brief Configure STA, connect and wait for result.
+ *
+ * @param target BSSID to lock STA to, NULL to let driver choose any AP of SSID.
+ * @param wait   false to return once connecting started, result is then reported only as state.
+ *
+ * @todo changing connection timeout time
+ */
+static int wifi_c_sta_connect(wifi_c_ctx_t *ctx, const char *ssid, const char *password, const wifi_ap_record_t *target, bool wait)
+{
+    volatile err_c_t err = ERR_C_OK;
+#if WIFI_C_APSTA_POLICY_ENABLED
+    wifi_ap_record_t located;
+    bool apsta = false;
+#endif
+    wifi_config_t wifi_sta_config = {
+        .sta = {
+            .failure_retry_cnt = 1, // WIFI_C_STA_RETRY_COUNT,
+            .scan_method = WIFI_ALL_CHANNEL_SCAN,
+        },
+    };
+    assert(ssid);
+
+    Try
+    {
+        ERR_C_CHECK_AND_THROW_ERR(wifi_c_sta_prepare(ctx, ssid));
+
+#if WIFI_C_APSTA_POLICY_ENABLED
+        apsta = (ctx->status.wifi_mode == WIFI_C_MODE_APSTA && ctx->status.ap_started);
+        if (apsta)
+        {
+            ctx->apsta_stats.connects++;
+        }
+        if (apsta && target == NULL && ctx->apsta_policy.enabled)
+        {
+            /*Sweep of all channels would keep radio away from AP clients, find BSSID first.*/
+            ERR_C_CHECK_AND_THROW_ERR(wifi_c_apsta_locate(ctx, ssid, &located));
+            target = &located;
+        }
+#endif
+
+        if (target != NULL)
+        {
+            /*Channel is known, driver doesn't have to sweep all of them.*/
+            wifi_sta_config.sta.bssid_set = true;
+            memcpy(wifi_sta_config.sta.bssid, target->bssid, sizeof(wifi_sta_config.sta.bssid));
+            wifi_sta_config.sta.channel = target->primary;
+            wifi_sta_config.sta.scan_method = WIFI_FAST_SCAN;
+        }
+        wifi_sta_config.sta.rm_enabled = ctx->sta_11kv;
+        wifi_sta_config.sta.btm_enabled = ctx->sta_11kv;
+        ctx->resume_pinned = false; // new config replaces the one cached by suspend
+
+        if ((memcpy(&(wifi_sta_config.sta.ssid), ssid, sizeof(wifi_sta_config.sta.ssid))) != &(wifi_sta_config.sta.ssid))
+        {
+            ERR_C_SET_AND_THROW_ERR(err, ERR_C_MEMORY_ERR);
+        }
+
+        if ((memcpy(&(wifi_sta_config.sta.password), password, sizeof(wifi_sta_config.sta.password))) != &(wifi_sta_config.sta.password))
+        {
+            ERR_C_SET_AND_THROW_ERR(err, ERR_C_MEMORY_ERR);
+        }
+
+        ERR_C_CHECK_AND_THROW_ERR(wifi_c_sta_apply_link_profile(ctx, &wifi_sta_config));
+#if WIFI_C_PSK_CACHE_ENABLED
+        /*WPA3-SAE needs passphrase, PSK is passed only when AP may accept WPA2.*/
+        ctx->psk_used = false;
+        if (strnlen(password, WIFI_C_PSK_HEX_LEN) >= 8 && strnlen(password, WIFI_C_PSK_HEX_LEN) < WIFI_C_PSK_HEX_LEN &&
+            (target == NULL || target->authmode != WIFI_AUTH_WPA3_PSK) &&
+            wifi_sta_config.sta.threshold.authmode != WIFI_AUTH_WPA3_PSK)
+        {
+            /*Driver takes 64 hex digits as PSK and skips PBKDF2 of passphrase.*/
+            err = wifi_c_psk_get(ssid, password, wifi_sta_config.sta.password);
+            if (err != ERR_C_OK && err != WIFI_C_ERR_PSK_PASSPHRASE_ONLY)
+            {
+                ERR_C_CHECK_AND_THROW_ERR(err);
+            }
+            ctx->psk_used = (err == ERR_C_OK);
+            err = ERR_C_OK;
+        }
+#endif
+        ERR_C_CHECK_AND_THROW_ERR(esp_wifi_set_config(WIFI_IF_STA, &wifi_sta_config));
+        ERR_C_CHECK_AND_THROW_ERR(wifi_c_sta_apply_ip_config(ctx, ssid));
+        LOG_DEBUG("WiFi successfully configured as STA.");
+        ctx->status.sta_started = true;
+
+        /*Wait till sta started before trying to connect.*/
+        xEventGroupWaitBits(ctx->event_group, WIFI_C_STA_STARTED_BIT, pdFALSE, pdFALSE, pdMS_TO_TICKS(2000));
+
+        /*Result of previous connection must not be taken as result of this one.*/
+        xEventGroupClearBits(ctx->event_group, WIFI_C_CONNECTED_BIT | WIFI_C_CONNECT_FAIL_BIT);
+        WIFI_C_METRIC(wifi_c_metrics_connect_attempt());
+        WIFI_C_SPAN_ASYNC_BEGIN(WIFI_C_SPAN_CONNECT);
+#if WIFI_C_APSTA_POLICY_ENABLED
+        ctx->apsta_connecting = apsta;
+#endif
+        ERR_C_CHECK_AND_THROW_ERR(esp_wifi_connect());
+
+        /*Without waiting, event handler reports result as WIFI_C_STATE_STA_GOT_IP or WIFI_C_STATE_STA_CONNECT_FAILED.*/
+        if (wait)
+        {
+            /*Wait for sta to finish connecting or timeout*/
+            err = wifi_c_check_sta_connection_result(ctx, 60);
+#if WIFI_C_PSK_CACHE_ENABLED
+            if (err == WIFI_C_ERR_STA_CONNECT_FAIL && ctx->psk_used)
+            {
+                /*WPA3-only AP rejects PSK, disconnect handler marked SSID to be joined with passphrase.*/
+                LOG_WARN("Connect to %s with cached PSK failed, trying passphrase.", ssid);
+                memcpy(&(wifi_sta_config.sta.password), password, sizeof(wifi_sta_config.sta.password));
+                ctx->psk_used = false;
+                ERR_C_CHECK_AND_THROW_ERR(esp_wifi_set_config(WIFI_IF_STA, &wifi_sta_config));
+                xEventGroupClearBits(ctx->event_group, WIFI_C_CONNECTED_BIT | WIFI_C_CONNECT_FAIL_BIT);
+                ctx->sta_link.retry_num = 0;
+                WIFI_C_METRIC(wifi_c_metrics_connect_attempt());
+                WIFI_C_SPAN_ASYNC_BEGIN(WIFI_C_SPAN_CONNECT);
+                ERR_C_CHECK_AND_THROW_ERR(esp_wifi_connect());
+                err = wifi_c_check_sta_connection_result(ctx, 60);
+            }
+#endif
+            ERR_C_CHECK_AND_THROW_ERR(err);
+
+            // update AP of ssid we are connected to in status
+            memutil_zero_memory(&(ctx->status.sta.ssid), sizeof(ctx->status.sta.ssid));
+            memcpy(&(ctx->status.sta.ssid), ssid, strlen(ssid));
+        }
+    }
+    Catch(err)
+    {
+        switch (err)
+        {
+        case WIFI_C_ERR_WRONG_MODE:
+            LOG_ERROR("Wrong Wifi mode.");
+            break;
+        case WIFI_C_ERR_NULL_SSID:
+            LOG_ERROR("SSID cannot be null");
+            break;
+        case ERR_C_MEMORY_ERR:
+            LOG_ERROR("Memory allocation was not successful");
+            break;
+        case WIFI_C_ERR_STA_NOT_STARTED:
+            LOG_ERROR("STA didn't start properly");
+            break;
+        case WIFI_C_ERR_STA_CONNECT_FAIL:
+            LOG_ERROR("All attempts to connect to Wifi failed");
+#if WIFI_C_PSK_CACHE_ENABLED
+            wifi_c_psk_forget(ssid); // passphrase failed too, next connect tries PSK derived again
+#endif
+            break;
+        case WIFI_C_ERR_STA_TIMEOUT_EXPIRE:
+            LOG_ERROR("Failed to connect before timeout expired, returning...");
+            break;
+        case WIFI_C_ERR_AP_NOT_FOUND:
+            LOG_ERROR("SSID %s not found on any channel.", ssid);
+            break;
+        case WIFI_C_ERR_AP_CHANNEL_CONFLICT:
+            LOG_ERROR("SSID %s is not on AP channel and AP+STA policy doesn't allow moving AP.", ssid);
+            break;
+        default:
+            LOG_ERROR("Error when starting STA: %d, \nESP-IDF error: %s", err, esp_err_to_name(err));
+            break;
+        }
+        memset(&wifi_sta_config, 0, sizeof(wifi_sta_config));
+    }
+
+    return err;
+}
+
+int wifi_c_ctx_start_sta(wifi_c_ctx_t *ctx, const char *ssid, const char *password)
+{
+    return wifi_c_sta_connect(ctx, ssid, password, NULL, true);
+}
+
+int wifi_c_ctx_start_sta_async(wifi_c_ctx_t *ctx, const char *ssid, const char *password)
+{
+    return wifi_c_sta_connect(ctx, ssid, password, NULL, false);
+}
+#endif
+
+#if WIFI_C_SCAN_ENABLED
+#define WIFI_C_SCAN_BUSY_WAIT_MS        3000        // longest wait for connect or other scan which keeps driver from scanning
+
+/**
+ * @brief Check if STA can scan.
+ */
+static err_c_t wifi_c_scan_check(wifi_c_ctx_t *ctx)
+{
+    if (!ctx->status.wifi_initialized)
+    {
+        return WIFI_C_ERR_WIFI_NOT_INIT;
+    }
+
+    if (ctx->status.wifi_mode == WIFI_C_MODE_AP)
+    {
+        return WIFI_C_ERR_WRONG_MODE; // scans are only allowed in STA mode.
+    }
+
+    if (!ctx->status.sta_started)
+    {
+        return WIFI_C_ERR_STA_NOT_STARTED;
+    }
+    return ERR_C_OK;
+}
+
+/**
+ * @brief Check if STA can scan, start scan and wait until it's done, without counting it in metrics.
+ */
+static err_c_t wifi_c_scan_run(wifi_c_ctx_t *ctx, const wifi_scan_config_t *scan_config)
+{
+    err_c_t err = wifi_c_scan_check(ctx);
+
+    if (err != ERR_C_OK)
+    {
+        return err;
+    }
+
+    LOG_DEBUG("scanning for Access Points...");
+
+    /*Scan done state lasts until next scan starts.*/
+    xEventGroupClearBits(ctx->event_group, WIFI_C_SCAN_DONE_BIT);
+    WIFI_C_SPAN_BEGIN(WIFI_C_SPAN_DRIVER_SCAN);
+    err = esp_wifi_scan_start(scan_config, WIFI_C_SCAN_BLOCK);
+
+    /*ESP_ERR_WIFI_STATE means STA is connecting or other scan runs, try again once either of them ends.*/
+    if (err == ESP_ERR_WIFI_STATE)
+    {
+        xEventGroupWaitBits(ctx->event_group,
+                            WIFI_C_STA_LINK_UP_BIT | WIFI_C_CONNECT_FAIL_BIT | WIFI_C_SCAN_DONE_BIT,
+                            pdFALSE, pdFALSE, pdMS_TO_TICKS(WIFI_C_SCAN_BUSY_WAIT_MS));
+        err = esp_wifi_scan_start(scan_config, WIFI_C_SCAN_BLOCK);
+    }
+
+    if (err == ERR_C_OK)
+    {
+        /*Wait for scan to finish before reading results.*/
+        xEventGroupWaitBits(ctx->event_group, WIFI_C_SCAN_DONE_BIT, pdFALSE, pdFALSE, pdMS_TO_TICKS(2000));
+    }
+    WIFI_C_SPAN_END(WIFI_C_SPAN_DRIVER_SCAN);
+    return err;
+}
+
+/**
+ * @brief Check if STA can scan, start scan and wait until it's done.
+ */
+static err_c_t wifi_c_scan_start_and_wait(wifi_c_ctx_t *ctx, const wifi_scan_config_t *scan_config)
+{
+    int64_t scan_start_us = esp_timer_get_time();
+    err_c_t err = wifi_c_scan_run(ctx, scan_config);
+
+    if (err == ERR_C_OK)
+    {
+        WIFI_C_METRIC(wifi_c_metrics_scan_done((uint32_t)(esp_timer_get_time() - scan_start_us)));
+    }
+    return err;
+}
+
+/**
+ * @brief Copy records of finished scan from driver to context and history.
+ */
+static err_c_t wifi_c_scan_collect(wifi_c_ctx_t *ctx)
+{
+    err_c_t err = esp_wifi_scan_get_ap_records(&ctx->scan_info.ap_count, &ctx->ap_info[0]);
+
+    if (err != ERR_C_OK)
+    {
+        return err;
+    }
+    if (wifi_c_history_is_init())
+    {
+        wifi_c_history_add_scan(&ctx->ap_info[0], ctx->scan_info.ap_count);
+    }
+    err = esp_wifi_scan_get_ap_num(&(ctx->scan_info.ap_count));
+    ctx->scan_info.ap_record = &ctx->ap_info[0];
+    return err;
+}
+
+/**
+ * @todo return only needed number of scan results
+ * @todo use memory arena for storing scan results
+ */
+int wifi_c_ctx_scan_all_ap(wifi_c_ctx_t *ctx, wifi_c_scan_result_t *result_to_return)
+{
+    volatile err_c_t err = ERR_C_OK;
+    wifi_scan_config_t scan_config = {
+        .show_hidden = 0 // Don't  show hidden AP.
+    };
+
+    ctx->scan_info.ap_count = WIFI_C_DEFAULT_SCAN_SIZE;
+
+    Try
+    {
+        ERR_C_CHECK_NULL_PTR(result_to_return, LOG_ERROR("pointer to scan result buffer cannot be NULL"));
+
+        memset(&ctx->ap_info, 0, sizeof(ctx->ap_info));
+        ERR_C_CHECK_AND_THROW_ERR(wifi_c_scan_start_and_wait(ctx, &scan_config));
+        ERR_C_CHECK_AND_THROW_ERR(wifi_c_scan_collect(ctx));
+
+        /*Copy scan results to caller, records stay in context until next scan*/
+        *result_to_return = ctx->scan_info;
+    }
+    Catch(err)
+    {
+        switch (err)
+        {
+        case WIFI_C_ERR_WRONG_MODE:
+            LOG_ERROR("Wrong Wifi mode, scanning only possible in STA mode.");
+            break;
+        case WIFI_C_ERR_WIFI_NOT_INIT:
+            LOG_ERROR("WiFi was not initialized.");
+            break;
+        case WIFI_C_ERR_STA_NOT_STARTED:
+            LOG_ERROR("STA was not started.");
+            break;
+        default:
+            LOG_ERROR("Error when scanning: %d \nESP-IDF error: %s", err, esp_err_to_name((esp_err_t)err));
+            break;
+        }
+        // Clear AP list found in last scan
+        memset(&ctx->ap_info, 0, sizeof(ctx->ap_info));
+        memset(&ctx->scan_info, 0, sizeof(ctx->scan_info));
+        esp_wifi_clear_ap_list();
+    }
+
+    return err;
+}
+
+int wifi_c_ctx_scan_start_async(wifi_c_ctx_t *ctx)
+{
+    wifi_scan_config_t scan_config = {
+        .show_hidden = 0 // Don't  show hidden AP.
+    };
+    err_c_t err = wifi_c_scan_check(ctx);
+
+    if (err != ERR_C_OK)
+    {
+        LOG_ERROR("Cannot scan, STA is not ready: %d", err);
+        return err;
+    }
+
+    /*Scan done state lasts until next scan starts.*/
+    xEventGroupClearBits(ctx->event_group, WIFI_C_SCAN_DONE_BIT);
+    ctx->scan_info.ap_record = NULL; // results of this scan are not taken from driver yet
+    err = esp_wifi_scan_start(&scan_config, false);
+    if (err != ESP_OK)
+    {
+        LOG_ERROR("error %d when starting scan: %s", err, error_to_name(err));
+    }
+    return err;
+}
+
+int wifi_c_ctx_scan_get_results(wifi_c_ctx_t *ctx, wifi_c_scan_result_t *result)
+{
+    err_c_t err = ERR_C_OK;
+    ERR_C_CHECK_NULL_PTR(result, LOG_ERROR("pointer to scan result buffer cannot be NULL"));
+
+    if (ctx->event_group == NULL || !(xEventGroupGetBits(ctx->event_group) & WIFI_C_SCAN_DONE_BIT))
+    {
+        LOG_WARN("Scan is not done, no results to take.");
+        return WIFI_C_ERR_SCAN_NOT_DONE;
+    }
+
+    /*Driver frees its list when records are taken, later calls get the copy in context.*/
+    if (ctx->scan_info.ap_record != NULL)
+    {
+        *result = ctx->scan_info;
+        return ERR_C_OK;
+    }
+
+    memset(&ctx->ap_info, 0, sizeof(ctx->ap_info));
+    ctx->scan_info.ap_count = WIFI_C_DEFAULT_SCAN_SIZE;
+    err = wifi_c_scan_collect(ctx);
+    if (err != ERR_C_OK)
+    {
+        LOG_ERROR("Error when taking scan results: %d \nESP-IDF error: %s", err, esp_err_to_name((esp_err_t)err));
+        memset(&ctx->scan_info, 0, sizeof(ctx->scan_info));
+        esp_wifi_clear_ap_list();
+        return err;
+    }
+    *result = ctx->scan_info;
+    return ERR_C_OK;
+}
+
+/**
+ * @brief Take scanned records from driver one by one, add them to history and pass to consumer.
+ *
+ * @note Driver list is always freed, also when error is returned.
+ */
+static err_c_t wifi_c_scan_pull_records(wifi_c_ctx_t *ctx, void (*consumer)(const wifi_ap_record_t *record, void *arg),
+                                        void *arg)
+{
+    err_c_t err = ERR_C_OK;
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+    wifi_ap_record_t record;
+
+    /*Driver frees every record taken, so memory doesn't depend on number of APs around.*/
+    while (esp_wifi_scan_get_ap_record(&record) == ESP_OK)
+    {
+        if (wifi_c_history_is_init())
+        {
+            wifi_c_history_add_scan(&record, 1);
+        }
+        consumer(&record, arg);
+    }
+#elif WIFI_C_STATIC_ALLOC_ENABLED
+    /*No API to take single record, records which fit buffer of context are copied, the rest is dropped.*/
+    wifi_ap_record_t *records = ctx->scan_records;
+    uint16_t ap_num = WIFI_C_DEFAULT_SCAN_SIZE;
+
+    err = esp_wifi_scan_get_ap_records(&ap_num, records);
+    if (err == ERR_C_OK && wifi_c_history_is_init())
+    {
+        wifi_c_history_add_scan(records, ap_num);
+    }
+    for (uint16_t i = 0; err == ERR_C_OK && i < ap_num; i++)
+    {
+        consumer(&records[i], arg);
+    }
+#else
+    /*No API to take single record, driver list has to be copied at once.*/
+    uint16_t ap_num = 0;
+    wifi_ap_record_t *records = NULL;
+
+    err = esp_wifi_scan_get_ap_num(&ap_num);
+    if (err == ERR_C_OK)
+    {
+        records = calloc(ap_num > 0 ? ap_num : 1, sizeof(wifi_ap_record_t));
+        err = (records != NULL) ? esp_wifi_scan_get_ap_records(&ap_num, records) : ERR_C_MEMORY_ERR;
+    }
+    if (err == ERR_C_OK && wifi_c_history_is_init())
+    {
+        wifi_c_history_add_scan(records, ap_num);
+    }
+    for (uint16_t i = 0; err == ERR_C_OK && i < ap_num; i++)
+    {
+        consumer(&records[i], arg);
+    }
+    free(records);
+#endif
+    esp_wifi_clear_ap_list();
+    return err;
+}
+
+static void wifi_c_scan_push_to_top(const wifi_ap_record_t *record, void *arg)
+{
+    wifi_c_scan_top_push((wifi_c_scan_top_t *)arg, record);
+}
+
+/**
+ * @brief Top-K selection which also scores congestion of every scanned AP, the ones rejected by filter too.
+ */
+struct wifi_c_scan_scored_top_obj {
+    wifi_c_scan_top_t top;
+    wifi_c_channel_scores_t *scores;
+};
+
+static void wifi_c_scan_push_to_scored_top(const wifi_ap_record_t *record, void *arg)
+{
+    struct wifi_c_scan_scored_top_obj *scored = (struct wifi_c_scan_scored_top_obj *)arg;
+
+    if (scored->scores != NULL)
+    {
+        wifi_c_channel_scores_add(scored->scores, record);
+    }
+    wifi_c_scan_top_push(&scored->top, record);
+}
+
+/**
+ * @brief Pass criteria of filter which driver can handle itself to scan configuration.
+ */
+static void wifi_c_scan_filter_to_config(const wifi_c_scan_filter_t *filter, wifi_scan_config_t *scan_config)
+{
+    if (filter == NULL)
+    {
+        return;
+    }
+
+    /*Only one channel allowed, don't scan the others.*/
+    if (filter->channel_mask != WIFI_C_SCAN_FILTER_ANY_CHANNEL && (filter->channel_mask & (filter->channel_mask - 1)) == 0)
+    {
+        scan_config->channel = (uint8_t)__builtin_ctz(filter->channel_mask);
+    }
+
+    /*SSID without wildcards, driver can probe for it directly.*/
+    if (filter->ssid_pattern != NULL && filter->ssid_pattern[0] != '\0' && strpbrk(filter->ssid_pattern, "*?") == NULL)
+    {
+        scan_config->ssid = (uint8_t *)filter->ssid_pattern;
+    }
+}
+
+int wifi_c_ctx_scan_filtered(wifi_c_ctx_t *ctx, const wifi_c_scan_filter_t *filter, wifi_ap_record_t *records, uint16_t *count)
+{
+    volatile err_c_t err = ERR_C_OK;
+    wifi_c_scan_top_t top;
+    wifi_scan_config_t scan_config = {
+        .show_hidden = 0 // Don't  show hidden AP.
+    };
+
+    ERR_C_CHECK_NULL_PTR(records, LOG_ERROR("buffer to store scan results cannot be NULL"));
+    ERR_C_CHECK_NULL_PTR(count, LOG_ERROR("pointer to number of scan results cannot be NULL"));
+
+    Try
+    {
+        if (*count == 0)
+        {
+            ERR_C_SET_AND_THROW_ERR(err, ERR_C_INVALID_ARGS);
+        }
+
+        wifi_c_scan_top_init(&top, filter, records, *count);
+        wifi_c_scan_filter_to_config(filter, &scan_config);
+        ERR_C_CHECK_AND_THROW_ERR(wifi_c_scan_start_and_wait(ctx, &scan_config));
+        ERR_C_CHECK_AND_THROW_ERR(wifi_c_scan_pull_records(ctx, wifi_c_scan_push_to_top, &top));
+        *count = top.count;
+        LOG_DEBUG("%u of %u scanned APs matched filter, stored %u.", top.seen - top.rejected, top.seen, top.count);
+    }
+    Catch(err)
+    {
+        switch (err)
+        {
+        case ERR_C_INVALID_ARGS:
+            LOG_ERROR("Size of buffer to store scan results cannot be zero.");
+            break;
+        case WIFI_C_ERR_WRONG_MODE:
+            LOG_ERROR("Wrong Wifi mode, scanning only possible in STA mode.");
+            break;
+        case WIFI_C_ERR_WIFI_NOT_INIT:
+            LOG_ERROR("WiFi was not initialized.");
+            break;
+        case WIFI_C_ERR_STA_NOT_STARTED:
+            LOG_ERROR("STA was not started.");
+            break;
+        default:
+            LOG_ERROR("Error when scanning: %d \nESP-IDF error: %s", err, esp_err_to_name((esp_err_t)err));
+            break;
+        }
+        *count = 0;
+        esp_wifi_clear_ap_list();
+    }
+
+    return err;
+}
+
+/**
+ * @brief Get channels allowed in current country, as bit per channel.
+ */
+static uint16_t wifi_c_scan_country_channels(void)
+{
+    wifi_country_t country;
+    uint16_t mask = 0;
+
+    if (esp_wifi_get_country(&country) != ESP_OK || country.schan == 0)
+    {
+        return 0x07FE; // channels 1-11 are allowed everywhere
+    }
+    for (uint8_t channel = country.schan; channel < country.schan + country.nchan && channel <= 14; channel++)
+    {
+        mask |= WIFI_C_SCAN_FILTER_CHANNEL_BIT(channel);
+    }
+    return mask;
+}
+
+int wifi_c_ctx_scan_sliced(wifi_c_ctx_t *ctx, const wifi_c_scan_slice_config_t *config, const wifi_c_scan_filter_t *filter,
+                           wifi_ap_record_t *records, uint16_t *count, wifi_c_scan_slice_report_t *report)
+{
+    volatile err_c_t err = ERR_C_OK;
+    wifi_c_scan_slice_config_t default_config = WIFI_C_SCAN_SLICE_CONFIG_DEFAULT();
+    wifi_c_scan_slice_report_t slice_report;
+    struct wifi_c_scan_scored_top_obj scored;
+    wifi_scan_config_t scan_config = {
+        .scan_type = WIFI_SCAN_TYPE_ACTIVE,
+    };
+    uint16_t channel_mask = 0;
+    uint8_t in_slice = 0;
+    uint32_t slice_off_us = 0;
+    uint32_t scan_us = 0;
+    int64_t sweep_start_us = 0;
+    int64_t scan_start_us = 0;
+
+    ERR_C_CHECK_NULL_PTR(records, LOG_ERROR("buffer to store scan results cannot be NULL"));
+    ERR_C_CHECK_NULL_PTR(count, LOG_ERROR("pointer to number of scan results cannot be NULL"));
+
+    if (config == NULL)
+    {
+        config = &default_config;
+    }
+    memutil_zero_memory(&slice_report, sizeof(slice_report));
+
+    Try
+    {
+        if (*count == 0 || config->channels_per_slice == 0)
+        {
+            ERR_C_SET_AND_THROW_ERR(err, ERR_C_INVALID_ARGS);
+        }
+
+        /*Cap planned time away from home channel by shortening time on every channel.*/
+        slice_report.channel_time_ms = config->channel_time_ms;
+        if ((uint32_t)config->channels_per_slice * slice_report.channel_time_ms > config->max_off_channel_ms)
+        {
+            slice_report.channel_time_ms = config->max_off_channel_ms / config->channels_per_slice;
+        }
+        if (slice_report.channel_time_ms < WIFI_C_SCAN_SLICE_MIN_CHANNEL_MS)
+        {
+            ERR_C_SET_AND_THROW_ERR(err, ERR_C_INVALID_ARGS);
+        }
+
+        channel_mask = wifi_c_scan_country_channels();
+        if (config->channel_mask != 0)
+        {
+            channel_mask &= config->channel_mask;
+        }
+        if (filter != NULL && filter->channel_mask != WIFI_C_SCAN_FILTER_ANY_CHANNEL)
+        {
+            channel_mask &= filter->channel_mask;
+        }
+
+        wifi_c_scan_top_init(&scored.top, filter, records, *count);
+        scored.scores = config->scores;
+        wifi_c_scan_filter_to_config(filter, &scan_config);
+        if (scored.scores != NULL)
+        {
+            scan_config.ssid = NULL; // congestion counts APs of all SSIDs
+        }
+        scan_config.show_hidden = config->show_hidden;
+        scan_config.scan_time.active.min = 0;
+        scan_config.scan_time.active.max = slice_report.channel_time_ms;
+
+        sweep_start_us = esp_timer_get_time();
+        for (uint8_t channel = 1; channel <= 14; channel++)
+        {
+            if (!(channel_mask & WIFI_C_SCAN_FILTER_CHANNEL_BIT(channel)))
+            {
+                continue;
+            }
+
+            /*Slice is full, give connection time on home channel.*/
+            if (in_slice == config->channels_per_slice)
+            {
+                vTaskDelay(pdMS_TO_TICKS(config->home_dwell_ms));
+                in_slice = 0;
+            }
+            if (in_slice == 0)
+            {
+                slice_off_us = 0;
+                slice_report.slices++;
+            }
+
+            /*Channels of one slice are scanned back to back, only reading results in between.*/
+            scan_config.channel = channel;
+            scan_start_us = esp_timer_get_time();
+            ERR_C_CHECK_AND_THROW_ERR(wifi_c_scan_run(ctx, &scan_config));
+            scan_us = (uint32_t)(esp_timer_get_time() - scan_start_us);
+            ERR_C_CHECK_AND_THROW_ERR(wifi_c_scan_pull_records(ctx, wifi_c_scan_push_to_scored_top, &scored));
+            in_slice++;
+            slice_report.channels++;
+
+            slice_off_us += scan_us;
+            slice_report.off_channel_us += scan_us;
+            if (slice_off_us > slice_report.max_off_channel_us)
+            {
+                slice_report.max_off_channel_us = slice_off_us;
+            }
+        }
+        slice_report.duration_us = (uint32_t)(esp_timer_get_time() - sweep_start_us);
+        WIFI_C_METRIC(wifi_c_metrics_scan_sliced_done(slice_report.duration_us, slice_report.slices, slice_report.max_off_channel_us));
+
+        *count = scored.top.count;
+        LOG_DEBUG("Sliced scan: %u channels in %u slices, %lu us, longest slice %lu us, stored %u APs.",
+                  slice_report.channels, slice_report.slices, (unsigned long)slice_report.duration_us,
+                  (unsigned long)slice_report.max_off_channel_us, scored.top.count);
+    }
+    Catch(err)
+    {
+        switch (err)
+        {
+        case ERR_C_INVALID_ARGS:
+            LOG_ERROR("Buffer size and channels per slice cannot be zero, and slice cap must leave at least %u ms per channel.",
+                      WIFI_C_SCAN_SLICE_MIN_CHANNEL_MS);
+            break;
+        case WIFI_C_ERR_WRONG_MODE:
+            LOG_ERROR("Wrong Wifi mode, scanning only possible in STA mode.");
+            break;
+        case WIFI_C_ERR_WIFI_NOT_INIT:
+            LOG_ERROR("WiFi was not initialized.");
+            break;
+        case WIFI_C_ERR_STA_NOT_STARTED:
+            LOG_ERROR("STA was not started.");
+            break;
+        default:
+            LOG_ERROR("Error when scanning: %d \nESP-IDF error: %s", err, esp_err_to_name((esp_err_t)err));
+            break;
+        }
+        *count = 0;
+        esp_wifi_clear_ap_list();
+    }
+
+    if (report != NULL)
+    {
+        memcpy(report, &slice_report, sizeof(wifi_c_scan_slice_report_t));
+    }
+    return err;
+}
+
+#if WIFI_C_APSTA_POLICY_ENABLED
+/**
+ * @brief Strongest AP with exactly the searched SSID, scan filter patterns would also match wildcards in it.
+ */
+struct wifi_c_apsta_probe_obj {
+    const char *ssid;
+    wifi_ap_record_t *found;
+    bool seen;
+};
+
+static void wifi_c_apsta_probe_collect(const wifi_ap_record_t *record, void *arg)
+{
+    struct wifi_c_apsta_probe_obj *probe = (struct wifi_c_apsta_probe_obj *)arg;
+
+    if (strncmp((const char *)record->ssid, probe->ssid, sizeof(record->ssid)) == 0 &&
+        (!probe->seen || record->rssi > probe->found->rssi))
+    {
+        memcpy(probe->found, record, sizeof(wifi_ap_record_t));
+        probe->seen = true;
+    }
+}
+
+static err_c_t wifi_c_apsta_locate(wifi_c_ctx_t *ctx, const char *ssid, wifi_ap_record_t *found)
+{
+    const wifi_c_apsta_policy_t *policy = &ctx->apsta_policy;
+    wifi_c_scan_slice_config_t slice_config = WIFI_C_SCAN_SLICE_CONFIG_DEFAULT();
+    wifi_c_scan_filter_t filter = WIFI_C_SCAN_FILTER_DEFAULT();
+    wifi_c_scan_slice_report_t slice_report;
+    wifi_ap_record_t candidates[4];
+    uint16_t count = sizeof(candidates) / sizeof(candidates[0]);
+    struct wifi_c_apsta_probe_obj probe = {.ssid = ssid, .found = found, .seen = false};
+    wifi_scan_config_t scan_config = {
+        .ssid = (uint8_t *)ssid,
+        .scan_type = WIFI_SCAN_TYPE_ACTIVE,
+    };
+    wifi_second_chan_t second = WIFI_SECOND_CHAN_NONE;
+    wifi_sta_list_t stations;
+#if WIFI_C_APSTA_CSA_SUPPORTED
+    wifi_config_t ap_config;
+#endif
+    uint8_t ap_channel = 0;
+    err_c_t err = ERR_C_OK;
+
+    /*STA interface is started with WiFi, it has to be up before scanning.*/
+    xEventGroupWaitBits(ctx->event_group, WIFI_C_STA_STARTED_BIT, pdFALSE, pdFALSE, pdMS_TO_TICKS(2000));
+
+    err = esp_wifi_get_channel(&ap_channel, &second);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    /*Probe on AP channel doesn't take radio away from AP clients.*/
+    scan_config.channel = ap_channel;
+    scan_config.scan_time.active.min = 0;
+    scan_config.scan_time.active.max = policy->probe_time_ms;
+    err = wifi_c_scan_run(ctx, &scan_config);
+    if (err == ERR_C_OK)
+    {
+        err = wifi_c_scan_pull_records(ctx, wifi_c_apsta_probe_collect, &probe);
+    }
+    if (err != ERR_C_OK)
+    {
+        return err;
+    }
+    if (probe.seen)
+    {
+        ctx->apsta_stats.same_channel++;
+        ctx->apsta_stats.last_off_channel_us = 0;
+        LOG_INFO("%s found on AP channel %u, AP clients stay undisturbed.", ssid, ap_channel);
+        return ERR_C_OK;
+    }
+
+    /*Other channels one at a time, radio returns to AP channel between them.*/
+    slice_config.channel_mask = (uint16_t)(0x7FFE & ~WIFI_C_SCAN_FILTER_CHANNEL_BIT(ap_channel)); // channels 1-14 but AP one
+    slice_config.channels_per_slice = 1;
+    slice_config.channel_time_ms = policy->max_off_channel_ms;
+    slice_config.max_off_channel_ms = policy->max_off_channel_ms;
+    slice_config.home_dwell_ms = policy->home_dwell_ms;
+    filter.ssid_pattern = ssid;
+    err = wifi_c_ctx_scan_sliced(ctx, &slice_config, &filter, candidates, &count, &slice_report);
+    if (err != ERR_C_OK)
+    {
+        return err;
+    }
+    ctx->apsta_stats.last_off_channel_us = slice_report.max_off_channel_us;
+    if (slice_report.max_off_channel_us > ctx->apsta_stats.max_off_channel_us)
+    {
+        ctx->apsta_stats.max_off_channel_us = slice_report.max_off_channel_us;
+    }
+    for (uint16_t i = 0; i < count; i++)
+    {
+        wifi_c_apsta_probe_collect(&candidates[i], &probe);
+    }
+    if (!probe.seen)
+    {
+        return WIFI_C_ERR_AP_NOT_FOUND;
+    }
+    if (!policy->allow_channel_switch)
+    {
+        return WIFI_C_ERR_AP_CHANNEL_CONFLICT;
+    }
+
+    /*STA link decides channel of shared radio, AP follows it.*/
+    ctx->apsta_stats.channel_switches++;
+    if (esp_wifi_ap_get_sta_list(&stations) == ESP_OK)
+    {
+        ctx->apsta_stats.clients_at_switch = (uint32_t)stations.num;
+    }
+#if WIFI_C_APSTA_CSA_SUPPORTED
+    /*Driver announces switch with count AP was started with, not with count of current policy.*/
+    if (esp_wifi_get_config(WIFI_IF_AP, &ap_config) == ESP_OK && ap_config.ap.csa_count > 0)
+    {
+        ctx->apsta_stats.csa_announced++;
+    }
+#endif
+    LOG_WARN("%s found on channel %u, AP moves from channel %u.", ssid, found->primary, ap_channel);
+    return ERR_C_OK;
+}
+
+int wifi_c_ctx_apsta_set_policy(wifi_c_ctx_t *ctx, const wifi_c_apsta_policy_t *policy)
+{
+    wifi_c_apsta_policy_t default_policy = WIFI_C_APSTA_POLICY_DEFAULT();
+
+    if (policy == NULL)
+    {
+        policy = &default_policy;
+    }
+
+    if (policy->enabled &&
+        (policy->probe_time_ms < WIFI_C_SCAN_SLICE_MIN_CHANNEL_MS || policy->max_off_channel_ms < WIFI_C_SCAN_SLICE_MIN_CHANNEL_MS))
+    {
+        LOG_ERROR("Probe and off-channel time must be at least %u ms.", WIFI_C_SCAN_SLICE_MIN_CHANNEL_MS);
+        return ERR_C_INVALID_ARGS;
+    }
+
+    /*Setting AP config restarts running AP and drops its clients, which policy is there to spare.*/
+    if (ctx->status.ap_started && policy->csa_count != ctx->apsta_policy.csa_count)
+    {
+        LOG_WARN("CSA count %u is used from next AP start, running AP keeps %u.", policy->csa_count,
+                 ctx->apsta_policy.csa_count);
+    }
+    memcpy(&ctx->apsta_policy, policy, sizeof(wifi_c_apsta_policy_t));
+    return ERR_C_OK;
+}
+
+void wifi_c_ctx_apsta_get_stats(wifi_c_ctx_t *ctx, wifi_c_apsta_stats_t *stats)
+{
+    if (stats != NULL)
+    {
+        memcpy(stats, &ctx->apsta_stats, sizeof(*stats));
+    }
+}
+#endif
+
+#if WIFI_C_AUTO_CHANNEL_ENABLED
+static void wifi_c_scan_add_to_scores(const wifi_ap_record_t *record, void *arg)
+{
+    wifi_c_channel_scores_add((wifi_c_channel_scores_t *)arg, record);
+}
+
+/**
+ * @brief Scan and score congestion, channel 0 sweeps all channels.
+ *
+ * Single channel is listened to passively, so radio stays on AP channel when it's the measured one.
+ */
+static int wifi_c_measure(wifi_c_ctx_t *ctx, uint8_t channel, wifi_c_channel_scores_t *scores)
+{
+    volatile err_c_t err = ERR_C_OK;
+    volatile bool sta_borrowed = false;
+    wifi_scan_config_t scan_config = {
+        .channel = channel,
+        .show_hidden = 1, // hidden APs congest channel too
+        .scan_type = WIFI_SCAN_TYPE_ACTIVE,
+        .scan_time.active.min = 0,
+        .scan_time.active.max = WIFI_C_CHANNEL_SCAN_TIME_MS,
+    };
+
+    ERR_C_CHECK_NULL_PTR(scores, LOG_ERROR("pointer to store channel scores cannot be NULL"));
+    if (channel != 0)
+    {
+        scan_config.scan_type = WIFI_SCAN_TYPE_PASSIVE;
+        scan_config.scan_time.passive = WIFI_C_CHANNEL_SCAN_TIME_MS;
+    }
+
+    Try
+    {
+        if (!ctx->status.wifi_initialized)
+        {
+            ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_WIFI_NOT_INIT);
+        }
+        if (ctx->status.suspended)
+        {
+            ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_WIFI_NOT_STARTED); // borrowing STA would start radio
+        }
+
+        /*Driver can't scan in AP mode, enable STA only for time of the scan.*/
+        if (ctx->status.wifi_mode == WIFI_C_MODE_AP)
+        {
+            ERR_C_CHECK_AND_THROW_ERR(wifi_c_shared_claim(ctx, WIFI_C_MODE_APSTA));
+            sta_borrowed = true;
+            ERR_C_CHECK_AND_THROW_ERR(esp_wifi_set_mode(WIFI_MODE_APSTA));
+            ctx->status.wifi_mode = WIFI_C_MODE_APSTA;
+            xEventGroupWaitBits(ctx->event_group, WIFI_C_STA_STARTED_BIT, pdFALSE, pdFALSE, pdMS_TO_TICKS(2000));
+        }
+
+        wifi_c_channel_scores_clear(scores);
+        ERR_C_CHECK_AND_THROW_ERR(wifi_c_scan_start_and_wait(ctx, &scan_config));
+        ERR_C_CHECK_AND_THROW_ERR(wifi_c_scan_pull_records(ctx, wifi_c_scan_add_to_scores, scores));
+    }
+    Catch(err)
+    {
+        switch (err)
+        {
+        case WIFI_C_ERR_WIFI_NOT_INIT:
+            LOG_ERROR("WiFi was not initialized.");
+            break;
+        case WIFI_C_ERR_STA_NOT_STARTED:
+            LOG_ERROR("STA was not started.");
+            break;
+        default:
+            LOG_ERROR("Error when measuring channels: %d \nESP-IDF error: %s", err, esp_err_to_name((esp_err_t)err));
+            break;
+        }
+        esp_wifi_clear_ap_list();
+    }
+
+    if (sta_borrowed)
+    {
+        wifi_c_shared_claim(ctx, WIFI_C_MODE_AP);
+        esp_wifi_set_mode(wifi_c_shared_driver_mode());
+        ctx->status.wifi_mode = WIFI_C_MODE_AP;
+        ctx->status.sta_started = false;
+        xEventGroupClearBits(ctx->event_group, WIFI_C_STA_STARTED_BIT);
+    }
+
+    return err;
+}
+
+int wifi_c_ctx_measure_channels(wifi_c_ctx_t *ctx, wifi_c_channel_scores_t *scores)
+{
+    return wifi_c_measure(ctx, 0, scores);
+}
+
+int wifi_c_ctx_measure_channel(wifi_c_ctx_t *ctx, uint8_t channel, wifi_c_channel_scores_t *scores)
+{
+    if (channel < 1 || channel > WIFI_C_CHANNEL_MAX)
+    {
+        LOG_ERROR("Channel %u is not a 2.4 GHz channel.", channel);
+        return ERR_C_INVALID_ARGS;
+    }
+    return wifi_c_measure(ctx, channel, scores);
+}
+
+int wifi_c_ctx_start_ap_auto_channel(wifi_c_ctx_t *ctx, const char *ssid, const char *password, uint16_t channel_mask, uint8_t *channel)
+{
+    err_c_t err = ERR_C_OK;
+    wifi_c_channel_scores_t scores;
+    wifi_second_chan_t second = WIFI_SECOND_CHAN_NONE;
+    wifi_c_ap_config_t config = WIFI_C_AP_CONFIG_DEFAULT();
+    uint8_t selected = 0;
+
+    if (ctx->status.wifi_initialized != true)
+    {
+        LOG_WARN("WiFi not init, initializing...");
+        err = wifi_c_ctx_init_wifi(ctx, WIFI_C_MODE_AP);
+        if (err != ERR_C_OK)
+        {
+            return err;
+        }
+    }
+
+    if (ctx->status.sta_connected)
+    {
+        // AP has to follow channel of AP which STA is connected to
+        esp_wifi_get_channel(&selected, &second);
+        LOG_WARN("STA is connected, AP will use its channel %u.", selected);
+    }
+    else
+    {
+        err = wifi_c_ctx_measure_channels(ctx, &scores);
+        if (err != ERR_C_OK)
+        {
+            return err;
+        }
+        selected = wifi_c_channel_pick_best(&scores, channel_mask);
+        if (selected == 0)
+        {
+            LOG_ERROR("No valid channel in channel mask 0x%04x.", channel_mask);
+            return ERR_C_INVALID_ARGS;
+        }
+        LOG_INFO("Least congested channel: %u, score %lu, %u APs.", selected,
+                 (unsigned long)scores.score[selected], scores.ap_count[selected]);
+    }
+
+    config.ssid = ssid;
+    config.password = password;
+    config.channel = selected;
+    err = wifi_c_ctx_start_ap_with_config(ctx, &config);
+    if (err == ERR_C_OK && channel != NULL)
+    {
+        *channel = selected;
+    }
+    return err;
+}
+#endif
+
+/**
+ * @brief Scan state of BSSID selection, every AP adds to channel load, only APs of SSID are candidates.
+ */
+struct wifi_c_bssid_scan_obj {
+    const char *ssid;
+    wifi_c_scan_top_t top;
+    wifi_c_channel_scores_t scores;
+};
+
+static void wifi_c_bssid_scan_collect(const wifi_ap_record_t *record, void *arg)
+{
+    struct wifi_c_bssid_scan_obj *scan = (struct wifi_c_bssid_scan_obj *)arg;
+
+    wifi_c_channel_scores_add(&scan->scores, record);
+    if (strncmp((const char *)record->ssid, scan->ssid, sizeof(record->ssid)) == 0)
+    {
+        wifi_c_scan_top_push(&scan->top, record);
+    }
+}
+
+int wifi_c_ctx_start_sta_best_bssid(wifi_c_ctx_t *ctx, const char *ssid, const char *password,
+                                    const wifi_c_bssid_select_config_t *config, wifi_ap_record_t *selected)
+{
+    volatile err_c_t err = ERR_C_OK;
+    wifi_c_bssid_select_config_t default_config = WIFI_C_BSSID_SELECT_CONFIG_DEFAULT();
+    wifi_ap_record_t candidates[WIFI_C_DEFAULT_SCAN_SIZE];
+    struct wifi_c_bssid_scan_obj scan;
+    wifi_scan_config_t scan_config = {
+        .show_hidden = 0 // Don't  show hidden AP.
+    };
+    const wifi_ap_record_t *best = NULL;
+
+    ERR_C_CHECK_NULL_PTR(ssid, LOG_ERROR("SSID cannot be NULL"));
+
+    if (config == NULL)
+    {
+        config = &default_config;
+    }
+    if (password == NULL)
+    {
+        password = "";
+    }
+
+    Try
+    {
+        ERR_C_CHECK_AND_THROW_ERR(wifi_c_sta_prepare(ctx, ssid));
+
+        /*STA interface is started with WiFi, it has to be up before scanning.*/
+        xEventGroupWaitBits(ctx->event_group, WIFI_C_STA_STARTED_BIT, pdFALSE, pdFALSE, pdMS_TO_TICKS(2000));
+
+        memutil_zero_memory(&scan, sizeof(scan));
+        scan.ssid = ssid;
+        wifi_c_scan_top_init(&scan.top, NULL, candidates, WIFI_C_DEFAULT_SCAN_SIZE);
+        if (config->load_penalty_db == 0)
+        {
+            scan_config.ssid = (uint8_t *)ssid; // load of other APs is not needed, probe only for SSID
+        }
+        ERR_C_CHECK_AND_THROW_ERR(wifi_c_scan_start_and_wait(ctx, &scan_config));
+        ERR_C_CHECK_AND_THROW_ERR(wifi_c_scan_pull_records(ctx, wifi_c_bssid_scan_collect, &scan));
+
+        best = wifi_c_bssid_pick_best(config, (config->load_penalty_db != 0) ? &scan.scores : NULL,
+                                      ssid, candidates, scan.top.count);
+        if (best == NULL)
+        {
+            ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_AP_NOT_FOUND);
+        }
+        LOG_INFO("Selected BSSID " MACSTR " on channel %u, RSSI %d, out of %u BSSIDs.",
+                 MAC2STR(best->bssid), best->primary, best->rssi, scan.top.count);
+
+        ERR_C_CHECK_AND_THROW_ERR(wifi_c_sta_connect(ctx, ssid, password, best, true));
+        if (selected != NULL)
+        {
+            memcpy(selected, best, sizeof(wifi_ap_record_t));
+        }
+    }
+    Catch(err)
+    {
+        switch (err)
+        {
+        case WIFI_C_ERR_AP_NOT_FOUND:
+            LOG_ERROR("No BSSID of %s matches selection criteria.", ssid);
+            break;
+        case WIFI_C_ERR_WRONG_MODE:
+            LOG_ERROR("Wrong Wifi mode.");
+            break;
+        case WIFI_C_ERR_NULL_SSID:
+            LOG_ERROR("SSID cannot be null");
+            break;
+        case WIFI_C_ERR_STA_NOT_STARTED:
+            LOG_ERROR("STA was not started.");
+            break;
+        default:
+            LOG_ERROR("Error when connecting to best BSSID: %d", err);
+            break;
+        }
+    }
+    return err;
+}
+
+int wifi_c_ctx_sta_roam_to(wifi_c_ctx_t *ctx, const uint8_t bssid[6], uint8_t channel)
+{
+    err_c_t err = ERR_C_OK;
+    wifi_config_t wifi_sta_config;
+
+    ERR_C_CHECK_NULL_PTR(bssid, LOG_ERROR("BSSID to roam to cannot be NULL"));
+
+    if (!ctx->status.sta_connected)
+    {
+        LOG_ERROR("STA is not connected, there is nothing to roam from.");
+        return WIFI_C_ERR_STA_NOT_CONNECTED;
+    }
+
+    /*SSID and password stay as they are, only target BSSID changes.*/
+    ctx->resume_pinned = false;
+    err = esp_wifi_get_config(WIFI_IF_STA, &wifi_sta_config);
+    if (err == ESP_OK)
+    {
+        wifi_sta_config.sta.bssid_set = true;
+        memcpy(wifi_sta_config.sta.bssid, bssid, sizeof(wifi_sta_config.sta.bssid));
+        wifi_sta_config.sta.channel = channel;
+        wifi_sta_config.sta.scan_method = (channel != 0) ? WIFI_FAST_SCAN : WIFI_ALL_CHANNEL_SCAN;
+        wifi_sta_config.sta.rm_enabled = ctx->sta_11kv;
+        wifi_sta_config.sta.btm_enabled = ctx->sta_11kv;
+        err = esp_wifi_set_config(WIFI_IF_STA, &wifi_sta_config);
+    }
+    if (err != ESP_OK)
+    {
+        LOG_ERROR("error %d when configuring roam target: %s", err, error_to_name(err));
+        return err;
+    }
+
+    /*Disconnect handler reconnects to new target, roam gets whole retry budget.*/
+    ctx->sta_link.retry_num = 0;
+    xEventGroupClearBits(ctx->event_group, WIFI_C_STA_LINK_UP_BIT | WIFI_C_CONNECTED_BIT);
+    err = esp_wifi_disconnect();
+    if (err != ESP_OK)
+    {
+        LOG_ERROR("error %d when leaving current AP: %s", err, error_to_name(err));
+        return err;
+    }
+    LOG_INFO("Roaming to " MACSTR " on channel %u.", MAC2STR(bssid), channel);
+    return ERR_C_OK;
+}
+
+void wifi_c_ctx_sta_set_11kv(wifi_c_ctx_t *ctx, bool enable)
+{
+    ctx->sta_11kv = enable;
+}
+
+int wifi_c_ctx_scan_for_ap_with_ssid(wifi_c_ctx_t *ctx, const char *searched_ssid, wifi_c_ap_record_t *ap_record)
+{
+    volatile err_c_t err = ERR_C_OK;
+    assert(searched_ssid);
+    wifi_ap_record_t *record;
+    bool success = false;
+
+    Try
+    {
+        assert(&ctx->scan_info);
+        record = ctx->scan_info.ap_record;
+        uint8_t ssid_len = strlen(searched_ssid);
+
+        for (uint16_t i = 0; i < ctx->scan_info.ap_count; i++)
+        {
+            const char *ssid = (char *)(record->ssid);
+            if (strncmp(searched_ssid, ssid, ssid_len) == 0)
+            {
+                LOG_INFO("Found %s AP.", searched_ssid);
+                success = true;
+                break;
+            }
+            record++;
+        }
+        if (success)
+        {
+            memcpy(ap_record, record, sizeof(wifi_ap_record_t));
+        }
+        else
+        {
+            ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_AP_NOT_FOUND);
+        }
+    }
+    Catch(err)
+    {
+        switch (err)
+        {
+        case WIFI_C_ERR_AP_NOT_FOUND:
+            LOG_WARN("Not found desired AP.");
+            break;
+        default:
+            LOG_ERROR("Error when scanning: %d \nESP-IDF error: %s", err, esp_err_to_name((esp_err_t)err));
+            esp_wifi_clear_ap_list(); // Clear AP list found in last scan
+            break;
+        }
+    }
+
+    return err;
+}
+
+/**
+ * @todo Change print format.
+ */
+int wifi_c_ctx_print_scanned_ap(wifi_c_ctx_t *ctx)
+{
+    volatile err_c_t err = ERR_C_OK;
+    Try
+    {
+        if (!(ctx->status.wifi_initialized))
+        {
+            ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_WIFI_NOT_INIT);
+        }
+
+        /*If scan is not yet done, wait for a while before continuing
+        Then bits, if it's again not done, then throw errror.*/
+        if (!(ctx->status.scan_done))
+        {
+            EventBits_t bits = xEventGroupWaitBits(ctx->event_group, WIFI_C_SCAN_DONE_BIT, pdFALSE, pdFALSE, pdMS_TO_TICKS(1000));
+            if ((bits & WIFI_C_SCAN_DONE_BIT) != WIFI_C_SCAN_DONE_BIT)
+            {
+                ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_SCAN_NOT_DONE);
+            }
+        }
+
+        wifi_ap_record_t *record = ctx->scan_info.ap_record;
+        for (uint16_t i = 0; i < WIFI_C_DEFAULT_SCAN_SIZE; i++)
+        {
+            const char *ssid = (char *)(record->ssid);
+            int8_t rssi = record->rssi;
+            LOG_INFO("SSID \t%s", ssid);
+            LOG_INFO("RSSI \t%d", rssi);
+            record++;
+        }
+    }
+    Catch(err)
+    {
+        switch (err)
+        {
+        case WIFI_C_ERR_SCAN_NOT_DONE:
+            LOG_ERROR("Scan not done, init scan before getting results.");
+            break;
+        case WIFI_C_ERR_WIFI_NOT_INIT:
+            LOG_ERROR("WiFi was not initialized.");
+            break;
+        default:
+            LOG_ERROR("Error when getting scan results: %d \nESP-IDF error: %s", err, esp_err_to_name((esp_err_t)err));
+            break;
+        }
+    }
+
+    return err;
+}
+
+#if WIFI_C_JSON_ENABLED
+int wifi_c_ctx_store_scan_result_as_json(wifi_c_ctx_t *ctx, char *buffer, uint16_t buflen)
+{
+    volatile err_c_t err = ERR_C_OK;
+    ERR_C_CHECK_NULL_PTR(buffer, LOG_ERROR("buffer to store scanned APs cannot be NULL"));
+    Try
+    {
+        if (!(ctx->status.wifi_initialized))
+        {
+            ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_WIFI_NOT_INIT);
+        }
+
+        /*If scan is not yet done, wait for a while before continuing
+        Then bits, if it's again not done, then throw errror.*/
+        if (!(ctx->status.scan_done))
+        {
+            EventBits_t bits = xEventGroupWaitBits(ctx->event_group, WIFI_C_SCAN_DONE_BIT, pdFALSE, pdFALSE, pdMS_TO_TICKS(1000));
+            if ((bits & WIFI_C_SCAN_DONE_BIT) != WIFI_C_SCAN_DONE_BIT)
+            {
+                ERR_C_SET_AND_THROW_ERR(err, WIFI_C_ERR_SCAN_NOT_DONE);
+            }
+        }
+
+        char ap[100];
+        uint16_t ap_len = 0;
+        uint16_t space_left = buflen;
+        uint16_t index = 0;
+        wifi_ap_record_t *record = ctx->scan_info.ap_record;
+        for (uint16_t i = 0; i < WIFI_C_DEFAULT_SCAN_SIZE; i++)
+        {
+            memutil_zero_memory(&ap, sizeof(ap));
+            char *ssid = (char *)(record->ssid);
+
+            sprintf(&ap[0], ", {\"ssid\": \"%s\", \"rssi\": %d}", ssid, record->rssi);
+            ap_len = strlen(&ap[0]);
+            memcpy(&(buffer[index]), &ap[0], ap_len);
+            space_left -= ap_len;
+            index += ap_len;
+            record++;
+        }
+        // delete first comma nad insert json array
+        buffer[index++] = ']';
+        buffer[0] = '[';
+
+        // null terminate end result
+        buffer[index] = '\0';
+    }
+    Catch(err)
+    {
+        switch (err)
+        {
+        case WIFI_C_ERR_SCAN_NOT_DONE:
+            LOG_ERROR("Scan not done, init scan before getting results.");
+            break;
+        case WIFI_C_ERR_WIFI_NOT_INIT:
+            LOG_ERROR("WiFi was not initialized.");
+            break;
+        default:
+            LOG_ERROR("Error when getting scan results: %d \nESP-IDF error: %s", err, esp_err_to_name((esp_err_t)err));
+            break;
+        }
+    }
+
+    return err;
+}
+
+/**
+ * @brief Check that scan results are stored and give their records.
+ *
+ * @param[out] record   Records stored in context.
+ * @param[in,out] count Capacity of caller on input, number of records to read on output.
+ */
+static int wifi_c_scan_stored_records(wifi_c_ctx_t *ctx, const wifi_ap_record_t **record, uint16_t *count)
+{
+    if (!(ctx->status.wifi_initialized))
+    {
+        LOG_ERROR("WiFi was not initialized.");
+        return WIFI_C_ERR_WIFI_NOT_INIT;
+    }
+    if (!(ctx->status.scan_done) || ctx->scan_info.ap_record == NULL)
+    {
+        LOG_ERROR("Scan not done, init scan before getting results.");
+        return WIFI_C_ERR_SCAN_NOT_DONE;
+    }
+
+    // ap_count is number of APs found, only WIFI_C_DEFAULT_SCAN_SIZE records are stored
+    *record = ctx->scan_info.ap_record;
+    if (*count > ctx->scan_info.ap_count)
+    {
+        *count = ctx->scan_info.ap_count;
+    }
+    if (*count > WIFI_C_DEFAULT_SCAN_SIZE)
+    {
+        *count = WIFI_C_DEFAULT_SCAN_SIZE;
+    }
+    return ERR_C_OK;
+}
+
+/**
+ * @brief Stream scanned APs as JSON array, records may be copy taken on controller task.
+ */
+static int wifi_c_scan_stream_json(const wifi_ap_record_t *record, uint16_t count, wifi_c_stream_sink_t sink, void *arg)
+{
+    wifi_c_stream_t stream;
+
+    wifi_c_stream_init(&stream, sink, arg);
+    wifi_c_stream_write(&stream, "[", 1);
+    for (uint16_t i = 0; i < count; i++, record++)
+    {
+        wifi_c_stream_printf(&stream, "%s{\"ssid\": ", (i > 0) ? ", " : "");
+        wifi_c_stream_json_string(&stream, (const char *)record->ssid, sizeof(record->ssid));
+        wifi_c_stream_printf(&stream, ", \"bssid\": \"" MACSTR "\", \"channel\": %u, \"rssi\": %d, \"authmode\": %d}",
+                             MAC2STR(record->bssid), record->primary, record->rssi, (int)record->authmode);
+    }
+    wifi_c_stream_write(&stream, "]", 1);
+
+    return wifi_c_stream_finish(&stream);
+}
+
+int wifi_c_ctx_stream_scan_json(wifi_c_ctx_t *ctx, wifi_c_stream_sink_t sink, void *arg)
+{
+    const wifi_ap_record_t *record = NULL;
+    uint16_t count = WIFI_C_DEFAULT_SCAN_SIZE;
+    int err = ERR_C_OK;
+
+    ERR_C_CHECK_NULL_PTR(sink, LOG_ERROR("sink of scanned APs cannot be NULL"));
+
+    // nothing is sent on error, so caller can still answer with error status
+    err = wifi_c_scan_stored_records(ctx, &record, &count);
+    if (err != ERR_C_OK)
+    {
+        return err;
+    }
+    return wifi_c_scan_stream_json(record, count, sink, arg);
+}
+#endif // WIFI_C_JSON_ENABLED
+#endif // WIFI_C_SCAN_ENABLED
+
+#if WIFI_C_STA_ENABLED
+int wifi_c_ctx_disconnect(wifi_c_ctx_t *ctx)
+{
+    err_c_t err = 0;
+    err = esp_wifi_disconnect();
+    if (err != ESP_OK)
+    {
+        LOG_ERROR("error %d when trying to disconnect: %s", err, error_to_name(err));
+        return err;
+    }
+    ctx->status.sta_connected = false;
+
+    // update IP
+    memutil_zero_memory(&(ctx->status.sta.ip), sizeof(ctx->status.sta.ip));
+    memcpy(&(ctx->status.sta.ip), "0.0.0.0", strlen("0.0.0.0"));
+
+    // update ap_ssid
+    memutil_zero_memory((&ctx->status.sta.ssid), sizeof(ctx->status.sta.ssid));
+    memcpy(&(ctx->status.sta.ssid), "none", strlen("none"));
+
+    return err;
+}
+#endif
+
+#if WIFI_C_EVENT_TRACE_ENABLED
+/**
+ * @brief Rebuild event data from trace record, netif pointers are taken from context.
+ *
+ * @return Pointer to event data, NULL for events without data.
+ */
+static void *wifi_c_trace_decode(wifi_c_ctx_t *ctx, const wifi_c_trace_event_t *event, void *data, size_t size, bool *valid)
+{
+    memutil_zero_memory(data, size);
+    *valid = true;
+
+    if (event->record.base == WIFI_C_TRACE_BASE_IP)
+    {
+        if (event->record.id != IP_EVENT_STA_GOT_IP || event->record.len < sizeof(esp_netif_ip_info_t) + 1)
+        {
+            *valid = false; // only handled IP event is got IP
+            return NULL;
+        }
+        ip_event_got_ip_t *got_ip = (ip_event_got_ip_t *)data;
+        memcpy(&got_ip->ip_info, event->payload, sizeof(esp_netif_ip_info_t));
+        got_ip->ip_changed = event->payload[sizeof(esp_netif_ip_info_t)];
+#if WIFI_C_STA_ENABLED
+        got_ip->esp_netif = ctx->netif_handle_sta;
+#endif
+        return data;
+    }
+
+    if (event->record.base != WIFI_C_TRACE_BASE_WIFI)
+    {
+        *valid = false;
+        return NULL;
+    }
+    switch (event->record.id)
+    {
+    case WIFI_EVENT_STA_DISCONNECTED:
+    case WIFI_EVENT_AP_STACONNECTED:
+    case WIFI_EVENT_AP_STADISCONNECTED:
+        if (event->record.len == 0)
+        {
+            *valid = false; // handlers read data of these events
+            return NULL;
+        }
+        break;
+    default:
+        break;
+    }
+    if (event->record.len == 0)
+    {
+        return NULL;
+    }
+    memcpy(data, event->payload, (event->record.len < size) ? event->record.len : size);
+    return data;
+}
+
+int wifi_c_ctx_trace_replay(wifi_c_ctx_t *ctx, const uint8_t *trace, size_t len, wifi_c_trace_speed_t speed, wifi_c_trace_replay_stats_t *stats)
+{
+    union {
+        ip_event_got_ip_t got_ip;
+        wifi_event_sta_scan_done_t scan_done;
+        wifi_event_sta_connected_t sta_connected;
+        wifi_event_sta_disconnected_t sta_disconnected;
+        wifi_event_ap_staconnected_t ap_staconnected;
+        wifi_event_ap_stadisconnected_t ap_stadisconnected;
+    } data;
+    wifi_c_trace_replay_stats_t result = {0};
+    wifi_c_trace_event_t event;
+    size_t offset = 0;
+    int64_t start_us = esp_timer_get_time();
+    int64_t due_us = 0;
+
+    if (!wifi_c_trace_begin(trace, len, &offset))
+    {
+        LOG_ERROR("Trace header is not valid.");
+        return ERR_C_INVALID_ARGS;
+    }
+    if (!ctx->status.even_loop_started)
+    {
+        LOG_ERROR("Event loop was not initialized, there are no handlers to replay trace to.");
+        return WIFI_C_ERR_EVENT_LOOP_NOT_INIT;
+    }
+    if (ctx->status.wifi_initialized)
+    {
+        LOG_ERROR("Context owns interfaces, its live events would mix with replayed ones.");
+        return WIFI_C_ERR_WIFI_ALREADY_INIT;
+    }
+
+    ctx->replaying = true;
+    while (wifi_c_trace_next(trace, len, &offset, &event))
+    {
+        bool valid = false;
+        void *event_data = wifi_c_trace_decode(ctx, &event, &data, sizeof(data), &valid);
+        esp_event_base_t base = (event.record.base == WIFI_C_TRACE_BASE_IP) ? IP_EVENT : WIFI_EVENT;
+
+        if (speed == WIFI_C_TRACE_REPLAY_REAL_TIME)
+        {
+            int64_t now_us = esp_timer_get_time() - start_us;
+            due_us += event.record.delta_us;
+            if (due_us > now_us)
+            {
+                vTaskDelay(pdMS_TO_TICKS((due_us - now_us) / 1000));
+            }
+        }
+        if (!valid)
+        {
+            result.skipped++;
+            continue;
+        }
+
+        int64_t handler_start_us = esp_timer_get_time();
+#if WIFI_C_AP_ENABLED
+        wifi_c_ap_event_handler(ctx, base, event.record.id, event_data);
+#endif
+#if WIFI_C_STA_ENABLED
+        wifi_c_sta_event_handler(ctx, base, event.record.id, event_data);
+#endif
+        uint32_t handler_us = (uint32_t)(esp_timer_get_time() - handler_start_us);
+        result.handler_time_us += handler_us;
+        if (handler_us > result.handler_max_us)
+        {
+            result.handler_max_us = handler_us;
+        }
+        result.events++;
+    }
+    ctx->replaying = false;
+    result.duration_us = (uint32_t)(esp_timer_get_time() - start_us);
+
+    LOG_INFO("Replayed %lu events, %lu skipped, %lu us in handlers, longest %lu us",
+             (unsigned long)result.events, (unsigned long)result.skipped,
+             (unsigned long)result.handler_time_us, (unsigned long)result.handler_max_us);
+    if (stats != NULL)
+    {
+        *stats = result;
+    }
+    return ERR_C_OK;
+}
+#endif
+
+int wifi_c_ctx_suspend(wifi_c_ctx_t *ctx)
+{
+    esp_err_t err = ESP_OK;
+#if WIFI_C_STA_ENABLED
+    wifi_ap_record_t ap_info;
+    bool sta_was_started = ctx->status.sta_started;
+#endif
+
+    if (!ctx->status.wifi_initialized)
+    {
+        LOG_ERROR("WiFi was not initialized.");
+        return WIFI_C_ERR_WIFI_NOT_INIT;
+    }
+    if (ctx->status.suspended)
+    {
+        LOG_WARN("WiFi is already suspended.");
+        return ERR_C_OK;
+    }
+    if (wifi_c_shared.driver_users > 1)
+    {
+        LOG_ERROR("Suspend stops driver of all contexts, other contexts are initialized.");
+        return WIFI_C_ERR_IFACE_BUSY;
+    }
+
+#if WIFI_C_STA_ENABLED
+    ctx->resume_connect = false;
+    if (ctx->status.sta_connected && esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK)
+    {
+        /*Pinned config is the one set by previous resume, keep config from before it.*/
+        if (!ctx->resume_pinned)
+        {
+            err = esp_wifi_get_config(WIFI_IF_STA, &ctx->resume_config);
+            if (err != ESP_OK)
+            {
+                LOG_ERROR("error %d when reading STA config: %s", err, error_to_name(err));
+                return err;
+            }
+        }
+        memcpy(ctx->resume_bssid, ap_info.bssid, sizeof(ctx->resume_bssid));
+        ctx->resume_channel = ap_info.primary;
+        ctx->resume_connect = true;
+    }
+    ctx->resume_pinned = false;
+    if (ctx->lease_timer != NULL)
+    {
+        esp_timer_stop(ctx->lease_timer);
+    }
+#endif
+    ctx->resume_ap = ctx->status.ap_started;
+
+    /*Set before stopping, so disconnect handler doesn't reconnect.*/
+    ctx->status.suspended = true;
+    err = esp_wifi_stop();
+    if (err != ESP_OK)
+    {
+        ctx->status.suspended = false;
+        LOG_ERROR("error %d when stopping WiFi: %s", err, error_to_name(err));
+        return err;
+    }
+
+#if WIFI_C_STA_ENABLED
+    /*Disconnect and stop events of stopped STA must be handled before resume can start it again.*/
+    for (int i = 0; sta_was_started && i < 100 && (xEventGroupGetBits(ctx->event_group) & WIFI_C_STA_STARTED_BIT); i++)
+    {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    ctx->status.sta_started = false;
+    memutil_zero_memory(&(ctx->status.sta.ip), sizeof(ctx->status.sta.ip));
+    memcpy(&(ctx->status.sta.ip), "0.0.0.0", strlen("0.0.0.0"));
+#endif
+    ctx->status.ap_started = false;
+    ctx->status.sta_connected = false;
+    ctx->resume_stats.suspends++;
+
+#if WIFI_C_STA_ENABLED
+    if (ctx->resume_connect)
+    {
+        LOG_INFO("WiFi suspended, STA will resume to " MACSTR " on channel %u.", MAC2STR(ctx->resume_bssid), ctx->resume_channel);
+        return ERR_C_OK;
+    }
+#endif
+    LOG_INFO("WiFi suspended.");
+    return ERR_C_OK;
+}
+
+#if WIFI_C_STA_ENABLED
+/**
+ * @brief Wait until any of bits is set or deadline passes.
+ */
+static EventBits_t wifi_c_resume_wait(wifi_c_ctx_t *ctx, EventBits_t bits, int64_t deadline_us)
+{
+    int64_t left_us = deadline_us - esp_timer_get_time();
+
+    if (left_us < 0)
+    {
+        left_us = 0;
+    }
+    return xEventGroupWaitBits(ctx->event_group, bits, pdFALSE, pdFALSE, pdMS_TO_TICKS(left_us / 1000));
+}
+
+/**
+ * @brief Connect STA to cached BSSID, then to any AP of SSID if cached one fails, and wait for IP.
+ */
+static err_c_t wifi_c_resume_sta(wifi_c_ctx_t *ctx, int64_t start_us, uint32_t timeout_ms)
+{
+    int64_t deadline_us = start_us + (int64_t)timeout_ms * 1000;
+    EventBits_t bits = 0;
+    uint32_t ip_ms = 0;
+    esp_err_t err = ESP_OK;
+
+    /*Wait till sta started before trying to connect.*/
+    xEventGroupWaitBits(ctx->event_group, WIFI_C_STA_STARTED_BIT, pdFALSE, pdFALSE, pdMS_TO_TICKS(2000));
+    xEventGroupClearBits(ctx->event_group, WIFI_C_CONNECTED_BIT | WIFI_C_CONNECT_FAIL_BIT);
+
+    /*Cached BSSID gets one attempt, disconnect handler unpins STA and reports failure at once.*/
+    ctx->sta_link.retry_num = ctx->sta_link.retry_count;
+    WIFI_C_METRIC(wifi_c_metrics_connect_attempt());
+    WIFI_C_SPAN_ASYNC_BEGIN(WIFI_C_SPAN_CONNECT);
+    err = esp_wifi_connect();
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+
+    bits = wifi_c_resume_wait(ctx, WIFI_C_STA_LINK_UP_BIT | WIFI_C_CONNECTED_BIT | WIFI_C_CONNECT_FAIL_BIT, deadline_us);
+    if (bits & WIFI_C_CONNECT_FAIL_BIT)
+    {
+        LOG_WARN("Cached AP " MACSTR " not reachable, connecting to any AP of SSID.", MAC2STR(ctx->resume_bssid));
+        ctx->resume_stats.fallbacks++;
+        ctx->sta_link.retry_num = 0;
+        xEventGroupClearBits(ctx->event_group, WIFI_C_CONNECT_FAIL_BIT);
+        WIFI_C_METRIC(wifi_c_metrics_connect_attempt());
+        WIFI_C_SPAN_ASYNC_BEGIN(WIFI_C_SPAN_CONNECT);
+        err = esp_wifi_connect();
+        if (err != ESP_OK)
+        {
+            return err;
+        }
+        bits = wifi_c_resume_wait(ctx, WIFI_C_STA_LINK_UP_BIT | WIFI_C_CONNECTED_BIT | WIFI_C_CONNECT_FAIL_BIT, deadline_us);
+    }
+    if (bits & (WIFI_C_STA_LINK_UP_BIT | WIFI_C_CONNECTED_BIT))
+    {
+        ctx->resume_stats.last_link_ms = (uint32_t)((esp_timer_get_time() - start_us) / 1000);
+    }
+
+    bits = wifi_c_resume_wait(ctx, WIFI_C_CONNECTED_BIT | WIFI_C_CONNECT_FAIL_BIT, deadline_us);
+    if (bits & WIFI_C_CONNECTED_BIT)
+    {
+        ip_ms = (uint32_t)((esp_timer_get_time() - start_us) / 1000);
+        ctx->resume_stats.last_ip_ms = ip_ms;
+        if (ip_ms > ctx->resume_stats.max_ip_ms)
+        {
+            ctx->resume_stats.max_ip_ms = ip_ms;
+        }
+        WIFI_C_METRIC(wifi_c_metrics_resume_done(ip_ms * 1000));
+
+        memutil_zero_memory(&(ctx->status.sta.ssid), sizeof(ctx->status.sta.ssid));
+        memcpy(&(ctx->status.sta.ssid), ctx->resume_config.sta.ssid, sizeof(ctx->resume_config.sta.ssid));
+        LOG_INFO("STA resumed, associated after %lu ms, IP after %lu ms.",
+                 (unsigned long)ctx->resume_stats.last_link_ms, (unsigned long)ip_ms);
+        return ERR_C_OK;
+    }
+    if (bits & WIFI_C_CONNECT_FAIL_BIT)
+    {
+        return WIFI_C_ERR_STA_CONNECT_FAIL;
+    }
+    ctx->sta_link.retry_num = 0; // keep connecting in background with whole retry budget
+    return WIFI_C_ERR_STA_TIMEOUT_EXPIRE;
+}
+#endif
+
+int wifi_c_ctx_resume(wifi_c_ctx_t *ctx, uint32_t timeout_ms)
+{
+    volatile err_c_t err = ERR_C_OK;
+    volatile bool started = false;
+#if WIFI_C_STA_ENABLED
+    int64_t start_us = esp_timer_get_time();
+    wifi_config_t pinned_config;
+    char ssid[33] = {0};
+#endif
+
+    if (!ctx->status.suspended)
+    {
+        LOG_ERROR("WiFi was not suspended.");
+        return WIFI_C_ERR_NOT_SUSPENDED;
+    }
+
+    Try
+    {
+#if WIFI_C_STA_ENABLED
+        if (ctx->resume_connect)
+        {
+            /*Channel and BSSID are known, driver doesn't have to sweep all channels.*/
+            memcpy(&pinned_config, &ctx->resume_config, sizeof(pinned_config));
+            pinned_config.sta.bssid_set = true;
+            memcpy(pinned_config.sta.bssid, ctx->resume_bssid, sizeof(pinned_config.sta.bssid));
+            pinned_config.sta.channel = ctx->resume_channel;
+            pinned_config.sta.scan_method = WIFI_FAST_SCAN;
+            ERR_C_CHECK_AND_THROW_ERR(esp_wifi_set_config(WIFI_IF_STA, &pinned_config));
+            ctx->resume_pinned = true;
+            memcpy(ssid, ctx->resume_config.sta.ssid, sizeof(ctx->resume_config.sta.ssid));
+            ERR_C_CHECK_AND_THROW_ERR(wifi_c_sta_apply_ip_config(ctx, ssid));
+        }
+#endif
+        ctx->status.suspended = false;
+        ERR_C_CHECK_AND_THROW_ERR(esp_wifi_start());
+        started = true;
+        ctx->status.ap_started = ctx->resume_ap;
+
+#if WIFI_C_STA_ENABLED
+        if (ctx->resume_connect)
+        {
+            /*TX power limit doesn't survive driver stop, association settings came back with cached config.*/
+            ERR_C_CHECK_AND_THROW_ERR(wifi_c_sta_apply_link_profile(ctx, NULL));
+            ERR_C_CHECK_AND_THROW_ERR(wifi_c_resume_sta(ctx, start_us, timeout_ms));
+        }
+#endif
+        ctx->resume_stats.resumes++;
+    }
+    Catch(err)
+    {
+        ctx->status.suspended = !started; // radio still stopped, resume can be called again
+        ctx->resume_stats.failures++;
+        switch (err)
+        {
+        case WIFI_C_ERR_STA_CONNECT_FAIL:
+            LOG_ERROR("All attempts to reconnect after resume failed");
+            break;
+        case WIFI_C_ERR_STA_TIMEOUT_EXPIRE:
+            LOG_ERROR("STA didn't get IP within %lu ms after resume, still connecting...", (unsigned long)timeout_ms);
+            break;
+        default:
+            LOG_ERROR("Error when resuming WiFi: %d, \nESP-IDF error: %s", err, esp_err_to_name(err));
+            break;
+        }
+    }
+
+    return err;
+}
+
+void wifi_c_ctx_get_resume_stats(wifi_c_ctx_t *ctx, wifi_c_resume_stats_t *stats)
+{
+    if (stats != NULL)
+    {
+        memcpy(stats, &ctx->resume_stats, sizeof(*stats));
+    }
+}
+
+/**
+ * @brief Create netifs of interfaces which are in mode to and not in mode from.
+ *
+ * @retval ERR_C_OK on success
+ * @retval WIFI_C_ERR_NETIF_INIT_FAILED if netif could not be created, none is created then
+ */
+static err_c_t wifi_c_netif_add(wifi_c_ctx_t *ctx, wifi_c_mode_t from, wifi_c_mode_t to)
+{
+#if WIFI_C_STA_ENABLED
+    bool add_sta = (to == WIFI_C_MODE_STA || to == WIFI_C_MODE_APSTA) &&
+                   !(from == WIFI_C_MODE_STA || from == WIFI_C_MODE_APSTA);
+
+    if (add_sta)
+    {
+        ctx->netif_handle_sta = esp_netif_create_default_wifi_sta();
+        if (ctx->netif_handle_sta == NULL)
+        {
+            return WIFI_C_ERR_NETIF_INIT_FAILED;
+        }
+    }
+#endif
+#if WIFI_C_AP_ENABLED
+    if ((to == WIFI_C_MODE_AP || to == WIFI_C_MODE_APSTA) && !(from == WIFI_C_MODE_AP || from == WIFI_C_MODE_APSTA))
+    {
+        ctx->netif_handle_ap = esp_netif_create_default_wifi_ap();
+        if (ctx->netif_handle_ap == NULL)
+        {
+#if WIFI_C_STA_ENABLED
+            if (add_sta)
+            {
+                esp_netif_destroy_default_wifi(ctx->netif_handle_sta);
+                ctx->netif_handle_sta = NULL;
+            }
+#endif
+            return WIFI_C_ERR_NETIF_INIT_FAILED;
+        }
+    }
+#endif
+    return ERR_C_OK;
+}
+
+/**
+ * @brief Destroy netifs of interfaces which are in mode from and not in mode to.
+ */
+static void wifi_c_netif_remove(wifi_c_ctx_t *ctx, wifi_c_mode_t from, wifi_c_mode_t to)
+{
+#if WIFI_C_STA_ENABLED
+    if ((from == WIFI_C_MODE_STA || from == WIFI_C_MODE_APSTA) && !(to == WIFI_C_MODE_STA || to == WIFI_C_MODE_APSTA))
+    {
+        esp_netif_destroy_default_wifi(ctx->netif_handle_sta);
+        ctx->netif_handle_sta = NULL;
+    }
+#endif
+#if WIFI_C_AP_ENABLED
+    if ((from == WIFI_C_MODE_AP || from == WIFI_C_MODE_APSTA) && !(to == WIFI_C_MODE_AP || to == WIFI_C_MODE_APSTA))
+    {
+        esp_netif_destroy_default_wifi(ctx->netif_handle_ap);
+        ctx->netif_handle_ap = NULL;
+    }
+#endif
+}
+
+int wifi_c_ctx_change_mode(wifi_c_ctx_t *ctx, wifi_c_mode_t mode)
+{
+    wifi_c_mode_t old_mode = ctx->status.wifi_mode;
+    err_c_t err = 0;
+
+    if (!ctx->status.wifi_initialized)
+    {
+        LOG_ERROR("WiFi was not initialized.");
+        return WIFI_C_ERR_WIFI_NOT_INIT;
+    }
+    if (old_mode == mode)
+    {
+        LOG_WARN("mode to set is the same as current mode");
+        return WIFI_C_ERR_WRONG_MODE;
+    }
+    if (wifi_c_select_wifi_mode(mode) == WIFI_MODE_NULL)
+    {
+        LOG_ERROR("mode to set is not known or compiled out");
+        return WIFI_C_ERR_WRONG_MODE;
+    }
+    err = wifi_c_shared_claim(ctx, mode);
+    if (err != ERR_C_OK)
+    {
+        return err;
+    }
+
+    /*Netifs of added interfaces exist before driver starts them, removed ones go after driver stopped them.*/
+    err = wifi_c_netif_add(ctx, old_mode, mode);
+    if (err == ERR_C_OK)
+    {
+        err = esp_wifi_set_mode(wifi_c_shared_driver_mode());
+        if (err != ERR_C_OK)
+        {
+            wifi_c_netif_remove(ctx, mode, old_mode);
+        }
+    }
+    if (err != ERR_C_OK)
+    {
+        wifi_c_shared_claim(ctx, old_mode); // interfaces of old mode stay with this context, new ones are released
+        LOG_ERROR("error %d when changing wifi mode: %s", err, error_to_name(err));
+        return err;
+    }
+    wifi_c_netif_remove(ctx, old_mode, mode);
+
+    ctx->status.wifi_mode = mode;
+    if (mode == WIFI_C_MODE_AP)
+    {
+        ctx->status.sta_started = false;
+        ctx->status.sta_connected = false;
+    }
+    else if (mode == WIFI_C_MODE_STA)
+    {
+        ctx->status.ap_started = false;
+    }
+    LOG_INFO("WiFi mode changed from %d to %d.", old_mode, mode);
+    return err;
+}
+
+static void wifi_c_netif_deinit(wifi_c_ctx_t *ctx, wifi_c_mode_t mode)
+{
+    switch (mode)
+    {
+#if WIFI_C_STA_ENABLED
+    case WIFI_C_MODE_STA:
+        esp_netif_destroy_default_wifi(ctx->netif_handle_sta);
+        break;
+#endif
+#if WIFI_C_AP_ENABLED
+    case WIFI_C_MODE_AP:
+        esp_netif_destroy_default_wifi(ctx->netif_handle_ap);
+        break;
+#endif
+#if WIFI_C_AP_ENABLED && WIFI_C_STA_ENABLED
+    case WIFI_C_MODE_APSTA:
+        esp_netif_destroy_default_wifi(ctx->netif_handle_ap);
+        esp_netif_destroy_default_wifi(ctx->netif_handle_sta);
+        break;
+#endif
+    default:
+        break;
+    }
+}
+
+/**
+ * Mostly when we are deinitializing wifi interface in our application, it means something
+ * somewhere has gone really bad, and we are doing panic exit.
+ * This function was also created with this assumption, so no error checking is done here.
+ */
+void wifi_c_ctx_deinit(wifi_c_ctx_t *ctx)
+{
+    bool last_user = false;
+    bool last_driver_user = false;
+
+    LOG_DEBUG("Deinitializing wifi_controller...");
+    portENTER_CRITICAL(&wifi_c_shared.lock);
+    if (ctx->status.even_loop_started)
+    {
+        last_user = (--wifi_c_shared.users == 0);
+    }
+    if (ctx->status.wifi_initialized)
+    {
+        last_driver_user = (--wifi_c_shared.driver_users == 0);
+    }
+    portEXIT_CRITICAL(&wifi_c_shared.lock);
+
+    if (last_user)
+    {
+        wifi_c_worker_stop(); // callbacks of other contexts may still be queued
+    }
+#if WIFI_C_STA_ENABLED
+    if (ctx->lease_timer != NULL)
+    {
+        esp_timer_stop(ctx->lease_timer);
+        esp_timer_delete(ctx->lease_timer);
+        ctx->lease_timer = NULL;
+    }
+    ctx->lease_state = WIFI_C_LEASE_NONE;
+#endif
+#if WIFI_C_AUTO_CHANNEL_ENABLED
+    if (ctx == &wifi_c_default_ctx)
+    {
+        wifi_c_channel_monitor_stop(); // monitor scans with default context
+    }
+#endif
+#if WIFI_C_SCAN_ENABLED
+    if (ctx == &wifi_c_default_ctx)
+    {
+        wifi_c_roam_stop(); // roaming also works on default context
+    }
+#endif
+    if (ctx->status.sta_connected)
+    {
+        esp_wifi_disconnect();
+        LOG_DEBUG("disconnected sta from AP...");
+    }
+    if (ctx->status.wifi_initialized)
+    {
+        wifi_c_shared_claim(ctx, WIFI_C_NO_MODE);
+        if (last_driver_user)
+        {
+            esp_wifi_stop();
+            esp_wifi_deinit();
+            LOG_DEBUG("stopped and deinitialized wifi...");
+        }
+        else
+        {
+            esp_wifi_set_mode(wifi_c_shared_driver_mode()); // interfaces of other contexts keep running
+            LOG_DEBUG("interfaces of context removed from wifi...");
+        }
+    }
+    if (ctx->status.netif_initialized)
+    {
+        wifi_c_netif_deinit(ctx, ctx->status.wifi_mode);
+        LOG_DEBUG("netif deinitialized...");
+    }
+
+    if (ctx->status.even_loop_started)
+    {
+#if WIFI_C_AP_ENABLED
+        WIFI_C_EVENT_UNREGISTER(WIFI_EVENT, ESP_EVENT_ANY_ID, ctx->ap_event_instance);
+#endif
+#if WIFI_C_STA_ENABLED
+        WIFI_C_EVENT_UNREGISTER(WIFI_EVENT, ESP_EVENT_ANY_ID, ctx->wifi_event_instance);
+        WIFI_C_EVENT_UNREGISTER(IP_EVENT, IP_EVENT_STA_GOT_IP, ctx->ip_event_instance);
+        WIFI_C_EVENT_UNREGISTER(WIFI_C_LEASE_EVENT, ESP_EVENT_ANY_ID, ctx->lease_event_instance);
+#endif
+#if WIFI_C_PRIVATE_EVENT_LOOP_ENABLED
+        wifi_c_event_loop_stop(); // handlers of this context are gone, loop is deleted after the last one
+#endif
+#if WIFI_C_EVENT_TRACE_ENABLED
+        if (ctx == &wifi_c_default_ctx)
+        {
+            esp_event_handler_instance_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, ctx->trace_wifi_instance);
+            esp_event_handler_instance_unregister(IP_EVENT, ESP_EVENT_ANY_ID, ctx->trace_ip_instance);
+        }
+#endif
+        vEventGroupDelete(ctx->event_group); // unblocks tasks in wifi_c_wait_for()
+        ctx->event_group = NULL;
+        if (last_user && wifi_c_default_loop_owned)
+        {
+            esp_event_loop_delete_default();
+            wifi_c_default_loop_owned = false;
+        }
+        LOG_DEBUG("wifi_c_event loop destroyed...");
+    }
+
+    // at least clear wifi_c_status state
+    ctx->status.wifi_initialized = false;
+    ctx->status.netif_initialized = false;
+    ctx->status.wifi_mode = WIFI_C_NO_MODE;
+    ctx->status.even_loop_started = false;
+    ctx->status.sta_started = false;
+    ctx->status.ap_started = false;
+    ctx->status.scan_done = false;
+    ctx->status.sta_connected = false;
+    ctx->status.suspended = false;
+    memutil_zero_memory(&ctx->resume_stats, sizeof(ctx->resume_stats));
+#if WIFI_C_APSTA_POLICY_ENABLED
+    memutil_zero_memory(&ctx->apsta_stats, sizeof(ctx->apsta_stats));
+    ctx->apsta_connecting = false;
+#endif
+#if WIFI_C_STA_ENABLED
+    ctx->resume_pinned = false;
+    ctx->resume_connect = false;
+    ctx->status.sta.connect_handler = NULL;
+    memcpy(ctx->status.sta.ip, "0.0.0.0", 8);
+    memcpy(ctx->status.sta.ssid, "none", 5);
+#endif
+#if WIFI_C_AP_ENABLED
+    ctx->status.ap.connect_handler = NULL;
+    memcpy(ctx->status.ap.ip, "0.0.0.0", 8);
+    memcpy(ctx->status.ap.ssid, "none", 5);
+#endif
+#if WIFI_C_DEFERRED_LOG_ENABLED
+    if (last_user)
+    {
+        wifi_c_log_stop();
+    }
+#endif
+    LOG_WARN("wifi_controller deinitialized");
+}
+
+wifi_c_ctx_t *wifi_c_ctx_get_default(void)
+{
+    return &wifi_c_default_ctx;
+}
+
+wifi_c_ctx_t *wifi_c_ctx_create(void)
+{
+    wifi_c_ctx_t *ctx = calloc(1, sizeof(wifi_c_ctx_t));
+    if (ctx == NULL)
+    {
+        LOG_ERROR("Memory allocation was not successful");
+        return NULL;
+    }
+    ctx->status = (wifi_c_status_t)WIFI_C_STATUS_DEFAULT();
+#if WIFI_C_STA_ENABLED
+    wifi_c_link_init(&ctx->sta_link, &ctx->status, ctx->lease_ssid, WIFI_C_STA_RETRY_COUNT);
+    ctx->sta_ip_config = (wifi_c_sta_ip_config_t)WIFI_C_STA_IP_CONFIG_DEFAULT();
+    ctx->sta_link_profile = (wifi_c_sta_link_profile_t)WIFI_C_STA_LINK_PROFILE_DEFAULT();
+#endif
+#if WIFI_C_APSTA_POLICY_ENABLED
+    ctx->apsta_policy = (wifi_c_apsta_policy_t)WIFI_C_APSTA_POLICY_DEFAULT();
+#endif
+    return ctx;
+}
+
+void wifi_c_ctx_destroy(wifi_c_ctx_t *ctx)
+{
+    if (ctx == NULL || ctx == &wifi_c_default_ctx)
+    {
+        return;
+    }
+    wifi_c_ctx_deinit(ctx);
+    free(ctx);
+}
+
+/*Functions without context argument use default instance, calls changing it run on controller task - see wifi_c_cmd.h.*/
+
+/**
+ * @brief Arguments of API call passed to controller task, each call uses only some of them.
+ */
+struct wifi_c_api_args_obj {
+    const char *ssid;
+    const char *password;
+    const void *config;
+    const void *filter;
+    void *result;
+    uint16_t *count;
+    void *report;
+    const uint8_t *bssid;
+    uint32_t value;                         // mode, channel, channel mask or timeout
+    wifi_c_stream_sink_t sink;              // receiver of streamed JSON, result is its argument
+};
+
+typedef struct wifi_c_api_args_obj wifi_c_api_args_t;
+
+static int wifi_c_api_init_wifi(void *args)
+{
+    return wifi_c_ctx_init_wifi(&wifi_c_default_ctx, (wifi_c_mode_t)((wifi_c_api_args_t *)args)->value);
+}
+
+int wifi_c_init_wifi(wifi_c_mode_t WIFI_C_WIFI_MODE)
+{
+    wifi_c_api_args_t args = {.value = WIFI_C_WIFI_MODE};
+    return WIFI_C_SPAN_CALL(WIFI_C_SPAN_INIT_WIFI, wifi_c_cmd_call(WIFI_C_CMD_INIT_WIFI, wifi_c_api_init_wifi, NULL, &args));
+}
+
+#if WIFI_C_AP_ENABLED
+static int wifi_c_api_start_ap(void *args)
+{
+    wifi_c_api_args_t *a = args;
+    return wifi_c_ctx_start_ap(&wifi_c_default_ctx, a->ssid, a->password);
+}
+
+int wifi_c_start_ap(const char *ssid, const char *password)
+{
+    wifi_c_api_args_t args = {.ssid = ssid, .password = password};
+    return WIFI_C_SPAN_CALL(WIFI_C_SPAN_START_AP, wifi_c_cmd_call(WIFI_C_CMD_START_AP, wifi_c_api_start_ap, NULL, &args));
+}
+
+static int wifi_c_api_start_ap_with_config(void *args)
+{
+    return wifi_c_ctx_start_ap_with_config(&wifi_c_default_ctx, ((wifi_c_api_args_t *)args)->config);
+}
+
+int wifi_c_start_ap_with_config(const wifi_c_ap_config_t *config)
+{
+    wifi_c_api_args_t args = {.config = config};
+    return WIFI_C_SPAN_CALL(WIFI_C_SPAN_START_AP, wifi_c_cmd_call(WIFI_C_CMD_START_AP, wifi_c_api_start_ap_with_config, NULL, &args));
+}
+
+char *wifi_c_get_ap_ipv4(void)
+{
+    return wifi_c_ctx_get_ap_ipv4(&wifi_c_default_ctx);
+}
+
+char *wifi_c_ap_get_ssid(void)
+{
+    return wifi_c_ctx_ap_get_ssid(&wifi_c_default_ctx);
+}
+
+#if WIFI_C_JSON_ENABLED
+int wifi_c_stream_stations_json(wifi_c_stream_sink_t sink, void *arg)
+{
+    return wifi_c_ctx_stream_stations_json(&wifi_c_default_ctx, sink, arg);
+}
+#endif
+#endif
+
+#if WIFI_C_STA_ENABLED
+static int wifi_c_api_start_sta(void *args)
+{
+    wifi_c_api_args_t *a = args;
+    return wifi_c_ctx_start_sta(&wifi_c_default_ctx, a->ssid, a->password);
+}
+
+int wifi_c_start_sta(const char *ssid, const char *password)
+{
+    wifi_c_api_args_t args = {.ssid = ssid, .password = password};
+    return WIFI_C_SPAN_CALL(WIFI_C_SPAN_START_STA, wifi_c_cmd_call(WIFI_C_CMD_START_STA, wifi_c_api_start_sta, NULL, &args));
+}
+
+static int wifi_c_api_start_sta_async(void *args)
+{
+    wifi_c_api_args_t *a = args;
+    return wifi_c_ctx_start_sta_async(&wifi_c_default_ctx, a->ssid, a->password);
+}
+
+int wifi_c_start_sta_async(const char *ssid, const char *password)
+{
+    wifi_c_api_args_t args = {.ssid = ssid, .password = password};
+    return wifi_c_cmd_call(WIFI_C_CMD_START_STA_ASYNC, wifi_c_api_start_sta_async, NULL, &args);
+}
+
+char *wifi_c_get_sta_ipv4(void)
+{
+    return wifi_c_ctx_get_sta_ipv4(&wifi_c_default_ctx);
+}
+
+char *wifi_c_sta_get_ap_ssid(void)
+{
+    return wifi_c_ctx_sta_get_ap_ssid(&wifi_c_default_ctx);
+}
+
+static int wifi_c_api_disconnect(void *args)
+{
+    return wifi_c_ctx_disconnect(&wifi_c_default_ctx);
+}
+
+int wifi_c_disconnect(void)
+{
+    return WIFI_C_SPAN_CALL(WIFI_C_SPAN_DISCONNECT, wifi_c_cmd_call(WIFI_C_CMD_DISCONNECT, wifi_c_api_disconnect, NULL, NULL));
+}
+
+int wifi_c_sta_register_connect_handler(void (*connect_handler)(void))
+{
+    return wifi_c_ctx_sta_register_connect_handler(&wifi_c_default_ctx, connect_handler);
+}
+
+int wifi_c_wait_for(wifi_c_state_t state, uint32_t timeout_ms)
+{
+    return wifi_c_ctx_wait_for(&wifi_c_default_ctx, state, timeout_ms);
+}
+
+int wifi_c_register_state_handler(wifi_c_state_handler_t handler, void *arg)
+{
+    return wifi_c_ctx_register_state_handler(&wifi_c_default_ctx, handler, arg);
+}
+
+int wifi_c_sta_set_ip_config(const wifi_c_sta_ip_config_t *config)
+{
+    return wifi_c_ctx_sta_set_ip_config(&wifi_c_default_ctx, config);
+}
+
+int wifi_c_sta_set_link_profile(const wifi_c_sta_link_profile_t *profile)
+{
+    return wifi_c_ctx_sta_set_link_profile(&wifi_c_default_ctx, profile);
+}
+
+uint32_t wifi_c_sta_get_lease_conflicts(void)
+{
+    return wifi_c_ctx_sta_get_lease_conflicts(&wifi_c_default_ctx);
+}
+#endif
+
+#if WIFI_C_APSTA_POLICY_ENABLED
+int wifi_c_apsta_set_policy(const wifi_c_apsta_policy_t *policy)
+{
+    return wifi_c_ctx_apsta_set_policy(&wifi_c_default_ctx, policy);
+}
+
+void wifi_c_apsta_get_stats(wifi_c_apsta_stats_t *stats)
+{
+    wifi_c_ctx_apsta_get_stats(&wifi_c_default_ctx, stats);
+}
+#endif
+
+wifi_c_status_t *wifi_c_get_status(void)
+{
+    return wifi_c_ctx_get_status(&wifi_c_default_ctx);
+}
+
+#if WIFI_C_JSON_ENABLED
+static int wifi_c_api_get_status_as_json(void *args)
+{
+    wifi_c_api_args_t *a = args;
+    return wifi_c_ctx_get_status_as_json(&wifi_c_default_ctx, a->result, a->value);
+}
+
+int wifi_c_get_status_as_json(char *buffer, size_t buflen)
+{
+    wifi_c_api_args_t args = {.result = buffer, .value = buflen};
+    return wifi_c_cmd_call(WIFI_C_CMD_STATUS, wifi_c_api_get_status_as_json, NULL, &args);
+}
+
+static int wifi_c_api_copy_status(void *args)
+{
+    memcpy(((wifi_c_api_args_t *)args)->result, &wifi_c_default_ctx.status, sizeof(wifi_c_status_t));
+    return ERR_C_OK;
+}
+
+int wifi_c_stream_status_json(wifi_c_stream_sink_t sink, void *arg)
+{
+    wifi_c_status_t status;
+    wifi_c_api_args_t args = {.result = &status};
+    int err = ERR_C_OK;
+
+    ERR_C_CHECK_NULL_PTR(sink, LOG_ERROR("sink of wifi_c_status JSON cannot be NULL"));
+    /*Copy is taken on controller task, slow sink doesn't hold commands queued behind.*/
+    err = wifi_c_cmd_call(WIFI_C_CMD_STATUS, wifi_c_api_copy_status, NULL, &args);
+    if (err != ERR_C_OK)
+    {
+        return err;
+    }
+    return wifi_c_status_stream_json(&status, sink, arg);
+}
+#endif
+
+int wifi_c_create_default_event_loop(void)
+{
+    return wifi_c_ctx_create_default_event_loop(&wifi_c_default_ctx);
+}
+
+#if WIFI_C_SCAN_ENABLED
+static int wifi_c_api_scan_all_ap(void *args)
+{
+    return wifi_c_ctx_scan_all_ap(&wifi_c_default_ctx, ((wifi_c_api_args_t *)args)->result);
+}
+
+static void wifi_c_api_share_scan_all_ap(const void *done, void *waiting)
+{
+    const wifi_c_api_args_t *from = done;
+    wifi_c_api_args_t *to = waiting;
+
+    if (from->result != NULL && to->result != NULL)
+    {
+        memcpy(to->result, from->result, sizeof(wifi_c_scan_result_t));
+    }
+}
+
+int wifi_c_scan_all_ap(wifi_c_scan_result_t *result_to_return)
+{
+    wifi_c_api_args_t args = {.result = result_to_return};
+    /*Scan requested while other caller's scan is running gets its results, radio sweeps only once.*/
+    return WIFI_C_SPAN_CALL(WIFI_C_SPAN_SCAN_ALL_AP, wifi_c_cmd_call(WIFI_C_CMD_SCAN_ALL_AP, wifi_c_api_scan_all_ap,
+                                                                     wifi_c_api_share_scan_all_ap, &args));
+}
+
+static int wifi_c_api_scan_start_async(void *args)
+{
+    return wifi_c_ctx_scan_start_async(&wifi_c_default_ctx);
+}
+
+int wifi_c_scan_start_async(void)
+{
+    return wifi_c_cmd_call(WIFI_C_CMD_SCAN_START, wifi_c_api_scan_start_async, NULL, NULL);
+}
+
+static int wifi_c_api_scan_get_results(void *args)
+{
+    return wifi_c_ctx_scan_get_results(&wifi_c_default_ctx, ((wifi_c_api_args_t *)args)->result);
+}
+
+int wifi_c_scan_get_results(wifi_c_scan_result_t *result)
+{
+    wifi_c_api_args_t args = {.result = result};
+    return wifi_c_cmd_call(WIFI_C_CMD_SCAN_RESULTS, wifi_c_api_scan_get_results, NULL, &args);
+}
+
+static int wifi_c_api_scan_filtered(void *args)
+{
+    wifi_c_api_args_t *a = args;
+    return wifi_c_ctx_scan_filtered(&wifi_c_default_ctx, a->filter, a->result, a->count);
+}
+
+int wifi_c_scan_filtered(const wifi_c_scan_filter_t *filter, wifi_ap_record_t *records, uint16_t *count)
+{
+    wifi_c_api_args_t args = {.filter = filter, .result = records, .count = count};
+    return WIFI_C_SPAN_CALL(WIFI_C_SPAN_SCAN_FILTERED, wifi_c_cmd_call(WIFI_C_CMD_SCAN_FILTERED, wifi_c_api_scan_filtered, NULL, &args));
+}
+
+static int wifi_c_api_scan_sliced(void *args)
+{
+    wifi_c_api_args_t *a = args;
+    return wifi_c_ctx_scan_sliced(&wifi_c_default_ctx, a->config, a->filter, a->result, a->count, a->report);
+}
+
+int wifi_c_scan_sliced(const wifi_c_scan_slice_config_t *config, const wifi_c_scan_filter_t *filter,
+                       wifi_ap_record_t *records, uint16_t *count, wifi_c_scan_slice_report_t *report)
+{
+    wifi_c_api_args_t args = {.config = config, .filter = filter, .result = records, .count = count, .report = report};
+    return WIFI_C_SPAN_CALL(WIFI_C_SPAN_SCAN_SLICED, wifi_c_cmd_call(WIFI_C_CMD_SCAN_SLICED, wifi_c_api_scan_sliced, NULL, &args));
+}
+
+#if WIFI_C_AUTO_CHANNEL_ENABLED
+static int wifi_c_api_measure_channels(void *args)
+{
+    return wifi_c_ctx_measure_channels(&wifi_c_default_ctx, ((wifi_c_api_args_t *)args)->result);
+}
+
+int wifi_c_measure_channels(wifi_c_channel_scores_t *scores)
+{
+    wifi_c_api_args_t args = {.result = scores};
+    return WIFI_C_SPAN_CALL(WIFI_C_SPAN_MEASURE_CHANNELS,
+                            wifi_c_cmd_call(WIFI_C_CMD_MEASURE_CHANNELS, wifi_c_api_measure_channels, NULL, &args));
+}
+
+static int wifi_c_api_measure_channel(void *args)
+{
+    wifi_c_api_args_t *a = args;
+    return wifi_c_ctx_measure_channel(&wifi_c_default_ctx, (uint8_t)a->value, a->result);
+}
+
+int wifi_c_measure_channel(uint8_t channel, wifi_c_channel_scores_t *scores)
+{
+    wifi_c_api_args_t args = {.value = channel, .result = scores};
+    return WIFI_C_SPAN_CALL(WIFI_C_SPAN_MEASURE_CHANNELS,
+                            wifi_c_cmd_call(WIFI_C_CMD_MEASURE_CHANNELS, wifi_c_api_measure_channel, NULL, &args));
+}
+
+static int wifi_c_api_start_ap_auto_channel(void *args)
+{
+    wifi_c_api_args_t *a = args;
+    return wifi_c_ctx_start_ap_auto_channel(&wifi_c_default_ctx, a->ssid, a->password, (uint16_t)a->value, a->result);
+}
+
+int wifi_c_start_ap_auto_channel(const char *ssid, const char *password, uint16_t channel_mask, uint8_t *channel)
+{
+    wifi_c_api_args_t args = {.ssid = ssid, .password = password, .value = channel_mask, .result = channel};
+    return WIFI_C_SPAN_CALL(WIFI_C_SPAN_START_AP_AUTO_CHANNEL,
+                            wifi_c_cmd_call(WIFI_C_CMD_START_AP_AUTO_CHANNEL, wifi_c_api_start_ap_auto_channel, NULL, &args));
+}
+#endif
+
+static int wifi_c_api_start_sta_best_bssid(void *args)
+{
+    wifi_c_api_args_t *a = args;
+    return wifi_c_ctx_start_sta_best_bssid(&wifi_c_default_ctx, a->ssid, a->password, a->config, a->result);
+}
+
+int wifi_c_start_sta_best_bssid(const char *ssid, const char *password, const wifi_c_bssid_select_config_t *config,
+                                wifi_ap_record_t *selected)
+{
+    wifi_c_api_args_t args = {.ssid = ssid, .password = password, .config = config, .result = selected};
+    return WIFI_C_SPAN_CALL(WIFI_C_SPAN_START_STA_BEST_BSSID,
+                            wifi_c_cmd_call(WIFI_C_CMD_START_STA_BEST_BSSID, wifi_c_api_start_sta_best_bssid, NULL, &args));
+}
+
+static int wifi_c_api_sta_roam_to(void *args)
+{
+    wifi_c_api_args_t *a = args;
+    return wifi_c_ctx_sta_roam_to(&wifi_c_default_ctx, a->bssid, (uint8_t)a->value);
+}
+
+int wifi_c_sta_roam_to(const uint8_t bssid[6], uint8_t channel)
+{
+    wifi_c_api_args_t args = {.bssid = bssid, .value = channel};
+    return WIFI_C_SPAN_CALL(WIFI_C_SPAN_ROAM_TO, wifi_c_cmd_call(WIFI_C_CMD_ROAM_TO, wifi_c_api_sta_roam_to, NULL, &args));
+}
+
+void wifi_c_sta_set_11kv(bool enable)
+{
+    wifi_c_ctx_sta_set_11kv(&wifi_c_default_ctx, enable);
+}
+
+static int wifi_c_api_scan_for_ap_with_ssid(void *args)
+{
+    wifi_c_api_args_t *a = args;
+    return wifi_c_ctx_scan_for_ap_with_ssid(&wifi_c_default_ctx, a->ssid, a->result);
+}
+
+int wifi_c_scan_for_ap_with_ssid(const char *searched_ssid, wifi_c_ap_record_t *ap_record)
+{
+    wifi_c_api_args_t args = {.ssid = searched_ssid, .result = ap_record};
+    return wifi_c_cmd_call(WIFI_C_CMD_SCAN_RESULTS, wifi_c_api_scan_for_ap_with_ssid, NULL, &args);
+}
+
+static int wifi_c_api_print_scanned_ap(void *args)
+{
+    return wifi_c_ctx_print_scanned_ap(&wifi_c_default_ctx);
+}
+
+int wifi_c_print_scanned_ap(void)
+{
+    return wifi_c_cmd_call(WIFI_C_CMD_SCAN_RESULTS, wifi_c_api_print_scanned_ap, NULL, NULL);
+}
+
+#if WIFI_C_JSON_ENABLED
+static int wifi_c_api_store_scan_result_as_json(void *args)
+{
+    wifi_c_api_args_t *a = args;
+    return wifi_c_ctx_store_scan_result_as_json(&wifi_c_default_ctx, a->result, (uint16_t)a->value);
+}
+
+int wifi_c_store_scan_result_as_json(char *buffer, uint16_t buflen)
+{
+    wifi_c_api_args_t args = {.result = buffer, .value = buflen};
+    return wifi_c_cmd_call(WIFI_C_CMD_SCAN_RESULTS, wifi_c_api_store_scan_result_as_json, NULL, &args);
+}
+
+static int wifi_c_api_copy_scan_records(void *args)
+{
+    wifi_c_api_args_t *a = args;
+    const wifi_ap_record_t *record = NULL;
+    int err = wifi_c_scan_stored_records(&wifi_c_default_ctx, &record, a->count);
+
+    if (err == ERR_C_OK)
+    {
+        memcpy(a->result, record, *a->count * sizeof(wifi_ap_record_t));
+    }
+    return err;
+}
+
+int wifi_c_stream_scan_json(wifi_c_stream_sink_t sink, void *arg)
+{
+    wifi_ap_record_t records[WIFI_C_DEFAULT_SCAN_SIZE];
+    uint16_t count = WIFI_C_DEFAULT_SCAN_SIZE;
+    wifi_c_api_args_t args = {.result = records, .count = &count};
+    int err = ERR_C_OK;
+
+    ERR_C_CHECK_NULL_PTR(sink, LOG_ERROR("sink of scanned APs cannot be NULL"));
+    /*Records are copied on controller task and streamed on caller's, like wifi_c_stream_status_json().*/
+    err = wifi_c_cmd_call(WIFI_C_CMD_SCAN_RESULTS, wifi_c_api_copy_scan_records, NULL, &args);
+    if (err != ERR_C_OK)
+    {
+        return err;
+    }
+    return wifi_c_scan_stream_json(records, count, sink, arg);
+}
+#endif
+#endif
+
+#if WIFI_C_EVENT_TRACE_ENABLED
+int wifi_c_trace_replay(const uint8_t *trace, size_t len, wifi_c_trace_speed_t speed, wifi_c_trace_replay_stats_t *stats)
+{
+    int err = ERR_C_OK;
+    wifi_c_ctx_t *ctx = wifi_c_ctx_create(); // owns no interface, so it gets no live events
+
+    if (ctx == NULL)
+    {
+        return ERR_C_MEMORY_ERR;
+    }
+    err = wifi_c_ctx_create_default_event_loop(ctx);
+    if (err == ERR_C_OK)
+    {
+        err = wifi_c_ctx_trace_replay(ctx, trace, len, speed, stats);
+    }
+    wifi_c_ctx_destroy(ctx);
+    return err;
+}
+#endif
+
+static int wifi_c_api_suspend(void *args)
+{
+    return wifi_c_ctx_suspend(&wifi_c_default_ctx);
+}
+
+int wifi_c_suspend(void)
+{
+    return WIFI_C_SPAN_CALL(WIFI_C_SPAN_SUSPEND, wifi_c_cmd_call(WIFI_C_CMD_SUSPEND, wifi_c_api_suspend, NULL, NULL));
+}
+
+static int wifi_c_api_resume(void *args)
+{
+    return wifi_c_ctx_resume(&wifi_c_default_ctx, ((wifi_c_api_args_t *)args)->value);
+}
+
+int wifi_c_resume(uint32_t timeout_ms)
+{
+    wifi_c_api_args_t args = {.value = timeout_ms};
+    return WIFI_C_SPAN_CALL(WIFI_C_SPAN_RESUME, wifi_c_cmd_call(WIFI_C_CMD_RESUME, wifi_c_api_resume, NULL, &args));
+}
+
+void wifi_c_get_resume_stats(wifi_c_resume_stats_t *stats)
+{
+    wifi_c_ctx_get_resume_stats(&wifi_c_default_ctx, stats);
+}
+
+static int wifi_c_api_change_mode(void *args)
+{
+    return wifi_c_ctx_change_mode(&wifi_c_default_ctx, (wifi_c_mode_t)((wifi_c_api_args_t *)args)->value);
+}
+
+int wifi_c_change_mode(wifi_c_mode_t mode)
+{
+    wifi_c_api_args_t args = {.value = mode};
+    return WIFI_C_SPAN_CALL(WIFI_C_SPAN_CHANGE_MODE, wifi_c_cmd_call(WIFI_C_CMD_CHANGE_MODE, wifi_c_api_change_mode, NULL, &args));
+}
+
+static int wifi_c_api_deinit(void *args)
+{
+    wifi_c_ctx_deinit(&wifi_c_default_ctx);
+    return ERR_C_OK;
+}
+
+void wifi_c_deinit(void)
+{
+    WIFI_C_SPAN_BEGIN(WIFI_C_SPAN_DEINIT);
+    /*Both tasks call API through the queue, stopping them on controller task would wait for command queued behind deinit.*/
+#if WIFI_C_AUTO_CHANNEL_ENABLED
+    wifi_c_channel_monitor_stop();
+#endif
+#if WIFI_C_SCAN_ENABLED
+    wifi_c_roam_stop();
+#endif
+    wifi_c_cmd_call(WIFI_C_CMD_DEINIT, wifi_c_api_deinit, NULL, NULL);
+    WIFI_C_SPAN_END(WIFI_C_SPAN_DEINIT);
+}
+#endif // ESP_PLATFORM
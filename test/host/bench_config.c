@@ -0,0 +1,159 @@
+/*
+ * Host benchmark of wifi_c_config_parse() against cJSON_Parse() plus reading the same members.
+ *
+ * Usage:
+ *   bench_config [runs]
+ *
+ * Each document is parsed runs times (default 100000) by both parsers, time per parse and
+ * allocations per parse of cJSON are printed. Host numbers show the ratio, absolute ones on target
+ * come from examples/config_json_benchmark.c.
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "cJSON.h"
+#include "err_controller.h"
+#include "wifi_controller.h"
+#include "wifi_c_config.h"
+
+static const char *documents[] = {
+    "{\"sta\":{\"ssid\":\"HomeNetwork\",\"password\":\"correct horse battery\"}}",
+    "{\"mode\":\"apsta\",\"sta\":[{\"ssid\":\"HomeNetwork\",\"password\":\"correct horse battery\"},"
+    "{\"ssid\":\"Office\",\"password\":\"s3cr3t-office-pass\"}],\"ap\":{\"ssid\":\"device-setup\","
+    "\"password\":\"provision-me\",\"channel\":6,\"bandwidth\":20,\"authmode\":\"wpa2\",\"max_connection\":2}}",
+};
+
+static uint64_t cjson_allocs = 0;
+
+/*WiFi functions of wifi_c_config_apply(), which benchmark doesn't call.*/
+int wifi_c_init_wifi(wifi_c_mode_t mode)
+{
+    (void)mode;
+    return ERR_C_OK;
+}
+
+int wifi_c_start_ap_with_config(const wifi_c_ap_config_t *config)
+{
+    (void)config;
+    return ERR_C_OK;
+}
+
+int wifi_c_start_sta(const char *ssid, const char *password)
+{
+    (void)ssid;
+    (void)password;
+    return ERR_C_OK;
+}
+
+static void *counting_malloc(size_t size)
+{
+    cjson_allocs++;
+    return malloc(size);
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Parse with cJSON and read members wifi_c_config_parse() fills.
+ *
+ * @return Number of members found, -1 if document is not valid.
+ */
+static int read_with_cjson(const char *text)
+{
+    cJSON *root = cJSON_Parse(text);
+    cJSON *sta = NULL;
+    cJSON *networks = NULL;
+    cJSON *network = NULL;
+    cJSON *ap = NULL;
+    int found = 0;
+
+    if (root == NULL)
+    {
+        return -1;
+    }
+    found += cJSON_IsString(cJSON_GetObjectItem(root, "mode"));
+    sta = cJSON_GetObjectItem(root, "sta");
+    networks = cJSON_IsArray(sta) ? sta : NULL; // cJSON_ArrayForEach() doesn't parenthesize its array argument
+    cJSON_ArrayForEach(network, networks)
+    {
+        found += cJSON_IsString(cJSON_GetObjectItem(network, "ssid"));
+        found += cJSON_IsString(cJSON_GetObjectItem(network, "password"));
+    }
+    if (cJSON_IsObject(sta))
+    {
+        found += cJSON_IsString(cJSON_GetObjectItem(sta, "ssid"));
+        found += cJSON_IsString(cJSON_GetObjectItem(sta, "password"));
+    }
+    ap = cJSON_GetObjectItem(root, "ap");
+    found += cJSON_IsString(cJSON_GetObjectItem(ap, "ssid"));
+    found += cJSON_IsString(cJSON_GetObjectItem(ap, "password"));
+    found += cJSON_IsNumber(cJSON_GetObjectItem(ap, "channel"));
+    found += cJSON_IsNumber(cJSON_GetObjectItem(ap, "bandwidth"));
+    found += cJSON_IsString(cJSON_GetObjectItem(ap, "authmode"));
+    found += cJSON_IsNumber(cJSON_GetObjectItem(ap, "max_connection"));
+    cJSON_Delete(root);
+    return found;
+}
+
+int main(int argc, char **argv)
+{
+    cJSON_Hooks hooks = {.malloc_fn = counting_malloc, .free_fn = free};
+    long runs = (argc > 1) ? strtol(argv[1], NULL, 10) : 100000;
+    wifi_c_config_t config;
+    char buffer[512];
+
+    if (runs <= 0)
+    {
+        fprintf(stderr, "usage: %s [runs]\n", argv[0]);
+        return 2;
+    }
+    cJSON_InitHooks(&hooks);
+
+    for (size_t d = 0; d < sizeof(documents) / sizeof(documents[0]); d++)
+    {
+        size_t len = strlen(documents[d]);
+        uint64_t start_ns = 0;
+        uint64_t config_ns = 0;
+        uint64_t cjson_ns = 0;
+
+        for (long i = 0; i < runs; i++)
+        {
+            memcpy(buffer, documents[d], len); // parsing is in place, each run needs fresh copy
+            start_ns = now_ns();
+            if (wifi_c_config_parse(buffer, len, &config, NULL) != ERR_C_OK)
+            {
+                fprintf(stderr, "document %u rejected by wifi_c_config_parse\n", (unsigned)d);
+                return 1;
+            }
+            config_ns += now_ns() - start_ns;
+        }
+
+        cjson_allocs = 0;
+        for (long i = 0; i < runs; i++)
+        {
+            start_ns = now_ns();
+            if (read_with_cjson(documents[d]) < 0)
+            {
+                fprintf(stderr, "document %u rejected by cJSON\n", (unsigned)d);
+                return 1;
+            }
+            cjson_ns += now_ns() - start_ns;
+        }
+
+        printf("document %u (%u bytes):\n", (unsigned)d, (unsigned)len);
+        printf("  wifi_c_config_parse %6llu ns, 0 allocations\n", (unsigned long long)(config_ns / runs));
+        printf("  cJSON_Parse         %6llu ns, %llu allocations\n", (unsigned long long)(cjson_ns / runs),
+               (unsigned long long)(cjson_allocs / runs));
+    }
+    return 0;
+}
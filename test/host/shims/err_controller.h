@@ -0,0 +1,19 @@
+/* Host shim of component header err_controller.h, declares only what host tests compile against. */
+#pragma once
+#include <setjmp.h>
+#include <stddef.h>
+typedef int err_c_t;
+#define ERR_C_OK 0
+#define ERR_C_MEMORY_ERR 0x10
+#define ERR_C_INVALID_ARGS 0x11
+#define ERR_C_NULL_POINTER 0x12
+#define ERR_C_NO_MEMORY 0x13
+extern jmp_buf *err_c_frame; extern int err_c_val; extern int err_c_caught;
+#define Try { jmp_buf *_prev = err_c_frame; jmp_buf _jb; err_c_frame = &_jb; if (setjmp(_jb) == 0) { if(1)
+/* Block after Catch runs only when error was thrown, flag is cleared before it runs. */
+#define Catch(e) else {} err_c_frame = _prev; } else { e = err_c_val; err_c_frame = _prev; err_c_caught = 1; } } if (err_c_caught && !(err_c_caught = 0))
+#define Throw(e) do { err_c_val = (e); longjmp(*err_c_frame, 1); } while (0)
+#define ERR_C_CHECK_AND_THROW_ERR(x) do { err_c_t _e = (x); if (_e != 0) Throw(_e); } while (0)
+#define ERR_C_SET_AND_THROW_ERR(err, x) do { err = (x); Throw(err); } while (0)
+#define ERR_C_CHECK_NULL_PTR(p, action) do { if ((p) == NULL) { action; return ERR_C_NULL_POINTER; } } while (0)
+const char *error_to_name(int err);
@@ -0,0 +1,2 @@
+/* Host shim of component header errors_list.h, declares only what host tests compile against. */
+#pragma once
@@ -0,0 +1,5 @@
+/* Host shim of ESP-IDF esp_attr.h, declares only what host tests compile against. */
+#pragma once
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define IRAM_ATTR
@@ -0,0 +1,18 @@
+/* Host shim of ESP-IDF esp_err.h, declares only what host tests compile against. */
+#pragma once
+#include <stdint.h>
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_NO_MEM 0x101
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_INVALID_SIZE 0x104
+#define ESP_ERR_NOT_FOUND 0x105
+#define ESP_ERR_NOT_SUPPORTED 0x106
+#define ESP_ERR_TIMEOUT 0x107
+#define ESP_ERR_WIFI_BASE 0x3000
+#define ESP_ERR_WIFI_STATE (ESP_ERR_WIFI_BASE + 7)
+const char *esp_err_to_name(esp_err_t);
+#define ESP_ERROR_CHECK(x) do { esp_err_t _r = (x); (void)_r; } while (0)
+#define ESP_ERROR_CHECK_WITHOUT_ABORT(x) (x)
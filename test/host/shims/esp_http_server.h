@@ -0,0 +1,19 @@
+/* Host shim of ESP-IDF esp_http_server.h, declares only what host tests compile against. */
+#pragma once
+#include <stddef.h>
+#include <sys/types.h>
+#include "esp_err.h"
+#define HTTPD_MAX_URI_LEN 512
+typedef void *httpd_handle_t;
+typedef enum { HTTP_DELETE, HTTP_GET, HTTP_HEAD, HTTP_POST } httpd_method_t;
+typedef struct httpd_req { httpd_handle_t handle; int method; char uri[HTTPD_MAX_URI_LEN + 1]; size_t content_len; void *aux; void *user_ctx; void *sess_ctx; } httpd_req_t;
+typedef struct httpd_uri { const char *uri; httpd_method_t method; esp_err_t (*handler)(httpd_req_t *r); void *user_ctx; } httpd_uri_t;
+typedef enum { HTTPD_500_INTERNAL_SERVER_ERROR = 0, HTTPD_501_METHOD_NOT_IMPLEMENTED, HTTPD_505_VERSION_NOT_SUPPORTED, HTTPD_400_BAD_REQUEST, HTTPD_401_UNAUTHORIZED, HTTPD_403_FORBIDDEN, HTTPD_404_NOT_FOUND } httpd_err_code_t;
+esp_err_t httpd_register_uri_handler(httpd_handle_t, const httpd_uri_t *);
+esp_err_t httpd_unregister_uri_handler(httpd_handle_t, const char *, httpd_method_t);
+esp_err_t httpd_resp_set_type(httpd_req_t *, const char *);
+esp_err_t httpd_resp_set_status(httpd_req_t *, const char *);
+esp_err_t httpd_resp_set_hdr(httpd_req_t *, const char *, const char *);
+esp_err_t httpd_resp_send_chunk(httpd_req_t *, const char *, ssize_t);
+esp_err_t httpd_resp_sendstr(httpd_req_t *, const char *);
+esp_err_t httpd_resp_send_err(httpd_req_t *, httpd_err_code_t, const char *);
@@ -0,0 +1,4 @@
+/* Host shim of ESP-IDF esp_mac.h, declares only what host tests compile against. */
+#pragma once
+#define MAC2STR(a) (a)[0], (a)[1], (a)[2], (a)[3], (a)[4], (a)[5]
+#define MACSTR "%02x:%02x:%02x:%02x:%02x:%02x"
@@ -0,0 +1,32 @@
+/* Host shim of ESP-IDF esp_netif.h, declares only what host tests compile against. */
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+typedef struct esp_netif_obj esp_netif_t;
+typedef struct { uint32_t addr; } esp_ip4_addr_t;
+typedef struct { esp_ip4_addr_t ip, netmask, gw; } esp_netif_ip_info_t;
+typedef enum { ESP_NETIF_DNS_MAIN, ESP_NETIF_DNS_BACKUP, ESP_NETIF_DNS_FALLBACK, ESP_NETIF_DNS_MAX } esp_netif_dns_type_t;
+typedef struct { struct { union { esp_ip4_addr_t ip4; } u_addr; uint8_t type; } ip; } esp_netif_dns_info_t;
+#define ESP_IPADDR_TYPE_V4 0
+#define IPSTR "%d.%d.%d.%d"
+#define esp_ip4_addr1_16(ipaddr) ((uint16_t)(((ipaddr)->addr) & 0xff))
+#define IP2STR(ipaddr) (int)((ipaddr)->addr & 0xff), (int)(((ipaddr)->addr >> 8) & 0xff), (int)(((ipaddr)->addr >> 16) & 0xff), (int)(((ipaddr)->addr >> 24) & 0xff)
+#define ESP_IP4TOADDR(a,b,c,d) ((uint32_t)(a) | ((uint32_t)(b) << 8) | ((uint32_t)(c) << 16) | ((uint32_t)(d) << 24))
+esp_err_t esp_netif_init(void);
+esp_netif_t *esp_netif_create_default_wifi_ap(void);
+esp_netif_t *esp_netif_create_default_wifi_sta(void);
+void esp_netif_destroy_default_wifi(void *);
+esp_err_t esp_netif_dhcpc_stop(esp_netif_t *);
+esp_err_t esp_netif_dhcpc_start(esp_netif_t *);
+esp_err_t esp_netif_set_ip_info(esp_netif_t *, const esp_netif_ip_info_t *);
+esp_err_t esp_netif_get_ip_info(esp_netif_t *, esp_netif_ip_info_t *);
+esp_err_t esp_netif_set_dns_info(esp_netif_t *, esp_netif_dns_type_t, esp_netif_dns_info_t *);
+esp_err_t esp_netif_get_dns_info(esp_netif_t *, esp_netif_dns_type_t, esp_netif_dns_info_t *);
+esp_err_t esp_netif_str_to_ip4(const char *, esp_ip4_addr_t *);
+typedef struct { esp_netif_t *esp_netif; esp_netif_ip_info_t ip_info; bool ip_changed; } ip_event_got_ip_t;
+typedef enum { IP_EVENT_STA_GOT_IP, IP_EVENT_STA_LOST_IP, IP_EVENT_AP_STAIPASSIGNED } ip_event_t;
+typedef struct { esp_netif_t *esp_netif; esp_ip4_addr_t ip; uint8_t mac[6]; } ip_event_ap_staipassigned_t;
+#define ESP_ERR_ESP_NETIF_BASE 0x5000
+#define ESP_ERR_ESP_NETIF_DHCP_ALREADY_STARTED (ESP_ERR_ESP_NETIF_BASE + 0x03)
+#define ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED (ESP_ERR_ESP_NETIF_BASE + 0x04)
@@ -0,0 +1,80 @@
+/* Host shim of ESP-IDF esp_wifi.h, declares only what host tests compile against. */
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+typedef enum { WIFI_MODE_NULL, WIFI_MODE_STA, WIFI_MODE_AP, WIFI_MODE_APSTA } wifi_mode_t;
+typedef enum { WIFI_IF_STA, WIFI_IF_AP } wifi_interface_t;
+typedef enum { WIFI_AUTH_OPEN, WIFI_AUTH_WEP, WIFI_AUTH_WPA_PSK, WIFI_AUTH_WPA2_PSK, WIFI_AUTH_WPA_WPA2_PSK, WIFI_AUTH_ENTERPRISE, WIFI_AUTH_WPA3_PSK, WIFI_AUTH_WPA2_WPA3_PSK, WIFI_AUTH_WAPI_PSK, WIFI_AUTH_OWE, WIFI_AUTH_MAX } wifi_auth_mode_t;
+typedef enum { WIFI_CIPHER_TYPE_NONE, WIFI_CIPHER_TYPE_CCMP } wifi_cipher_type_t;
+typedef enum { WIFI_SECOND_CHAN_NONE, WIFI_SECOND_CHAN_ABOVE, WIFI_SECOND_CHAN_BELOW } wifi_second_chan_t;
+typedef enum { WIFI_FAST_SCAN, WIFI_ALL_CHANNEL_SCAN } wifi_scan_method_t;
+typedef enum { WIFI_CONNECT_AP_BY_SIGNAL, WIFI_CONNECT_AP_BY_SECURITY } wifi_sort_method_t;
+typedef enum { WIFI_SCAN_TYPE_ACTIVE, WIFI_SCAN_TYPE_PASSIVE } wifi_scan_type_t;
+typedef enum { WIFI_BW_HT20 = 1, WIFI_BW_HT40 } wifi_bandwidth_t;
+typedef enum { WIFI_PS_NONE, WIFI_PS_MIN_MODEM, WIFI_PS_MAX_MODEM } wifi_ps_type_t;
+typedef enum { WIFI_STORAGE_FLASH, WIFI_STORAGE_RAM } wifi_storage_t;
+#define WIFI_PROTOCOL_11B 1
+#define WIFI_PROTOCOL_11G 2
+#define WIFI_PROTOCOL_11N 4
+#define WIFI_PROTOCOL_LR 8
+typedef struct { int8_t rssi; wifi_auth_mode_t authmode; } wifi_scan_threshold_t;
+typedef struct { bool capable; bool required; } wifi_pmf_config_t;
+typedef struct { uint32_t min, max; } wifi_active_scan_time_t;
+typedef struct { wifi_active_scan_time_t active; uint32_t passive; } wifi_scan_time_t;
+typedef struct { uint8_t *ssid; uint8_t *bssid; uint8_t channel; bool show_hidden; wifi_scan_type_t scan_type; wifi_scan_time_t scan_time; uint8_t home_chan_dwell_time; } wifi_scan_config_t;
+typedef struct { uint8_t bssid[6]; uint8_t ssid[33]; uint8_t primary; wifi_second_chan_t second; int8_t rssi; wifi_auth_mode_t authmode; wifi_cipher_type_t pairwise_cipher; wifi_cipher_type_t group_cipher; uint32_t phy_11b:1, phy_11g:1, phy_11n:1, phy_lr:1, wps:1, ftm_responder:1, ftm_initiator:1, reserved:25; } wifi_ap_record_t;
+typedef struct { uint8_t ssid[32]; uint8_t password[64]; uint8_t ssid_len; uint8_t channel; wifi_auth_mode_t authmode; uint8_t ssid_hidden; uint8_t max_connection; uint16_t beacon_interval; wifi_cipher_type_t pairwise_cipher; bool ftm_responder; wifi_pmf_config_t pmf_cfg; int sae_pwe_h2e; uint8_t dtim_period; uint8_t csa_count; } wifi_ap_config_t;
+typedef struct { uint8_t ssid[32]; uint8_t password[64]; wifi_scan_method_t scan_method; bool bssid_set; uint8_t bssid[6]; uint8_t channel; uint16_t listen_interval; wifi_sort_method_t sort_method; wifi_scan_threshold_t threshold; wifi_pmf_config_t pmf_cfg; uint32_t rm_enabled:1, btm_enabled:1, mbo_enabled:1, ft_enabled:1, owe_enabled:1, transition_disable:1, reserved:26; int sae_pwe_h2e; uint8_t failure_retry_cnt; } wifi_sta_config_t;
+typedef union { wifi_ap_config_t ap; wifi_sta_config_t sta; } wifi_config_t;
+typedef struct { int dummy; } wifi_init_config_t;
+#define WIFI_INIT_CONFIG_DEFAULT() { 0 }
+typedef enum { WIFI_EVENT_WIFI_READY, WIFI_EVENT_SCAN_DONE, WIFI_EVENT_STA_START, WIFI_EVENT_STA_STOP, WIFI_EVENT_STA_CONNECTED, WIFI_EVENT_STA_DISCONNECTED, WIFI_EVENT_STA_AUTHMODE_CHANGE, WIFI_EVENT_STA_BSS_RSSI_LOW = 13, WIFI_EVENT_AP_START = 12, WIFI_EVENT_AP_STOP = 14, WIFI_EVENT_AP_STACONNECTED = 15, WIFI_EVENT_AP_STADISCONNECTED = 16, WIFI_EVENT_AP_PROBEREQRECVED = 17, WIFI_EVENT_STA_BEACON_TIMEOUT = 21, WIFI_EVENT_STA_NEIGHBOR_REP = 27 } wifi_event_t;
+typedef struct { uint32_t status; uint8_t number; uint8_t scan_id; } wifi_event_sta_scan_done_t;
+typedef struct { uint8_t ssid[32]; uint8_t ssid_len; uint8_t bssid[6]; uint8_t channel; wifi_auth_mode_t authmode; uint16_t aid; } wifi_event_sta_connected_t;
+typedef struct { uint8_t ssid[32]; uint8_t ssid_len; uint8_t bssid[6]; uint8_t reason; int8_t rssi; } wifi_event_sta_disconnected_t;
+typedef struct { uint8_t mac[6]; uint8_t aid; bool is_mesh_child; } wifi_event_ap_staconnected_t;
+typedef struct { uint8_t mac[6]; uint8_t aid; bool is_mesh_child; uint8_t reason; } wifi_event_ap_stadisconnected_t;
+typedef struct { int32_t rssi; } wifi_event_bss_rssi_low_t;
+typedef struct { wifi_auth_mode_t old_mode; wifi_auth_mode_t new_mode; } wifi_event_sta_authmode_change_t;
+typedef struct { uint8_t mac[6]; int8_t rssi; } wifi_sta_info_t;
+#define ESP_WIFI_MAX_CONN_NUM 15
+typedef struct { wifi_sta_info_t sta[ESP_WIFI_MAX_CONN_NUM]; int num; } wifi_sta_list_t;
+typedef struct { uint8_t primary; uint8_t secondary; } wifi_chan_t;
+esp_err_t esp_wifi_init(const wifi_init_config_t *);
+esp_err_t esp_wifi_deinit(void);
+esp_err_t esp_wifi_set_mode(wifi_mode_t);
+esp_err_t esp_wifi_get_mode(wifi_mode_t *);
+esp_err_t esp_wifi_start(void);
+esp_err_t esp_wifi_stop(void);
+esp_err_t esp_wifi_connect(void);
+esp_err_t esp_wifi_disconnect(void);
+esp_err_t esp_wifi_set_config(wifi_interface_t, wifi_config_t *);
+esp_err_t esp_wifi_get_config(wifi_interface_t, wifi_config_t *);
+esp_err_t esp_wifi_set_storage(wifi_storage_t);
+esp_err_t esp_wifi_scan_start(const wifi_scan_config_t *, bool);
+esp_err_t esp_wifi_scan_stop(void);
+esp_err_t esp_wifi_scan_get_ap_num(uint16_t *);
+esp_err_t esp_wifi_scan_get_ap_records(uint16_t *, wifi_ap_record_t *);
+esp_err_t esp_wifi_scan_get_ap_record(wifi_ap_record_t *);
+esp_err_t esp_wifi_clear_ap_list(void);
+esp_err_t esp_wifi_set_bandwidth(wifi_interface_t, wifi_bandwidth_t);
+esp_err_t esp_wifi_get_bandwidth(wifi_interface_t, wifi_bandwidth_t *);
+esp_err_t esp_wifi_set_protocol(wifi_interface_t, uint8_t);
+esp_err_t esp_wifi_get_protocol(wifi_interface_t, uint8_t *);
+esp_err_t esp_wifi_set_max_tx_power(int8_t);
+esp_err_t esp_wifi_get_max_tx_power(int8_t *);
+esp_err_t esp_wifi_sta_get_ap_info(wifi_ap_record_t *);
+esp_err_t esp_wifi_ap_get_sta_list(wifi_sta_list_t *);
+esp_err_t esp_wifi_get_channel(uint8_t *, wifi_second_chan_t *);
+esp_err_t esp_wifi_set_channel(uint8_t, wifi_second_chan_t);
+esp_err_t esp_wifi_set_rssi_threshold(int32_t);
+esp_err_t esp_wifi_set_ps(wifi_ps_type_t);
+typedef enum { WIFI_COUNTRY_POLICY_AUTO, WIFI_COUNTRY_POLICY_MANUAL } wifi_country_policy_t;
+typedef struct { char cc[3]; uint8_t schan; uint8_t nchan; int8_t max_tx_power; wifi_country_policy_t policy; } wifi_country_t;
+esp_err_t esp_wifi_get_country(wifi_country_t *);
+
+#define ESP_WIFI_MAX_NEIGHBOR_REP_LEN 512
+typedef struct { uint8_t report[ESP_WIFI_MAX_NEIGHBOR_REP_LEN]; uint16_t report_len; } wifi_event_neighbor_report_t;
@@ -0,0 +1,25 @@
+/* Host shim of ESP-IDF freertos/FreeRTOS.h, declares only what host tests compile against. */
+#pragma once
+#include <stdint.h>
+typedef uint32_t TickType_t; typedef int BaseType_t; typedef unsigned UBaseType_t; typedef uint32_t StackType_t;
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY 0xffffffffu
+#define tskNO_AFFINITY 0x7fffffff
+#define pdMS_TO_TICKS(x) ((TickType_t)(x))
+#define portTICK_PERIOD_MS 1
+#define configMAX_PRIORITIES 25
+#define tskIDLE_PRIORITY 0
+typedef struct { int dummy; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(m) ((void)(m))
+#define portEXIT_CRITICAL(m) ((void)(m))
+#define portENTER_CRITICAL_ISR(m) ((void)(m))
+#define portEXIT_CRITICAL_ISR(m) ((void)(m))
+#define configASSERT(x) ((void)(x))
+#define configMAX_TASK_NAME_LEN 16
+#define portENTER_CRITICAL_SAFE(m) ((void)(m))
+#define portEXIT_CRITICAL_SAFE(m) ((void)(m))
+BaseType_t xPortInIsrContext(void);
@@ -0,0 +1,12 @@
+/* Host shim of ESP-IDF freertos/queue.h, declares only what host tests compile against. */
+#pragma once
+#include "freertos/FreeRTOS.h"
+typedef void *QueueHandle_t;
+typedef struct StaticQueue { int d[16]; } StaticQueue_t;
+QueueHandle_t xQueueCreate(UBaseType_t, UBaseType_t);
+QueueHandle_t xQueueCreateStatic(UBaseType_t, UBaseType_t, uint8_t *, StaticQueue_t *);
+BaseType_t xQueueSend(QueueHandle_t, const void *, TickType_t);
+BaseType_t xQueueReceive(QueueHandle_t, void *, TickType_t);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t);
+void vQueueDelete(QueueHandle_t);
+BaseType_t xQueuePeek(QueueHandle_t, void *, TickType_t);
@@ -0,0 +1,12 @@
+/* Host shim of ESP-IDF freertos/semphr.h, declares only what host tests compile against. */
+#pragma once
+#include "freertos/queue.h"
+typedef void *SemaphoreHandle_t;
+typedef struct StaticSemaphore { int d[16]; } StaticSemaphore_t;
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t, TickType_t);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t);
+void vSemaphoreDelete(SemaphoreHandle_t);
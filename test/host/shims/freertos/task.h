@@ -0,0 +1,18 @@
+/* Host shim of ESP-IDF freertos/task.h, declares only what host tests compile against. */
+#pragma once
+#include "freertos/FreeRTOS.h"
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+void vTaskDelay(TickType_t);
+TickType_t xTaskGetTickCount(void);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char *, uint32_t, void *, UBaseType_t, TaskHandle_t *, BaseType_t);
+BaseType_t xTaskCreate(TaskFunction_t, const char *, uint32_t, void *, UBaseType_t, TaskHandle_t *);
+void vTaskDelete(TaskHandle_t);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+char *pcTaskGetName(TaskHandle_t);
+BaseType_t xPortGetCoreID(void);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t);
+typedef struct StaticTask { int d[64]; } StaticTask_t;
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t, const char *, uint32_t, void *, UBaseType_t, StackType_t *, StaticTask_t *, BaseType_t);
+void xTaskNotifyGive(TaskHandle_t);
+uint32_t ulTaskNotifyTake(BaseType_t, TickType_t);
@@ -0,0 +1,13 @@
+/* Host shim of component header logger.h, declares only what host tests compile against. */
+#pragma once
+#include <stdio.h>
+#ifdef LOG_HOST_SHIM_QUIET
+#define LOG_HOST_SHIM(...) do { } while (0)
+#else
+#define LOG_HOST_SHIM(...) do { printf(__VA_ARGS__); printf("\n"); } while (0)
+#endif
+#define LOG_VERBOSE(...) LOG_HOST_SHIM(__VA_ARGS__)
+#define LOG_DEBUG(...) LOG_HOST_SHIM(__VA_ARGS__)
+#define LOG_INFO(...) LOG_HOST_SHIM(__VA_ARGS__)
+#define LOG_WARN(...) LOG_HOST_SHIM(__VA_ARGS__)
+#define LOG_ERROR(...) LOG_HOST_SHIM(__VA_ARGS__)
@@ -0,0 +1,4 @@
+/* Host shim of component header memory_utils.h, declares only what host tests compile against. */
+#pragma once
+#include <stddef.h>
+void memutil_zero_memory(void *p, size_t n);
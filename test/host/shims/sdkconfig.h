@@ -0,0 +1,2 @@
+/* Host shim of sdkconfig.h, controller defaults are used, declares only what host tests compile against. */
+#pragma once
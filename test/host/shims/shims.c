@@ -0,0 +1,54 @@
+/*
+ * Host implementation of shimmed functions, single-threaded: locks always succeed and time is set by tests.
+ */
+#include <stddef.h>
+#include <string.h>
+#include "err_controller.h"
+#include "esp_event.h"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+#include "memory_utils.h"
+
+jmp_buf *err_c_frame = NULL;
+int err_c_val = 0;
+int err_c_caught = 0;
+
+esp_event_base_t const WIFI_EVENT = "WIFI_EVENT";
+esp_event_base_t const IP_EVENT = "IP_EVENT";
+
+int64_t host_shim_time_us = 0;
+
+static int host_shim_mutex;
+
+int64_t esp_timer_get_time(void)
+{
+    return host_shim_time_us;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return &host_shim_mutex;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks)
+{
+    (void)semaphore;
+    (void)ticks;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    (void)semaphore;
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore)
+{
+    (void)semaphore;
+}
+
+void memutil_zero_memory(void *p, size_t n)
+{
+    memset(p, 0, n);
+}
@@ -0,0 +1,216 @@
+/*
+ * Host test of JSON provisioning config parser and its validation rules.
+ *
+ * Source is built with ESP_PLATFORM against shims in test/host/shims, WiFi functions called by
+ * wifi_c_config_apply() are faked here.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "test_util.h"
+#include "err_controller.h"
+#include "wifi_controller.h"
+#include "wifi_c_config.h"
+
+static struct {
+    int init_err;
+    int ap_err;
+    int sta_fail_count;                     // networks refusing connection before one accepts it
+    int sta_calls;
+    const char *sta_ssid;
+    const wifi_c_ap_config_t *ap;
+} fake;
+
+int wifi_c_init_wifi(wifi_c_mode_t mode)
+{
+    (void)mode;
+    return fake.init_err;
+}
+
+int wifi_c_start_ap_with_config(const wifi_c_ap_config_t *config)
+{
+    fake.ap = config;
+    return fake.ap_err;
+}
+
+int wifi_c_start_sta(const char *ssid, const char *password)
+{
+    (void)password;
+    fake.sta_ssid = ssid;
+    return (++fake.sta_calls <= fake.sta_fail_count) ? WIFI_C_ERR_STA_CONNECT_FAIL : ERR_C_OK;
+}
+
+/**
+ * @brief Parse copy of document, parsing is in place.
+ */
+static int parse(const char *text, wifi_c_config_t *config, wifi_c_config_error_t *error)
+{
+    static char buffer[1024];
+    size_t len = strlen(text);
+
+    memcpy(buffer, text, len);
+    memset(error, 0, sizeof(*error));
+    return wifi_c_config_parse(buffer, len, config, error);
+}
+
+/**
+ * @brief Document is rejected with reason at offset of text which follows marker.
+ */
+static bool rejected(const char *text, const char *marker, const char *reason)
+{
+    wifi_c_config_t config;
+    wifi_c_config_error_t error;
+    const char *at = strstr(text, marker);
+
+    return parse(text, &config, &error) == WIFI_C_ERR_CONFIG_INVALID && at != NULL &&
+           error.offset == (size_t)(at - text) + strlen(marker) && error.reason != NULL &&
+           strcmp(error.reason, reason) == 0;
+}
+
+static void test_sta_networks(void)
+{
+    wifi_c_config_t config;
+    wifi_c_config_error_t error;
+
+    CHECK(parse("{\"sta\": {\"ssid\": \"home\", \"password\": \"12345678\", \"bssid\": [1, 2]}}", &config, &error) ==
+          ERR_C_OK);
+    CHECK(config.mode == WIFI_C_MODE_STA);
+    CHECK(config.network_count == 1);
+    CHECK(strcmp(config.networks[0].ssid, "home") == 0 && strcmp(config.networks[0].password, "12345678") == 0);
+
+    // network without password is open
+    CHECK(parse("{\"sta\": [{\"ssid\": \"a\\u00e9\"}, {\"ssid\": \"b\", \"password\": \"12345678\"}]}", &config,
+                &error) == ERR_C_OK);
+    CHECK(config.network_count == 2);
+    CHECK(strcmp(config.networks[0].ssid, "a\xc3\xa9") == 0 && strcmp(config.networks[0].password, "") == 0);
+    CHECK(strcmp(config.networks[1].ssid, "b") == 0);
+
+    // one more than WIFI_C_CONFIG_MAX_NETWORKS
+    CHECK(rejected("{\"sta\": [{\"ssid\": \"a\"}, {\"ssid\": \"b\"}, {\"ssid\": \"c\"}, {\"ssid\": \"d\"}, "
+                   "{\"ssid\": \"e\"}]}", "\"d\"}, ", "too many STA networks"));
+    CHECK(rejected("{\"sta\": {\"password\": \"12345678\"}}", "\"12345678\"}", "STA network without SSID"));
+}
+
+static void test_ssid_length(void)
+{
+    wifi_c_config_t config;
+    wifi_c_config_error_t error;
+
+    // 32 bytes after unescaping, escape sequence is not counted as its characters
+    CHECK(parse("{\"sta\": {\"ssid\": \"0123456789abcdef0123456789abcde\\\"\"}}", &config, &error) == ERR_C_OK);
+    CHECK(strlen(config.networks[0].ssid) == 32);
+    CHECK(rejected("{\"sta\": {\"ssid\": \"0123456789abcdef0123456789abcdef0\"}}", "\"ssid\": ",
+                   "SSID longer than 32 bytes"));
+    // two bytes of UTF-8 make it 33
+    CHECK(rejected("{\"sta\": {\"ssid\": \"0123456789abcdef0123456789abcde\\u00e9\"}}", "\"ssid\": ",
+                   "SSID longer than 32 bytes"));
+    CHECK(rejected("{\"sta\": {\"ssid\": \"\"}}", "\"ssid\": ", "SSID is empty"));
+    CHECK(rejected("{\"ap\": {\"ssid\": \"\"}}", "\"ssid\": ", "SSID is empty"));
+}
+
+static void test_password_length(void)
+{
+    wifi_c_config_t config;
+    wifi_c_config_error_t error;
+
+    CHECK(rejected("{\"sta\": {\"ssid\": \"home\", \"password\": \"1234567\"}}", "\"password\": ",
+                   "password shorter than 8 characters"));
+    CHECK(rejected("{\"ap\": {\"ssid\": \"dev\", \"password\": \"1234567\"}}", "\"password\": ",
+                   "password shorter than 8 characters"));
+    CHECK(parse("{\"ap\": {\"ssid\": \"dev\", \"password\": \"12345678\"}}", &config, &error) == ERR_C_OK);
+    CHECK(strcmp(config.ap.password, "12345678") == 0);
+
+    CHECK(parse("{\"sta\": {\"ssid\": \"home\", \"password\": "
+                "\"123456789012345678901234567890123456789012345678901234567890123\"}}", &config, &error) == ERR_C_OK);
+    CHECK(rejected("{\"sta\": {\"ssid\": \"home\", \"password\": "
+                   "\"1234567890123456789012345678901234567890123456789012345678901234x\"}}", "\"password\": ",
+                   "password longer than 63 characters"));
+
+    // 64 characters are PSK of STA, which must be hex, AP takes passphrase only
+    CHECK(parse("{\"sta\": {\"ssid\": \"home\", \"password\": "
+                "\"0123456789abcdef0123456789ABCDEF0123456789abcdef0123456789abcdef\"}}", &config, &error) == ERR_C_OK);
+    CHECK(rejected("{\"sta\": {\"ssid\": \"home\", \"password\": "
+                   "\"0123456789abcdef0123456789ABCDEF0123456789abcdef0123456789abcdeg\"}}", "\"password\": ",
+                   "64 character password must be hex PSK"));
+    CHECK(rejected("{\"ap\": {\"ssid\": \"dev\", \"password\": "
+                   "\"0123456789abcdef0123456789ABCDEF0123456789abcdef0123456789abcdef\"}}", "\"password\": ",
+                   "password longer than 63 characters"));
+}
+
+static void test_ap_ranges(void)
+{
+    wifi_c_config_t config;
+    wifi_c_config_error_t error;
+
+    CHECK(parse("{\"ap\": {\"ssid\": \"dev\", \"channel\": 14, \"bandwidth\": 40, \"authmode\": \"wpa3\", "
+                "\"pmf_required\": true, \"max_connection\": 2, \"beacon_interval\": 200, \"dtim_period\": 1}}",
+                &config, &error) == ERR_C_OK);
+    CHECK(config.mode == WIFI_C_MODE_AP);
+    CHECK(config.ap.channel == WIFI_C_AP_CHANNEL_MAX && config.ap.bandwidth == WIFI_BW_HT40);
+    CHECK(config.ap.authmode == WIFI_AUTH_WPA3_PSK && config.ap.pmf_required);
+    CHECK(config.ap.max_connection == 2 && config.ap.beacon_interval == 200 && config.ap.dtim_period == 1);
+
+    // members not in document keep WIFI_C_AP_CONFIG_DEFAULT()
+    CHECK(parse("{\"ap\": {\"ssid\": \"dev\", \"channel\": 0}}", &config, &error) == ERR_C_OK);
+    CHECK(config.ap.channel == 0 && config.ap.bandwidth == WIFI_BW_HT20 && config.ap.beacon_interval == 100);
+
+    CHECK(rejected("{\"ap\": {\"ssid\": \"dev\", \"channel\": 15}}", "\"channel\": ", "number out of range"));
+    CHECK(rejected("{\"ap\": {\"ssid\": \"dev\", \"channel\": -1}}", "\"channel\": ", "number out of range"));
+    CHECK(rejected("{\"ap\": {\"ssid\": \"dev\", \"channel\": 6.5}}", "\"channel\": ", "integer expected"));
+    CHECK(rejected("{\"ap\": {\"ssid\": \"dev\", \"bandwidth\": 80}}", "\"bandwidth\": ", "bandwidth must be 20 or 40"));
+    CHECK(rejected("{\"ap\": {\"ssid\": \"dev\", \"authmode\": \"wep\"}}", "\"authmode\": ",
+                   "unknown authmode, use wpa2, wpa3, wpa2_wpa3 or wpa_wpa2"));
+    CHECK(rejected("{\"ap\": {\"channel\": 6}}", "6}", "AP without SSID"));
+}
+
+static void test_document(void)
+{
+    wifi_c_config_t config;
+    wifi_c_config_error_t error;
+
+    CHECK(parse("{\"mode\": \"apsta\", \"sta\": {\"ssid\": \"home\"}, \"ap\": {\"ssid\": \"dev\"}}", &config, &error) ==
+          ERR_C_OK);
+    CHECK(config.mode == WIFI_C_MODE_APSTA);
+    CHECK(rejected("{\"mode\": \"ap\", \"sta\": {\"ssid\": \"home\"}}", "", "mode needs AP settings"));
+    CHECK(rejected("{\"mode\": \"mesh\"}", "\"mode\": ", "mode unknown or not compiled in"));
+    CHECK(rejected("{}", "", "no STA network or AP in document"));
+    CHECK(rejected("[]", "", "document must be JSON object"));
+    CHECK(rejected("{\"sta\": {\"ssid\": \"home\"}} x", "} ", "data after end of document"));
+    // unknown members are skipped up to WIFI_C_CONFIG_MAX_DEPTH levels
+    CHECK(parse("{\"x\": [[[[[[[1]]]]]]], \"sta\": {\"ssid\": \"home\"}}", &config, &error) == ERR_C_OK);
+    CHECK(rejected("{\"x\": [[[[[[[[1]]]]]]]], \"sta\": {\"ssid\": \"home\"}}", "[[[[[[[[", "document nested too deep"));
+    CHECK(rejected("{\"sta\": {\"ssid\": \"ho\x01me\"}}", "\"ho", "control character in string"));
+    CHECK(rejected("{\"sta\": {\"ssid\": \"home", "\"home", "unterminated string"));
+
+    CHECK(wifi_c_config_parse(NULL, 0, &config, NULL) == ERR_C_NULL_POINTER);
+}
+
+static void test_apply(void)
+{
+    wifi_c_config_t config;
+    wifi_c_config_error_t error;
+
+    memset(&fake, 0, sizeof(fake));
+    fake.sta_fail_count = 1;
+    CHECK(parse("{\"sta\": [{\"ssid\": \"first\"}, {\"ssid\": \"second\"}, {\"ssid\": \"third\"}], "
+                "\"ap\": {\"ssid\": \"dev\"}}", &config, &error) == ERR_C_OK);
+    CHECK(wifi_c_config_apply(&config) == ERR_C_OK);
+    CHECK(fake.ap == &config.ap);
+    CHECK(fake.sta_calls == 2 && strcmp(fake.sta_ssid, "second") == 0);
+
+    memset(&fake, 0, sizeof(fake));
+    fake.ap_err = WIFI_C_ERR_WIFI_NOT_INIT;
+    CHECK(wifi_c_config_apply(&config) == WIFI_C_ERR_WIFI_NOT_INIT);
+    CHECK(fake.sta_calls == 0);
+}
+
+int main(void)
+{
+    test_sta_networks();
+    test_ssid_length();
+    test_password_length();
+    test_ap_ranges();
+    test_document();
+    test_apply();
+    return TEST_RESULT();
+}
@@ -0,0 +1,347 @@
+/*
+ * Host test of wifi_c::loop and awaitables of wifi_c_coro.hpp.
+ *
+ * Controller functions and FreeRTOS task notifications are faked here: states are set and state handler
+ * is called by the test, blocking in ulTaskNotifyTake() only advances fake time.
+ */
+#include <cstring>
+#include <functional>
+#include "wifi_c_coro.hpp"
+
+extern "C" {
+#include "test_util.h"
+}
+
+namespace {
+
+struct fake_controller {
+    int held;                             // or-ed states wifi_c_wait_for() reports as reached
+    wifi_c_state_handler_t handler;
+    void *handler_arg;
+    int init_err;
+    int deinits;
+    int start_err;
+    const char *ssid;
+    int scan_err;
+    wifi_ap_record_t scanned[2];
+    uint16_t scanned_count;
+    int notify_takes;
+    int notify_gives;
+    TickType_t last_ticks;
+    std::function<void()> on_block;       // runs when loop task blocks, e.g. to reach a state
+    std::function<void(int)> on_check;    // runs when state is checked, argument counts checks
+    int checks;
+};
+
+fake_controller fake;
+
+void reset_fake()
+{
+    fake.held = 0;
+    fake.init_err = ERR_C_OK;
+    fake.deinits = 0;
+    fake.start_err = ERR_C_OK;
+    fake.ssid = nullptr;
+    fake.scan_err = ERR_C_OK;
+    fake.scanned_count = 0;
+    fake.notify_takes = 0;
+    fake.notify_gives = 0;
+    fake.last_ticks = 0;
+    fake.on_block = nullptr;
+    fake.on_check = nullptr;
+    fake.checks = 0;
+    host_shim_time_us = 0;
+}
+
+/*State is visible to wifi_c_wait_for() before handler is called, as on target.*/
+void reach(int state)
+{
+    fake.held |= state;
+    if (fake.handler != nullptr)
+    {
+        fake.handler((wifi_c_state_t)state, fake.handler_arg);
+    }
+}
+
+} // namespace
+
+extern "C" {
+int wifi_c_init_wifi(wifi_c_mode_t mode)
+{
+    (void)mode;
+    return fake.init_err;
+}
+
+void wifi_c_deinit(void)
+{
+    fake.deinits++;
+}
+
+int wifi_c_register_state_handler(wifi_c_state_handler_t handler, void *arg)
+{
+    fake.handler = handler;
+    fake.handler_arg = arg;
+    return ERR_C_OK;
+}
+
+int wifi_c_wait_for(wifi_c_state_t state, uint32_t timeout_ms)
+{
+    (void)timeout_ms;
+    fake.checks++;
+    if (fake.on_check)
+    {
+        fake.on_check(fake.checks);
+    }
+    return (fake.held & state) ? ERR_C_OK : WIFI_C_ERR_WAIT_TIMEOUT;
+}
+
+int wifi_c_start_sta_async(const char *ssid, const char *password)
+{
+    (void)password;
+    fake.ssid = ssid;
+    fake.held &= ~(WIFI_C_STATE_STA_GOT_IP | WIFI_C_STATE_STA_CONNECT_FAILED);
+    return fake.start_err;
+}
+
+int wifi_c_scan_start_async(void)
+{
+    fake.held &= ~WIFI_C_STATE_SCAN_DONE;
+    return fake.scan_err;
+}
+
+int wifi_c_scan_get_results(wifi_c_scan_result_t *result)
+{
+    result->ap_record = reinterpret_cast<wifi_c_ap_record_t *>(fake.scanned);
+    result->ap_count = fake.scanned_count;
+    return ERR_C_OK;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return &fake;
+}
+
+void xTaskNotifyGive(TaskHandle_t task)
+{
+    (void)task;
+    fake.notify_gives++;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks)
+{
+    (void)clear;
+    fake.notify_takes++;
+    fake.last_ticks = ticks;
+    if (fake.on_block)
+    {
+        fake.on_block();
+    }
+    else if (ticks != portMAX_DELAY)
+    {
+        host_shim_time_us += (int64_t)ticks * portTICK_PERIOD_MS * 1000;
+    }
+    return 0;
+}
+}
+
+static wifi_c::task<int> wait_once(wifi_c::loop &loop, int states, uint32_t timeout_ms, int *resumes)
+{
+    int state = co_await loop.wait_for(states, timeout_ms);
+    (*resumes)++;
+    co_return state;
+}
+
+static void test_wifi_owner()
+{
+    reset_fake();
+    {
+        wifi_c::wifi wifi(WIFI_C_MODE_STA);
+        CHECK(wifi);
+    }
+    CHECK(fake.deinits == 1);
+
+    fake.init_err = WIFI_C_ERR_WIFI_ALREADY_INIT;
+    {
+        wifi_c::wifi wifi(WIFI_C_MODE_STA);
+        CHECK(!wifi && wifi.error() == WIFI_C_ERR_WIFI_ALREADY_INIT);
+    }
+    CHECK(fake.deinits == 1);
+}
+
+static void test_ready_state()
+{
+    wifi_c::loop loop;
+    int resumes = 0;
+
+    reset_fake();
+    fake.held = WIFI_C_STATE_STA_GOT_IP;
+    auto op = wait_once(loop, WIFI_C_STATE_STA_GOT_IP | WIFI_C_STATE_SCAN_DONE, WIFI_C_WAIT_FOREVER, &resumes);
+    CHECK(loop.run(op) == WIFI_C_STATE_STA_GOT_IP);
+    CHECK(resumes == 1);
+    CHECK(fake.notify_takes == 0);
+    CHECK(fake.checks == 1); // SCAN_DONE is not checked once GOT_IP holds
+}
+
+static void test_state_before_link()
+{
+    wifi_c::loop loop;
+    int resumes = 0;
+
+    // state reached after await_ready() and before link(), handler found no waiter
+    reset_fake();
+    fake.on_check = [](int checks) {
+        if (checks == 1)
+        {
+            fake.held |= WIFI_C_STATE_SCAN_DONE;
+        }
+    };
+    auto op = wait_once(loop, WIFI_C_STATE_SCAN_DONE, WIFI_C_WAIT_FOREVER, &resumes);
+    loop.start(op);
+    CHECK(op.done() && op.result() == WIFI_C_STATE_SCAN_DONE);
+    CHECK(resumes == 1);
+    CHECK(fake.notify_takes == 0);
+}
+
+static void test_handler_during_link()
+{
+    wifi_c::loop loop;
+    int resumes = 0;
+
+    // handler takes waiter between link() and second check, unlink() fails and waiter is resumed by loop
+    reset_fake();
+    fake.on_check = [](int checks) {
+        if (checks == 2)
+        {
+            reach(WIFI_C_STATE_STA_CONNECT_FAILED);
+        }
+    };
+    auto op = wait_once(loop, WIFI_C_STATE_STA_CONNECT_FAILED, 1000, &resumes);
+    loop.start(op);
+    CHECK(!op.done());
+    CHECK(resumes == 0);
+    CHECK(loop.run(op) == WIFI_C_STATE_STA_CONNECT_FAILED);
+    CHECK(resumes == 1);
+    CHECK(fake.notify_takes == 0); // ready list was not empty, loop didn't block
+}
+
+static void test_timeout()
+{
+    wifi_c::loop loop;
+    int resumes = 0;
+
+    reset_fake();
+    auto op = wait_once(loop, WIFI_C_STATE_STA_GOT_IP, 500, &resumes);
+    CHECK(loop.run(op) == 0);
+    CHECK(resumes == 1);
+    CHECK(fake.notify_takes == 1);
+    CHECK(fake.last_ticks == pdMS_TO_TICKS(500) + 1);
+    CHECK(host_shim_time_us >= 500000);
+
+    // state reached after timeout doesn't resume it again
+    reach(WIFI_C_STATE_STA_GOT_IP);
+    CHECK(resumes == 1);
+}
+
+static void test_waiters_in_order()
+{
+    wifi_c::loop loop;
+    int resumes = 0;
+
+    reset_fake();
+    auto first = wait_once(loop, WIFI_C_STATE_SCAN_DONE, WIFI_C_WAIT_FOREVER, &resumes);
+    auto second = wait_once(loop, WIFI_C_STATE_STA_GOT_IP, 2000, &resumes);
+    loop.start(first);
+    loop.start(second);
+    fake.on_block = [] {
+        CHECK(fake.last_ticks == pdMS_TO_TICKS(2000) + 1); // nearest deadline
+        reach(WIFI_C_STATE_SCAN_DONE);
+    };
+    CHECK(loop.run(first) == WIFI_C_STATE_SCAN_DONE);
+    CHECK(!second.done());
+    CHECK(fake.notify_gives == 1);
+
+    fake.on_block = [] { reach(WIFI_C_STATE_STA_GOT_IP); };
+    CHECK(loop.run(second) == WIFI_C_STATE_STA_GOT_IP);
+    CHECK(resumes == 2);
+}
+
+static void test_connect()
+{
+    wifi_c::loop loop;
+
+    reset_fake();
+    fake.on_block = [] { reach(WIFI_C_STATE_STA_GOT_IP); };
+    auto ok = wifi_c::connect(loop, "home", "password");
+    CHECK(loop.run(ok) == ERR_C_OK);
+    CHECK(fake.ssid != nullptr && strcmp(fake.ssid, "home") == 0);
+
+    // result of previous connect is cleared by start, it's not taken as result of this one
+    fake.on_block = [] { reach(WIFI_C_STATE_STA_CONNECT_FAILED); };
+    auto failed = wifi_c::connect(loop, "home", "password");
+    CHECK(loop.run(failed) == WIFI_C_ERR_STA_CONNECT_FAIL);
+
+    fake.on_block = nullptr;
+    auto timeout = wifi_c::connect(loop, "home", "password", 100);
+    CHECK(loop.run(timeout) == WIFI_C_ERR_STA_TIMEOUT_EXPIRE);
+
+    fake.start_err = WIFI_C_ERR_WIFI_NOT_INIT;
+    fake.notify_takes = 0;
+    auto not_started = wifi_c::connect(loop, "home", "password");
+    CHECK(loop.run(not_started) == WIFI_C_ERR_WIFI_NOT_INIT);
+    CHECK(fake.notify_takes == 0);
+}
+
+#if WIFI_C_SCAN_ENABLED
+static wifi_c::task<int> scan_count(wifi_c::loop &loop, uint32_t timeout_ms, size_t *count)
+{
+    auto result = co_await wifi_c::scan(loop, timeout_ms);
+    *count = result.records.size();
+    if (result.error == ERR_C_OK && *count == 2)
+    {
+        CHECK(strcmp((const char *)result.records[1].ssid, "office") == 0);
+    }
+    co_return result.error;
+}
+
+static void test_scan()
+{
+    wifi_c::loop loop;
+    size_t count = 0;
+
+    reset_fake();
+    strcpy((char *)fake.scanned[0].ssid, "home");
+    strcpy((char *)fake.scanned[1].ssid, "office");
+    fake.scanned_count = 2;
+    fake.on_block = [] { reach(WIFI_C_STATE_SCAN_DONE); };
+    auto done = scan_count(loop, 10000, &count);
+    CHECK(loop.run(done) == ERR_C_OK);
+    CHECK(count == 2);
+
+    // SCAN_DONE of previous scan is cleared by start, this one times out with no records
+    fake.on_block = nullptr;
+    auto timeout = scan_count(loop, 200, &count);
+    CHECK(loop.run(timeout) == WIFI_C_ERR_SCAN_NOT_DONE);
+    CHECK(count == 0);
+
+    fake.scan_err = WIFI_C_ERR_STA_NOT_STARTED;
+    auto not_started = scan_count(loop, 200, &count);
+    CHECK(loop.run(not_started) == WIFI_C_ERR_STA_NOT_STARTED);
+    CHECK(count == 0);
+}
+#endif
+
+int main()
+{
+    test_wifi_owner();
+    test_ready_state();
+    test_state_before_link();
+    test_handler_during_link();
+    test_timeout();
+    test_waiters_in_order();
+    test_connect();
+#if WIFI_C_SCAN_ENABLED
+    test_scan();
+#endif
+    CHECK(fake.handler == nullptr); // every loop unregistered itself
+    return TEST_RESULT();
+}
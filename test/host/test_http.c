@@ -0,0 +1,317 @@
+/*
+ * Host test of HTTP endpoints handler against fake httpd_req_t.
+ *
+ * Source is built with ESP_PLATFORM and CONFIG_WIFI_C_HTTP against shims in test/host/shims. HTTP server
+ * and controller functions streaming state are faked here, their output goes through real wifi_c_stream.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "test_util.h"
+#include "esp_http_server.h"
+#include "err_controller.h"
+#include "wifi_controller.h"
+#include "wifi_c_ctx.h"
+#include "wifi_c_http.h"
+#include "wifi_c_metrics.h"
+#include "wifi_c_stream.h"
+
+#define SERVER ((httpd_handle_t)0x1)
+
+static int own_ctx;                         // storage of opaque context created by application
+
+static struct {
+    httpd_uri_t handlers[8];
+    size_t registered;
+    size_t register_calls;
+    size_t register_fail_at;                // call which returns error, 0 never fails
+} server;
+
+static struct {
+    char body[2048];
+    size_t len;
+    size_t chunks;
+    size_t chunk_fail_at;                   // chunk which returns error, 0 never fails
+    bool ended;                             // zero length chunk was sent
+    const char *type;
+    const char *status;
+    const char *cache_control;
+    int err_code;                           // code of httpd_resp_send_err(), -1 not sent
+} response;
+
+static struct {
+    int default_ctx;                        // storage of opaque default context
+    wifi_c_ctx_t *source_ctx;               // context passed to ctx version of source
+    int status_copies;                      // status taken through controller task
+    int scan_err;
+} controller;
+
+static void reset(void)
+{
+    memset(&response, 0, sizeof(response));
+    response.err_code = -1;
+    memset(&controller, 0, sizeof(controller));
+}
+
+esp_err_t httpd_register_uri_handler(httpd_handle_t handle, const httpd_uri_t *uri)
+{
+    (void)handle;
+    if (++server.register_calls == server.register_fail_at)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    server.handlers[server.registered++] = *uri;
+    return ESP_OK;
+}
+
+esp_err_t httpd_unregister_uri_handler(httpd_handle_t handle, const char *uri, httpd_method_t method)
+{
+    (void)handle;
+    for (size_t i = 0; i < server.registered; i++)
+    {
+        if (strcmp(server.handlers[i].uri, uri) == 0 && server.handlers[i].method == method)
+        {
+            server.handlers[i] = server.handlers[--server.registered];
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t httpd_resp_set_type(httpd_req_t *req, const char *type)
+{
+    (void)req;
+    response.type = type;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_status(httpd_req_t *req, const char *status)
+{
+    (void)req;
+    response.status = status;
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_set_hdr(httpd_req_t *req, const char *field, const char *value)
+{
+    (void)req;
+    if (strcmp(field, "Cache-Control") == 0)
+    {
+        response.cache_control = value;
+    }
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_chunk(httpd_req_t *req, const char *buf, ssize_t len)
+{
+    (void)req;
+    if (++response.chunks == response.chunk_fail_at)
+    {
+        return ESP_FAIL;
+    }
+    if (buf == NULL || len == 0)
+    {
+        response.ended = true;
+        return ESP_OK;
+    }
+    memcpy(&response.body[response.len], buf, (size_t)len);
+    response.len += (size_t)len;
+    response.body[response.len] = '\0';
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_sendstr(httpd_req_t *req, const char *str)
+{
+    (void)req;
+    response.len = strlen(str);
+    memcpy(response.body, str, response.len + 1);
+    return ESP_OK;
+}
+
+esp_err_t httpd_resp_send_err(httpd_req_t *req, httpd_err_code_t error, const char *msg)
+{
+    (void)req;
+    (void)msg;
+    response.err_code = error;
+    return ESP_OK;
+}
+
+const char *error_to_name(int err)
+{
+    return (err == WIFI_C_ERR_SCAN_NOT_DONE) ? "WIFI_C_ERR_SCAN_NOT_DONE" : NULL;
+}
+
+const char *esp_err_to_name(esp_err_t err)
+{
+    (void)err;
+    return "ESP_FAIL";
+}
+
+wifi_c_ctx_t *wifi_c_ctx_get_default(void)
+{
+    return (wifi_c_ctx_t *)&controller.default_ctx;
+}
+
+/**
+ * @brief Stream JSON object longer than one chunk, as status of real controller is.
+ */
+static int stream_status(const char *name, wifi_c_stream_sink_t sink, void *arg)
+{
+    wifi_c_stream_t stream;
+
+    wifi_c_stream_init(&stream, sink, arg);
+    wifi_c_stream_printf(&stream, "{\"source\": \"%s\"", name);
+    for (int i = 0; i < 40; i++)
+    {
+        wifi_c_stream_printf(&stream, ", \"field_%02d\": false", i);
+    }
+    wifi_c_stream_write(&stream, "}", 1);
+    return wifi_c_stream_finish(&stream);
+}
+
+int wifi_c_stream_status_json(wifi_c_stream_sink_t sink, void *arg)
+{
+    controller.status_copies++;
+    return stream_status("default", sink, arg);
+}
+
+int wifi_c_ctx_stream_status_json(wifi_c_ctx_t *ctx, wifi_c_stream_sink_t sink, void *arg)
+{
+    controller.source_ctx = ctx;
+    return stream_status("ctx", sink, arg);
+}
+
+int wifi_c_stream_scan_json(wifi_c_stream_sink_t sink, void *arg)
+{
+    return (controller.scan_err != ERR_C_OK) ? controller.scan_err : sink("[]", 2, arg);
+}
+
+int wifi_c_ctx_stream_scan_json(wifi_c_ctx_t *ctx, wifi_c_stream_sink_t sink, void *arg)
+{
+    controller.source_ctx = ctx;
+    return sink("[]", 2, arg);
+}
+
+int wifi_c_ctx_stream_stations_json(wifi_c_ctx_t *ctx, wifi_c_stream_sink_t sink, void *arg)
+{
+    controller.source_ctx = ctx;
+    return sink("[]", 2, arg);
+}
+
+int wifi_c_metrics_stream_prometheus(wifi_c_stream_sink_t sink, void *arg)
+{
+    static const char text[] = "wifi_c_sta_connects_total 1\n";
+    return sink(text, sizeof(text) - 1, arg);
+}
+
+/**
+ * @brief Call handler registered for uri as server does for request with given target.
+ */
+static esp_err_t get(const char *uri, const char *target)
+{
+    httpd_req_t req = {.method = HTTP_GET};
+
+    strncpy(req.uri, target, HTTPD_MAX_URI_LEN);
+    for (size_t i = 0; i < server.registered; i++)
+    {
+        if (strcmp(server.handlers[i].uri, uri) == 0)
+        {
+            req.user_ctx = server.handlers[i].user_ctx;
+            return server.handlers[i].handler(&req);
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+static void test_register(void)
+{
+    wifi_c_ctx_t *own = (wifi_c_ctx_t *)&own_ctx;
+
+    memset(&server, 0, sizeof(server));
+    server.register_fail_at = 3;
+    CHECK(wifi_c_http_register(SERVER, NULL) == ESP_ERR_NO_MEM);
+    CHECK(server.registered == 0);
+
+    memset(&server, 0, sizeof(server));
+    CHECK(wifi_c_http_register(NULL, NULL) == ERR_C_NULL_POINTER);
+    CHECK(wifi_c_http_register(SERVER, own) == ESP_OK);
+    CHECK(server.registered == WIFI_C_HTTP_URI_COUNT);
+    CHECK(server.handlers[0].method == HTTP_GET && server.handlers[0].user_ctx == own);
+    wifi_c_http_unregister(SERVER);
+    CHECK(server.registered == 0);
+}
+
+static void test_status(void)
+{
+    memset(&server, 0, sizeof(server));
+    CHECK(wifi_c_http_register(SERVER, NULL) == ESP_OK);
+
+    reset();
+    CHECK(get("/wifi/status", "/wifi/status?pretty=1") == ESP_OK);
+    CHECK(controller.status_copies == 1 && controller.source_ctx == NULL);
+    CHECK(response.type != NULL && strcmp(response.type, "application/json") == 0);
+    CHECK(response.cache_control != NULL && strcmp(response.cache_control, "no-store") == 0);
+    CHECK(response.status == NULL);
+    // body is longer than chunk, it goes out in pieces and ends with empty chunk
+    CHECK(response.len > WIFI_C_STREAM_CHUNK_SIZE && response.chunks == response.len / WIFI_C_STREAM_CHUNK_SIZE + 2);
+    CHECK(response.ended);
+    CHECK(strncmp(response.body, "{\"source\": \"default\",", 21) == 0 && response.body[response.len - 1] == '}');
+
+    reset();
+    CHECK(get("/wifi/metrics", "/wifi/metrics") == ESP_OK);
+    CHECK(strcmp(response.type, "text/plain; version=0.0.4") == 0);
+    CHECK(strcmp(response.body, "wifi_c_sta_connects_total 1\n") == 0 && response.ended);
+
+    reset();
+    CHECK(get("/wifi/status", "/wifi/nothing") == ESP_OK);
+    CHECK(response.err_code == HTTPD_404_NOT_FOUND && response.chunks == 0);
+    wifi_c_http_unregister(SERVER);
+}
+
+static void test_own_ctx(void)
+{
+    wifi_c_ctx_t *own = (wifi_c_ctx_t *)&own_ctx;
+
+    memset(&server, 0, sizeof(server));
+    CHECK(wifi_c_http_register(SERVER, own) == ESP_OK);
+
+    reset();
+    CHECK(get("/wifi/status", "/wifi/status") == ESP_OK);
+    CHECK(controller.status_copies == 0 && controller.source_ctx == own);
+    CHECK(strncmp(response.body, "{\"source\": \"ctx\",", 17) == 0 && response.ended);
+
+    reset();
+    CHECK(get("/wifi/scan", "/wifi/scan") == ESP_OK);
+    CHECK(controller.source_ctx == own && strcmp(response.body, "[]") == 0);
+    wifi_c_http_unregister(SERVER);
+}
+
+static void test_errors(void)
+{
+    memset(&server, 0, sizeof(server));
+    CHECK(wifi_c_http_register(SERVER, NULL) == ESP_OK);
+
+    // nothing sent yet, error status can still be set
+    reset();
+    controller.scan_err = WIFI_C_ERR_SCAN_NOT_DONE;
+    CHECK(get("/wifi/scan", "/wifi/scan") == ESP_OK);
+    CHECK(response.status != NULL && strcmp(response.status, "503 Service Unavailable") == 0);
+    CHECK(strcmp(response.body, "{\"error\": \"WIFI_C_ERR_SCAN_NOT_DONE\"}") == 0);
+    CHECK(response.chunks == 0);
+
+    // client gone after first chunk, response is cut without end chunk
+    reset();
+    response.chunk_fail_at = 2;
+    CHECK(get("/wifi/status", "/wifi/status") == ESP_FAIL);
+    CHECK(response.len == WIFI_C_STREAM_CHUNK_SIZE && !response.ended && response.status == NULL);
+    wifi_c_http_unregister(SERVER);
+}
+
+int main(void)
+{
+    test_register();
+    test_status();
+    test_own_ctx();
+    test_errors();
+    return TEST_RESULT();
+}
@@ -0,0 +1,198 @@
+/*
+ * Host test of chunked stream and JSON emitters of BSSID history and metrics.
+ *
+ * Sources are built with ESP_PLATFORM against shims in test/host/shims.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "test_util.h"
+#include "esp_timer.h"
+#include "err_controller.h"
+#include "wifi_controller.h"
+#include "wifi_c_history.h"
+#include "wifi_c_metrics.h"
+#include "wifi_c_stream.h"
+
+struct collect_sink {
+    char data[8192];
+    size_t len;
+    size_t chunks[16];
+    size_t calls;
+    size_t fail_at;                         // call which returns error, 0 never fails
+};
+
+static int collect(const char *data, size_t len, void *arg)
+{
+    struct collect_sink *sink = (struct collect_sink *)arg;
+
+    sink->calls++;
+    if (sink->calls == sink->fail_at)
+    {
+        return 5;
+    }
+    if (sink->calls <= sizeof(sink->chunks) / sizeof(sink->chunks[0]))
+    {
+        sink->chunks[sink->calls - 1] = len;
+    }
+    memcpy(&sink->data[sink->len], data, len);
+    sink->len += len;
+    sink->data[sink->len] = '\0';
+    return 0;
+}
+
+static void test_stream_chunks(void)
+{
+    struct collect_sink sink = {0};
+    wifi_c_stream_t stream;
+    char data[600];
+
+    for (size_t i = 0; i < sizeof(data); i++)
+    {
+        data[i] = (char)('a' + i % 26);
+    }
+    wifi_c_stream_init(&stream, collect, &sink);
+    wifi_c_stream_write(&stream, data, 100);
+    CHECK(sink.calls == 0);
+    wifi_c_stream_write(&stream, &data[100], sizeof(data) - 100);
+    CHECK(sink.calls == 2);
+    CHECK(wifi_c_stream_finish(&stream) == 0);
+    CHECK(sink.calls == 3);
+    CHECK(sink.chunks[0] == WIFI_C_STREAM_CHUNK_SIZE);
+    CHECK(sink.chunks[1] == WIFI_C_STREAM_CHUNK_SIZE);
+    CHECK(sink.chunks[2] == sizeof(data) - 2 * WIFI_C_STREAM_CHUNK_SIZE);
+    CHECK(sink.len == sizeof(data) && memcmp(sink.data, data, sizeof(data)) == 0);
+
+    // nothing left, finish doesn't call sink with empty chunk
+    CHECK(wifi_c_stream_finish(&stream) == 0);
+    CHECK(sink.calls == 3);
+}
+
+static void test_stream_sink_error(void)
+{
+    struct collect_sink sink = {.fail_at = 2};
+    wifi_c_stream_t stream;
+    char data[WIFI_C_STREAM_CHUNK_SIZE * 3] = {0};
+
+    wifi_c_stream_init(&stream, collect, &sink);
+    wifi_c_stream_write(&stream, data, sizeof(data));
+    wifi_c_stream_printf(&stream, "dropped %d", 1);
+    CHECK(wifi_c_stream_finish(&stream) == 5);
+    CHECK(sink.calls == 2);
+    CHECK(sink.len == WIFI_C_STREAM_CHUNK_SIZE);
+}
+
+static void test_stream_printf_cut(void)
+{
+    struct collect_sink sink = {0};
+    wifi_c_stream_t stream;
+
+    wifi_c_stream_init(&stream, collect, &sink);
+    wifi_c_stream_printf(&stream, "%0300d", 7);
+    CHECK(wifi_c_stream_finish(&stream) == 0);
+    CHECK(sink.len == WIFI_C_STREAM_CHUNK_SIZE - 1);
+}
+
+static void test_stream_json_string(void)
+{
+    struct collect_sink sink = {0};
+    wifi_c_stream_t stream;
+    char ssid[32];
+
+    wifi_c_stream_init(&stream, collect, &sink);
+    wifi_c_stream_json_string(&stream, "a\"b\\c\n\x1f", 16);
+    CHECK(wifi_c_stream_finish(&stream) == 0);
+    CHECK(strcmp(sink.data, "\"a\\\"b\\\\c\\u000a\\u001f\"") == 0);
+
+    // SSID of 32 characters is not null terminated
+    memset(&sink, 0, sizeof(sink));
+    memset(ssid, 'x', sizeof(ssid));
+    wifi_c_stream_init(&stream, collect, &sink);
+    wifi_c_stream_json_string(&stream, ssid, sizeof(ssid));
+    CHECK(wifi_c_stream_finish(&stream) == 0);
+    CHECK(sink.len == sizeof(ssid) + 2);
+}
+
+static void test_history_json(void)
+{
+    wifi_c_history_config_t config = {.max_bssids = 4, .max_ssids = 4};
+    wifi_ap_record_t records[2] = {
+        {.bssid = {0x10, 0x20, 0x30, 0x40, 0x50, 0x01}, .ssid = "home", .primary = 6, .rssi = -60},
+        {.bssid = {0x10, 0x20, 0x30, 0x40, 0x50, 0x02}, .ssid = "\"q\"", .primary = 11, .rssi = -70},
+    };
+    char buffer[512];
+
+    CHECK(wifi_c_history_store_as_json(buffer, sizeof(buffer)) == WIFI_C_ERR_HISTORY_NOT_INIT);
+    CHECK(wifi_c_history_init(&config) == ERR_C_OK);
+
+    CHECK(wifi_c_history_store_as_json(buffer, sizeof(buffer)) == ERR_C_OK);
+    CHECK(strcmp(buffer, "[]") == 0);
+
+    host_shim_time_us = 1000000;
+    CHECK(wifi_c_history_add_scan(records, 2) == ERR_C_OK);
+    records[0].rssi = -50;
+    records[0].primary = 1;
+    host_shim_time_us = 3000000;
+    CHECK(wifi_c_history_add_scan(records, 1) == ERR_C_OK);
+
+    // most recently seen first
+    CHECK(wifi_c_history_store_as_json(buffer, sizeof(buffer)) == ERR_C_OK);
+    CHECK(strcmp(buffer,
+                 "[{\"bssid\": \"10:20:30:40:50:01\", \"ssid\": \"home\", \"channel\": 1, \"rssi_min\": -60, "
+                 "\"rssi_max\": -50, \"rssi_mean\": -55, \"seen\": 2, \"channel_changes\": 1, \"first_seen_ms\": 1000, "
+                 "\"last_seen_ms\": 3000}, "
+                 "{\"bssid\": \"10:20:30:40:50:02\", \"ssid\": \"\\\"q\\\"\", \"channel\": 11, \"rssi_min\": -70, "
+                 "\"rssi_max\": -70, \"rssi_mean\": -70, \"seen\": 1, \"channel_changes\": 0, \"first_seen_ms\": 1000, "
+                 "\"last_seen_ms\": 1000}]") == 0);
+
+    // records which don't fit are left out, output stays valid JSON
+    CHECK(wifi_c_history_store_as_json(buffer, 200) == ERR_C_OK);
+    CHECK(strncmp(buffer, "[{\"bssid\": \"10:20:30:40:50:01\"", 30) == 0);
+    CHECK(strcmp(&buffer[strlen(buffer) - 3], "0}]") == 0);
+    CHECK(wifi_c_history_store_as_json(buffer, 3) == ERR_C_OK);
+    CHECK(strcmp(buffer, "[]") == 0);
+    CHECK(wifi_c_history_store_as_json(buffer, 2) == ERR_C_INVALID_ARGS);
+
+    wifi_c_history_deinit();
+}
+
+static void test_metrics_json(void)
+{
+    char buffer[8192];
+    char small[16];
+    struct collect_sink sink = {0};
+    int len = 0;
+
+    wifi_c_metrics_reset();
+    wifi_c_metrics_connect_attempt();
+    wifi_c_metrics_disconnect(8);
+    wifi_c_metrics_ap_station(true);
+
+    len = wifi_c_metrics_store_as_json(buffer, sizeof(buffer));
+    CHECK(len == (int)strlen(buffer));
+    CHECK(strncmp(buffer, "{\"connect_attempts_total\":1,", 28) == 0);
+    CHECK(strstr(buffer, ",\"ap_clients\":1,") != NULL);
+    CHECK(strstr(buffer, ",\"disconnect_reasons\":{\"8\":1}}") == &buffer[len - 30]);
+
+    // too small buffer gets terminated prefix, return value is full length
+    CHECK(wifi_c_metrics_store_as_json(small, sizeof(small)) == len);
+    CHECK(strlen(small) == sizeof(small) - 1);
+
+    // streamed output is the same as stored one
+    len = wifi_c_metrics_store_as_prometheus(buffer, sizeof(buffer));
+    CHECK(len > 0 && (size_t)len < sizeof(buffer));
+    CHECK(wifi_c_metrics_stream_prometheus(collect, &sink) == 0);
+    CHECK(sink.len == (size_t)len && strcmp(sink.data, buffer) == 0);
+    CHECK(strstr(buffer, "wifi_c_disconnect_reasons_total{reason=\"8\"} 1\n") != NULL);
+}
+
+int main(void)
+{
+    test_stream_chunks();
+    test_stream_sink_error();
+    test_stream_printf_cut();
+    test_stream_json_string();
+    test_history_json();
+    test_metrics_json();
+    return TEST_RESULT();
+}
@@ -0,0 +1,180 @@
+/*
+ * Host test of STA connection state machine, each simulated device has its own link and status.
+ *
+ * Devices run in parallel threads with scripted events, results must match sequential run of the same
+ * scripts, so links share nothing. Source is built with ESP_PLATFORM against shims in test/host/shims.
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "test_util.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+#include "esp_wifi.h"
+#include "wifi_controller.h"
+#include "wifi_c_link.h"
+
+#define DEVICES         256
+#define ROUNDS          500
+
+/**
+ * @brief Simulated device, counters are filled by script and compared after run.
+ */
+struct device {
+    wifi_c_status_t status;
+    wifi_c_link_t link;
+    char ssid[33];
+    uint32_t id;
+    uint32_t seed;
+    uint32_t reconnects;
+    uint32_t failures;
+    uint32_t connects;
+    uint32_t errors;                        // steps which were not what script expected
+};
+
+static struct device threaded[DEVICES];
+static struct device sequential[DEVICES];
+
+static uint32_t next_random(uint32_t *seed)
+{
+    *seed = *seed * 1664525u + 1013904223u;
+    return *seed >> 16;
+}
+
+static void device_init(struct device *device, uint32_t id)
+{
+    memset(device, 0, sizeof(*device));
+    device->status = (wifi_c_status_t){.sta.ip = "0.0.0.0", .sta.ssid = "none"};
+    device->id = id;
+    device->seed = id * 2654435761u + 1;
+    snprintf(device->ssid, sizeof(device->ssid), "net-%u", (unsigned)id);
+    wifi_c_link_init(&device->link, &device->status, device->ssid, WIFI_C_STA_RETRY_COUNT);
+}
+
+static void expect(struct device *device, bool ok)
+{
+    if (!ok)
+    {
+        device->errors++;
+    }
+}
+
+/**
+ * @brief Each round link is lost some times before it connects, or fails when retry budget is used up.
+ */
+static void *device_run(void *arg)
+{
+    struct device *device = arg;
+    wifi_c_link_step_t step;
+    ip_event_got_ip_t got_ip = {.ip_info.ip.addr = ESP_IP4TOADDR(10, (device->id >> 8) & 0xff, device->id & 0xff, 1)};
+    char ip[20];
+
+    snprintf(ip, sizeof(ip), IPSTR, IP2STR(&got_ip.ip_info.ip));
+    step = wifi_c_link_on_event(&device->link, WIFI_EVENT, WIFI_EVENT_STA_START, NULL);
+    expect(device, step.set_bits == WIFI_C_STA_STARTED_BIT && device->status.sta_started);
+
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        uint32_t losses = next_random(&device->seed) % (WIFI_C_STA_RETRY_COUNT + 3);
+        bool failed = false;
+
+        for (uint32_t i = 0; i < losses && !failed; i++)
+        {
+            step = wifi_c_link_on_event(&device->link, WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, NULL);
+            expect(device, step.clear_bits == (WIFI_C_STA_LINK_UP_BIT | WIFI_C_CONNECTED_BIT));
+            if (step.reconnect)
+            {
+                device->reconnects++;
+                expect(device, step.set_bits == 0 && device->link.retry_num == i + 1);
+            }
+            else
+            {
+                device->failures++;
+                failed = true;
+                expect(device, step.set_bits == WIFI_C_CONNECT_FAIL_BIT && i == WIFI_C_STA_RETRY_COUNT);
+            }
+        }
+        if (failed)
+        {
+            device->link.retry_num = 0; // application connects again with whole budget
+            continue;
+        }
+
+        step = wifi_c_link_on_event(&device->link, WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, NULL);
+        expect(device, step.set_bits == WIFI_C_STA_LINK_UP_BIT && !step.reconnect);
+        step = wifi_c_link_on_event(&device->link, IP_EVENT, IP_EVENT_STA_GOT_IP, &got_ip);
+        expect(device, step.set_bits == WIFI_C_CONNECTED_BIT && device->link.retry_num == 0);
+        expect(device, device->status.sta_connected && strcmp(device->status.sta.ip, ip) == 0 &&
+                       strcmp(device->status.sta.ssid, device->ssid) == 0);
+        device->connects++;
+    }
+    return NULL;
+}
+
+static void test_parallel_devices(void)
+{
+    pthread_t threads[DEVICES];
+    uint32_t errors = 0;
+    bool same = true;
+
+    for (uint32_t i = 0; i < DEVICES; i++)
+    {
+        device_init(&threaded[i], i);
+        device_init(&sequential[i], i);
+        device_run(&sequential[i]);
+    }
+    for (uint32_t i = 0; i < DEVICES; i++)
+    {
+        CHECK(pthread_create(&threads[i], NULL, device_run, &threaded[i]) == 0);
+    }
+    for (uint32_t i = 0; i < DEVICES; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    for (uint32_t i = 0; i < DEVICES; i++)
+    {
+        errors += threaded[i].errors + sequential[i].errors;
+        same = same && threaded[i].reconnects == sequential[i].reconnects &&
+               threaded[i].failures == sequential[i].failures && threaded[i].connects == sequential[i].connects;
+        CHECK(threaded[i].connects + threaded[i].failures == ROUNDS);
+    }
+    CHECK(errors == 0);
+    CHECK(same);
+    // scripts must exercise both outcomes
+    CHECK(threaded[0].failures > 0 && threaded[0].reconnects > 0);
+    printf("%u devices, %u rounds each, errors %u\n", (unsigned)DEVICES, (unsigned)ROUNDS, (unsigned)errors);
+}
+
+static void test_suspend_stop_scan(void)
+{
+    struct device device;
+    wifi_c_link_step_t step;
+
+    device_init(&device, 1);
+    device.status.suspended = true;
+    device.link.retry_num = 2;
+    step = wifi_c_link_on_event(&device.link, WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, NULL);
+    CHECK(!step.reconnect && step.set_bits == 0 && device.link.retry_num == 2);
+
+    step = wifi_c_link_on_event(&device.link, WIFI_EVENT, WIFI_EVENT_STA_START, NULL);
+    step = wifi_c_link_on_event(&device.link, WIFI_EVENT, WIFI_EVENT_STA_STOP, NULL);
+    CHECK(!device.status.sta_started && step.set_bits == 0);
+    CHECK(step.clear_bits == (WIFI_C_STA_STARTED_BIT | WIFI_C_STA_LINK_UP_BIT | WIFI_C_CONNECTED_BIT));
+
+    step = wifi_c_link_on_event(&device.link, WIFI_EVENT, WIFI_EVENT_SCAN_DONE, NULL);
+    CHECK(device.status.scan_done && step.set_bits == WIFI_C_SCAN_DONE_BIT);
+
+    // events of AP are not part of STA link
+    step = wifi_c_link_on_event(&device.link, WIFI_EVENT, WIFI_EVENT_AP_STACONNECTED, NULL);
+    CHECK(step.set_bits == 0 && step.clear_bits == 0 && !step.reconnect);
+}
+
+int main(void)
+{
+    test_suspend_stop_scan();
+    test_parallel_devices();
+    return TEST_RESULT();
+}
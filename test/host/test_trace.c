@@ -0,0 +1,95 @@
+/*
+ * Host test of dumped trace parser - see src/wifi_c_trace.c.
+ */
+#include <stdint.h>
+#include <string.h>
+#include "wifi_c_trace.h"
+#include "test_util.h"
+
+static size_t put_header(uint8_t *trace, uint32_t magic, uint8_t version)
+{
+    wifi_c_trace_header_t header = {.magic = magic, .version = version, .dropped = 3};
+    memcpy(trace, &header, sizeof(header));
+    return sizeof(header);
+}
+
+static size_t put_record(uint8_t *trace, size_t offset, uint32_t delta_us, uint8_t base, uint8_t id, uint8_t len)
+{
+    wifi_c_trace_record_t record = {.delta_us = delta_us, .base = base, .id = id, .len = len};
+    memcpy(&trace[offset], &record, sizeof(record));
+    memset(&trace[offset + sizeof(record)], 0xA5, len);
+    return offset + sizeof(record) + len;
+}
+
+static void test_header(void)
+{
+    uint8_t trace[32];
+    size_t offset = 0;
+
+    CHECK(!wifi_c_trace_begin(NULL, 0, &offset));
+    put_header(trace, WIFI_C_TRACE_MAGIC, WIFI_C_TRACE_VERSION);
+    CHECK(!wifi_c_trace_begin(trace, sizeof(wifi_c_trace_header_t) - 1, &offset));
+    CHECK(wifi_c_trace_begin(trace, sizeof(wifi_c_trace_header_t), &offset));
+    CHECK(offset == sizeof(wifi_c_trace_header_t));
+
+    put_header(trace, WIFI_C_TRACE_MAGIC + 1, WIFI_C_TRACE_VERSION);
+    CHECK(!wifi_c_trace_begin(trace, sizeof(trace), &offset));
+    put_header(trace, WIFI_C_TRACE_MAGIC, WIFI_C_TRACE_VERSION + 1);
+    CHECK(!wifi_c_trace_begin(trace, sizeof(trace), &offset));
+}
+
+static void test_records(void)
+{
+    uint8_t trace[128];
+    size_t len = put_header(trace, WIFI_C_TRACE_MAGIC, WIFI_C_TRACE_VERSION);
+    size_t offset = 0;
+    wifi_c_trace_event_t event;
+
+    len = put_record(trace, len, 0, WIFI_C_TRACE_BASE_WIFI, 2, 0);
+    len = put_record(trace, len, 1500, WIFI_C_TRACE_BASE_WIFI, 5, 42);
+    len = put_record(trace, len, 20, WIFI_C_TRACE_BASE_IP, 0, 13);
+
+    CHECK(wifi_c_trace_begin(trace, len, &offset));
+    CHECK(wifi_c_trace_next(trace, len, &offset, &event));
+    CHECK(event.record.base == WIFI_C_TRACE_BASE_WIFI && event.record.id == 2 && event.record.len == 0);
+    CHECK(wifi_c_trace_next(trace, len, &offset, &event));
+    CHECK(event.record.delta_us == 1500 && event.record.id == 5 && event.record.len == 42);
+    CHECK(event.payload == &trace[sizeof(wifi_c_trace_header_t) + 2 * sizeof(wifi_c_trace_record_t)]);
+    CHECK(event.payload[0] == 0xA5 && event.payload[41] == 0xA5);
+    CHECK(wifi_c_trace_next(trace, len, &offset, &event));
+    CHECK(event.record.base == WIFI_C_TRACE_BASE_IP && event.record.len == 13);
+    CHECK(offset == len);
+    CHECK(!wifi_c_trace_next(trace, len, &offset, &event));
+}
+
+static void test_truncated(void)
+{
+    uint8_t trace[128];
+    size_t len = put_header(trace, WIFI_C_TRACE_MAGIC, WIFI_C_TRACE_VERSION);
+    size_t first = 0;
+    size_t offset = 0;
+    wifi_c_trace_event_t event;
+
+    first = len = put_record(trace, len, 0, WIFI_C_TRACE_BASE_WIFI, 4, 40);
+    len = put_record(trace, len, 10, WIFI_C_TRACE_BASE_WIFI, 5, 42);
+
+    // payload of last record cut off
+    CHECK(wifi_c_trace_begin(trace, len - 1, &offset));
+    CHECK(wifi_c_trace_next(trace, len - 1, &offset, &event));
+    CHECK(!wifi_c_trace_next(trace, len - 1, &offset, &event));
+    CHECK(offset == first);
+
+    // header of last record cut off
+    offset = sizeof(wifi_c_trace_header_t);
+    CHECK(wifi_c_trace_next(trace, first + 4, &offset, &event));
+    CHECK(!wifi_c_trace_next(trace, first + 4, &offset, &event));
+    CHECK(offset == first);
+}
+
+int main(void)
+{
+    test_header();
+    test_records();
+    test_truncated();
+    return TEST_RESULT();
+}
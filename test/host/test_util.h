@@ -0,0 +1,19 @@
+/*
+ * Minimal checks for host tests, failed check is printed and makes test exit with 1.
+ */
+#pragma once
+
+#include <stdio.h>
+
+static int test_failures = 0;
+
+#define CHECK(cond)                                                             \
+    do {                                                                        \
+        if (!(cond))                                                            \
+        {                                                                       \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);     \
+            test_failures++;                                                    \
+        }                                                                       \
+    } while (0)
+
+#define TEST_RESULT() (test_failures == 0 ? 0 : 1)
@@ -0,0 +1,105 @@
+#!/usr/bin/env bash
+#
+# Build a minimal application for every wifi_controller Kconfig role
+# configuration and print flash/RAM usage, compared with the full build.
+#
+# Usage: tools/size_report.sh [target]
+#
+# Needs exported ESP-IDF environment (idf.py in PATH). Components that
+# wifi_controller depends on (err_controller, logger, memory_utils) are
+# searched in directories listed in WIFI_C_EXTRA_COMPONENT_DIRS.
+
+set -euo pipefail
+
+TARGET="${1:-esp32}"
+COMPONENT_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+WORK_DIR="$(mktemp -d)"
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+CONFIGS=(
+    "full:"
+    "sta_only:CONFIG_WIFI_C_ROLE_STA_ONLY=y"
+    "ap_only:CONFIG_WIFI_C_ROLE_AP_ONLY=y"
+    "sta_no_scan:CONFIG_WIFI_C_ROLE_STA_ONLY=y CONFIG_WIFI_C_DISABLE_SCAN=y"
+    "sta_no_scan_no_json:CONFIG_WIFI_C_ROLE_STA_ONLY=y CONFIG_WIFI_C_DISABLE_SCAN=y CONFIG_WIFI_C_DISABLE_JSON=y CONFIG_WIFI_C_LOG_LEVEL_WARN=y"
+)
+
+mkdir -p "$WORK_DIR/app/main"
+cat > "$WORK_DIR/app/CMakeLists.txt" <<CMAKE
+cmake_minimum_required(VERSION 3.16)
+set(EXTRA_COMPONENT_DIRS "$COMPONENT_DIR" ${WIFI_C_EXTRA_COMPONENT_DIRS:-})
+include(\$ENV{IDF_PATH}/tools/cmake/project.cmake)
+project(wifi_c_size)
+CMAKE
+
+cat > "$WORK_DIR/app/main/CMakeLists.txt" <<CMAKE
+idf_component_register(SRCS "main.c" REQUIRES $(basename "$COMPONENT_DIR") nvs_flash)
+CMAKE
+
+# Application uses every function compiled in, so nothing is dropped by the linker.
+cat > "$WORK_DIR/app/main/main.c" <<'C'
+#include "nvs_flash.h"
+#include "wifi_controller.h"
+
+void app_main(void)
+{
+    static char buffer[512];
+    nvs_flash_init();
+#if WIFI_C_STA_ENABLED
+    wifi_c_init_wifi(WIFI_C_MODE_STA);
+    wifi_c_start_sta("SSID", "PASSWORD");
+#endif
+#if WIFI_C_AP_ENABLED
+    wifi_c_init_wifi(WIFI_C_MODE_AP);
+    wifi_c_start_ap("SSID", "PASSWORD");
+#endif
+#if WIFI_C_SCAN_ENABLED
+    wifi_c_scan_result_t result;
+    wifi_c_scan_all_ap(&result);
+    wifi_c_print_scanned_ap();
+#endif
+#if WIFI_C_JSON_ENABLED
+    wifi_c_get_status_as_json(buffer, sizeof(buffer));
+#endif
+#if WIFI_C_SCAN_ENABLED && WIFI_C_JSON_ENABLED
+    wifi_c_store_scan_result_as_json(buffer, sizeof(buffer));
+#endif
+    wifi_c_deinit();
+}
+C
+
+size_of() {
+    python3 - "$1" <<'PY'
+import json, sys
+d = json.load(open(sys.argv[1]))
+flash = sum(d.get(k, 0) for k in ("flash_code", "flash_rodata", "flash_other"))
+ram = d.get("used_dram", d.get("dram_data", 0) + d.get("dram_bss", 0))
+print(flash, ram)
+PY
+}
+
+printf "%-22s %10s %10s %10s %10s\n" "config" "flash" "d_flash" "dram" "d_dram"
+base_flash=""
+base_ram=""
+for entry in "${CONFIGS[@]}"; do
+    name="${entry%%:*}"
+    options="${entry#*:}"
+    defaults="$WORK_DIR/sdkconfig.$name"
+    : > "$defaults"
+    for option in $options; do
+        echo "$option" >> "$defaults"
+    done
+
+    build="$WORK_DIR/build_$name"
+    idf.py -C "$WORK_DIR/app" -B "$build" -D SDKCONFIG="$build/sdkconfig" \
+        -D SDKCONFIG_DEFAULTS="$defaults" set-target "$TARGET" > /dev/null
+    idf.py -C "$WORK_DIR/app" -B "$build" -D SDKCONFIG="$build/sdkconfig" build > /dev/null
+    idf.py -C "$WORK_DIR/app" -B "$build" -D SDKCONFIG="$build/sdkconfig" size --format json --output-file "$build/size.json" > /dev/null
+
+    read -r flash ram < <(size_of "$build/size.json")
+    if [ -z "$base_flash" ]; then
+        base_flash="$flash"
+        base_ram="$ram"
+    fi
+    printf "%-22s %10d %10d %10d %10d\n" "$name" "$flash" "$((flash - base_flash))" "$ram" "$((ram - base_ram))"
+done
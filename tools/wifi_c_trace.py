@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+#
+# Read WiFi/IP event traces recorded by wifi_controller (CONFIG_WIFI_C_EVENT_TRACE).
+#
+# Usage:
+#   tools/wifi_c_trace.py extract monitor.log trace.bin   hex lines of wifi_c_trace_print() -> binary trace
+#   tools/wifi_c_trace.py show trace.bin                  list events with timestamps
+#   tools/wifi_c_trace.py carray trace.bin [name]         C array to pass to wifi_c_trace_replay()
+#
+# Format of binary trace is described in include/wifi_c_trace.h. Payload offsets
+# below follow ESP-IDF event structs on Xtensa/RISC-V targets.
+
+import re
+import struct
+import sys
+
+MAGIC = 0x52544357
+VERSION = 1
+HEADER = struct.Struct("<IB3xI")
+RECORD = struct.Struct("<IBBBx")
+
+WIFI_EVENTS = [
+    "WIFI_READY", "SCAN_DONE", "STA_START", "STA_STOP", "STA_CONNECTED", "STA_DISCONNECTED",
+    "STA_AUTHMODE_CHANGE", "STA_WPS_ER_SUCCESS", "STA_WPS_ER_FAILED", "STA_WPS_ER_TIMEOUT",
+    "STA_WPS_ER_PIN", "STA_WPS_ER_PBC_OVERLAP", "AP_START", "AP_STOP", "AP_STACONNECTED",
+    "AP_STADISCONNECTED", "AP_PROBEREQRECVED",
+]
+IP_EVENTS = [
+    "STA_GOT_IP", "STA_LOST_IP", "AP_STAIPASSIGNED", "GOT_IP6", "ETH_GOT_IP", "ETH_LOST_IP",
+    "PPP_GOT_IP", "PPP_LOST_IP",
+]
+
+LINE = re.compile(r"WCTR ([0-9a-fA-F]{4,}) ([0-9a-fA-F]+)")
+
+
+def mac(data):
+    return ":".join("%02x" % b for b in data)
+
+
+def ip(data):
+    return ".".join(str(b) for b in data)
+
+
+def ssid(data):
+    return data[:32].split(b"\0", 1)[0].decode("utf-8", "replace")
+
+
+def describe(base, event_id, payload):
+    if base == 1:
+        name = "IP_EVENT_" + (IP_EVENTS[event_id] if event_id < len(IP_EVENTS) else str(event_id))
+        if event_id == 0 and len(payload) >= 13:
+            return name, "ip %s mask %s gw %s%s" % (ip(payload[0:4]), ip(payload[4:8]), ip(payload[8:12]),
+                                                    ", changed" if payload[12] else "")
+        if event_id == 2 and len(payload) >= 10:
+            return name, "ip %s mac %s" % (ip(payload[0:4]), mac(payload[4:10]))
+        return name, ""
+
+    name = "WIFI_EVENT_" + (WIFI_EVENTS[event_id] if event_id < len(WIFI_EVENTS) else str(event_id))
+    if event_id == 1 and len(payload) >= 5:
+        return name, "status %u, %u APs" % (struct.unpack_from("<I", payload)[0], payload[4])
+    if event_id == 4 and len(payload) >= 40:
+        return name, "ssid '%s' bssid %s channel %u" % (ssid(payload), mac(payload[33:39]), payload[39])
+    if event_id == 5 and len(payload) >= 41:
+        return name, "ssid '%s' bssid %s reason %u rssi %d" % (ssid(payload), mac(payload[33:39]), payload[39],
+                                                               struct.unpack_from("<b", payload, 40)[0])
+    if event_id in (14, 15) and len(payload) >= 7:
+        return name, "mac %s aid %u" % (mac(payload[0:6]), payload[6])
+    return name, ""
+
+
+def read_events(trace):
+    if len(trace) < HEADER.size:
+        raise ValueError("trace too short")
+    magic, version, dropped = HEADER.unpack_from(trace)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("not a wifi_controller trace, or unknown version")
+    events = []
+    offset = HEADER.size
+    while offset + RECORD.size <= len(trace):
+        delta_us, base, event_id, length = RECORD.unpack_from(trace, offset)
+        payload = trace[offset + RECORD.size:offset + RECORD.size + length]
+        if len(payload) < length:
+            break
+        events.append((delta_us, base, event_id, payload))
+        offset += RECORD.size + length
+    return dropped, events
+
+
+def extract(log_path, out_path):
+    chunks = {}
+    with open(log_path, errors="replace") as log:
+        for line in log:
+            match = LINE.search(line)
+            if match:
+                offset = int(match.group(1), 16)
+                if offset == 0:
+                    chunks = {}  # newer print of trace starts, keep only the last one
+                chunks[offset] = bytes.fromhex(match.group(2))
+    trace = b""
+    for offset in sorted(chunks):
+        if offset != len(trace):
+            raise ValueError("line with offset %04x is missing" % len(trace))
+        trace += chunks[offset]
+    read_events(trace)
+    with open(out_path, "wb") as out:
+        out.write(trace)
+    print("%u bytes written to %s" % (len(trace), out_path))
+
+
+def show(path):
+    with open(path, "rb") as f:
+        dropped, events = read_events(f.read())
+    if dropped:
+        print("%u older records were overwritten before dump" % dropped)
+    time_us = 0
+    for delta_us, base, event_id, payload in events:
+        time_us += delta_us
+        name, details = describe(base, event_id, payload)
+        print("%10.3f ms  +%9.3f ms  %-32s %s" % (time_us / 1000, delta_us / 1000, name, details))
+
+
+def carray(path, name):
+    with open(path, "rb") as f:
+        trace = f.read()
+    read_events(trace)
+    print("static const uint8_t %s[%u] = {" % (name, len(trace)))
+    for i in range(0, len(trace), 16):
+        print("    " + " ".join("0x%02x," % b for b in trace[i:i + 16]))
+    print("};")
+
+
+def main(argv):
+    if len(argv) >= 4 and argv[1] == "extract":
+        extract(argv[2], argv[3])
+    elif len(argv) >= 3 and argv[1] == "show":
+        show(argv[2])
+    elif len(argv) >= 3 and argv[1] == "carray":
+        carray(argv[2], argv[3] if len(argv) >= 4 else "wifi_trace")
+    else:
+        sys.stderr.write("usage: wifi_c_trace.py extract <log> <trace.bin> | show <trace.bin> | carray <trace.bin> [name]\n")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,266 @@
+/*
+ * Replay WiFi/IP event trace recorded by wifi_controller (CONFIG_WIFI_C_EVENT_TRACE) on host.
+ *
+ * Usage:
+ *   wifi_c_trace_replay [-r] <trace.bin | monitor.log>
+ *
+ * Trace is read with parser of src/wifi_c_trace.c, either as binary trace or as hex lines
+ * printed by wifi_c_trace_print(). Events are listed in order, with -r time between them is kept
+ * as recorded. Records are checked by same rules as wifi_c_trace_replay() on target, so events and
+ * skipped counts match the ones replay on board reports.
+ *
+ * Build: cc -Iinclude tools/wifi_c_trace_replay.c src/wifi_c_trace.c -o wifi_c_trace_replay
+ * or with host tests - see test/host/CMakeLists.txt.
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "wifi_c_trace.h"
+
+#define TRACE_MAX_SIZE                  (256 * 1024)
+
+/*Event ids of ESP-IDF, host has no esp_wifi_types.h.*/
+static const char *const wifi_events[] = {
+    "WIFI_READY", "SCAN_DONE", "STA_START", "STA_STOP", "STA_CONNECTED", "STA_DISCONNECTED",
+    "STA_AUTHMODE_CHANGE", "STA_WPS_ER_SUCCESS", "STA_WPS_ER_FAILED", "STA_WPS_ER_TIMEOUT",
+    "STA_WPS_ER_PIN", "STA_WPS_ER_PBC_OVERLAP", "AP_START", "AP_STOP", "AP_STACONNECTED",
+    "AP_STADISCONNECTED", "AP_PROBEREQRECVED",
+};
+static const char *const ip_events[] = {
+    "STA_GOT_IP", "STA_LOST_IP", "AP_STAIPASSIGNED", "GOT_IP6", "ETH_GOT_IP", "ETH_LOST_IP",
+    "PPP_GOT_IP", "PPP_LOST_IP",
+};
+
+#define WIFI_EVENT_STA_CONNECTED        4
+#define WIFI_EVENT_STA_DISCONNECTED     5
+#define WIFI_EVENT_AP_STACONNECTED      14
+#define WIFI_EVENT_AP_STADISCONNECTED   15
+#define IP_EVENT_STA_GOT_IP             0
+#define GOT_IP_PAYLOAD                  13          // ip_info and ip_changed
+
+struct replay_stats {
+    uint32_t events;
+    uint32_t skipped;
+    uint32_t disconnects;
+    uint32_t got_ip;
+    uint64_t duration_us;
+};
+
+/**
+ * @brief Same check as wifi_c_trace_decode() on target, handlers read data of these events.
+ */
+static bool event_valid(const wifi_c_trace_event_t *event)
+{
+    if (event->record.base == WIFI_C_TRACE_BASE_IP)
+    {
+        return event->record.id == IP_EVENT_STA_GOT_IP && event->record.len >= GOT_IP_PAYLOAD;
+    }
+    if (event->record.base != WIFI_C_TRACE_BASE_WIFI)
+    {
+        return false;
+    }
+    switch (event->record.id)
+    {
+    case WIFI_EVENT_STA_DISCONNECTED:
+    case WIFI_EVENT_AP_STACONNECTED:
+    case WIFI_EVENT_AP_STADISCONNECTED:
+        return event->record.len != 0;
+    default:
+        return true;
+    }
+}
+
+static void print_details(const wifi_c_trace_event_t *event)
+{
+    const uint8_t *p = event->payload;
+
+    if (event->record.base == WIFI_C_TRACE_BASE_IP && event->record.id == IP_EVENT_STA_GOT_IP &&
+        event->record.len >= GOT_IP_PAYLOAD)
+    {
+        printf(" ip %u.%u.%u.%u gw %u.%u.%u.%u%s", p[0], p[1], p[2], p[3], p[8], p[9], p[10], p[11],
+               p[12] ? ", changed" : "");
+        return;
+    }
+    if (event->record.base != WIFI_C_TRACE_BASE_WIFI)
+    {
+        return;
+    }
+    if (event->record.id == WIFI_EVENT_STA_CONNECTED && event->record.len >= 40)
+    {
+        printf(" ssid '%.32s' channel %u", (const char *)p, p[39]);
+    }
+    else if (event->record.id == WIFI_EVENT_STA_DISCONNECTED && event->record.len >= 41)
+    {
+        printf(" ssid '%.32s' reason %u rssi %d", (const char *)p, p[39], (int8_t)p[40]);
+    }
+    else if ((event->record.id == WIFI_EVENT_AP_STACONNECTED || event->record.id == WIFI_EVENT_AP_STADISCONNECTED) &&
+             event->record.len >= 7)
+    {
+        printf(" mac %02x:%02x:%02x:%02x:%02x:%02x aid %u", p[0], p[1], p[2], p[3], p[4], p[5], p[6]);
+    }
+}
+
+static void print_event(const wifi_c_trace_event_t *event, uint64_t time_us, bool valid)
+{
+    const char *const *names = (event->record.base == WIFI_C_TRACE_BASE_IP) ? ip_events : wifi_events;
+    size_t count = (event->record.base == WIFI_C_TRACE_BASE_IP) ? sizeof(ip_events) / sizeof(ip_events[0])
+                                                                 : sizeof(wifi_events) / sizeof(wifi_events[0]);
+
+    printf("%10.3f ms  %s", time_us / 1000.0, (event->record.base == WIFI_C_TRACE_BASE_IP) ? "IP_EVENT_" : "WIFI_EVENT_");
+    if (event->record.id < count && event->record.base <= WIFI_C_TRACE_BASE_IP)
+    {
+        printf("%s", names[event->record.id]);
+    }
+    else
+    {
+        printf("%u", event->record.id);
+    }
+    if (valid)
+    {
+        print_details(event);
+    }
+    else
+    {
+        printf(" (skipped)");
+    }
+    printf("\n");
+}
+
+static void sleep_us(uint64_t us)
+{
+    struct timespec ts = {.tv_sec = (time_t)(us / 1000000), .tv_nsec = (long)(us % 1000000) * 1000};
+    nanosleep(&ts, NULL);
+}
+
+/**
+ * @brief Read binary trace, or rebuild it from "WCTR <offset> <hex>" lines, last printed trace wins.
+ *
+ * @return Length of trace, 0 on error.
+ */
+static size_t read_trace(const char *path, uint8_t *trace, size_t size)
+{
+    FILE *file = fopen(path, "rb");
+    size_t len = 0;
+    size_t offset = 0;
+    char line[512];
+
+    if (file == NULL)
+    {
+        perror(path);
+        return 0;
+    }
+    len = fread(trace, 1, size, file);
+    if (wifi_c_trace_begin(trace, len, &offset))
+    {
+        fclose(file);
+        return len;
+    }
+
+    rewind(file);
+    len = 0;
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        const char *marker = strstr(line, "WCTR ");
+        unsigned line_offset = 0;
+        char hex[sizeof(line)];
+
+        if (marker == NULL || sscanf(marker, "WCTR %x %511s", &line_offset, hex) != 2)
+        {
+            continue;
+        }
+        if (line_offset != len && line_offset != 0)
+        {
+            fprintf(stderr, "line with offset %04x is missing\n", (unsigned)len);
+            len = 0;
+            break;
+        }
+        len = line_offset; // offset 0 starts newer print of trace
+        for (const char *h = hex; h[0] != '\0' && h[1] != '\0' && len < size; h += 2)
+        {
+            unsigned byte = 0;
+            sscanf(h, "%2x", &byte);
+            trace[len++] = (uint8_t)byte;
+        }
+    }
+    fclose(file);
+    return len;
+}
+
+int main(int argc, char **argv)
+{
+    bool real_time = false;
+    const char *path = NULL;
+    static uint8_t trace[TRACE_MAX_SIZE];
+    struct replay_stats stats = {0};
+    wifi_c_trace_header_t header;
+    wifi_c_trace_event_t event;
+    size_t offset = 0;
+    size_t len = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-r") == 0)
+        {
+            real_time = true;
+        }
+        else
+        {
+            path = argv[i];
+        }
+    }
+    if (path == NULL)
+    {
+        fprintf(stderr, "usage: %s [-r] <trace.bin | monitor.log>\n", argv[0]);
+        return 2;
+    }
+
+    len = read_trace(path, trace, sizeof(trace));
+    if (!wifi_c_trace_begin(trace, len, &offset))
+    {
+        fprintf(stderr, "%s: not a wifi_controller trace, or unknown version\n", path);
+        return 1;
+    }
+    memcpy(&header, trace, sizeof(header));
+    if (header.dropped != 0)
+    {
+        printf("%u older records were overwritten before dump\n", (unsigned)header.dropped);
+    }
+
+    while (wifi_c_trace_next(trace, len, &offset, &event))
+    {
+        bool valid = event_valid(&event);
+
+        stats.duration_us += event.record.delta_us;
+        if (real_time)
+        {
+            sleep_us(event.record.delta_us);
+        }
+        print_event(&event, stats.duration_us, valid);
+        if (!valid)
+        {
+            stats.skipped++;
+            continue;
+        }
+        stats.events++;
+        if (event.record.base == WIFI_C_TRACE_BASE_WIFI && event.record.id == WIFI_EVENT_STA_DISCONNECTED)
+        {
+            stats.disconnects++;
+        }
+        else if (event.record.base == WIFI_C_TRACE_BASE_IP)
+        {
+            stats.got_ip++;
+        }
+    }
+    if (offset != len)
+    {
+        printf("last record is truncated\n");
+    }
+
+    printf("Replayed %u events, %u skipped, %u disconnects, %u got IP, %.3f ms\n", (unsigned)stats.events,
+           (unsigned)stats.skipped, (unsigned)stats.disconnects, (unsigned)stats.got_ip, stats.duration_us / 1000.0);
+    return 0;
+}